@@ -56,6 +56,23 @@
 #include "storyline.h"
 #include "companion.h"
 #include "new_apps.h"
+#include "imu_fifo.h"
+#include "activity_history.h"
+#include "wrist_wake.h"
+#include "compass_app.h"
+#include "sleep_tracker.h"
+#include "time_service.h"
+#include "scheduler.h"
+#include "loop_events.h"
+#include "energy_monitor.h"
+#include "dvfs_governor.h"
+#include "fuel_gauge.h"
+#include "persist.h"
+#include "save_schema.h"
+#include "save_scheduler.h"
+#include "nvs_inspector.h"
+#include <esp_sleep.h>
+#include <driver/gpio.h>
 
 // =============================================================================
 // POWER MANAGEMENT DEFINES
@@ -140,10 +157,12 @@ void IRAM_ATTR touchWakeISR() {
     touchWakeFlag = true;
     touch_interrupt = true;   // Also trigger touch input handling
     lastActivityMs = millis();
+    loopEventFromISR(LOOP_EVT_TOUCH);
 }
 
 void IRAM_ATTR powerButtonISR() {
     buttonWakeFlag = true;
+    loopEventFromISR(LOOP_EVT_BUTTON);
 }
 
 // =============================================================================
@@ -275,6 +294,8 @@ void screenOff() {
     Serial.println("[POWER] Screen OFF - smooth fade");
     
     screenOn = false;
+    stopCompass();
+    persistFlush(PERSIST_REASON_SCREEN_OFF);
     
     int currentBrightness = system_state.brightness;
     for (int b = currentBrightness; b >= 0; b -= 20) {
@@ -303,6 +324,7 @@ void screenOnFunc() {
         delay(8);
     }
     gfx->setBrightness(system_state.brightness);
+    energyNoteBrightness(system_state.brightness);
     
     screenOn = true;
     lastActivityMs = millis();
@@ -362,12 +384,78 @@ void checkTouchWake() {
     }
 }
 
+// Daily quest reset: a repeating scheduler deadline just after midnight
+void onDailyResetEvent(const SchedEvent& ev, uint32_t late_ms) {
+    (void)ev;
+    (void)late_ms;
+    checkDailyReset();
+}
+
+void checkWristWake() {
+    unsigned long trigger_ms;
+    if (pollWristRaise(&trigger_ms)) {
+        if (!screenOn) {
+            screenOnFunc();
+            recordWristWakeLatency(trigger_ms);
+        }
+        lastActivityMs = millis();
+    }
+}
+
+// Screen-off idle: light sleep until touch, button, IMU or the poll timer
+void idleLightSleep(uint32_t max_ms) {
+#if WRIST_LIGHT_SLEEP
+    gpio_wakeup_enable((gpio_num_t)TP_INT, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)PWR_BUTTON, GPIO_INTR_LOW_LEVEL);
+    enableWristWakeSource();
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)max_ms * 1000);
+    
+    Serial.flush();
+    esp_light_sleep_start();
+    
+    // Level wake sources would keep re-firing the edge ISRs - restore them
+    gpio_wakeup_disable((gpio_num_t)TP_INT);
+    gpio_wakeup_disable((gpio_num_t)PWR_BUTTON);
+    gpio_set_intr_type((gpio_num_t)TP_INT, GPIO_INTR_NEGEDGE);
+    gpio_set_intr_type((gpio_num_t)PWR_BUTTON, GPIO_INTR_NEGEDGE);
+#if WRIST_WAKE_INT_PIN >= 0
+    gpio_wakeup_disable((gpio_num_t)WRIST_WAKE_INT_PIN);
+    gpio_set_intr_type((gpio_num_t)WRIST_WAKE_INT_PIN, GPIO_INTR_POSEDGE);
+#endif
+    
+    // Edge ISRs do not run for a level wake - latch the flags here
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        if (digitalRead(TP_INT) == LOW) {
+            touchWakeFlag = true;
+            loopEventSet(LOOP_EVT_TOUCH);
+        }
+        if (digitalRead(PWR_BUTTON) == LOW) {
+            buttonWakeFlag = true;
+            loopEventSet(LOOP_EVT_BUTTON);
+        }
+#if WRIST_WAKE_INT_PIN >= 0
+        if (digitalRead(WRIST_WAKE_INT_PIN) == HIGH) wristWakeISR();
+#endif
+    }
+#else
+    delay(max_ms);
+#endif
+}
+
 // =============================================================================
 // FORWARD DECLARATIONS
 // =============================================================================
 void updateCurrentScreen();
 void handleTouchGesture(TouchGesture& gesture);
 void saveAllData();
+void saveAllGameData();
+
+// Full-save steps after the write-behind records (save_scheduler.h)
+static bool saveGameStep() {
+  saveGameProgress();
+  return true;
+}
 
 // =============================================================================
 // SETUP
@@ -385,6 +473,28 @@ void setup() {
   initWatchdog();
   feedWatchdog();
   
+  // Before any ISR or timer that signals the loop is armed
+  initLoopEvents();
+  
+  // Key-set versions checked (and migrated) before anything loads
+  initSaveSchema();
+
+  // Write-behind records: modules mark, the cache decides when to write
+  initPersist();
+  persistSetWriter(PERSIST_GAME, saveAllGameData);
+  persistSetWriter(PERSIST_XP, saveXPData);
+  persistSetWriter(PERSIST_STEPS, saveStepsData);
+  persistSetWriter(PERSIST_QUESTS, saveDailyQuestsData);
+  persistSetWriter(PERSIST_GACHA, saveGachaProgress);
+  persistSetWriter(PERSIST_BOSS, saveBossProgress);
+  persistSetWriter(PERSIST_TRAINING, saveTrainingProgress);
+  persistSetWriter(PERSIST_STORY, saveStoryProgress);
+  saveSchedAddStep("game", saveGameStep, ENERGY_STORE_NVS);
+  saveSchedAddStep("activity", saveActivityHistory, ENERGY_STORE_NVS);
+  // cards.dat is the gacha checkpoint, written by the PERSIST_GACHA writer
+  saveSchedAddStep("player.dat", savePlayerDataToSD, ENERGY_STORE_SD);
+  saveSchedAddStep("progress.dat", saveBossDataToSD, ENERGY_STORE_SD);
+  
   checkBootPanic();
   feedWatchdog();
   
@@ -424,6 +534,8 @@ void setup() {
   attachInterrupt(digitalPinToInterrupt(PWR_BUTTON), powerButtonISR, FALLING);
   Serial.println("[INIT] Power button: GPIO 10");
   
+  initWristWake();
+  
   initializeThemes();
   feedWatchdog();
   
@@ -438,9 +550,6 @@ void setup() {
   initializeGames();
   feedWatchdog();
   
-  initGachaSystem();
-  feedWatchdog();
-  
   initTrainingSystem();
   feedWatchdog();
   
@@ -456,6 +565,11 @@ void setup() {
   initFilesystem();
   feedWatchdog();
   
+  // cards.dat and its journal are on the SD card: load and replay only
+  // once initFilesystem() has mounted it
+  initGachaSystem();
+  feedWatchdog();
+  
   Serial.println("[INIT] Initializing WiFi sync...");
   feedWatchdog();
   initWiFiSync();  // Always load SD card networks (even in safe mode)
@@ -504,7 +618,17 @@ void setup() {
   
   initStepsTracker();
   feedWatchdog();
+  initCompassApp();
+  feedWatchdog();
+  initSleepTracker();
+  feedWatchdog();
   initDailyQuests();
+  schedulerSetHandler(SCHED_DAILY_RESET, onDailyResetEvent);
+  if (!schedulerFind(SCHED_DAILY_RESET, 0)) {
+    schedulerAdd(SCHED_DAILY_RESET, 0, schedulerNextDaily(0, 0) + 5000, 86400, "Daily");
+  }
+  checkDailyReset();
+  initPomodoroTimer();
   feedWatchdog();
   initStorySystem();
   feedWatchdog();
@@ -515,6 +639,11 @@ void setup() {
   screenOn = true;
   
   initPowerManager();
+  initEnergyMonitor();
+  initDvfsGovernor();
+  initFuelGauge();
+  initSaveScheduler();
+  initNvsInspector();
   feedWatchdog();
   
   system_state.current_screen = SCREEN_WATCHFACE;
@@ -550,23 +679,56 @@ void setup() {
 // =============================================================================
 
 void loop() {
-  feedWatchdog();
+  // Block until an event or the earliest deadline (light sleep with the screen off)
+  uint32_t events = loopWaitEvents(screenOn ? NULL : idleLightSleep);
+  updateEnergyMonitor();
+  updateFuelGauge();
   
-  static unsigned long lastAutoSave = 0;
-  if (millis() - lastAutoSave > 300000) {
-    lastAutoSave = millis();
-    saveAllData();
-    Serial.println("[AUTO-SAVE] All game data saved (5 min interval)");
-  }
+  feedWatchdog();
   
   updatePowerState();
+  dvfsUpdateLimits();
+  
+  // Cached clock: RTC resync + minute/hour/day events
+  updateTimeService();
+  
+  // Alarms, timers, Pomodoro phases, daily reset (no-op until a deadline)
+  updateScheduler();
+  
+  // Write-behind flushes and the full-save backstop, in quiet moments
+  updateSaveScheduler(screenOn, millis() - lastActivityMs);
+  
+  // Drain the IMU FIFO in bursts and feed the step engine + classifier
+  // (runs with the screen off too - the ring only holds ~4.5 s). Screen
+  // off, the status poll is stretched and the wrist STATUS1 read rides it.
+  imuFifoSetPollMs(screenOn ? IMU_FIFO_POLL_MS : getWristPollMs());
+  serviceIMUFifo();
+  serviceImuTrace();
+  updateStepCount();
+  updateSleepTracker();
+  
+  if ((events & LOOP_EVT_SERIAL) || Serial.available()) {
+    handleSerialConfig();
+  }
   
   checkPowerButton();
   
   checkTouchWake();
   
+  if (!screenOn) {
+    checkWristWake();
+  }
+  
   if (screenOn) {
-    TouchGesture gesture = handleTouchInput();
+    dvfsFrameBegin();
+    if (events & LOOP_EVT_TOUCH) dvfsBoost();
+    
+    // FT3168 pulls INT on contact; track the gesture at frame rate until release
+    bool pollTouch = !LOOP_TOUCH_ON_INT || (events & LOOP_EVT_TOUCH) ||
+                     touch_interrupt || isTouchPressed();
+    touch_interrupt = false;
+    TouchGesture gesture = {};
+    if (pollTouch) gesture = handleTouchInput();
     
     if (gesture.is_valid && gesture.event != TOUCH_NONE) {
       recordInteraction();
@@ -584,21 +746,10 @@ void loop() {
     
     updateCurrentScreen();
     
-    static unsigned long lastStepUpdate = 0;
-    int step_interval = getSensorPollInterval();
-    if (millis() - lastStepUpdate > step_interval) {
-      updateStepCount();
-      lastStepUpdate = millis();
-    }
-    
-    static unsigned long lastQuestCheck = 0;
-    if (millis() - lastQuestCheck > 60000) {
-      checkDailyReset();
-      lastQuestCheck = millis();
-    }
+    // Pomodoro countdown display - the phases themselves are scheduler deadlines
+    if (system_state.current_screen == SCREEN_POMODORO) updatePomodoro();
     
-    // Update Pomodoro timer
-    updatePomodoro();
+    dvfsFrameEnd(getPowerLoopDelay());
     
     // SIMPLE 5-SECOND TIMEOUT CHECK (bypasses power manager)
     if (millis() - lastActivityMs >= SCREEN_OFF_TIMEOUT_MS) {
@@ -606,8 +757,20 @@ void loop() {
     }
   }
   
-  int loop_delay = getPowerLoopDelay();
-  delay(loop_delay);
+  // Next wake: the earliest periodic job (events cut the wait short)
+  if (screenOn) {
+    loopWakeWithin(getPowerLoopDelay(), LOOP_DL_FRAME);
+    unsigned long idle = millis() - lastActivityMs;
+    loopWakeWithin(idle >= SCREEN_OFF_TIMEOUT_MS ? 0 : SCREEN_OFF_TIMEOUT_MS - idle, LOOP_DL_SCREEN_TIMEOUT);
+  } else {
+    loopWakeWithin(getWristSleepMs(), LOOP_DL_WRIST);
+  }
+  loopWakeWithin(saveSchedMsUntilNext(), LOOP_DL_SAVE);
+  loopWakeWithin(timeServiceMsUntilNext(), LOOP_DL_TIME);
+  loopWakeWithin(schedulerMsUntilNext(), LOOP_DL_SCHEDULER);
+  loopWakeWithin(imuFifoMsUntilService(), LOOP_DL_IMU);
+  loopWakeWithin(sleepTrackerMsUntilEpoch(), LOOP_DL_SLEEP_EPOCH);
+  loopWakeWithin(fuelGaugeMsUntilSample(), LOOP_DL_FUEL);
 }
 
 // =============================================================================
@@ -901,6 +1064,15 @@ void handleTouchGesture(TouchGesture& gesture) {
       }
       break;
     
+    case SCREEN_COMPASS:
+      if (gesture.event == TOUCH_SWIPE_LEFT || gesture.event == TOUCH_SWIPE_DOWN) {
+        closeCompassApp();
+        returnToAppGrid();
+      } else {
+        handleCompassTouch(gesture);
+      }
+      break;
+    
     case SCREEN_SD_BACKUP:
       if (gesture.event == TOUCH_TAP) {
         if (in_backup_list_view) {
@@ -914,6 +1086,10 @@ void handleTouchGesture(TouchGesture& gesture) {
       }
       break;
     
+    case SCREEN_NVS_INSPECTOR:
+      handleNvsInspectorTouch(gesture);
+      break;
+    
     default:
       break;
   }
@@ -935,6 +1111,8 @@ void updateCurrentScreen() {
     last_screen = system_state.current_screen;
     Serial.printf("[SCREEN] Changed to: %d\n", system_state.current_screen);
     
+    if (system_state.current_screen != SCREEN_COMPASS) stopCompass();
+    
     extern void forceWatchfaceRedraw();
     forceWatchfaceRedraw();
   }
@@ -964,6 +1142,10 @@ void updateCurrentScreen() {
     updateTimerDisplay();
   }
   
+  if (system_state.current_screen == SCREEN_COMPASS) {
+    updateCompassDisplay();
+  }
+  
   if (system_state.current_screen == SCREEN_GAMES && shouldAnimationsRun()) {
     AdvancedGameManager::updateGame();
   }
@@ -1076,21 +1258,8 @@ void loadAllGameData() {
 }
 
 void saveAllData() {
-  saveAllGameData();
-  saveGachaProgress();
-  saveGameProgress();
-  saveTrainingProgress();
-  saveBossProgress();
-  saveXPData();
-  saveStepsData();
-  saveStoryProgress();
-  
-  // Also save to SD card if available
-  if (sdCardInitialized) {
-    savePlayerDataToSD();
-    saveGachaDataToSD();
-    saveBossDataToSD();
-  }
-  
+  // Every record and full-save step in this call; the periodic backstop
+  // goes through the save scheduler instead
+  saveSchedSaveNow(screenOn);
   Serial.println("[SAVE] All data saved (NVS + SD card)");
 }
\ No newline at end of file
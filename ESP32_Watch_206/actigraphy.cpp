@@ -0,0 +1,262 @@
+/*
+ * actigraphy.cpp - Sleep/Wake Scoring Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "actigraphy.h"
+#include "step_engine.h"
+#include <string.h>
+
+// Cole-Kripke 1-minute weights for epochs -4 .. +2 (scaled by 1000)
+static const int16_t ck_weights[7] = {106, 54, 58, 76, 230, 74, 67};
+#define CK_THRESHOLD  1000    // D = sum / 1000, sleep when D < 1
+
+// =============================================================================
+// EPOCH COUNTER
+// =============================================================================
+
+void actigraphyCounterInit(ActigraphyCounter& c, uint16_t odr_hz, int32_t lsb_per_g) {
+  memset(&c, 0, sizeof(ActigraphyCounter));
+  c.odr_hz = odr_hz ? odr_hz : 50;
+  c.lsb_per_g = lsb_per_g;
+}
+
+void actigraphyAddSample(ActigraphyCounter& c, int16_t ax, int16_t ay, int16_t az) {
+  uint32_t sq = (uint32_t)((int32_t)ax * ax) + (uint32_t)((int32_t)ay * ay) +
+                (uint32_t)((int32_t)az * az);
+  int32_t mag = (int32_t)(stepEngineSqrt(sq) * 1000 / c.lsb_per_g);
+
+  if (!c.primed) {
+    c.baseline_q = mag << ACTI_BASELINE_SHIFT;
+    c.primed = true;
+  }
+  c.baseline_q += mag - (c.baseline_q >> ACTI_BASELINE_SHIFT);
+
+  int32_t dev = mag - (c.baseline_q >> ACTI_BASELINE_SHIFT);
+  if (dev < 0) dev = -dev;
+  if (dev > ACTI_DEADBAND_MG) c.dev_sum += dev - ACTI_DEADBAND_MG;
+  c.samples++;
+}
+
+uint16_t actigraphyCloseEpoch(ActigraphyCounter& c) {
+  uint32_t count = c.dev_sum / c.odr_hz / ACTI_COUNT_MG_S;
+  if (count > ACTI_COUNT_MAX) count = ACTI_COUNT_MAX;
+  c.dev_sum = 0;
+  c.samples = 0;
+  return (uint16_t)count;
+}
+
+// =============================================================================
+// SCORING
+// =============================================================================
+
+void actigraphyScore(const uint16_t* counts, uint16_t n, uint8_t* sleep) {
+  for (int i = 0; i < n; i++) {
+    int32_t d = 0;
+    for (int k = 0; k < 7; k++) {
+      int j = i + k - 4;
+      if (j >= 0 && j < n) d += (int32_t)ck_weights[k] * counts[j];
+    }
+    sleep[i] = d < CK_THRESHOLD ? 1 : 0;
+  }
+}
+
+static uint16_t runEnd(const uint8_t* sleep, uint16_t n, uint16_t i) {
+  uint8_t v = sleep[i];
+  while (i < n && sleep[i] == v) i++;
+  return i;
+}
+
+void actigraphyRescore(uint8_t* sleep, uint16_t n) {
+  // Rules a-c: after 4/10/15 minutes of wake, the first 1/3/4 minutes of
+  // sleep are rescored as wake
+  uint16_t i = 0;
+  while (i < n) {
+    uint16_t end = runEnd(sleep, n, i);
+    if (sleep[i] == 1) {
+      i = end;
+      continue;
+    }
+    uint16_t wake = end - i;
+    uint16_t k = wake >= 15 ? 4 : wake >= 10 ? 3 : wake >= 4 ? 1 : 0;
+
+    // Then skip the rest of that sleep bout, so rescored minutes do not
+    // lengthen the next wake run and cascade
+    uint16_t next = end < n ? runEnd(sleep, n, end) : n;
+    for (uint16_t m = end; m < next && m < end + k; m++) sleep[m] = 0;
+    i = next;
+  }
+
+  // Rules d-e: short sleep bouts inside long wake stretches
+  i = 0;
+  uint16_t wake_before = 0;
+  while (i < n) {
+    uint16_t end = runEnd(sleep, n, i);
+    uint16_t len = end - i;
+    if (sleep[i] == 0) {
+      wake_before = len;
+      i = end;
+      continue;
+    }
+    uint16_t wake_after = end < n ? runEnd(sleep, n, end) - end : 0;
+    bool wake_both_10 = wake_before >= 10 && wake_after >= 10;
+    bool wake_both_20 = wake_before >= 20 && wake_after >= 20;
+    if ((len <= 6 && wake_both_10) || (len <= 10 && wake_both_20)) {
+      memset(sleep + i, 0, len);
+      // Merged into one wake run with its neighbours
+      wake_before = wake_before + len + wake_after;
+      i = end + wake_after;
+      continue;
+    }
+    wake_before = 0;
+    i = end;
+  }
+}
+
+void actigraphySummarize(const uint8_t* sleep, uint16_t n, SleepSummary& out) {
+  memset(&out, 0, sizeof(SleepSummary));
+  out.epochs = n;
+  out.onset = n;
+  out.offset = n;
+
+  uint16_t run = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    run = sleep[i] ? run + 1 : 0;
+    if (run >= ACTI_ONSET_EPOCHS) {
+      out.onset = i + 1 - run;
+      break;
+    }
+  }
+  if (out.onset >= n) return;
+
+  uint16_t last = out.onset;
+  for (uint16_t i = out.onset; i < n; i++) {
+    if (sleep[i]) last = i;
+  }
+  out.offset = last + 1;
+
+  bool in_wake = false;
+  for (uint16_t i = out.onset; i < out.offset; i++) {
+    if (sleep[i]) {
+      out.total_sleep++;
+      in_wake = false;
+    } else {
+      out.waso++;
+      if (!in_wake && out.awakenings < 255) out.awakenings++;
+      in_wake = true;
+    }
+  }
+  out.efficiency = n ? (uint8_t)((uint32_t)out.total_sleep * 100 / n) : 0;
+}
+
+uint8_t actigraphyLevel(uint16_t count) {
+  uint8_t level = 0;
+  while (count && level < 15) {
+    level++;
+    count >>= 1;
+  }
+  return level;
+}
+
+// =============================================================================
+// BIT PACKING (LSB first)
+// =============================================================================
+
+struct BitWriter {
+  uint8_t* buf;
+  size_t cap;
+  size_t bit;
+  bool overflow;
+};
+
+static void putBits(BitWriter& w, uint32_t value, uint8_t bits) {
+  for (uint8_t b = 0; b < bits; b++, w.bit++) {
+    size_t byte = w.bit >> 3;
+    if (byte >= w.cap) {
+      w.overflow = true;
+      return;
+    }
+    if (value & (1UL << b)) w.buf[byte] |= 1 << (w.bit & 7);
+    else w.buf[byte] &= ~(1 << (w.bit & 7));
+  }
+}
+
+struct BitReader {
+  const uint8_t* buf;
+  size_t len;
+  size_t bit;
+  bool overflow;
+};
+
+static uint32_t getBits(BitReader& r, uint8_t bits) {
+  uint32_t value = 0;
+  for (uint8_t b = 0; b < bits; b++, r.bit++) {
+    size_t byte = r.bit >> 3;
+    if (byte >= r.len) {
+      r.overflow = true;
+      return 0;
+    }
+    if (r.buf[byte] & (1 << (r.bit & 7))) value |= 1UL << b;
+  }
+  return value;
+}
+
+static uint32_t clampBits(uint32_t v, uint8_t bits) {
+  uint32_t max = (1UL << bits) - 1;
+  return v > max ? max : v;
+}
+
+size_t actigraphyPack(const SleepNight& night, uint8_t* out, size_t cap) {
+  const SleepSummary& s = night.summary;
+  if (s.epochs > ACTI_MAX_EPOCHS) return 0;
+
+  BitWriter w = {out, cap, 0, false};
+  putBits(w, ACTI_RECORD_MAGIC, 16);
+  putBits(w, ACTI_RECORD_VERSION, 4);
+  putBits(w, clampBits(night.year >= 2000 ? night.year - 2000 : 0, 7), 7);
+  putBits(w, night.month, 4);
+  putBits(w, night.day, 5);
+  putBits(w, night.start_minute, 11);
+  putBits(w, s.epochs, 10);
+  putBits(w, s.onset, 10);
+  putBits(w, s.offset, 10);
+  putBits(w, s.total_sleep, 10);
+  putBits(w, s.waso, 10);
+  putBits(w, clampBits(s.awakenings, 6), 6);
+  putBits(w, clampBits(s.efficiency, 7), 7);
+
+  for (uint16_t i = 0; i < s.epochs; i++) {
+    putBits(w, night.sleep[i] ? 1 : 0, 1);
+    putBits(w, night.level[i] & 0x0F, 4);
+  }
+  if (w.overflow) return 0;
+  return (w.bit + 7) >> 3;
+}
+
+size_t actigraphyUnpack(const uint8_t* in, size_t len, SleepNight& night) {
+  BitReader r = {in, len, 0, false};
+  if (getBits(r, 16) != ACTI_RECORD_MAGIC) return 0;
+  if (getBits(r, 4) != ACTI_RECORD_VERSION) return 0;
+
+  memset(&night, 0, sizeof(SleepNight));
+  SleepSummary& s = night.summary;
+  night.year = 2000 + getBits(r, 7);
+  night.month = getBits(r, 4);
+  night.day = getBits(r, 5);
+  night.start_minute = getBits(r, 11);
+  s.epochs = getBits(r, 10);
+  s.onset = getBits(r, 10);
+  s.offset = getBits(r, 10);
+  s.total_sleep = getBits(r, 10);
+  s.waso = getBits(r, 10);
+  s.awakenings = getBits(r, 6);
+  s.efficiency = getBits(r, 7);
+  if (s.epochs > ACTI_MAX_EPOCHS) return 0;
+
+  for (uint16_t i = 0; i < s.epochs; i++) {
+    night.sleep[i] = getBits(r, 1);
+    night.level[i] = getBits(r, 4);
+  }
+  if (r.overflow) return 0;
+  return (r.bit + 7) >> 3;
+}
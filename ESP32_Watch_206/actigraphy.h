@@ -0,0 +1,104 @@
+/*
+ * actigraphy.h - Sleep/Wake Scoring from Activity Counts
+ * FUSION OS Sensor Layer
+ *
+ * Minute activity counts are built from raw accelerometer samples: the
+ * magnitude's deviation from its slow baseline, above a small dead band,
+ * integrated over the epoch (mg*s / ACTI_COUNT_MG_S). A still wrist gives
+ * zero, turning over in bed a few counts and an awake minute ~50 - the
+ * range the Cole-Kripke weights expect, where a count of ~5 or more in the
+ * scored minute reads as wake.
+ *
+ * Scoring is Cole-Kripke (1992, 1-minute epochs) on a 7-epoch weighted
+ * window, followed by Webster's rescoring rules that turn short "sleep"
+ * islands inside long wake stretches back into wake.
+ *
+ * A night packs into a bit stream: a header with the summary, then 5 bits
+ * per epoch (sleep flag + 4-bit log2 activity level), ~450 bytes for 12 h.
+ *
+ * Integer-only per sample and Arduino-free so recorded traces can be
+ * replayed and scored on a PC.
+ */
+
+#ifndef ACTIGRAPHY_H
+#define ACTIGRAPHY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =============================================================================
+// TUNING
+// =============================================================================
+#define ACTI_DEADBAND_MG        12      // Sensor noise + pulse, ignored
+#define ACTI_BASELINE_SHIFT     6       // Baseline EMA (~1s at 56 Hz)
+#define ACTI_COUNT_MG_S         100     // mg*s per activity count
+#define ACTI_COUNT_MAX          1000
+
+#define ACTI_MAX_EPOCHS         720     // 12 h of 1-minute epochs
+#define ACTI_ONSET_EPOCHS       10      // Consecutive sleep minutes for onset
+#define ACTI_RECORD_VERSION     1
+#define ACTI_RECORD_MAGIC       0x534C  // "SL"
+
+// Worst-case packed size (header + 5 bits per epoch)
+#define ACTI_PACKED_MAX         (16 + (ACTI_MAX_EPOCHS * 5 + 7) / 8)
+
+// =============================================================================
+// EPOCH COUNTER
+// =============================================================================
+struct ActigraphyCounter {
+  int32_t lsb_per_g;
+  uint16_t odr_hz;
+  int32_t baseline_q;     // Baseline |a| in mg << ACTI_BASELINE_SHIFT
+  bool primed;
+  uint32_t dev_sum;       // Sum of (deviation - dead band) in mg, this epoch
+  uint16_t samples;
+};
+
+void actigraphyCounterInit(ActigraphyCounter& c, uint16_t odr_hz, int32_t lsb_per_g);
+void actigraphyAddSample(ActigraphyCounter& c, int16_t ax, int16_t ay, int16_t az);
+
+// Close the epoch: returns its activity count and starts the next one
+uint16_t actigraphyCloseEpoch(ActigraphyCounter& c);
+
+// =============================================================================
+// SCORING
+// =============================================================================
+struct SleepSummary {
+  uint16_t epochs;
+  uint16_t onset;           // First epoch of sustained sleep (epochs if none)
+  uint16_t offset;          // Last sleep epoch + 1
+  uint16_t total_sleep;     // Sleep minutes between onset and offset
+  uint16_t waso;            // Wake after sleep onset
+  uint8_t awakenings;       // Wake bouts between onset and offset
+  uint8_t efficiency;       // total_sleep * 100 / epochs
+};
+
+// Cole-Kripke: sleep[i] = 1 when epoch i is scored sleep
+void actigraphyScore(const uint16_t* counts, uint16_t n, uint8_t* sleep);
+
+// Webster rescoring rules, in place
+void actigraphyRescore(uint8_t* sleep, uint16_t n);
+
+void actigraphySummarize(const uint8_t* sleep, uint16_t n, SleepSummary& out);
+
+// =============================================================================
+// NIGHT RECORD
+// =============================================================================
+struct SleepNight {
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint16_t start_minute;    // Minute of day of epoch 0
+  SleepSummary summary;
+  uint8_t sleep[ACTI_MAX_EPOCHS];
+  uint8_t level[ACTI_MAX_EPOCHS];   // 0..15, see actigraphyLevel()
+};
+
+// 4-bit activity level: 0 for no movement, else 1 + log2(count), max 15
+uint8_t actigraphyLevel(uint16_t count);
+
+// Pack / unpack; return bytes written / consumed, 0 on error
+size_t actigraphyPack(const SleepNight& night, uint8_t* out, size_t cap);
+size_t actigraphyUnpack(const uint8_t* in, size_t len, SleepNight& night);
+
+#endif // ACTIGRAPHY_H
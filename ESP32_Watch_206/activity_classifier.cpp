@@ -0,0 +1,162 @@
+/*
+ * activity_classifier.cpp - Windowed Activity Classifier Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "activity_classifier.h"
+#include "step_engine.h"
+#include <math.h>
+#include <string.h>
+
+// Goertzel bin centres in 0.1 Hz - covers slow walk through sprint cadence
+static const uint16_t bin_dhz[CLASSIFIER_GOERTZEL_BINS] = {8, 12, 16, 20, 24, 28, 33};
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void activityClassifierInit(ActivityClassifier& c, uint16_t odr_hz, int32_t lsb_per_g) {
+  memset(&c, 0, sizeof(ActivityClassifier));
+  c.odr_hz = odr_hz ? odr_hz : 50;
+  c.lsb_per_g = lsb_per_g;
+
+  uint32_t len = (uint32_t)c.odr_hz * CLASSIFIER_WINDOW_MS / 1000;
+  if (len > CLASSIFIER_MAX_WINDOW) len = CLASSIFIER_MAX_WINDOW;
+  if (len < 16) len = 16;
+  c.window_len = len;
+
+  for (int b = 0; b < CLASSIFIER_GOERTZEL_BINS; b++) {
+    float w = 2.0f * (float)M_PI * (bin_dhz[b] / 10.0f) / (float)c.odr_hz;
+    c.coef[b] = (int16_t)lroundf(cosf(w) * (1 << CLASSIFIER_COEF_SHIFT));
+  }
+
+  c.windows_per_minute = (60000UL + CLASSIFIER_WINDOW_MS / 2) /
+                         ((uint32_t)c.window_len * 1000 / c.odr_hz);
+  c.label = ACTIVITY_UNKNOWN;
+}
+
+// =============================================================================
+// FEATURES
+// =============================================================================
+
+void activityExtractFeatures(const ActivityClassifier& c, const int16_t* mag_mg, uint16_t n,
+                             ActivityFeatures& out) {
+  if (n == 0) {
+    memset(&out, 0, sizeof(out));
+    return;
+  }
+  int32_t sum = 0;
+  for (uint16_t i = 0; i < n; i++) sum += mag_mg[i];
+  int32_t mean = sum / n;
+
+  // Variance (energy of the AC part) in mg^2
+  uint64_t energy = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    int32_t d = mag_mg[i] - mean;
+    energy += (uint64_t)((int64_t)d * d);
+  }
+  uint32_t var = (uint32_t)(energy / n);
+
+  // Goertzel bank on the mean-removed signal. coef holds cos(w) in Q14, so
+  // the recurrence uses 2 * coef.
+  uint64_t best_power = 0;
+  int best_bin = 0;
+  for (int b = 0; b < CLASSIFIER_GOERTZEL_BINS; b++) {
+    int64_t s1 = 0, s2 = 0;
+    int64_t k = c.coef[b];
+    for (uint16_t i = 0; i < n; i++) {
+      int64_t s0 = (mag_mg[i] - mean) + ((2 * k * s1) >> CLASSIFIER_COEF_SHIFT) - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    int64_t p = s1 * s1 + s2 * s2 - (((2 * k * s1) >> CLASSIFIER_COEF_SHIFT) * s2);
+    uint64_t power = p > 0 ? (uint64_t)p : 0;
+    if (power > best_power) {
+      best_power = power;
+      best_bin = b;
+    }
+  }
+
+  // Parseval: a pure tone at a bin centre has power ~ energy * n / 2
+  uint32_t pct = 0;
+  if (energy > 0) {
+    uint64_t full = energy * n / 2;
+    pct = (uint32_t)(best_power * 100 / full);
+    if (pct > 100) pct = 100;
+  }
+
+  out.mean_mg = mean;
+  out.std_mg = (int32_t)stepEngineSqrt(var);
+  out.dominant_dhz = bin_dhz[best_bin];
+  out.periodic_pct = pct;
+}
+
+// =============================================================================
+// DECISION TREE
+// =============================================================================
+
+ActivityLabel activityDecide(const ActivityFeatures& f) {
+  if (f.std_mg < CLASSIFIER_IDLE_STD_MG) return ACTIVITY_IDLE;
+
+  if (f.periodic_pct >= CLASSIFIER_PERIODIC_PCT) {
+    if (f.std_mg >= CLASSIFIER_RUN_STD_MG &&
+        f.dominant_dhz >= CLASSIFIER_RUN_MIN_DHZ && f.dominant_dhz <= CLASSIFIER_RUN_MAX_DHZ) {
+      return ACTIVITY_RUN;
+    }
+    if (f.dominant_dhz >= CLASSIFIER_WALK_MIN_DHZ && f.dominant_dhz <= CLASSIFIER_WALK_MAX_DHZ) {
+      return ACTIVITY_WALK;
+    }
+  }
+  return ACTIVITY_OTHER;
+}
+
+const char* activityLabelName(ActivityLabel label) {
+  switch (label) {
+    case ACTIVITY_IDLE:  return "Idle";
+    case ACTIVITY_WALK:  return "Walking";
+    case ACTIVITY_RUN:   return "Running";
+    case ACTIVITY_OTHER: return "Moving";
+    default:             return "Unknown";
+  }
+}
+
+// =============================================================================
+// PER-SAMPLE UPDATE
+// =============================================================================
+
+int activityClassifierUpdate(ActivityClassifier& c, int16_t ax, int16_t ay, int16_t az) {
+  uint32_t sq = (uint32_t)((int32_t)ax * ax) + (uint32_t)((int32_t)ay * ay) +
+                (uint32_t)((int32_t)az * az);
+  c.window[c.fill++] = (int16_t)(stepEngineSqrt(sq) * 1000 / c.lsb_per_g);
+  if (c.fill < c.window_len) return 0;
+  c.fill = 0;
+
+  activityExtractFeatures(c, c.window, c.window_len, c.features);
+  c.raw_label = activityDecide(c.features);
+  c.windows++;
+
+  // Debounce: first window sets the label, later changes need a streak
+  if (c.label == ACTIVITY_UNKNOWN || c.raw_label == c.label) {
+    c.label = c.raw_label;
+    c.candidate_count = 0;
+  } else if (c.raw_label == c.candidate) {
+    if (++c.candidate_count >= CLASSIFIER_HOLD_WINDOWS) {
+      c.label = c.candidate;
+      c.candidate_count = 0;
+    }
+  } else {
+    c.candidate = c.raw_label;
+    c.candidate_count = 1;
+    if (CLASSIFIER_HOLD_WINDOWS <= 1) c.label = c.candidate;
+  }
+
+  // Minute accounting
+  if (c.label == ACTIVITY_WALK || c.label == ACTIVITY_RUN) c.minute_active_windows++;
+  if (++c.minute_windows < c.windows_per_minute) return 0;
+
+  bool active = c.minute_active_windows * 100 >= (uint32_t)c.minute_windows * CLASSIFIER_ACTIVE_PCT;
+  c.minute_windows = 0;
+  c.minute_active_windows = 0;
+  if (active) c.active_minutes++;
+  return active ? 1 : -1;
+}
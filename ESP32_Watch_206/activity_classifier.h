@@ -0,0 +1,102 @@
+/*
+ * activity_classifier.h - Windowed Activity Classifier
+ * FUSION OS Sensor Layer
+ *
+ * Raw accelerometer samples are grouped into fixed windows. Per window:
+ *   mean and standard deviation of |a|, plus a small fixed-point Goertzel
+ *   bank over |a| - mean that gives the dominant frequency and how much of
+ *   the signal energy sits in it (periodicity).
+ * A hand-tuned decision tree maps the features to idle / walk / run / other,
+ * and a label only changes after it wins CLASSIFIER_HOLD_WINDOWS windows in
+ * a row, so it no longer flips every poll.
+ *
+ * Like step_engine, integer-only per sample and Arduino-free so recorded
+ * traces can be replayed on a PC.
+ */
+
+#ifndef ACTIVITY_CLASSIFIER_H
+#define ACTIVITY_CLASSIFIER_H
+
+#include <stdint.h>
+
+// =============================================================================
+// TUNING
+// =============================================================================
+#define CLASSIFIER_WINDOW_MS        2000
+#define CLASSIFIER_MAX_WINDOW       256     // Samples buffered per window
+#define CLASSIFIER_HOLD_WINDOWS     2       // Consecutive wins before a label change
+#define CLASSIFIER_GOERTZEL_BINS    7
+#define CLASSIFIER_COEF_SHIFT       14
+
+// Decision tree thresholds
+#define CLASSIFIER_IDLE_STD_MG      25      // Below: not moving
+#define CLASSIFIER_PERIODIC_PCT     35      // Dominant bin share of energy for gait
+#define CLASSIFIER_WALK_MIN_DHZ     12      // Walking cadence band (deci-Hz)
+#define CLASSIFIER_WALK_MAX_DHZ     25
+#define CLASSIFIER_RUN_MIN_DHZ      22      // Running cadence band
+#define CLASSIFIER_RUN_MAX_DHZ      35
+#define CLASSIFIER_RUN_STD_MG       350     // Running moves the wrist much harder
+
+// A minute counts as active when this share of its windows is walk/run
+#define CLASSIFIER_ACTIVE_PCT       50
+
+enum ActivityLabel : uint8_t {
+  ACTIVITY_UNKNOWN = 0,   // No full window yet
+  ACTIVITY_IDLE,
+  ACTIVITY_WALK,
+  ACTIVITY_RUN,
+  ACTIVITY_OTHER          // Moving, but not gait (gestures, transport, ...)
+};
+
+struct ActivityFeatures {
+  int32_t mean_mg;
+  int32_t std_mg;
+  uint16_t dominant_dhz;  // Dominant frequency in 0.1 Hz
+  uint8_t periodic_pct;   // Energy share of the dominant bin
+};
+
+// =============================================================================
+// STATE
+// =============================================================================
+struct ActivityClassifier {
+  uint16_t odr_hz;
+  int32_t lsb_per_g;
+  uint16_t window_len;
+
+  int16_t coef[CLASSIFIER_GOERTZEL_BINS];   // cos(w) in Q14 (recurrence doubles it)
+
+  int16_t window[CLASSIFIER_MAX_WINDOW];    // |a| in mg
+  uint16_t fill;
+
+  ActivityFeatures features;                // Last completed window
+  ActivityLabel raw_label;                  // Tree output for that window
+  ActivityLabel label;                      // Debounced output
+  ActivityLabel candidate;
+  uint8_t candidate_count;
+
+  // Active minute accounting (on the sample clock)
+  uint16_t windows_per_minute;
+  uint16_t minute_windows;
+  uint16_t minute_active_windows;
+  uint32_t active_minutes;
+  uint32_t windows;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void activityClassifierInit(ActivityClassifier& c, uint16_t odr_hz, int32_t lsb_per_g);
+
+// Feed one raw sample. Returns 1 when a minute of samples completes and it
+// was active, -1 when it completes inactive, 0 otherwise.
+int activityClassifierUpdate(ActivityClassifier& c, int16_t ax, int16_t ay, int16_t az);
+
+// Run the feature extractor / tree on an arbitrary window (mg magnitudes)
+void activityExtractFeatures(const ActivityClassifier& c, const int16_t* mag_mg, uint16_t n,
+                             ActivityFeatures& out);
+ActivityLabel activityDecide(const ActivityFeatures& f);
+
+const char* activityLabelName(ActivityLabel label);
+
+#endif // ACTIVITY_CLASSIFIER_H
@@ -0,0 +1,356 @@
+/*
+ * activity_history.cpp - Multi-Resolution Activity History Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "activity_history.h"
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+// =============================================================================
+// RING STORAGE - running sums, one spare slot so the oldest value stays valid
+// =============================================================================
+struct HistoryRing {
+  uint16_t size;            // Slots exposed to queries
+  uint32_t head;            // Absolute index of the newest slot
+  uint32_t* step_sum;       // size + 1 entries
+  uint32_t* active_sum;
+};
+
+static uint32_t minute_steps[HISTORY_MINUTES + 1];
+static uint32_t minute_active[HISTORY_MINUTES + 1];
+static uint32_t hour_steps[HISTORY_HOURS + 1];
+static uint32_t hour_active[HISTORY_HOURS + 1];
+static uint32_t day_steps[HISTORY_DAYS + 1];
+static uint32_t day_active[HISTORY_DAYS + 1];
+
+static HistoryRing rings[HISTORY_LEVEL_COUNT] = {
+  {HISTORY_MINUTES, 0, minute_steps, minute_active},
+  {HISTORY_HOURS,   0, hour_steps,   hour_active},
+  {HISTORY_DAYS,    0, day_steps,    day_active},
+};
+
+static const uint16_t level_minutes[HISTORY_LEVEL_COUNT] = {1, 60, 1440};
+
+static bool history_started = false;
+static uint32_t history_seq = 0;
+
+static inline uint16_t slotOf(const HistoryRing& r, uint32_t index) {
+  return index % (r.size + 1);
+}
+
+static inline uint32_t valueAt(const HistoryRing& r, const uint32_t* sums, uint32_t index) {
+  return sums[slotOf(r, index)] - sums[slotOf(r, index - 1)];
+}
+
+// =============================================================================
+// PACKED CHUNKS - one NVS key per ring, the largest ~3.3 KB
+// =============================================================================
+#define HISTORY_MAGIC 0x54534841  // "AHST"
+
+#pragma pack(push, 1)
+struct HistoryChunkHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t  level;
+  uint8_t  reserved;
+  uint32_t seq;                              // Save counter
+  uint32_t head_minute;                      // Absolute minute of the newest slot
+  uint32_t crc;                              // Over the payload after the header
+};
+
+struct MinuteChunk {
+  HistoryChunkHeader hdr;
+  uint8_t  steps[HISTORY_MINUTES];           // Saturated at 255 / minute
+  uint8_t  active[HISTORY_MINUTES / 8];
+};
+
+struct HourChunk {
+  HistoryChunkHeader hdr;
+  uint16_t steps[HISTORY_HOURS];
+  uint8_t  active[HISTORY_HOURS];            // 0-60
+};
+
+struct DayChunk {
+  HistoryChunkHeader hdr;
+  uint32_t steps[HISTORY_DAYS];
+  uint16_t active[HISTORY_DAYS];             // 0-1440
+};
+#pragma pack(pop)
+
+union HistoryChunk {
+  HistoryChunkHeader hdr;
+  MinuteChunk minute;
+  HourChunk hour;
+  DayChunk day;
+};
+
+static const char* const chunk_keys[HISTORY_LEVEL_COUNT] = {
+  HISTORY_KEY_MINUTE, HISTORY_KEY_HOUR, HISTORY_KEY_DAY
+};
+
+static const size_t chunk_sizes[HISTORY_LEVEL_COUNT] = {
+  sizeof(MinuteChunk), sizeof(HourChunk), sizeof(DayChunk)
+};
+
+static uint32_t chunkCrc(const HistoryChunk* c, size_t size) {
+  return esp_rom_crc32_le(0, (const uint8_t*)c + sizeof(HistoryChunkHeader),
+                          size - sizeof(HistoryChunkHeader));
+}
+
+// =============================================================================
+// TIME BASE
+// =============================================================================
+
+// Days since 1970-01-01 for a civil date (Howard Hinnant's algorithm)
+static int32_t daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  uint32_t yoe = (uint32_t)(y - era * 400);
+  uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+uint32_t historyMinuteOf(const WatchTime& t) {
+  int32_t days = daysFromCivil(t.year, t.month, t.day) - daysFromCivil(2000, 1, 1);
+  if (days < 0) days = 0;
+  return (uint32_t)days * 1440 + t.hour * 60 + t.minute;
+}
+
+// =============================================================================
+// RING OPERATIONS
+// =============================================================================
+
+static void ringStart(HistoryRing& r, uint32_t index) {
+  memset(r.step_sum, 0, (r.size + 1) * sizeof(uint32_t));
+  memset(r.active_sum, 0, (r.size + 1) * sizeof(uint32_t));
+  r.head = index;
+}
+
+static void ringAdvance(HistoryRing& r, uint32_t index) {
+  if (index <= r.head) return;  // Clock stepped back: keep crediting the head
+
+  uint32_t steps = r.step_sum[slotOf(r, r.head)];
+  uint32_t active = r.active_sum[slotOf(r, r.head)];
+  uint32_t gap = index - r.head;
+  if (gap > (uint32_t)r.size + 1) gap = r.size + 1;
+
+  for (uint32_t k = index - gap + 1; k <= index; k++) {
+    r.step_sum[slotOf(r, k)] = steps;
+    r.active_sum[slotOf(r, k)] = active;
+  }
+  r.head = index;
+}
+
+void initActivityHistory() {
+  history_started = loadActivityHistory();
+  Serial.printf("[HISTORY] %s (%d min / %d h / %d d)\n",
+                history_started ? "Restored" : "Empty",
+                HISTORY_MINUTES, HISTORY_HOURS, HISTORY_DAYS);
+}
+
+void historyTick(uint32_t abs_minute) {
+  if (!history_started) {
+    for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+      ringStart(rings[l], abs_minute / level_minutes[l]);
+    }
+    history_started = true;
+    return;
+  }
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    ringAdvance(rings[l], abs_minute / level_minutes[l]);
+  }
+}
+
+void historyAddSteps(uint32_t steps) {
+  if (!history_started || steps == 0) return;
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    rings[l].step_sum[slotOf(rings[l], rings[l].head)] += steps;
+  }
+  const HistoryRing& m = rings[HISTORY_MINUTE];
+  if (valueAt(m, m.step_sum, m.head) >= HISTORY_ACTIVE_STEPS) historySetActive();
+}
+
+void historySetActive() {
+  if (!history_started) return;
+  const HistoryRing& m = rings[HISTORY_MINUTE];
+  if (valueAt(m, m.active_sum, m.head) != 0) return;  // Already flagged
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    rings[l].active_sum[slotOf(rings[l], rings[l].head)] += 1;
+  }
+}
+
+// =============================================================================
+// QUERIES
+// =============================================================================
+
+uint32_t historySteps(HistoryLevel level, uint16_t count) {
+  const HistoryRing& r = rings[level];
+  if (!history_started || count == 0) return 0;
+  if (count > r.size) count = r.size;
+  return r.step_sum[slotOf(r, r.head)] - r.step_sum[slotOf(r, r.head - count)];
+}
+
+uint32_t historyActiveMinutes(HistoryLevel level, uint16_t count) {
+  const HistoryRing& r = rings[level];
+  if (!history_started || count == 0) return 0;
+  if (count > r.size) count = r.size;
+  return r.active_sum[slotOf(r, r.head)] - r.active_sum[slotOf(r, r.head - count)];
+}
+
+void historySeries(HistoryLevel level, uint32_t* out, uint16_t count) {
+  const HistoryRing& r = rings[level];
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t back = count - 1 - i;
+    out[i] = (history_started && back < r.size) ? valueAt(r, r.step_sum, r.head - back) : 0;
+  }
+}
+
+// =============================================================================
+// PERSISTENCE
+// =============================================================================
+
+// Oldest first: payload slot i is head - (size - 1 - i)
+static void packChunk(HistoryLevel level, HistoryChunk* c) {
+  const HistoryRing& r = rings[level];
+  memset(c, 0, chunk_sizes[level]);
+  for (int i = 0; i < r.size; i++) {
+    uint32_t k = r.head - (r.size - 1 - i);
+    uint32_t steps = valueAt(r, r.step_sum, k);
+    uint32_t active = valueAt(r, r.active_sum, k);
+    switch (level) {
+      case HISTORY_MINUTE:
+        c->minute.steps[i] = steps > 255 ? 255 : steps;
+        if (active) c->minute.active[i >> 3] |= 1 << (i & 7);
+        break;
+      case HISTORY_HOUR:
+        c->hour.steps[i] = steps > 65535 ? 65535 : steps;
+        c->hour.active[i] = active;
+        break;
+      default:
+        c->day.steps[i] = steps;
+        c->day.active[i] = active;
+        break;
+    }
+  }
+}
+
+// Append one restored slot on top of the previous running sum
+static void ringLoadSlot(HistoryRing& r, uint32_t index, uint32_t steps, uint32_t active) {
+  uint16_t prev = slotOf(r, index - 1);
+  r.step_sum[slotOf(r, index)] = r.step_sum[prev] + steps;
+  r.active_sum[slotOf(r, index)] = r.active_sum[prev] + active;
+}
+
+static void unpackChunk(HistoryLevel level, const HistoryChunk* c) {
+  HistoryRing& r = rings[level];
+  ringStart(r, c->hdr.head_minute / level_minutes[level]);
+  for (int i = 0; i < r.size; i++) {
+    uint32_t k = r.head - (r.size - 1 - i);
+    switch (level) {
+      case HISTORY_MINUTE:
+        ringLoadSlot(r, k, c->minute.steps[i], (c->minute.active[i >> 3] >> (i & 7)) & 1);
+        break;
+      case HISTORY_HOUR:
+        ringLoadSlot(r, k, c->hour.steps[i], c->hour.active[i]);
+        break;
+      default:
+        ringLoadSlot(r, k, c->day.steps[i], c->day.active[i]);
+        break;
+    }
+  }
+}
+
+// Each ring is its own key, so a rewrite needs room for one chunk, not the
+// whole history. A torn save leaves the rings at different generations;
+// each stays internally consistent and historyTick() catches them up.
+bool saveActivityHistory() {
+  if (!history_started) return false;
+
+  HistoryChunk* c = (HistoryChunk*)malloc(sizeof(HistoryChunk));
+  if (!c) return false;
+
+  history_seq++;
+  Preferences prefs;
+  prefs.begin("history", false);
+  int saved = 0;
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    HistoryLevel level = (HistoryLevel)l;
+    packChunk(level, c);
+    c->hdr.magic = HISTORY_MAGIC;
+    c->hdr.version = HISTORY_BLOB_VERSION;
+    c->hdr.level = l;
+    c->hdr.seq = history_seq;
+    c->hdr.head_minute = rings[HISTORY_MINUTE].head;
+    c->hdr.crc = chunkCrc(c, chunk_sizes[l]);
+    if (prefs.putBytes(chunk_keys[l], c, chunk_sizes[l]) == chunk_sizes[l]) saved++;
+  }
+  prefs.end();
+  free(c);
+
+  if (saved != HISTORY_LEVEL_COUNT) {
+    Serial.printf("[HISTORY] Save seq %lu FAILED for %d of %d rings (NVS full?) - previous copies kept\n",
+                  (unsigned long)history_seq, HISTORY_LEVEL_COUNT - saved, HISTORY_LEVEL_COUNT);
+    return false;
+  }
+  Serial.printf("[HISTORY] Saved seq %lu (%u + %u + %u bytes)\n", (unsigned long)history_seq,
+                (unsigned)sizeof(MinuteChunk), (unsigned)sizeof(HourChunk), (unsigned)sizeof(DayChunk));
+  return true;
+}
+
+static bool chunkValid(const HistoryChunk* c, int level, size_t n) {
+  return n == chunk_sizes[level] && c->hdr.magic == HISTORY_MAGIC &&
+         c->hdr.version == HISTORY_BLOB_VERSION && c->hdr.level == level &&
+         c->hdr.crc == chunkCrc(c, n);
+}
+
+bool loadActivityHistory() {
+  HistoryChunk* c = (HistoryChunk*)malloc(sizeof(HistoryChunk));
+  if (!c) return false;
+
+  Preferences prefs;
+  prefs.begin("history", true);
+  bool loaded[HISTORY_LEVEL_COUNT] = {false};
+  int32_t newest = -1;
+  uint32_t head_minute = 0;
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    size_t n = prefs.getBytes(chunk_keys[l], c, chunk_sizes[l]);
+    if (!chunkValid(c, l, n)) continue;
+    unpackChunk((HistoryLevel)l, c);
+    loaded[l] = true;
+    if (newest < 0 || (int32_t)(c->hdr.seq - history_seq) > 0) {
+      history_seq = c->hdr.seq;
+      head_minute = c->hdr.head_minute;
+      newest = l;
+    }
+  }
+  prefs.end();
+  free(c);
+  if (newest < 0) return false;
+
+  // A ring without a valid chunk restarts empty, the others catch up to it
+  for (int l = 0; l < HISTORY_LEVEL_COUNT; l++) {
+    if (!loaded[l]) ringStart(rings[l], head_minute / level_minutes[l]);
+    else ringAdvance(rings[l], head_minute / level_minutes[l]);
+  }
+  return true;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+void printActivityHistory() {
+  Serial.printf("[HISTORY] Last hour: %lu steps, %lu active min\n",
+                (unsigned long)historySteps(HISTORY_MINUTE, 60),
+                (unsigned long)historyActiveMinutes(HISTORY_MINUTE, 60));
+  Serial.printf("[HISTORY] Last 24 h: %lu steps | 7 d: %lu | 30 d: %lu | year: %lu\n",
+                (unsigned long)historySteps(HISTORY_HOUR, 24),
+                (unsigned long)historySteps(HISTORY_DAY, 7),
+                (unsigned long)historySteps(HISTORY_DAY, 30),
+                (unsigned long)historySteps(HISTORY_DAY, HISTORY_DAYS));
+  Serial.printf("[HISTORY] Save seq %lu, %u bytes in %d keys\n", (unsigned long)history_seq,
+                (unsigned)(sizeof(MinuteChunk) + sizeof(HourChunk) + sizeof(DayChunk)),
+                HISTORY_LEVEL_COUNT);
+}
@@ -0,0 +1,71 @@
+/*
+ * activity_history.h - Multi-Resolution Activity History
+ * FUSION OS Sensor Layer
+ *
+ * Three fixed-size rings, all updated in O(1) as steps arrive:
+ *   minute: steps + active flag, last 48 hours
+ *   hour:   steps + active minutes, last 30 days
+ *   day:    steps + active minutes, last year
+ * Each ring keeps running prefix sums, so the total over any window is one
+ * subtraction. Per-slot values are the difference of neighbouring sums.
+ *
+ * Persisted as three packed, CRC-checked chunks, one NVS key per ring
+ * (3.3 + 2.2 + 2.2 KB). NVS rewrites a blob copy-on-write, so a save needs
+ * free space for the new copy next to the old one; per-ring keys keep that
+ * to the largest chunk instead of the whole 7.6 KB, which the ~16 KB of
+ * usable NVS could not spare next to the other namespaces.
+ */
+
+#ifndef ACTIVITY_HISTORY_H
+#define ACTIVITY_HISTORY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define HISTORY_MINUTES         (48 * 60)
+#define HISTORY_HOURS           (30 * 24)
+#define HISTORY_DAYS            366
+#define HISTORY_KEY_MINUTE      "min"
+#define HISTORY_KEY_HOUR        "hour"
+#define HISTORY_KEY_DAY         "day"
+#define HISTORY_ACTIVE_STEPS    60        // Steps in a minute that mark it active
+#define HISTORY_BLOB_VERSION    1
+
+enum HistoryLevel {
+  HISTORY_MINUTE = 0,
+  HISTORY_HOUR,
+  HISTORY_DAY,
+  HISTORY_LEVEL_COUNT
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void initActivityHistory();
+
+// Absolute minute index (minutes since 2000-01-01) for a wall-clock time
+uint32_t historyMinuteOf(const WatchTime& t);
+
+// Advance all rings to the given minute, zero-filling any gap
+void historyTick(uint32_t abs_minute);
+
+// Credit steps / activity to the current minute (and its hour and day)
+void historyAddSteps(uint32_t steps);
+void historySetActive();
+
+// O(1) window totals. `count` slots ending at the newest one (1 = current).
+uint32_t historySteps(HistoryLevel level, uint16_t count);
+uint32_t historyActiveMinutes(HistoryLevel level, uint16_t count);
+
+// Per-slot values, oldest first; out[count-1] is the current slot
+void historySeries(HistoryLevel level, uint32_t* out, uint16_t count);
+
+bool saveActivityHistory();
+bool loadActivityHistory();
+void printActivityHistory();
+
+#endif // ACTIVITY_HISTORY_H
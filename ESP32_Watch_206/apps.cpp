@@ -12,6 +12,7 @@
 #include "hardware.h"
 #include "filesystem.h"
 #include "navigation.h"
+#include "persist.h"
 #include "wifi_apps.h"
 #include "ui.h"
 #include "converter_app.h"
@@ -846,12 +847,10 @@ void handleStopwatchTouch(TouchGesture& gesture) {
   int btnStartX = (LCD_WIDTH - (3 * btnW + 2 * btnGap)) / 2;
   
   if (y >= btnY && y < btnY + btnH) {
-    static bool running = false;
     if (x >= btnStartX && x < btnStartX + btnW) {
       // Start/Stop
-      if (running) pauseStopwatch();
+      if (isStopwatchRunning()) pauseStopwatch();
       else startStopwatch();
-      running = !running;
     }
     else if (x >= btnStartX + btnW + btnGap && x < btnStartX + 2*btnW + btnGap) {
       // Lap
@@ -1999,8 +1998,7 @@ void handleShopTouch(TouchGesture& gesture) {
       system_state.player_gems += 1000;
       gfx->fillRect(itemStartX + 5, itemY + 5, itemW - 10, itemH - 10, COLOR_WHITE);
       delay(50);
-      extern void saveAllGameData();
-      saveAllGameData();
+      persistMarkDirty(PERSIST_GAME);
       drawShopApp();
       return;
     }
@@ -2022,8 +2020,7 @@ void handleShopTouch(TouchGesture& gesture) {
       if (system_state.player_gems >= 200) {
         system_state.player_gems -= 200;
         gainExperience(50, "Training Boost");
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
         gfx->fillRect(item3X + 5, itemY + 5, itemW - 10, itemH - 10, RGB565(200, 100, 255));
         delay(100);
       }
@@ -2040,8 +2037,7 @@ void handleShopTouch(TouchGesture& gesture) {
         system_state.player_gems -= 300;
         // Increase player HP capacity (affects boss battles)
         gainExperience(20, "HP Boost");
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
       }
       drawShopApp();
       return;
@@ -2053,8 +2049,7 @@ void handleShopTouch(TouchGesture& gesture) {
       if (system_state.player_gems >= 500) {
         system_state.player_gems -= 500;
         gainExperience(30, "ATK Boost");
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
       }
       drawShopApp();
       return;
@@ -0,0 +1,260 @@
+/*
+ * atomic_file.cpp - Crash-Safe Save Files Implementation
+ * FUSION OS System Layer
+ */
+
+#include "atomic_file.h"
+#include <esp_rom_crc.h>
+
+static AtomicFileStats atomic_stats = {0};
+
+enum FooterState { FOOTER_NONE, FOOTER_BAD, FOOTER_OK };
+
+struct Footer {
+  uint32_t gen;
+  uint32_t len;
+  uint32_t crc;
+};
+
+static void suffixed(char* out, const char* path, const char* suffix) {
+  snprintf(out, ATOMIC_PATH_MAX, "%s%s", path, suffix);
+}
+
+// CRC32 of the first `len` bytes, read back from the card
+static bool crcOfBody(File& f, uint32_t len, uint32_t* crc) {
+  uint8_t buf[256];
+  uint32_t c = 0;
+  if (!f.seek(0)) return false;
+  while (len > 0) {
+    size_t n = len < sizeof(buf) ? len : sizeof(buf);
+    if (f.read(buf, n) != n) return false;
+    c = esp_rom_crc32_le(c, buf, n);
+    len -= n;
+  }
+  *crc = c;
+  return true;
+}
+
+static FooterState readFooter(File& f, size_t size, Footer* ft) {
+  char buf[ATOMIC_FOOTER_LEN + 1];
+  if (size < ATOMIC_FOOTER_LEN || !f.seek(size - ATOMIC_FOOTER_LEN) ||
+      f.read((uint8_t*)buf, ATOMIC_FOOTER_LEN) != ATOMIC_FOOTER_LEN) {
+    return FOOTER_NONE;
+  }
+  buf[ATOMIC_FOOTER_LEN] = '\0';
+  if (buf[0] != '\n' || strncmp(buf + 1, ATOMIC_FOOTER_TAG, strlen(ATOMIC_FOOTER_TAG)) != 0) {
+    return FOOTER_NONE;
+  }
+  unsigned long gen, len, crc;
+  if (buf[ATOMIC_FOOTER_LEN - 1] != '\n' ||
+      sscanf(buf + 1, ATOMIC_FOOTER_TAG " gen=%8lx len=%8lx crc=%8lx", &gen, &len, &crc) != 3) {
+    return FOOTER_BAD;
+  }
+  ft->gen = gen;
+  ft->len = len;
+  ft->crc = crc;
+  return FOOTER_OK;
+}
+
+// Generation of `path`, -1 if missing or damaged. Pre-footer files are
+// generation 0 when `legacy_ok` (never for a temp file).
+static int32_t checkFile(fs::FS& fs, const char* path, bool legacy_ok, uint32_t* body_len = NULL) {
+  if (!fs.exists(path)) return -1;
+  File f = fs.open(path, FILE_READ);
+  if (!f) return -1;
+
+  size_t size = f.size();
+  int32_t gen = -1;
+  Footer ft;
+  switch (readFooter(f, size, &ft)) {
+    case FOOTER_OK: {
+      uint32_t crc;
+      if (ft.gen > 0 && ft.gen < INT32_MAX && ft.len + ATOMIC_FOOTER_LEN == size &&
+          crcOfBody(f, ft.len, &crc) && crc == ft.crc) {
+        gen = (int32_t)ft.gen;
+        if (body_len) *body_len = ft.len;
+      }
+      break;
+    }
+    case FOOTER_NONE:
+      if (legacy_ok && size > 0) {
+        gen = 0;
+        if (body_len) *body_len = size;
+      }
+      break;
+    default:
+      break;
+  }
+  f.close();
+  return gen;
+}
+
+// =============================================================================
+// COMMIT
+// =============================================================================
+
+File atomicFileBegin(fs::FS& fs, const char* path) {
+  char tmp[ATOMIC_PATH_MAX];
+  suffixed(tmp, path, ATOMIC_TMP_SUFFIX);
+  return fs.open(tmp, FILE_WRITE);
+}
+
+bool atomicFileCommit(fs::FS& fs, const char* path, File& body) {
+  char tmp[ATOMIC_PATH_MAX], bak[ATOMIC_PATH_MAX];
+  suffixed(tmp, path, ATOMIC_TMP_SUFFIX);
+  suffixed(bak, path, ATOMIC_BAK_SUFFIX);
+  body.close();
+
+  int32_t gen = checkFile(fs, path, true);
+  if (gen < 0) gen = checkFile(fs, bak, true);
+  gen = (gen < 0 ? 0 : gen) + 1;
+
+  uint32_t len = 0, crc = 0;
+  File f = fs.open(tmp, FILE_READ);
+  bool ok = f;
+  if (ok) {
+    len = f.size();
+    ok = len > 0 && crcOfBody(f, len, &crc);
+    f.close();
+  }
+  if (ok) {
+    f = fs.open(tmp, FILE_APPEND);
+    ok = f;
+    if (ok) {
+      char footer[ATOMIC_FOOTER_LEN + 1];
+      snprintf(footer, sizeof(footer), "\n" ATOMIC_FOOTER_TAG " gen=%08lx len=%08lx crc=%08lx\n",
+               (unsigned long)gen, (unsigned long)len, (unsigned long)crc);
+      ok = f.write((const uint8_t*)footer, ATOMIC_FOOTER_LEN) == ATOMIC_FOOTER_LEN;
+      f.close();
+    }
+  }
+  // Read the whole temp file back before it may replace anything
+  if (ok) ok = checkFile(fs, tmp, false) == gen;
+  if (!ok) {
+    fs.remove(tmp);
+    atomic_stats.verify_failures++;
+    Serial.printf("[ATOMIC] %s: write did not verify, previous save kept\n", path);
+    return false;
+  }
+
+  if (fs.exists(bak)) fs.remove(bak);
+  if (fs.exists(path)) fs.rename(path, bak);
+  if (!fs.rename(tmp, path)) return false;  // atomicFileResolve() finishes it
+  atomic_stats.commits++;
+  return true;
+}
+
+void atomicFileAbort(fs::FS& fs, const char* path, File& body) {
+  char tmp[ATOMIC_PATH_MAX];
+  suffixed(tmp, path, ATOMIC_TMP_SUFFIX);
+  body.close();
+  fs.remove(tmp);
+}
+
+// =============================================================================
+// LOAD
+// =============================================================================
+
+bool atomicFileResolve(fs::FS& fs, const char* path) {
+  char tmp[ATOMIC_PATH_MAX], bak[ATOMIC_PATH_MAX];
+  suffixed(tmp, path, ATOMIC_TMP_SUFFIX);
+  suffixed(bak, path, ATOMIC_BAK_SUFFIX);
+
+  int32_t g_cur = checkFile(fs, path, true);
+  int32_t g_tmp = checkFile(fs, tmp, false);
+
+  if (g_tmp > g_cur) {
+    // Reset during the rotation: the verified temp file is the newest save
+    if (g_cur >= 0) {
+      if (fs.exists(bak)) fs.remove(bak);
+      fs.rename(path, bak);
+    } else if (fs.exists(path)) {
+      fs.remove(path);
+    }
+    if (!fs.rename(tmp, path)) return false;
+    atomic_stats.repairs++;
+    Serial.printf("[ATOMIC] %s: finished interrupted save (gen %ld)\n", path, (long)g_tmp);
+    return true;
+  }
+  if (fs.exists(tmp)) fs.remove(tmp);   // Torn or stale
+
+  if (g_cur >= 0) {
+    if (g_cur == 0) atomic_stats.legacy++;
+    return true;
+  }
+
+  int32_t g_bak = checkFile(fs, bak, true);
+  if (g_bak < 0) return false;
+  if (fs.exists(path)) fs.remove(path);
+  if (!fs.rename(bak, path)) return false;
+  atomic_stats.fallbacks++;
+  Serial.printf("[ATOMIC] %s: damaged, fell back to gen %ld\n", path, (long)g_bak);
+  return true;
+}
+
+int32_t atomicFileGeneration(fs::FS& fs, const char* path) {
+  return checkFile(fs, path, true);
+}
+
+bool atomicFileCopy(fs::FS& fs, const char* src, const char* dst) {
+  uint32_t len = 0;
+  if (checkFile(fs, src, true, &len) < 0) return false;
+
+  File in = fs.open(src, FILE_READ);
+  if (!in) return false;
+  File out = atomicFileBegin(fs, dst);
+  if (!out) {
+    in.close();
+    return false;
+  }
+
+  uint8_t buf[256];
+  bool ok = true;
+  while (ok && len > 0) {
+    size_t n = len < sizeof(buf) ? len : sizeof(buf);
+    ok = in.read(buf, n) == n && out.write(buf, n) == n;
+    len -= n;
+  }
+  in.close();
+  if (!ok) {
+    out.close();
+    return false;
+  }
+  return atomicFileCommit(fs, dst, out);
+}
+
+bool atomicFileStamp(fs::FS& fs, const char* path, AtomicStamp* stamp) {
+  File f = fs.open(path, FILE_READ);
+  if (!f) return false;
+  size_t size = f.size();
+  Footer ft;
+  FooterState state = readFooter(f, size, &ft);
+  f.close();
+
+  if (state == FOOTER_OK && ft.len + ATOMIC_FOOTER_LEN == size) {
+    stamp->gen = ft.gen;
+    stamp->len = ft.len;
+    stamp->crc = ft.crc;
+    return true;
+  }
+  if (state != FOOTER_NONE) return false;
+  stamp->gen = 0;
+  stamp->len = size;
+  stamp->crc = 0;
+  return true;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const AtomicFileStats* getAtomicFileStats() {
+  return &atomic_stats;
+}
+
+void printAtomicFileStats() {
+  const AtomicFileStats& s = atomic_stats;
+  Serial.printf("[ATOMIC] commits=%lu verify_failures=%lu repairs=%lu fallbacks=%lu legacy=%lu\n",
+                (unsigned long)s.commits, (unsigned long)s.verify_failures,
+                (unsigned long)s.repairs, (unsigned long)s.fallbacks, (unsigned long)s.legacy);
+}
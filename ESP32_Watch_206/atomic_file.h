@@ -0,0 +1,83 @@
+/*
+ * atomic_file.h - Crash-Safe Save Files
+ * FUSION OS System Layer
+ *
+ * The SD save files used to be opened with FILE_WRITE and rewritten in
+ * place, so a brownout or watchdog reset mid-write left a truncated save.
+ * Saves now go through a commit:
+ *
+ *   1. the caller writes the body to <path>.tmp
+ *   2. close (FATFS syncs on close), read the body back for its CRC32
+ *   3. append the footer line:  \n#FSAV gen=%08x len=%08x crc=%08x\n
+ *   4. re-read and verify the whole temp file
+ *   5. <path> -> <path>.bak (previous generation), <path>.tmp -> <path>
+ *
+ * FAT rename cannot replace an existing file, so step 5 is three
+ * operations. atomicFileResolve() repairs any state a reset can leave
+ * behind: it picks the highest valid generation among <path>, <path>.tmp
+ * and <path>.bak and renames it into place before the loader opens <path>.
+ * A file without a footer is a pre-footer save and counts as generation 0.
+ *
+ * The footer is a '#' line, so the KEY=VALUE loaders skip it unchanged.
+ */
+
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define ATOMIC_TMP_SUFFIX       ".tmp"
+#define ATOMIC_BAK_SUFFIX       ".bak"
+#define ATOMIC_FOOTER_TAG       "#FSAV"
+#define ATOMIC_FOOTER_LEN       46      // "\n#FSAV gen=........ len=........ crc=........\n"
+#define ATOMIC_PATH_MAX         96
+
+struct AtomicFileStats {
+  uint32_t commits;
+  uint32_t verify_failures;   // Temp file did not read back - old save kept
+  uint32_t repairs;           // Resolve finished an interrupted commit
+  uint32_t fallbacks;         // Resolve went back to the previous generation
+  uint32_t legacy;            // Pre-footer files accepted
+};
+
+// Identity of a committed version, from the footer alone
+struct AtomicStamp {
+  uint32_t gen;               // 0 for a pre-footer file
+  uint32_t len;               // Body bytes (the footer excluded)
+  uint32_t crc;               // Body CRC32 from the footer, 0 pre-footer
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Open <path>.tmp for the new body (truncates any stale temp file)
+File atomicFileBegin(fs::FS& fs, const char* path);
+
+// Close, footer, verify, rotate. On false the previous save is untouched.
+bool atomicFileCommit(fs::FS& fs, const char* path, File& body);
+
+// Close and drop a body that will not be committed
+void atomicFileAbort(fs::FS& fs, const char* path, File& body);
+
+// Before opening <path> to load: true if a valid generation is in place
+bool atomicFileResolve(fs::FS& fs, const char* path);
+
+// Generation of a committed file: 0 for a pre-footer file, -1 if invalid
+int32_t atomicFileGeneration(fs::FS& fs, const char* path);
+
+// Copy the body of `src` (without its footer) into `dst` as a new commit
+bool atomicFileCopy(fs::FS& fs, const char* src, const char* dst);
+
+// Footer fields without reading the body (not verified - the body CRC is
+// only checked by atomicFileResolve)
+bool atomicFileStamp(fs::FS& fs, const char* path, AtomicStamp* stamp);
+
+const AtomicFileStats* getAtomicFileStats();
+void printAtomicFileStats();
+
+#endif // ATOMIC_FILE_H
@@ -0,0 +1,540 @@
+/*
+ * backup_store.cpp - Incremental Deduplicated SD Backups Implementation
+ * FUSION OS System Layer
+ */
+
+#include "backup_store.h"
+#include "sd_manager.h"
+#include "atomic_file.h"
+#include "time_service.h"
+#include "energy_monitor.h"
+#include <mbedtls/sha256.h>
+
+#define HASH_LEN                32
+#define CHUNK_ID_HEX            16      // Chunk file name: first 8 hash bytes
+#define MANIFEST_LINE_MAX       160
+#define SECONDS_PER_DAY         86400UL
+#define SECONDS_PER_WEEK        (7UL * SECONDS_PER_DAY)
+
+struct SnapInfo {
+  char name[BACKUP_NAME_MAX];
+  uint32_t time;
+};
+
+// SD_MMC DMA wants word-aligned buffers; whole chunks per read
+static uint8_t chunk_buf[BACKUP_CHUNK_SIZE] __attribute__((aligned(4)));
+static SnapInfo snaps[BACKUP_MAX_SNAPSHOTS];
+
+static BackupStats backup_stats = {0};
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static void toHex(const uint8_t* data, int len, char* out) {
+  static const char digits[] = "0123456789abcdef";
+  for (int i = 0; i < len; i++) {
+    out[i * 2] = digits[data[i] >> 4];
+    out[i * 2 + 1] = digits[data[i] & 0x0F];
+  }
+  out[len * 2] = '\0';
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+static bool fromHex(const char* s, uint8_t* out, int len) {
+  for (int i = 0; i < len; i++) {
+    int hi = hexDigit(s[i * 2]), lo = hexDigit(s[i * 2 + 1]);
+    if (hi < 0 || lo < 0) return false;
+    out[i] = (uint8_t)(hi << 4 | lo);
+  }
+  return true;
+}
+
+// First 8 hash bytes: the chunk's file name and sweep key
+static uint64_t chunkId(const uint8_t* hash) {
+  uint64_t id = 0;
+  for (int i = 0; i < CHUNK_ID_HEX / 2; i++) id = id << 8 | hash[i];
+  return id;
+}
+
+static void snapPath(char* out, const char* name) {
+  snprintf(out, ATOMIC_PATH_MAX, "%s/%s%s", SD_BACKUP_SNAPS, name, BACKUP_SNAP_SUFFIX);
+}
+
+static void chunkPath(char* out, const uint8_t* hash) {
+  char hex[CHUNK_ID_HEX + 1];
+  toHex(hash, CHUNK_ID_HEX / 2, hex);
+  snprintf(out, ATOMIC_PATH_MAX, "%s/%s", SD_BACKUP_CHUNKS, hex);
+}
+
+// One manifest line without the newline; -1 at the end of the file
+static int readLine(File& f, char* buf) {
+  if (!f.available()) return -1;
+  size_t n = f.readBytesUntil('\n', buf, MANIFEST_LINE_MAX - 1);
+  buf[n] = '\0';
+  return n;
+}
+
+static bool parseFileLine(const char* line, char* name, uint32_t* len, AtomicStamp* st) {
+  unsigned long l, gen, crc;
+  if (sscanf(line, "FILE=%39s %lu %lu %lx", name, &l, &gen, &crc) != 4) return false;
+  *len = l;
+  st->gen = gen;
+  st->len = l;
+  st->crc = crc;
+  return true;
+}
+
+// What a snapshot compares. A pre-footer file (nights.dat is appended,
+// never committed) has no CRC: its modification time takes that slot, 0
+// when the card keeps none - then it is always read.
+static bool fileStamp(const char* path, AtomicStamp* st) {
+  if (!atomicFileStamp(SD_MMC, path, st)) {
+    // Torn rotation or damaged footer: settle it, then try again
+    if (!atomicFileResolve(SD_MMC, path) || !atomicFileStamp(SD_MMC, path, st)) return false;
+  }
+  if (st->gen == 0) {
+    File f = SD_MMC.open(path, FILE_READ);
+    if (!f) return false;
+    st->crc = (uint32_t)f.getLastWrite();
+    f.close();
+  }
+  return true;
+}
+
+// =============================================================================
+// SNAPSHOT INDEX
+// =============================================================================
+
+static uint32_t readSnapTime(const char* name) {
+  char path[ATOMIC_PATH_MAX], line[MANIFEST_LINE_MAX];
+  snapPath(path, name);
+  File f = SD_MMC.open(path, FILE_READ);
+  if (!f) return 0;
+  uint32_t t = 0;
+  for (int i = 0; i < 4 && readLine(f, line) >= 0; i++) {
+    if (strncmp(line, "TIME=", 5) == 0) {
+      t = strtoul(line + 5, NULL, 10);
+      break;
+    }
+  }
+  f.close();
+  return t;
+}
+
+// Fills snaps[] newest first. `complete` is false when the table was full.
+static int scanSnapshots(bool* complete) {
+  *complete = true;
+  File dir = SD_MMC.open(SD_BACKUP_SNAPS);
+  if (!dir) return 0;
+
+  int count = 0;
+  size_t suffix = strlen(BACKUP_SNAP_SUFFIX);
+  File entry;
+  while (entry = dir.openNextFile()) {
+    const char* name = entry.name();
+    size_t len = strlen(name);
+    bool snap = !entry.isDirectory() && len > suffix && len - suffix < BACKUP_NAME_MAX &&
+                strcmp(name + len - suffix, BACKUP_SNAP_SUFFIX) == 0;
+    if (snap) {
+      if (count == BACKUP_MAX_SNAPSHOTS) {
+        *complete = false;
+      } else {
+        memcpy(snaps[count].name, name, len - suffix);
+        snaps[count].name[len - suffix] = '\0';
+        count++;
+      }
+    }
+    entry.close();
+  }
+  dir.close();
+
+  for (int i = 0; i < count; i++) snaps[i].time = readSnapTime(snaps[i].name);
+  // Insertion sort, newest first
+  for (int i = 1; i < count; i++) {
+    SnapInfo s = snaps[i];
+    int j = i - 1;
+    while (j >= 0 && snaps[j].time < s.time) {
+      snaps[j + 1] = snaps[j];
+      j--;
+    }
+    snaps[j + 1] = s;
+  }
+  return count;
+}
+
+// =============================================================================
+// CHUNK STORE
+// =============================================================================
+
+static bool storeChunk(const uint8_t* hash, const uint8_t* data, size_t len) {
+  char path[ATOMIC_PATH_MAX], tmp[ATOMIC_PATH_MAX];
+  chunkPath(path, hash);
+  if (SD_MMC.exists(path)) {
+    backup_stats.chunks_reused++;
+    return true;
+  }
+
+  // Temp name first: a chunk under its real name is always complete
+  snprintf(tmp, sizeof(tmp), "%s%s", path, ATOMIC_TMP_SUFFIX);
+  File f = SD_MMC.open(tmp, FILE_WRITE);
+  if (!f) return false;
+  bool ok = f.write(data, len) == len;
+  f.close();
+  ok = ok && SD_MMC.rename(tmp, path);
+  if (!ok) {
+    SD_MMC.remove(tmp);
+    return false;
+  }
+  backup_stats.chunks_written++;
+  backup_stats.bytes_written += len;
+  energyNoteWrite(ENERGY_STORE_SD);
+  return true;
+}
+
+// The first `len` bytes of `path` into the store, streamed: one C line per
+// chunk into the manifest, then the H line with the whole-file hash. No
+// chunk table is held, so file size is not limited.
+static bool storeFile(const char* path, uint32_t len, File& man) {
+  File f = SD_MMC.open(path, FILE_READ);
+  if (!f) return false;
+
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+
+  uint8_t hash[HASH_LEN];
+  char hex[HASH_LEN * 2 + 1];
+  bool ok = true;
+  while (ok && len > 0) {
+    size_t n = len < BACKUP_CHUNK_SIZE ? len : BACKUP_CHUNK_SIZE;
+    ok = f.read(chunk_buf, n) == n;
+    if (!ok) break;
+    mbedtls_sha256_update(&ctx, chunk_buf, n);
+    mbedtls_sha256(chunk_buf, n, hash, 0);
+    ok = storeChunk(hash, chunk_buf, n);
+    toHex(hash, HASH_LEN, hex);
+    man.printf("C=%s\n", hex);
+    backup_stats.bytes_read += n;
+    len -= n;
+  }
+  f.close();
+  mbedtls_sha256_finish(&ctx, hash);
+  mbedtls_sha256_free(&ctx);
+  toHex(hash, HASH_LEN, hex);
+  man.printf("H=%s\n", hex);
+  return ok;
+}
+
+// Unchanged since the previous snapshot: copy its entry (FILE, C and H lines)
+static bool copyPrevEntry(File& prev, const char* name, const AtomicStamp& st, File& man) {
+  char line[MANIFEST_LINE_MAX], pname[BACKUP_NAME_MAX];
+  uint32_t len;
+  AtomicStamp pst;
+
+  prev.seek(0);
+  while (readLine(prev, line) >= 0) {
+    if (!parseFileLine(line, pname, &len, &pst) || strcmp(pname, name) != 0) continue;
+    if (pst.gen != st.gen || pst.len != st.len || pst.crc != st.crc) return false;
+    man.printf("%s\n", line);
+    while (readLine(prev, line) >= 0) {
+      bool chunk = strncmp(line, "C=", 2) == 0;
+      if (!chunk && strncmp(line, "H=", 2) != 0) break;
+      man.printf("%s\n", line);
+      if (!chunk) break;
+    }
+    return true;
+  }
+  return false;
+}
+
+// =============================================================================
+// SNAPSHOT
+// =============================================================================
+
+bool backupCreate(const char* name, const BackupFile* files, uint8_t count) {
+  if (!sdCardInitialized || strlen(name) >= BACKUP_NAME_MAX) return false;
+  unsigned long t0 = millis();
+  if (!SD_MMC.exists(SD_BACKUP_CHUNKS)) SD_MMC.mkdir(SD_BACKUP_CHUNKS);
+  if (!SD_MMC.exists(SD_BACKUP_SNAPS)) SD_MMC.mkdir(SD_BACKUP_SNAPS);
+
+  // The newest snapshot is the base for unchanged files
+  bool complete;
+  File prev;
+  if (scanSnapshots(&complete) > 0) {
+    char prev_path[ATOMIC_PATH_MAX];
+    snapPath(prev_path, snaps[0].name);
+    prev = SD_MMC.open(prev_path, FILE_READ);
+  }
+
+  char path[ATOMIC_PATH_MAX];
+  snapPath(path, name);
+  File man = atomicFileBegin(SD_MMC, path);
+  if (!man) {
+    if (prev) prev.close();
+    return false;
+  }
+  man.printf("# FUSION backup snapshot\nVERSION=1\nTIME=%lu\n", (unsigned long)timeServiceEpoch());
+
+  int stored = 0, hashed = 0;
+  bool ok = true;
+  for (uint8_t i = 0; i < count && ok; i++) {
+    AtomicStamp st;
+    if (!fileStamp(files[i].path, &st) || st.len == 0) continue;
+
+    bool stamped = st.gen > 0 || st.crc != 0;
+    if (prev && stamped && copyPrevEntry(prev, files[i].name, st, man)) {
+      backup_stats.files_skipped++;
+      stored++;
+      continue;
+    }
+
+    man.printf("FILE=%s %lu %lu %08lx\n", files[i].name, (unsigned long)st.len,
+               (unsigned long)st.gen, (unsigned long)st.crc);
+    if (!storeFile(files[i].path, st.len, man)) {
+      Serial.printf("[BACKUP] %s: could not be stored\n", files[i].name);
+      ok = false;
+      break;
+    }
+    backup_stats.files_hashed++;
+    hashed++;
+    stored++;
+  }
+  if (prev) prev.close();
+
+  if (!ok || stored == 0) {
+    atomicFileAbort(SD_MMC, path, man);
+    return false;
+  }
+  if (!atomicFileCommit(SD_MMC, path, man)) return false;
+
+  backup_stats.snapshots++;
+  backup_stats.last_ms = millis() - t0;
+  Serial.printf("[BACKUP] Snapshot %s: %d files, %d changed, %lu ms\n",
+                name, stored, hashed, (unsigned long)backup_stats.last_ms);
+  return true;
+}
+
+bool backupExists(const char* name) {
+  char path[ATOMIC_PATH_MAX];
+  snapPath(path, name);
+  return SD_MMC.exists(path);
+}
+
+// =============================================================================
+// RESTORE
+// =============================================================================
+
+// The C lines that follow a FILE line, rebuilt into `dest` as a new commit
+// once the H line matches
+static bool restoreFile(File& man, const char* dest, uint32_t len) {
+  File out = atomicFileBegin(SD_MMC, dest);
+  if (!out) return false;
+
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+
+  char line[MANIFEST_LINE_MAX], path[ATOMIC_PATH_MAX];
+  uint8_t hash[HASH_LEN], got[HASH_LEN], want[HASH_LEN];
+  bool ok = true;
+  while (ok && len > 0) {
+    size_t n = len < BACKUP_CHUNK_SIZE ? len : BACKUP_CHUNK_SIZE;
+    ok = readLine(man, line) > 0 && strncmp(line, "C=", 2) == 0 && fromHex(line + 2, hash, HASH_LEN);
+    if (!ok) break;
+    chunkPath(path, hash);
+    File c = SD_MMC.open(path, FILE_READ);
+    ok = c && c.read(chunk_buf, n) == n;
+    if (c) c.close();
+    if (ok) {
+      mbedtls_sha256(chunk_buf, n, got, 0);
+      ok = memcmp(got, hash, HASH_LEN) == 0 && out.write(chunk_buf, n) == n;
+      mbedtls_sha256_update(&ctx, chunk_buf, n);
+    }
+    len -= n;
+  }
+  ok = ok && readLine(man, line) > 0 && strncmp(line, "H=", 2) == 0 &&
+       fromHex(line + 2, want, HASH_LEN);
+  mbedtls_sha256_finish(&ctx, got);
+  mbedtls_sha256_free(&ctx);
+
+  if (!ok || memcmp(got, want, HASH_LEN) != 0) {
+    atomicFileAbort(SD_MMC, dest, out);
+    return false;
+  }
+  return atomicFileCommit(SD_MMC, dest, out);
+}
+
+int backupRestore(const char* name, const BackupFile* files, uint8_t count) {
+  if (!sdCardInitialized) return -1;
+  char path[ATOMIC_PATH_MAX];
+  snapPath(path, name);
+  if (!atomicFileResolve(SD_MMC, path)) return -1;
+  File man = SD_MMC.open(path, FILE_READ);
+  if (!man) return -1;
+
+  int restored = 0;
+  char line[MANIFEST_LINE_MAX], fname[BACKUP_NAME_MAX];
+  uint32_t len;
+  AtomicStamp st;
+  while (readLine(man, line) >= 0) {
+    if (!parseFileLine(line, fname, &len, &st)) continue;
+    for (uint8_t i = 0; i < count; i++) {
+      if (strcmp(files[i].name, fname) != 0) continue;
+      if (restoreFile(man, files[i].path, len)) {
+        restored++;
+        Serial.printf("[BACKUP] Restored %s\n", fname);
+      } else {
+        backup_stats.restore_failures++;
+        Serial.printf("[BACKUP] Restore of %s failed, kept current\n", fname);
+      }
+      break;
+    }
+  }
+  man.close();
+  backup_stats.restores++;
+  return restored;
+}
+
+// =============================================================================
+// RETENTION
+// =============================================================================
+
+static bool refsContain(const uint64_t* refs, int count, uint64_t id) {
+  for (int i = 0; i < count; i++) {
+    if (refs[i] == id) return true;
+  }
+  return false;
+}
+
+// Delete every chunk no kept snapshot references
+static void sweepChunks(const bool* keep, int count) {
+  uint64_t* refs = (uint64_t*)malloc(BACKUP_MAX_CHUNKS * sizeof(uint64_t));
+  if (!refs) return;
+  int nrefs = 0;
+  bool overflow = false;
+
+  char path[ATOMIC_PATH_MAX], line[MANIFEST_LINE_MAX];
+  uint8_t hash[HASH_LEN];
+  for (int i = 0; i < count && !overflow; i++) {
+    if (!keep[i]) continue;
+    snapPath(path, snaps[i].name);
+    File f = SD_MMC.open(path, FILE_READ);
+    if (!f) continue;
+    while (readLine(f, line) >= 0) {
+      if (strncmp(line, "C=", 2) != 0 || !fromHex(line + 2, hash, CHUNK_ID_HEX / 2)) continue;
+      uint64_t id = chunkId(hash);
+      if (refsContain(refs, nrefs, id)) continue;
+      if (nrefs == BACKUP_MAX_CHUNKS) {
+        overflow = true;
+        break;
+      }
+      refs[nrefs++] = id;
+    }
+    f.close();
+  }
+  if (overflow) {
+    // Unknown references: deleting anything could break a snapshot
+    Serial.println("[BACKUP] Chunk table full, sweep skipped");
+    free(refs);
+    return;
+  }
+
+  File dir = SD_MMC.open(SD_BACKUP_CHUNKS);
+  if (dir) {
+    File entry;
+    while (entry = dir.openNextFile()) {
+      char name[ATOMIC_PATH_MAX];
+      snprintf(name, sizeof(name), "%s", entry.name());
+      bool dead = true;
+      if (strlen(name) == CHUNK_ID_HEX && fromHex(name, hash, CHUNK_ID_HEX / 2)) {
+        dead = !refsContain(refs, nrefs, chunkId(hash));
+      }
+      entry.close();
+      if (dead) {
+        snprintf(path, sizeof(path), "%s/%s", SD_BACKUP_CHUNKS, name);
+        if (SD_MMC.remove(path)) backup_stats.pruned_chunks++;
+      }
+    }
+    dir.close();
+  }
+  free(refs);
+}
+
+uint16_t backupPrune(uint8_t keep_recent, uint8_t keep_daily, uint8_t keep_weekly) {
+  if (!sdCardInitialized) return 0;
+  bool complete;
+  int count = scanSnapshots(&complete);
+
+  // Newest first: the first snapshot seen of a day / week is its newest
+  static bool keep[BACKUP_MAX_SNAPSHOTS];
+  uint32_t last_day = UINT32_MAX, last_week = UINT32_MAX;
+  uint8_t days = 0, weeks = 0;
+  for (int i = 0; i < count; i++) {
+    keep[i] = i < max((int)keep_recent, 1);
+    uint32_t day = snaps[i].time / SECONDS_PER_DAY;
+    uint32_t week = snaps[i].time / SECONDS_PER_WEEK;
+    if (day != last_day) {
+      last_day = day;
+      if (days++ < keep_daily) keep[i] = true;
+    }
+    if (week != last_week) {
+      last_week = week;
+      if (weeks++ < keep_weekly) keep[i] = true;
+    }
+  }
+
+  uint16_t removed = 0;
+  char path[ATOMIC_PATH_MAX], bak[ATOMIC_PATH_MAX];
+  for (int i = 0; i < count; i++) {
+    if (keep[i]) continue;
+    snapPath(path, snaps[i].name);
+    snprintf(bak, sizeof(bak), "%s%s", path, ATOMIC_BAK_SUFFIX);
+    if (SD_MMC.exists(bak)) SD_MMC.remove(bak);
+    if (SD_MMC.remove(path)) removed++;
+  }
+  backup_stats.pruned_snapshots += removed;
+
+  // Snapshots past the scan table were not read: their chunks must stay
+  if (complete) sweepChunks(keep, count);
+  Serial.printf("[BACKUP] Retention: kept %d, removed %u snapshots\n", count - removed, removed);
+  return removed;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+void backupList() {
+  bool complete;
+  int count = scanSnapshots(&complete);
+  for (int i = 0; i < count; i++) {
+    WatchTime t;
+    timeFromEpoch(snaps[i].time, t);
+    Serial.printf("  - %s  %04d-%02d-%02d %02d:%02d\n", snaps[i].name,
+                  t.year, t.month, t.day, t.hour, t.minute);
+  }
+  if (!complete) Serial.printf("  (more than %d snapshots)\n", BACKUP_MAX_SNAPSHOTS);
+}
+
+const BackupStats* getBackupStats() {
+  return &backup_stats;
+}
+
+void printBackupStats() {
+  const BackupStats& s = backup_stats;
+  Serial.printf("[BACKUP] snapshots=%lu last=%lu ms files skipped=%lu hashed=%lu\n",
+                (unsigned long)s.snapshots, (unsigned long)s.last_ms,
+                (unsigned long)s.files_skipped, (unsigned long)s.files_hashed);
+  Serial.printf("[BACKUP] chunks written=%lu reused=%lu, bytes read=%lu written=%lu\n",
+                (unsigned long)s.chunks_written, (unsigned long)s.chunks_reused,
+                (unsigned long)s.bytes_read, (unsigned long)s.bytes_written);
+  Serial.printf("[BACKUP] restores=%lu failed files=%lu, pruned snapshots=%lu chunks=%lu\n",
+                (unsigned long)s.restores, (unsigned long)s.restore_failures,
+                (unsigned long)s.pruned_snapshots, (unsigned long)s.pruned_chunks);
+}
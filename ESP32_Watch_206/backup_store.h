@@ -0,0 +1,87 @@
+/*
+ * backup_store.h - Incremental Deduplicated SD Backups
+ * FUSION OS System Layer
+ *
+ * createBackup() used to copy every file a byte at a time into a new
+ * directory, and nothing ever deleted one, so each backup cost the full
+ * data size in time and space. Backups are now snapshots over a
+ * content-addressed chunk store:
+ *
+ *   SD_BACKUP_CHUNKS/<hash>     BACKUP_CHUNK_SIZE pieces of file bodies,
+ *                               named by SHA-256 prefix, written once
+ *   SD_BACKUP_SNAPS/<name>.snap manifest: per file its atomic-save stamp,
+ *                               chunk list and SHA-256
+ *
+ * A file whose footer stamp (generation, length, CRC) matches the previous
+ * snapshot is not read at all - its manifest entry is copied. A file
+ * without a footer (nights.dat is only appended) is matched on length and
+ * modification time instead. Changed files are streamed in aligned
+ * BACKUP_CHUNK_SIZE blocks and hashed, with no size limit, and only
+ * chunks the store does not hold are written. Manifests are atomic
+ * commits; chunks are written under a temp name and renamed, so a reset
+ * never leaves a referenced chunk half written.
+ *
+ * Retention keeps the BACKUP_KEEP_RECENT newest snapshots plus the newest
+ * of each of the last BACKUP_KEEP_DAILY days and BACKUP_KEEP_WEEKLY weeks,
+ * then deletes the chunks no kept snapshot references.
+ *
+ * Restore checks every chunk hash and goes through atomicFileCommit(), so
+ * a damaged snapshot never replaces a live save.
+ */
+
+#ifndef BACKUP_STORE_H
+#define BACKUP_STORE_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define BACKUP_CHUNK_SIZE       4096    // SD sector multiple
+#define BACKUP_KEEP_RECENT      5
+#define BACKUP_KEEP_DAILY       7
+#define BACKUP_KEEP_WEEKLY      4
+#define BACKUP_MAX_SNAPSHOTS    64      // Retention scan
+#define BACKUP_MAX_CHUNKS       512     // Chunk references tracked by the sweep
+#define BACKUP_NAME_MAX         40
+#define BACKUP_SNAP_SUFFIX      ".snap"
+
+struct BackupFile {
+  const char* name;           // Name inside the snapshot
+  const char* path;           // Live file
+};
+
+struct BackupStats {
+  uint32_t snapshots;
+  uint32_t files_skipped;     // Stamp unchanged - not read
+  uint32_t files_hashed;
+  uint32_t chunks_written;
+  uint32_t chunks_reused;
+  uint32_t bytes_read;
+  uint32_t bytes_written;
+  uint32_t last_ms;           // Duration of the last snapshot
+  uint32_t restores;
+  uint32_t restore_failures;
+  uint32_t pruned_snapshots;
+  uint32_t pruned_chunks;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+bool backupCreate(const char* name, const BackupFile* files, uint8_t count);
+bool backupExists(const char* name);
+
+// Files restored into their live paths, -1 if there is no such snapshot
+int backupRestore(const char* name, const BackupFile* files, uint8_t count);
+
+void backupList();
+
+// Retention + chunk sweep; returns the snapshots removed
+uint16_t backupPrune(uint8_t keep_recent, uint8_t keep_daily, uint8_t keep_weekly);
+
+const BackupStats* getBackupStats();
+void printBackupStats();
+
+#endif // BACKUP_STORE_H
@@ -19,6 +19,8 @@
 #include "gacha.h"
 #include "navigation.h"
 #include "xp_system.h"  // FUSION OS: XP rewards
+#include "persist.h"
+#include "save_schema.h"
 #include <Arduino.h>
 #include <Preferences.h>
 
@@ -178,18 +180,21 @@ void initBossRush() {
     show_boss_selection = false;
 }
 
+static void writeBossBlob(Preferences& bossPrefs) {
+    // Pack boss defeat flags into bytes (35 bosses = 5 bytes)
+    BossBlob b;
+    memset(&b, 0, sizeof(b));
+    for (int i = 0; i < TOTAL_BOSSES; i++) {
+        progressBitSet(b.defeated_bits, i, bosses_defeated[i]);
+    }
+    schemaPutBytes(bossPrefs, BOSS_BLOB_KEY, SCHEMA_BOSS, &b, sizeof(b));
+}
+
 void saveBossProgress() {
     // Save boss defeat status to NVS
     Preferences bossPrefs;
     bossPrefs.begin("bossrush", false);
-    bossPrefs.putInt("defeated", getBossesDefeated());
-    
-    // Pack boss defeat flags into bytes (35 bosses = 5 bytes)
-    for (int i = 0; i < TOTAL_BOSSES; i++) {
-        char key[12];
-        snprintf(key, sizeof(key), "b%d", i);
-        bossPrefs.putBool(key, bosses_defeated[i]);
-    }
+    writeBossBlob(bossPrefs);
     bossPrefs.end();
     
     // Also save to SD card if available
@@ -204,20 +209,31 @@ void saveBossProgress() {
 
 bool loadBossProgress() {
     Preferences bossPrefs;
-    bossPrefs.begin("bossrush", true);  // read-only
-    
-    int saved_defeated = bossPrefs.getInt("defeated", -1);
-    if (saved_defeated < 0) {
-        bossPrefs.end();
-        return false;  // No save data found
-    }
-    
-    for (int i = 0; i < TOTAL_BOSSES; i++) {
-        char key[12];
-        snprintf(key, sizeof(key), "b%d", i);
-        bosses_defeated[i] = bossPrefs.getBool(key, false);
+    bossPrefs.begin("bossrush", false);  // writable for the one-time migration
+
+    BossBlob b;
+    if (schemaGetBytes(bossPrefs, BOSS_BLOB_KEY, SCHEMA_BOSS, &b, sizeof(b))) {
+        for (int i = 0; i < TOTAL_BOSSES; i++) {
+            bosses_defeated[i] = progressBitGet(b.defeated_bits, i);
+        }
+    } else {
+        // Pre-blob layout: "defeated" count plus one "b%d" bool per boss
+        int saved_defeated = bossPrefs.getInt("defeated", -1);
+        if (saved_defeated < 0) {
+            bossPrefs.end();
+            return false;  // No save data found
+        }
+
+        for (int i = 0; i < TOTAL_BOSSES; i++) {
+            char key[12];
+            snprintf(key, sizeof(key), "b%d", i);
+            bosses_defeated[i] = bossPrefs.getBool(key, false);
+        }
+        bossPrefs.clear();
+        writeBossBlob(bossPrefs);
+        Serial.println("[BossRush] Migrated per-boss keys to packed blob");
     }
-    
+
     system_state.bosses_defeated = getBossesDefeated();
     bossPrefs.end();
     
@@ -453,11 +469,9 @@ bool checkBattleEnd() {
 
         Serial.printf("[BossRush] Victory! +%d gems, +%d XP\n", boss->gem_reward, xp_reward);
 
-        // Save gems and XP to NVS immediately
-        extern void saveAllGameData();
-        saveAllGameData();
-
-        saveBossProgress();
+        // Gems, XP and the boss record go out with the next flush
+        persistMarkDirty(PERSIST_GAME);
+        persistMarkDirty(PERSIST_BOSS);
         drawBossVictory(*boss);
         return true;
     }
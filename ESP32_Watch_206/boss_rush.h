@@ -9,6 +9,7 @@
 
 #include "types.h"  // Must include types.h for BossData, BossTier
 #include "config.h"
+#include "progress_bits.h"
 
 // =============================================================================
 // BOSS RUSH SYSTEM
@@ -18,6 +19,17 @@ void initBossRush();
 void saveBossProgress();
 bool loadBossProgress();
 
+// NVS layout: one bitset blob in "bossrush" instead of 35 "b%d" bools,
+// stored through save_schema (SCHEMA_BOSS, which carries the version).
+// The old keys are migrated on first load.
+#define BOSS_BLOB_KEY       "bits"
+
+#pragma pack(push, 1)
+struct BossBlob {
+    uint8_t  defeated_bits[PROGRESS_BITS_BYTES(TOTAL_BOSSES)];
+};  // 5 bytes
+#pragma pack(pop)
+
 // Boss management
 BossData* getCurrentBoss();
 BossData* getBoss(int index);
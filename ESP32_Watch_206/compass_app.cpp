@@ -4,44 +4,372 @@
  */
 
 #include "compass_app.h"
+#include "compass_engine.h"
 #include "config.h"
 #include "display.h"
 #include "themes.h"
 #include "navigation.h"
-#include <Wire.h>
+#include "i2c_bus.h"
+#include "reg_sequence.h"
+#include "energy_monitor.h"
+#include "qmi8658_reg.h"
+#include <Preferences.h>
 #include <math.h>
 
 extern Arduino_CO5300 *gfx;
 extern SystemState system_state;
 
-// Compass state
-CompassData compass = {0, 0, 0, 0, false, 0};
+// Compass state (written by the task under compass_mux)
+CompassData compass = {0};
+static CompassStats compass_stats = {0};
+static portMUX_TYPE compass_mux = portMUX_INITIALIZER_UNLOCKED;
 
-// QMI8658 Registers
-#define QMI8658_MAG_X_L    0x33
-#define QMI8658_MAG_X_H    0x34
-#define QMI8658_MAG_Y_L    0x35
-#define QMI8658_MAG_Y_H    0x36
-#define QMI8658_MAG_Z_L    0x37
-#define QMI8658_MAG_Z_H    0x38
+// Pipeline state (task only)
+static CompassCal compass_cal;
+static CompassCalFit cal_fit;
+static CompassSmoother smoother;
+static unsigned long cal_start_ms = 0;
+static volatile bool cal_requested = false;
+
+static TaskHandle_t compass_task = NULL;
+static volatile bool compass_run = false;
+
+// =============================================================================
+// MAGNETOMETER CONFIG
+// =============================================================================
+static const RegSeqEntry mag_config[] = {
+  { REG_OP_WRITE, QMC5883_CTRL2, QMC5883_CTRL2_SOFT_RST, 0x00, 10 },  // Soft reset + settle
+  REG_WRITE(QMC5883_SET_RESET, 0x01),                  // Recommended SET/RESET period
+  REG_WRITE(QMC5883_CTRL1, QMC5883_CTRL1_STANDBY),     // Task switches to continuous
+};
+
+static const RegSequence mag_sequence =
+  REG_SEQ("QMC5883 compass", COMPASS_MAG_ADDR, mag_config, true);
+
+// =============================================================================
+// CALIBRATION STORAGE
+// =============================================================================
+
+static bool loadCompassCal() {
+  Preferences prefs;
+  prefs.begin("compass", true);
+  size_t n = prefs.getBytes("cal", &compass_cal, sizeof(CompassCal));
+  prefs.end();
+
+  if (n != sizeof(CompassCal) || compass_cal.version != COMPASS_CAL_VERSION || !compass_cal.valid) {
+    compassCalIdentity(compass_cal);
+    return false;
+  }
+  return true;
+}
+
+static bool saveCompassCal() {
+  Preferences prefs;
+  prefs.begin("compass", false);
+  size_t written = prefs.putBytes("cal", &compass_cal, sizeof(CompassCal));
+  prefs.end();
+  energyNoteWrite(ENERGY_STORE_NVS);
+  return written == sizeof(CompassCal);
+}
 
 // =============================================================================
 // INITIALIZATION
 // =============================================================================
 
 void initCompassApp() {
-  compass.calibrated = false;
+  compass.calibrated = loadCompassCal();
   compass.heading = 0;
   compass.last_update = 0;
-  
-  // Note: QMI8658 initialization is done in hardware.cpp
-  Serial.println("[Compass] Compass app initialized");
+  compass.available = i2cProbe(COMPASS_MAG_ADDR) && runRegSequence(mag_sequence);
+  compassSmoothReset(smoother);
+
+  if (compass.available) {
+    Serial.printf("[Compass] Magnetometer at 0x%02X, %s\n", COMPASS_MAG_ADDR,
+                  compass.calibrated ? "calibration loaded" : "not calibrated");
+  } else {
+    Serial.printf("[Compass] No magnetometer at 0x%02X (QMI8658 is 6-axis)\n", COMPASS_MAG_ADDR);
+  }
+}
+
+// =============================================================================
+// BACKGROUND TASK
+// =============================================================================
+
+static void compassTask(void* arg) {
+  (void)arg;
+  TickType_t period = pdMS_TO_TICKS(1000 / COMPASS_RATE_HZ);
+  if (period == 0) period = 1;
+  TickType_t last_wake = xTaskGetTickCount();
+
+  while (compass_run) {
+    updateCompassReading();
+    vTaskDelayUntil(&last_wake, period);
+  }
+
+  compass_task = NULL;
+  vTaskDelete(NULL);
+}
+
+bool startCompass() {
+  if (!compass.available) return false;
+  if (compass_task) return true;
+
+  if (!i2cWriteReg(COMPASS_MAG_ADDR, QMC5883_CTRL1, QMC5883_CTRL1_CONT_50HZ_8G)) return false;
+  compassSmoothReset(smoother);
+
+  compass_run = true;
+  if (xTaskCreatePinnedToCore(compassTask, "compass", COMPASS_TASK_STACK, NULL,
+                              COMPASS_TASK_PRIORITY, &compass_task, COMPASS_TASK_CORE) != pdPASS) {
+    compass_run = false;
+    compass_task = NULL;
+    Serial.println("[Compass] Task create FAILED");
+    return false;
+  }
+  Serial.printf("[Compass] Sampling at %d Hz\n", COMPASS_RATE_HZ);
+  return true;
+}
+
+void stopCompass() {
+  if (!compass_task) return;
+  compass_run = false;
+
+  // Let the task finish its current cycle before the sensor goes to standby
+  unsigned long start = millis();
+  while (compass_task && millis() - start < 200) delay(5);
+
+  i2cWriteReg(COMPASS_MAG_ADDR, QMC5883_CTRL1, QMC5883_CTRL1_STANDBY);
+  portENTER_CRITICAL(&compass_mux);
+  compass.calibrating = false;
+  portEXIT_CRITICAL(&compass_mux);
+  Serial.println("[Compass] Sampling stopped");
+}
+
+// =============================================================================
+// COMPASS LOGIC
+// =============================================================================
+
+static void calibrationStep(float mx, float my, float mz) {
+  if (cal_requested) {
+    cal_requested = false;
+    compassCalReset(cal_fit);
+    cal_start_ms = millis();
+    portENTER_CRITICAL(&compass_mux);
+    compass.calibrating = true;
+    compass.cal_progress = 0;
+    portEXIT_CRITICAL(&compass_mux);
+    Serial.println("[Compass] Calibration started - rotate the watch in all directions");
+  }
+  if (!compass.calibrating) return;
+
+  compassCalAddSample(cal_fit, mx, my, mz);
+  uint8_t progress = compassCalProgress(cal_fit);
+
+  bool done = false;
+  bool solved = false;
+  if (progress >= 100) {
+    CompassCal fitted;
+    solved = compassCalSolve(cal_fit, fitted);
+    if (solved) {
+      compass_cal = fitted;
+      saveCompassCal();
+      compassSmoothReset(smoother);
+      compass_stats.calibrations++;
+      Serial.printf("[Compass] Calibrated: offset %.0f/%.0f/%.0f scale %.2f/%.2f/%.2f\n",
+                    fitted.offset[0], fitted.offset[1], fitted.offset[2],
+                    fitted.scale[0], fitted.scale[1], fitted.scale[2]);
+    }
+    done = true;
+  } else if (millis() - cal_start_ms > COMPASS_CAL_TIMEOUT_MS) {
+    Serial.printf("[Compass] Calibration timed out at %d%%\n", progress);
+    done = true;
+  }
+
+  portENTER_CRITICAL(&compass_mux);
+  compass.cal_progress = progress;
+  if (done) compass.calibrating = false;
+  if (solved) compass.calibrated = true;
+  portEXIT_CRITICAL(&compass_mux);
+}
+
+void updateCompassReading() {
+  uint32_t t0 = micros();
+
+  // DRDY clears on the data read, so check it first
+  uint8_t status = 0;
+  if (!i2cReadReg(COMPASS_MAG_ADDR, QMC5883_STATUS, &status)) {
+    compass_stats.read_errors++;
+    return;
+  }
+  if (!(status & QMC5883_STATUS_DRDY)) {
+    compass_stats.not_ready++;
+    return;
+  }
+
+  uint8_t raw[6];
+  if (!i2cReadRegs(COMPASS_MAG_ADDR, QMC5883_DATA_X_L, raw, sizeof(raw))) {
+    compass_stats.read_errors++;
+    return;
+  }
+
+  uint8_t acc[6];
+  if (!i2cReadRegs(QMI8658_ADDR, QMI8658_AX_L, acc, sizeof(acc))) {
+    compass_stats.read_errors++;
+    return;
+  }
+
+  float mx = COMPASS_MAG_SIGN_X * (float)(int16_t)(raw[0] | (raw[1] << 8));
+  float my = COMPASS_MAG_SIGN_Y * (float)(int16_t)(raw[2] | (raw[3] << 8));
+  float mz = COMPASS_MAG_SIGN_Z * (float)(int16_t)(raw[4] | (raw[5] << 8));
+  float ax = COMPASS_ACCEL_SIGN_X * (float)(int16_t)(acc[0] | (acc[1] << 8));
+  float ay = COMPASS_ACCEL_SIGN_Y * (float)(int16_t)(acc[2] | (acc[3] << 8));
+  float az = COMPASS_ACCEL_SIGN_Z * (float)(int16_t)(acc[4] | (acc[5] << 8));
+
+  calibrationStep(mx, my, mz);
+  compassCalApply(compass_cal, mx, my, mz);
+
+  float heading = compassTiltHeading(mx, my, mz, ax, ay, az) + COMPASS_DECLINATION_DEG;
+  if (heading < 0) heading += 360.0f;
+  if (heading >= 360.0f) heading -= 360.0f;
+  float smoothed = compassSmoothAdd(smoother, heading);
+  float stability = compassSmoothStability(smoother);
+
+  portENTER_CRITICAL(&compass_mux);
+  compass.heading = smoothed;
+  compass.mag_x = mx;
+  compass.mag_y = my;
+  compass.mag_z = mz;
+  compass.stability = stability;
+  compass.last_update = millis();
+  portEXIT_CRITICAL(&compass_mux);
+
+  uint32_t us = micros() - t0;
+  compass_stats.samples++;
+  compass_stats.last_cycle_us = us;
+  if (us > compass_stats.max_cycle_us) compass_stats.max_cycle_us = us;
+}
+
+void startCompassCalibration() {
+  if (!compass.available) return;
+  cal_requested = true;
+  startCompass();
+}
+
+void getCompassSnapshot(CompassData& out) {
+  portENTER_CRITICAL(&compass_mux);
+  out = compass;
+  portEXIT_CRITICAL(&compass_mux);
+}
+
+const char* getCardinalDirection(float heading) {
+  // 16-point compass rose
+  const char* directions[] = {
+    "N", "NNE", "NE", "ENE",
+    "E", "ESE", "SE", "SSE",
+    "S", "SSW", "SW", "WSW",
+    "W", "WNW", "NW", "NNW"
+  };
+
+  int index = (int)((heading + 11.25) / 22.5) % 16;
+  return directions[index];
 }
 
 // =============================================================================
 // COMPASS SCREEN
 // =============================================================================
 
+#define DIAL_CX       (LCD_WIDTH / 2)
+#define DIAL_CY       240
+#define DIAL_OUTER_R  120
+#define DIAL_FACE_R   96
+
+// Everything that moves: needle, heading readout, calibration status
+static void drawCompassDial() {
+  ThemeColors* theme = getCurrentTheme();
+  CompassData snap;
+  getCompassSnapshot(snap);
+
+  int centerX = DIAL_CX;
+  int centerY = DIAL_CY;
+
+  gfx->fillCircle(centerX, centerY, DIAL_FACE_R, RGB565(6, 7, 11));
+
+  if (snap.available) {
+    // Compass needle - pixel rectangles instead of circles
+    float needleAngle = snap.heading * PI / 180.0 - PI/2;
+
+    // North pointer (red pixel trail)
+    for (int i = 0; i < 8; i++) {
+      int x = centerX + cos(needleAngle) * (i * 12);
+      int y = centerY + sin(needleAngle) * (i * 12);
+      int sz = 8 - i;
+      gfx->fillRect(x - sz/2, y - sz/2, sz, sz, COLOR_RED);
+    }
+
+    // South pointer (dim pixel trail)
+    float southAngle = needleAngle + PI;
+    for (int i = 0; i < 5; i++) {
+      int x = centerX + cos(southAngle) * (i * 10);
+      int y = centerY + sin(southAngle) * (i * 10);
+      gfx->fillRect(x - 2, y - 2, 5, 5, RGB565(80, 85, 100));
+    }
+  }
+
+  // Center - pixel cross
+  gfx->fillRect(centerX - 6, centerY - 6, 12, 12, RGB565(30, 32, 42));
+  gfx->fillRect(centerX - 3, centerY - 3, 6, 6, theme->accent);
+
+  // Heading display - retro framed
+  gfx->fillRect(centerX - 60, 80, 120, 50, RGB565(12, 14, 20));
+  gfx->drawRect(centerX - 60, 80, 120, 50, RGB565(40, 45, 60));
+  gfx->fillRect(centerX - 60, 80, 5, 5, theme->primary);
+  gfx->fillRect(centerX + 55, 80, 5, 5, theme->primary);
+
+  gfx->setTextSize(4);
+  gfx->setTextColor(theme->primary);
+  char headingStr[8];
+  if (snap.available) {
+    sprintf(headingStr, "%3d", (int)snap.heading);
+  } else {
+    strcpy(headingStr, "---");
+  }
+  gfx->setCursor(centerX - 42, 90);
+  gfx->print(headingStr);
+  gfx->setTextSize(2);
+  gfx->print("o");
+
+  // Cardinal direction text
+  gfx->fillRect(centerX - 30, 138, 60, 18, RGB565(2, 2, 5));
+  if (snap.available) {
+    const char* direction = getCardinalDirection(snap.heading);
+    gfx->setTextSize(2);
+    gfx->setTextColor(theme->accent);
+    int dirLen = strlen(direction) * 12;
+    gfx->setCursor(centerX - dirLen/2, 140);
+    gfx->print(direction);
+  }
+
+  // Calibration status - retro
+  gfx->fillRect(50, 395, LCD_WIDTH - 100, 22, RGB565(2, 2, 5));
+  const char* status = NULL;
+  char progressStr[32];
+  if (!snap.available) {
+    status = "No magnetometer fitted";
+  } else if (snap.calibrating) {
+    snprintf(progressStr, sizeof(progressStr), "Rotate all ways... %d%%", snap.cal_progress);
+    status = progressStr;
+  } else if (!snap.calibrated) {
+    status = "Tap, then rotate to calibrate";
+  }
+  if (status) {
+    gfx->fillRect(50, 395, LCD_WIDTH - 100, 22, RGB565(10, 12, 18));
+    gfx->drawRect(50, 395, LCD_WIDTH - 100, 22, RGB565(255, 200, 0));
+    gfx->setTextSize(1);
+    gfx->setTextColor(RGB565(255, 200, 0));
+    gfx->setCursor(65, 402);
+    gfx->print(status);
+  }
+}
+
 void drawCompassApp() {
   // ========================================
   // RETRO ANIME COMPASS - CRT Style
@@ -50,9 +378,9 @@ void drawCompassApp() {
   for (int y = 0; y < LCD_HEIGHT; y += 4) {
     gfx->drawFastHLine(0, y, LCD_WIDTH, RGB565(4, 4, 7));
   }
-  
+
   ThemeColors* theme = getCurrentTheme();
-  
+
   // Retro header
   gfx->fillRect(0, 0, LCD_WIDTH, 48, RGB565(10, 12, 18));
   for (int x = 0; x < LCD_WIDTH; x += 8) {
@@ -65,20 +393,17 @@ void drawCompassApp() {
   gfx->setTextColor(COLOR_WHITE);
   gfx->setCursor(LCD_WIDTH/2 - 42, 14);
   gfx->print("COMPASS");
-  
-  int centerX = LCD_WIDTH / 2;
-  int centerY = 240;
-  int outerRadius = 120;
-  int innerRadius = 100;
-  
-  updateCompassReading();
-  
+
+  int centerX = DIAL_CX;
+  int centerY = DIAL_CY;
+  int outerRadius = DIAL_OUTER_R;
+
   // Outer compass ring - pixel style tick marks
   for (int i = 0; i < 360; i += 3) {
     float a = i * PI / 180.0 - PI/2;
     int x = centerX + cos(a) * outerRadius;
     int y = centerY + sin(a) * outerRadius;
-    
+
     if (i % 30 == 0) {
       // Major marks - pixel squares
       gfx->fillRect(x - 2, y - 2, 5, 5, theme->primary);
@@ -86,142 +411,64 @@ void drawCompassApp() {
       gfx->fillRect(x - 1, y - 1, 3, 3, RGB565(50, 55, 70));
     }
   }
-  
+
   // Cardinal directions - retro styled
   const char* cardinals[] = {"N", "E", "S", "W"};
   uint16_t cardinalColors[] = {COLOR_RED, RGB565(180, 185, 200), RGB565(180, 185, 200), RGB565(180, 185, 200)};
   int cardinalAngles[] = {0, 90, 180, 270};
-  
+
   for (int i = 0; i < 4; i++) {
     float a = cardinalAngles[i] * PI / 180.0 - PI/2;
     int x = centerX + cos(a) * (outerRadius + 20);
     int y = centerY + sin(a) * (outerRadius + 20);
-    
+
     gfx->setTextSize(2);
     gfx->setTextColor(cardinalColors[i]);
     gfx->setCursor(x - 6, y - 8);
     gfx->print(cardinals[i]);
   }
-  
-  // Compass needle - pixel rectangles instead of circles
-  float needleAngle = compass.heading * PI / 180.0 - PI/2;
-  
-  // North pointer (red pixel trail)
-  for (int i = 0; i < 8; i++) {
-    int x = centerX + cos(needleAngle) * (i * 12);
-    int y = centerY + sin(needleAngle) * (i * 12);
-    int sz = 8 - i;
-    gfx->fillRect(x - sz/2, y - sz/2, sz, sz, COLOR_RED);
-  }
-  
-  // South pointer (dim pixel trail)
-  float southAngle = needleAngle + PI;
-  for (int i = 0; i < 5; i++) {
-    int x = centerX + cos(southAngle) * (i * 10);
-    int y = centerY + sin(southAngle) * (i * 10);
-    gfx->fillRect(x - 2, y - 2, 5, 5, RGB565(80, 85, 100));
-  }
-  
-  // Center - pixel cross
-  gfx->fillRect(centerX - 6, centerY - 6, 12, 12, RGB565(30, 32, 42));
-  gfx->fillRect(centerX - 3, centerY - 3, 6, 6, theme->accent);
-  
-  // Heading display - retro framed
-  gfx->fillRect(centerX - 60, 80, 120, 50, RGB565(12, 14, 20));
-  gfx->drawRect(centerX - 60, 80, 120, 50, RGB565(40, 45, 60));
-  gfx->fillRect(centerX - 60, 80, 5, 5, theme->primary);
-  gfx->fillRect(centerX + 55, 80, 5, 5, theme->primary);
-  
-  gfx->setTextSize(4);
-  gfx->setTextColor(theme->primary);
-  char headingStr[8];
-  sprintf(headingStr, "%3d", (int)compass.heading);
-  gfx->setCursor(centerX - 42, 90);
-  gfx->print(headingStr);
-  gfx->setTextSize(2);
-  gfx->print("o");
-  
-  // Cardinal direction text
-  const char* direction = getCardinalDirection(compass.heading);
-  gfx->setTextSize(2);
-  gfx->setTextColor(theme->accent);
-  int dirLen = strlen(direction) * 12;
-  gfx->setCursor(centerX - dirLen/2, 140);
-  gfx->print(direction);
-  
-  // Calibration status - retro
-  if (!compass.calibrated) {
-    gfx->fillRect(50, 395, LCD_WIDTH - 100, 22, RGB565(10, 12, 18));
-    gfx->drawRect(50, 395, LCD_WIDTH - 100, 22, RGB565(255, 200, 0));
-    gfx->setTextSize(1);
-    gfx->setTextColor(RGB565(255, 200, 0));
-    gfx->setCursor(65, 402);
-    gfx->print("Rotate watch to calibrate");
-  }
-  
+
+  drawCompassDial();
   drawSwipeIndicator();
 }
 
-// =============================================================================
-// COMPASS LOGIC
-// =============================================================================
+void openCompassApp() {
+  startCompass();
+  drawCompassApp();
+}
 
-void updateCompassReading() {
-  // Read magnetometer data from QMI8658
-  // Note: This is a simplified version. Real implementation needs proper I2C reads
-  
-  Wire.beginTransmission(QMI8658_ADDR);
-  Wire.write(QMI8658_MAG_X_L);
-  Wire.endTransmission(false);
-  Wire.requestFrom(QMI8658_ADDR, 6);
-  
-  if (Wire.available() >= 6) {
-    int16_t mx = Wire.read() | (Wire.read() << 8);
-    int16_t my = Wire.read() | (Wire.read() << 8);
-    int16_t mz = Wire.read() | (Wire.read() << 8);
-    
-    compass.mag_x = mx;
-    compass.mag_y = my;
-    compass.mag_z = mz;
-    
-    compass.heading = calculateHeading(mx, my, mz);
-    compass.last_update = millis();
-    
-    // Simple calibration check
-    if (abs(mx) > 50 || abs(my) > 50) {
-      compass.calibrated = true;
-    }
-  }
+void closeCompassApp() {
+  stopCompass();
 }
 
-float calculateHeading(float mx, float my, float mz) {
-  // Calculate heading from magnetometer data
-  // Simplified 2D heading (assumes watch is held flat)
-  
-  float heading = atan2(my, mx) * 180.0 / PI;
-  
-  // Normalize to 0-359
-  if (heading < 0) {
-    heading += 360;
+void updateCompassDisplay() {
+  static unsigned long last_draw = 0;
+  static float drawn_heading = -1;
+  static uint8_t drawn_progress = 0;
+  static bool drawn_calibrating = false;
+  static bool drawn_calibrated = false;
+
+  if (!compass_task || millis() - last_draw < COMPASS_UI_MIN_MS) return;
+
+  CompassData snap;
+  getCompassSnapshot(snap);
+
+  float delta = fabsf(snap.heading - drawn_heading);
+  if (delta > 180.0f) delta = 360.0f - delta;
+
+  if (drawn_heading >= 0 && delta < COMPASS_UI_MIN_DELTA &&
+      snap.cal_progress == drawn_progress &&
+      snap.calibrating == drawn_calibrating &&
+      snap.calibrated == drawn_calibrated) {
+    return;
   }
-  
-  // Adjust for magnetic declination if needed
-  // (Varies by location, typically -20 to +20 degrees)
-  
-  return heading;
-}
 
-const char* getCardinalDirection(float heading) {
-  // 16-point compass rose
-  const char* directions[] = {
-    "N", "NNE", "NE", "ENE",
-    "E", "ESE", "SE", "SSE",
-    "S", "SSW", "SW", "WSW",
-    "W", "WNW", "NW", "NNW"
-  };
-  
-  int index = (int)((heading + 11.25) / 22.5) % 16;
-  return directions[index];
+  drawCompassDial();
+  last_draw = millis();
+  drawn_heading = snap.heading;
+  drawn_progress = snap.cal_progress;
+  drawn_calibrating = snap.calibrating;
+  drawn_calibrated = snap.calibrated;
 }
 
 // =============================================================================
@@ -231,13 +478,43 @@ const char* getCardinalDirection(float heading) {
 void handleCompassTouch(TouchGesture& gesture) {
   // Swipe UP to exit
   if (gesture.event == TOUCH_SWIPE_UP) {
+    closeCompassApp();
     returnToAppGrid();
     return;
   }
-  
+
   // Tap to recalibrate
   if (gesture.event == TOUCH_TAP) {
-    compass.calibrated = false;
-    drawCompassApp();
+    startCompassCalibration();
+    drawCompassDial();
   }
 }
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const CompassStats* getCompassStats() {
+  return &compass_stats;
+}
+
+void printCompassStats() {
+  CompassData snap;
+  getCompassSnapshot(snap);
+  Serial.printf("[Compass] %s, task %s, heading %.1f (stability %.2f)%s\n",
+                snap.available ? "mag present" : "no mag",
+                compass_task ? "running" : "stopped",
+                snap.heading, snap.stability,
+                snap.calibrated ? "" : " UNCALIBRATED");
+  Serial.printf("[Compass] samples=%lu errors=%lu not_ready=%lu cycle=%lu us (max %lu) cals=%lu\n",
+                (unsigned long)compass_stats.samples,
+                (unsigned long)compass_stats.read_errors,
+                (unsigned long)compass_stats.not_ready,
+                (unsigned long)compass_stats.last_cycle_us,
+                (unsigned long)compass_stats.max_cycle_us,
+                (unsigned long)compass_stats.calibrations);
+  Serial.printf("[Compass] cal offset %.0f/%.0f/%.0f scale %.2f/%.2f/%.2f field %.0f\n",
+                compass_cal.offset[0], compass_cal.offset[1], compass_cal.offset[2],
+                compass_cal.scale[0], compass_cal.scale[1], compass_cal.scale[2],
+                compass_cal.field);
+}
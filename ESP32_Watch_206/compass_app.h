@@ -1,6 +1,15 @@
 /*
  * compass_app.h - Digital Compass Application
- * Uses QMI8658 magnetometer for heading
+ * Tilt-compensated heading from an external magnetometer
+ *
+ * The QMI8658 is a 6-axis IMU with no magnetometer, so the compass talks to
+ * a QMC5883L-class module on the shared I2C bus (COMPASS_MAG_ADDR). Without
+ * one the app says so instead of inventing a heading.
+ *
+ * A background task samples mag + accel at COMPASS_RATE_HZ, applies the
+ * stored hard/soft-iron calibration, tilt-compensates and smooths (see
+ * compass_engine.h) and publishes the result. The UI only reads the latest
+ * snapshot and redraws the dial when the heading moves.
  */
 
 #ifndef COMPASS_APP_H
@@ -9,22 +18,96 @@
 #include <Arduino.h>
 #include "config.h"
 
-// Compass data
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define COMPASS_MAG_ADDR          0x0D    // QMC5883L-style module
+#define COMPASS_RATE_HZ           25      // Background task sample rate
+#define COMPASS_UI_MIN_MS         40      // Dial redraw cap (25 fps)
+#define COMPASS_UI_MIN_DELTA      1.0f    // Degrees of change worth a redraw
+#define COMPASS_CAL_TIMEOUT_MS    30000   // Give up on an unfinished rotation
+#define COMPASS_DECLINATION_DEG   0.0f    // Local magnetic declination (east +)
+
+#define COMPASS_TASK_STACK        4096
+#define COMPASS_TASK_PRIORITY     1
+#define COMPASS_TASK_CORE         0       // Arduino loop runs on core 1
+
+// Sensor axes -> body frame (x 12 o'clock, y 3 o'clock, z into the wrist).
+// The IMU reads -Z face-up (see WRIST_FACE_UP_SIGN): 180 deg about X.
+#define COMPASS_ACCEL_SIGN_X      1
+#define COMPASS_ACCEL_SIGN_Y      -1
+#define COMPASS_ACCEL_SIGN_Z      -1
+#define COMPASS_MAG_SIGN_X        1
+#define COMPASS_MAG_SIGN_Y        1
+#define COMPASS_MAG_SIGN_Z        1
+
+// QMC5883L registers
+#define QMC5883_DATA_X_L          0x00
+#define QMC5883_STATUS            0x06
+#define QMC5883_STATUS_DRDY       0x01
+#define QMC5883_CTRL1             0x09
+#define QMC5883_CTRL2             0x0A
+#define QMC5883_SET_RESET         0x0B
+#define QMC5883_CTRL1_CONT_50HZ_8G  0x15  // OSR 512, 8 G, 50 Hz, continuous
+#define QMC5883_CTRL1_STANDBY     0x00
+#define QMC5883_CTRL2_SOFT_RST    0x80
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+// Compass data (published by the task, read as a snapshot)
 struct CompassData {
-  float heading;        // 0-359 degrees
-  float mag_x;
+  float heading;        // 0-359 degrees, smoothed + declination
+  float mag_x;          // Calibrated field, counts
   float mag_y;
   float mag_z;
   bool calibrated;
   unsigned long last_update;
+  bool available;       // Magnetometer answered at init
+  bool calibrating;
+  uint8_t cal_progress; // 0..100 during a calibration rotation
+  float stability;      // 0..1 agreement of the smoothing window
+};
+
+struct CompassStats {
+  uint32_t samples;
+  uint32_t read_errors;
+  uint32_t not_ready;
+  uint32_t last_cycle_us;
+  uint32_t max_cycle_us;
+  uint32_t calibrations;
 };
 
-// Function declarations
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Boot: probe + configure the magnetometer, load calibration from NVS
 void initCompassApp();
+
+// App entry / exit (starts and stops the sampling task)
+void openCompassApp();
+void closeCompassApp();
+
 void drawCompassApp();
 void handleCompassTouch(TouchGesture& gesture);
+
+// Loop hook while the compass screen is up - redraws the dial on change
+void updateCompassDisplay();
+
+// Background sampling
+bool startCompass();
+void stopCompass();
+
+// One pipeline step (read, calibrate, tilt-compensate, smooth, publish)
 void updateCompassReading();
-float calculateHeading(float mx, float my, float mz);
+
+void startCompassCalibration();
+void getCompassSnapshot(CompassData& out);
 const char* getCardinalDirection(float heading);
 
+const CompassStats* getCompassStats();
+void printCompassStats();
+
 #endif
@@ -0,0 +1,214 @@
+/*
+ * compass_engine.cpp - Compass Math Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "compass_engine.h"
+#include <math.h>
+#include <string.h>
+
+// Samples are scaled down before squaring so the normal equations stay
+// well conditioned in double (raw counts run into the thousands)
+#define FIT_NORM  1.0e-3
+
+// =============================================================================
+// CALIBRATION FIT
+// =============================================================================
+
+void compassCalReset(CompassCalFit& fit) {
+  memset(&fit, 0, sizeof(CompassCalFit));
+  for (int i = 0; i < 3; i++) {
+    fit.min[i] = 1e30f;
+    fit.max[i] = -1e30f;
+  }
+}
+
+void compassCalAddSample(CompassCalFit& fit, float mx, float my, float mz) {
+  float v[3] = {mx, my, mz};
+  for (int i = 0; i < 3; i++) {
+    if (v[i] < fit.min[i]) fit.min[i] = v[i];
+    if (v[i] > fit.max[i]) fit.max[i] = v[i];
+  }
+
+  double x = mx * FIT_NORM, y = my * FIT_NORM, z = mz * FIT_NORM;
+  double row[6] = {x * x, y * y, z * z, x, y, z};
+  for (int r = 0; r < 6; r++) {
+    for (int c = r; c < 6; c++) fit.ata[r][c] += row[r] * row[c];
+    fit.atb[r] += row[r];
+  }
+  fit.samples++;
+}
+
+static float spanRatio(const CompassCalFit& fit) {
+  if (fit.samples == 0) return 0;
+  float lo = 1e30f, hi = 0;
+  for (int i = 0; i < 3; i++) {
+    float span = fit.max[i] - fit.min[i];
+    if (span < lo) lo = span;
+    if (span > hi) hi = span;
+  }
+  return hi > 0 ? lo / hi : 0;
+}
+
+uint8_t compassCalProgress(const CompassCalFit& fit) {
+  float by_samples = (float)fit.samples / COMPASS_CAL_MIN_SAMPLES;
+  float by_span = spanRatio(fit) / COMPASS_CAL_MIN_SPAN;
+  float p = by_samples < by_span ? by_samples : by_span;
+  if (p > 1.0f) p = 1.0f;
+  return (uint8_t)(p * 100.0f);
+}
+
+// Gaussian elimination with partial pivoting on the 6x6 normal equations
+static bool solve6(double a[6][6], double b[6], double x[6]) {
+  for (int col = 0; col < 6; col++) {
+    int pivot = col;
+    for (int r = col + 1; r < 6; r++) {
+      if (fabs(a[r][col]) > fabs(a[pivot][col])) pivot = r;
+    }
+    if (fabs(a[pivot][col]) < 1e-12) return false;
+    if (pivot != col) {
+      for (int c = 0; c < 6; c++) {
+        double t = a[col][c]; a[col][c] = a[pivot][c]; a[pivot][c] = t;
+      }
+      double t = b[col]; b[col] = b[pivot]; b[pivot] = t;
+    }
+    for (int r = col + 1; r < 6; r++) {
+      double f = a[r][col] / a[col][col];
+      for (int c = col; c < 6; c++) a[r][c] -= f * a[col][c];
+      b[r] -= f * b[col];
+    }
+  }
+  for (int r = 5; r >= 0; r--) {
+    double s = b[r];
+    for (int c = r + 1; c < 6; c++) s -= a[r][c] * x[c];
+    x[r] = s / a[r][r];
+  }
+  return true;
+}
+
+static bool solveEllipsoid(const CompassCalFit& fit, float centre[3], float radius[3]) {
+  double a[6][6], b[6], p[6];
+  for (int r = 0; r < 6; r++) {
+    for (int c = 0; c < 6; c++) a[r][c] = c >= r ? fit.ata[r][c] : fit.ata[c][r];
+    b[r] = fit.atb[r];
+  }
+  if (!solve6(a, b, p)) return false;
+
+  // A x^2 + D x = A (x - cx)^2 - A cx^2, so the sphere form is
+  // A (x - cx)^2 + B (y - cy)^2 + C (z - cz)^2 = G
+  double g = 1.0;
+  for (int i = 0; i < 3; i++) {
+    if (p[i] <= 0) return false;
+    double c = -p[i + 3] / (2.0 * p[i]);
+    centre[i] = (float)(c / FIT_NORM);
+    g += p[i] * c * c;
+  }
+  if (g <= 0) return false;
+  for (int i = 0; i < 3; i++) radius[i] = (float)(sqrt(g / p[i]) / FIT_NORM);
+  return true;
+}
+
+bool compassCalSolve(const CompassCalFit& fit, CompassCal& cal) {
+  if (compassCalProgress(fit) < 100) return false;
+
+  float centre[3], radius[3];
+  if (!solveEllipsoid(fit, centre, radius)) {
+    // Min/max box: centre of each span, half span as radius
+    for (int i = 0; i < 3; i++) {
+      centre[i] = (fit.max[i] + fit.min[i]) * 0.5f;
+      radius[i] = (fit.max[i] - fit.min[i]) * 0.5f;
+      if (radius[i] <= 0) return false;
+    }
+  }
+
+  float mean = (radius[0] + radius[1] + radius[2]) / 3.0f;
+  cal.version = COMPASS_CAL_VERSION;
+  cal.valid = 1;
+  for (int i = 0; i < 3; i++) {
+    cal.offset[i] = centre[i];
+    cal.scale[i] = mean / radius[i];
+  }
+  cal.field = mean;
+  return true;
+}
+
+void compassCalIdentity(CompassCal& cal) {
+  memset(&cal, 0, sizeof(CompassCal));
+  cal.version = COMPASS_CAL_VERSION;
+  for (int i = 0; i < 3; i++) cal.scale[i] = 1.0f;
+}
+
+void compassCalApply(const CompassCal& cal, float& mx, float& my, float& mz) {
+  mx = (mx - cal.offset[0]) * cal.scale[0];
+  my = (my - cal.offset[1]) * cal.scale[1];
+  mz = (mz - cal.offset[2]) * cal.scale[2];
+}
+
+// =============================================================================
+// TILT-COMPENSATED HEADING
+// =============================================================================
+
+// Body frame: x forward (12 o'clock), y right (3 o'clock), z into the wrist,
+// so a flat watch reads +1 g on z. Roll about x, then pitch about y, brings
+// the field into the horizontal plane.
+float compassTiltHeading(float mx, float my, float mz, float ax, float ay, float az) {
+  // No usable gravity (free fall, a zeroed read): treat the watch as flat
+  // rather than normalise a null vector into NaN, which would then sit in
+  // the smoothing ring for COMPASS_SMOOTH_LEN samples
+  float g2 = ax * ax + ay * ay + az * az;
+  if (!(g2 > 0) || !isfinite(g2)) {
+    ax = 0;
+    ay = 0;
+    az = 1;
+  }
+
+  float roll = atan2f(ay, az);
+  float sr = sinf(roll), cr = cosf(roll);
+
+  float by = my * cr - mz * sr;
+  float bz = my * sr + mz * cr;
+
+  // ay*sr + az*cr is |(ay, az)| >= 0; atan2 instead of atan(-ax / that)
+  // keeps the watch on its edge (|(ay, az)| = 0) finite at +-90 degrees
+  float pitch = atan2f(-ax, ay * sr + az * cr);
+  float bx = mx * cosf(pitch) + bz * sinf(pitch);
+
+  float heading = atan2f(-by, bx) * 180.0f / (float)M_PI;
+  if (!isfinite(heading)) return 0;
+  if (heading < 0) heading += 360.0f;
+  if (heading >= 360.0f) heading -= 360.0f;
+  return heading;
+}
+
+// =============================================================================
+// CIRCULAR-MEAN SMOOTHING
+// =============================================================================
+
+void compassSmoothReset(CompassSmoother& sm) {
+  memset(&sm, 0, sizeof(CompassSmoother));
+}
+
+float compassSmoothAdd(CompassSmoother& sm, float heading_deg) {
+  float rad = heading_deg * (float)M_PI / 180.0f;
+  sm.s[sm.idx] = sinf(rad);
+  sm.c[sm.idx] = cosf(rad);
+  sm.idx = (sm.idx + 1) % COMPASS_SMOOTH_LEN;
+  if (sm.fill < COMPASS_SMOOTH_LEN) sm.fill++;
+
+  // Re-summed each time (N is tiny) so float error never accumulates
+  sm.sum_s = 0;
+  sm.sum_c = 0;
+  for (int i = 0; i < sm.fill; i++) {
+    sm.sum_s += sm.s[i];
+    sm.sum_c += sm.c[i];
+  }
+
+  float mean = atan2f(sm.sum_s, sm.sum_c) * 180.0f / (float)M_PI;
+  if (mean < 0) mean += 360.0f;
+  return mean;
+}
+
+float compassSmoothStability(const CompassSmoother& sm) {
+  if (sm.fill == 0) return 0;
+  return sqrtf(sm.sum_s * sm.sum_s + sm.sum_c * sm.sum_c) / sm.fill;
+}
@@ -0,0 +1,96 @@
+/*
+ * compass_engine.h - Compass Math (calibration, tilt, smoothing)
+ * FUSION OS Sensor Layer
+ *
+ * Three stages between raw magnetometer counts and a heading:
+ * - Calibration: while the user turns the watch through every orientation,
+ *   running sums for an axis-aligned ellipsoid least-squares fit are
+ *   accumulated (no sample buffer). The fit gives the hard-iron offset
+ *   (ellipsoid centre) and a per-axis soft-iron scale that makes it a sphere.
+ *   If the fit is degenerate, the min/max box is used instead.
+ * - Tilt compensation: roll and pitch from the accelerometer rotate the
+ *   field vector back into the horizontal plane before atan2.
+ * - Smoothing: circular mean (sum of sin/cos) over a ring of headings, so
+ *   359 -> 1 degree does not average to 180.
+ *
+ * Arduino-free so it can be exercised on a PC.
+ */
+
+#ifndef COMPASS_ENGINE_H
+#define COMPASS_ENGINE_H
+
+#include <stdint.h>
+
+// =============================================================================
+// TUNING
+// =============================================================================
+#define COMPASS_SMOOTH_LEN        8       // Ring length (~0.3s at 25 Hz)
+#define COMPASS_CAL_MIN_SAMPLES   150     // Before a fit is attempted
+#define COMPASS_CAL_MIN_SPAN      0.6f    // Per-axis span vs mean span (coverage)
+
+// =============================================================================
+// CALIBRATION
+// =============================================================================
+
+// Stored in NVS - keep packed, bump version on layout change
+#pragma pack(push, 1)
+struct CompassCal {
+  uint8_t version;
+  uint8_t valid;
+  float offset[3];    // Hard iron, raw counts
+  float scale[3];     // Soft iron, per-axis gain
+  float field;        // Mean field radius after correction (counts)
+};
+#pragma pack(pop)
+
+#define COMPASS_CAL_VERSION  1
+
+// Running sums for the fit  A x^2 + B y^2 + C z^2 + D x + E y + F z = 1
+struct CompassCalFit {
+  double ata[6][6];
+  double atb[6];
+  float min[3];
+  float max[3];
+  uint32_t samples;
+};
+
+void compassCalReset(CompassCalFit& fit);
+void compassCalAddSample(CompassCalFit& fit, float mx, float my, float mz);
+
+// 0..100: how much of the rotation has been covered so far
+uint8_t compassCalProgress(const CompassCalFit& fit);
+
+// Solve the fit. Returns false (cal untouched) without enough coverage.
+bool compassCalSolve(const CompassCalFit& fit, CompassCal& cal);
+
+void compassCalIdentity(CompassCal& cal);
+void compassCalApply(const CompassCal& cal, float& mx, float& my, float& mz);
+
+// =============================================================================
+// HEADING
+// =============================================================================
+
+// Heading of the device +X axis in degrees [0, 360) from a calibrated field
+// vector and a gravity vector (any units, same axes as the magnetometer).
+// A null gravity vector (free fall) gives the untilted heading; the result
+// is always finite.
+float compassTiltHeading(float mx, float my, float mz, float ax, float ay, float az);
+
+struct CompassSmoother {
+  float s[COMPASS_SMOOTH_LEN];
+  float c[COMPASS_SMOOTH_LEN];
+  float sum_s;
+  float sum_c;
+  uint8_t idx;
+  uint8_t fill;
+};
+
+void compassSmoothReset(CompassSmoother& sm);
+
+// Push one heading, returns the circular mean in [0, 360)
+float compassSmoothAdd(CompassSmoother& sm, float heading_deg);
+
+// Mean resultant length 0..1 (1 = all samples agree)
+float compassSmoothStability(const CompassSmoother& sm);
+
+#endif // COMPASS_ENGINE_H
@@ -83,12 +83,6 @@
 #define BATTERY_LOW_THRESHOLD  20
 #define BATTERY_CRITICAL       10
 
-// =============================================================================
-// STEP DETECTION CONFIGURATION
-// =============================================================================
-#define MIN_STEP_THRESHOLD  1.2   // Minimum acceleration delta for step
-#define STEP_TIME_WINDOW    250   // Minimum ms between steps
-
 // =============================================================================
 // NAVIGATION CONFIGURATION - FIXED
 // =============================================================================
@@ -411,7 +405,9 @@ enum ScreenType {
     SCREEN_POMODORO,
     SCREEN_HABITS,
     SCREEN_DUNGEON,
-    SCREEN_SD_BACKUP
+    SCREEN_SD_BACKUP,
+    SCREEN_COMPASS,
+    SCREEN_NVS_INSPECTOR
 };
 
 // App Types
@@ -15,8 +15,10 @@
 #include "themes.h"
 #include "navigation.h"
 #include "steps_tracker.h"
+#include "persist.h"
 #include "gacha.h"
 #include "xp_system.h"  // FUSION OS: For getCurrentCharacterXP()
+#include "save_schema.h"
 #include <Preferences.h>
 
 extern Arduino_CO5300 *gfx;
@@ -299,7 +301,7 @@ void generateNewDailyQuests() {
     q.completed = false;
   }
 
-  saveDailyQuestsData();
+  persistMarkDirty(PERSIST_QUESTS);
 }
 
 void updateQuestProgress(QuestType type, uint32_t amount) {
@@ -312,7 +314,7 @@ void updateQuestProgress(QuestType type, uint32_t amount) {
         q.completed = true;
         Serial.printf("[Quests] Quest completed: %s\n", q.name);
       }
-      saveDailyQuestsData();
+      persistMarkDirty(PERSIST_QUESTS);
     }
   }
 }
@@ -338,7 +340,7 @@ void claimQuestReward(int questIndex) {
   q.reward_gems = 0;
 
   quest_data.total_completed++;
-  saveDailyQuestsData();
+  persistMarkDirty(PERSIST_QUESTS);
 
   drawDailyQuestsScreen();
 }
@@ -368,36 +370,37 @@ void checkDailyReset() {
     generateNewDailyQuests();
     quest_data.current_day = current_time.day;
     quest_data.last_reset = millis();
-    saveDailyQuestsData();
+    persistMarkDirty(PERSIST_QUESTS);
   }
 }
 
 void saveDailyQuestsData() {
-  questPrefs.begin("quests", false);
-  questPrefs.putUChar("day", quest_data.current_day);
-  questPrefs.putUInt("total", quest_data.total_completed);
-  questPrefs.putUInt("streak", quest_data.streak_days);
-
+  QuestBlob b = {};
+  b.day = quest_data.current_day;
+  b.total_completed = quest_data.total_completed;
+  b.streak_days = quest_data.streak_days;
   for (int i = 0; i < 3; i++) {
-    char key[20];
-    sprintf(key, "q%d_type", i);
-    questPrefs.putUChar(key, (uint8_t)quest_data.daily_quests[i].type);
-    sprintf(key, "q%d_prog", i);
-    questPrefs.putUInt(key, quest_data.daily_quests[i].progress);
-    sprintf(key, "q%d_comp", i);
-    questPrefs.putBool(key, quest_data.daily_quests[i].completed);
-    sprintf(key, "q%d_gold", i);
-    questPrefs.putUInt(key, quest_data.daily_quests[i].reward_gold);
+    b.quests[i].type = (uint8_t)quest_data.daily_quests[i].type;
+    b.quests[i].completed = quest_data.daily_quests[i].completed;
+    b.quests[i].progress = quest_data.daily_quests[i].progress;
+    b.quests[i].reward_gold = quest_data.daily_quests[i].reward_gold;
   }
+
+  questPrefs.begin("quests", false);
+  schemaPutBytes(questPrefs, QUEST_BLOB_KEY, SCHEMA_NS_QUESTS, &b, sizeof(b));
   questPrefs.end();
 }
 
 void loadDailyQuestsData() {
+  QuestBlob b = {};
   questPrefs.begin("quests", true);
-  quest_data.current_day = questPrefs.getUChar("day", 0);
-  quest_data.total_completed = questPrefs.getUInt("total", 0);
-  quest_data.streak_days = questPrefs.getUInt("streak", 0);
+  if (!schemaGetBytes(questPrefs, QUEST_BLOB_KEY, SCHEMA_NS_QUESTS, &b, sizeof(b))) {
+    memset(&b, 0, sizeof(b));
+  }
   questPrefs.end();
+  quest_data.current_day = b.day;
+  quest_data.total_completed = b.total_completed;
+  quest_data.streak_days = b.streak_days;
 
   WatchTime current_time = getCurrentTime();
   if (quest_data.current_day != current_time.day) {
@@ -406,6 +409,42 @@ void loadDailyQuestsData() {
   }
 }
 
+// The v1 keys, packed into QuestBlob. The blob lands before any key is
+// removed; a rerun after a reset in between only finishes the cleanup.
+bool questsKeysToBlob(Preferences& prefs) {
+  if (!prefs.isKey(QUEST_BLOB_KEY)) {
+    QuestBlob b = {};
+    b.day = prefs.getUChar("day", 0);
+    b.total_completed = prefs.getUInt("total", 0);
+    b.streak_days = prefs.getUInt("streak", 0);
+    for (int i = 0; i < 3; i++) {
+      char key[20];
+      sprintf(key, "q%d_type", i);
+      b.quests[i].type = prefs.getUChar(key, 0);
+      sprintf(key, "q%d_prog", i);
+      b.quests[i].progress = prefs.getUInt(key, 0);
+      sprintf(key, "q%d_comp", i);
+      b.quests[i].completed = prefs.getBool(key, false);
+      sprintf(key, "q%d_gold", i);
+      b.quests[i].reward_gold = prefs.getUInt(key, 0);
+    }
+    if (schemaPutBytes(prefs, QUEST_BLOB_KEY, SCHEMA_NS_QUESTS, &b, sizeof(b)) == 0) return false;
+  }
+
+  prefs.remove("day");
+  prefs.remove("total");
+  prefs.remove("streak");
+  for (int i = 0; i < 3; i++) {
+    static const char* fields[] = {"type", "prog", "comp", "gold"};
+    for (const char* f : fields) {
+      char key[20];
+      sprintf(key, "q%d_%s", i, f);
+      prefs.remove(key);
+    }
+  }
+  return true;
+}
+
 void handleDailyQuestsTouch(TouchGesture& gesture) {
   // Swipe up to exit
   if (gesture.event == TOUCH_SWIPE_UP) {
@@ -32,6 +32,25 @@ struct DailyQuestsData {
   unsigned long last_reset;
 };
 
+// "quests" namespace from schema v2: one blob instead of 15 keys
+#define QUEST_BLOB_KEY "d"
+
+#pragma pack(push, 1)
+struct QuestBlob {
+  uint8_t day;
+  uint32_t total_completed;
+  uint32_t streak_days;
+  struct {
+    uint8_t type;
+    uint8_t completed;
+    uint32_t progress;
+    uint32_t reward_gold;
+  } quests[3];
+};
+#pragma pack(pop)
+
+class Preferences;
+
 void initDailyQuests();
 void drawDailyQuestsScreen();
 void handleDailyQuestsTouch(TouchGesture& gesture);
@@ -42,4 +61,7 @@ void checkDailyReset();
 void saveDailyQuestsData();
 void loadDailyQuestsData();
 
+// Schema v1 -> v2 step (save_schema.cpp)
+bool questsKeysToBlob(Preferences& prefs);
+
 #endif
@@ -5,6 +5,7 @@
 
 #include "display.h"
 #include "config.h"
+#include "energy_monitor.h"
 
 lvgl_screen_t current_lvgl_screen = LVGL_SCREEN_WATCHFACE;
 lv_obj_t* screen_objects[LVGL_SCREEN_COUNT] = {nullptr};
@@ -39,6 +40,7 @@ void updateDisplay() {
 void setDisplayBrightness(int brightness) {
   brightness = constrain(brightness, 0, 255);
   gfx->setBrightness(brightness);
+  energyNoteBrightness(brightness);
   system_state.brightness = brightness;
 }
 
@@ -53,6 +55,7 @@ void enterDisplaySleep() {
 void wakeDisplay() {
   gfx->displayOn();
   gfx->setBrightness(system_state.brightness);
+  energyNoteBrightness(system_state.brightness);
 }
 
 // =============================================================================
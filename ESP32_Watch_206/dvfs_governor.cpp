@@ -0,0 +1,232 @@
+/*
+ * dvfs_governor.cpp - Frame-Budget CPU Frequency Governor Implementation
+ * FUSION OS Battery Optimization
+ */
+
+#include "dvfs_governor.h"
+#include "energy_monitor.h"
+#include <WiFi.h>
+#include <esp32-hal-cpu.h>
+
+extern bool screenOn;
+extern SystemState system_state;
+
+static const uint32_t levels[4] = {40, 80, 160, 240};
+
+static uint32_t current_mhz = 240;
+static uint32_t ceiling_mhz = 240;
+static unsigned long boost_until = 0;
+static bool boosting = false;
+
+static uint32_t window[DVFS_WINDOW];      // Cycles (us * MHz) per frame
+static uint8_t window_pos = 0;
+static uint16_t quiet_frames = 0;
+static unsigned long frame_start_us = 0;
+
+static int8_t hint_override[DVFS_SCREEN_SLOTS];
+
+static DvfsStats dvfs_stats = {0};
+
+// =============================================================================
+// LEVELS
+// =============================================================================
+
+static int levelIndex(uint32_t mhz) {
+  for (int i = 3; i >= 0; i--) {
+    if (mhz >= levels[i]) return i;
+  }
+  return 0;
+}
+
+// Lowest level >= mhz
+static uint32_t levelAtLeast(uint32_t mhz) {
+  for (int i = 0; i < 4; i++) {
+    if (levels[i] >= mhz) return levels[i];
+  }
+  return levels[3];
+}
+
+static void setFrequency(uint32_t mhz) {
+  if (mhz == current_mhz) return;
+  if (setCpuFrequencyMhz(mhz)) {
+    current_mhz = mhz;
+    dvfs_stats.switches++;
+  }
+}
+
+static uint32_t hintFloor(FrameHint hint) {
+  return hint == FRAME_HINT_GAME ? 160 : DVFS_SCREEN_ON_MIN_MHZ;
+}
+
+static uint32_t currentFloor() {
+  if (!screenOn) {
+    return WiFi.getMode() != WIFI_OFF ? DVFS_WIFI_MIN_MHZ : DVFS_SCREEN_OFF_MHZ;
+  }
+  uint32_t floor_mhz = hintFloor(dvfsScreenHint(system_state.current_screen));
+  if (WiFi.getMode() != WIFI_OFF) floor_mhz = max(floor_mhz, (uint32_t)DVFS_WIFI_MIN_MHZ);
+  return min(floor_mhz, ceiling_mhz);
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initDvfsGovernor() {
+  memset(hint_override, -1, sizeof(hint_override));
+  memset(window, 0, sizeof(window));
+  current_mhz = getCpuFrequencyMhz();
+  Serial.printf("[DVFS] Frame-budget governor, %lu MHz, target %d%% of frame\n",
+                (unsigned long)current_mhz, DVFS_TARGET_UTIL);
+}
+
+// =============================================================================
+// HINTS
+// =============================================================================
+
+FrameHint dvfsScreenHint(ScreenType screen) {
+  if (screen < DVFS_SCREEN_SLOTS && hint_override[screen] >= 0) {
+    return (FrameHint)hint_override[screen];
+  }
+  switch (screen) {
+    case SCREEN_GAMES:
+    case SCREEN_TRAINING:
+    case SCREEN_BOSS_RUSH:
+    case SCREEN_FUSION_GAME:
+    case SCREEN_CHARACTER_GAME:
+    case SCREEN_COMPANION_GAME:
+    case SCREEN_STORY_BOSS:
+    case SCREEN_DUNGEON:
+      return FRAME_HINT_GAME;
+    case SCREEN_WATCHFACE:
+    case SCREEN_TIMER:
+    case SCREEN_COMPASS:
+    case SCREEN_POMODORO:
+      return FRAME_HINT_ANIMATION;
+    default:
+      return FRAME_HINT_STATIC;
+  }
+}
+
+void dvfsSetScreenHint(ScreenType screen, FrameHint hint) {
+  if (screen < DVFS_SCREEN_SLOTS) hint_override[screen] = hint;
+}
+
+// =============================================================================
+// LIMITS
+// =============================================================================
+
+void dvfsSetCeiling(uint32_t mhz) {
+  ceiling_mhz = levelAtLeast(max(mhz, (uint32_t)DVFS_SCREEN_ON_MIN_MHZ));
+  if (current_mhz > ceiling_mhz) setFrequency(ceiling_mhz);
+}
+
+void dvfsBoost(uint32_t ms) {
+  if (!boosting) dvfs_stats.boosts++;
+  boost_until = millis() + ms;
+  boosting = true;
+  quiet_frames = 0;
+  setFrequency(ceiling_mhz);
+}
+
+void dvfsUpdateLimits() {
+  if (boosting && (long)(millis() - boost_until) >= 0) boosting = false;
+
+  if (!screenOn) {
+    boosting = false;
+    setFrequency(currentFloor());
+    return;
+  }
+
+  uint32_t floor_mhz = boosting ? ceiling_mhz : currentFloor();
+  if (current_mhz < floor_mhz) setFrequency(floor_mhz);
+  else if (current_mhz > ceiling_mhz) setFrequency(ceiling_mhz);
+}
+
+// =============================================================================
+// FRAME ACCOUNTING
+// =============================================================================
+
+void dvfsFrameBegin() {
+  frame_start_us = micros();
+}
+
+void dvfsFrameEnd(uint32_t frame_period_ms) {
+  uint32_t work_us = micros() - frame_start_us;
+  uint32_t mhz = current_mhz;
+  uint32_t period_us = max(frame_period_ms, (uint32_t)1) * 1000;
+
+  // Instrumentation
+  dvfs_stats.frames++;
+  dvfs_stats.frames_at[levelIndex(mhz)]++;
+  dvfs_stats.work_total_us += work_us;
+  if (work_us > dvfs_stats.work_max_us) dvfs_stats.work_max_us = work_us;
+  dvfs_stats.charge_uaus += (uint64_t)energyCpuRunUa(mhz) * work_us;
+  dvfs_stats.charge_fixed_uaus += (uint64_t)energyCpuRunUa(240) * work_us * mhz / 240;
+
+  uint32_t cycles = work_us * mhz;
+  window[window_pos] = cycles;
+  window_pos = (window_pos + 1) % DVFS_WINDOW;
+
+  if (work_us > period_us) {
+    // Deadline missed: straight to the ceiling
+    dvfs_stats.misses++;
+    quiet_frames = 0;
+    setFrequency(ceiling_mhz);
+    return;
+  }
+
+  uint32_t peak = 0;
+  for (int i = 0; i < DVFS_WINDOW; i++) peak = max(peak, window[i]);
+
+  // Lowest frequency that keeps the peak frame under the target utilisation
+  uint32_t needed = (uint32_t)((uint64_t)peak * 100 / ((uint64_t)period_us * DVFS_TARGET_UTIL)) + 1;
+  uint32_t floor_mhz = boosting ? ceiling_mhz : currentFloor();
+  uint32_t target = levelAtLeast(max(needed, floor_mhz));
+  if (target > ceiling_mhz) target = ceiling_mhz;
+
+  if (target > current_mhz) {
+    quiet_frames = 0;
+    setFrequency(target);
+  } else if (target < current_mhz) {
+    if (++quiet_frames >= DVFS_DOWN_FRAMES) {
+      quiet_frames = 0;
+      setFrequency(target);
+    }
+  } else {
+    quiet_frames = 0;
+  }
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+uint32_t dvfsCurrentMhz() {
+  return current_mhz;
+}
+
+const DvfsStats* getDvfsStats() {
+  return &dvfs_stats;
+}
+
+void resetDvfsStats() {
+  memset(&dvfs_stats, 0, sizeof(dvfs_stats));
+}
+
+void printDvfsStats() {
+  const DvfsStats& s = dvfs_stats;
+  uint32_t frames = s.frames ? s.frames : 1;
+  Serial.printf("[DVFS] %lu MHz (ceiling %lu, %s), hint %d\n",
+                (unsigned long)current_mhz, (unsigned long)ceiling_mhz,
+                boosting ? "boost" : "governed", dvfsScreenHint(system_state.current_screen));
+  Serial.printf("[DVFS] frames=%lu misses=%lu switches=%lu boosts=%lu work avg=%lu max=%lu us\n",
+                (unsigned long)s.frames, (unsigned long)s.misses, (unsigned long)s.switches,
+                (unsigned long)s.boosts, (unsigned long)(s.work_total_us / frames),
+                (unsigned long)s.work_max_us);
+  Serial.printf("[DVFS] frames at 40/80/160/240 MHz: %lu/%lu/%lu/%lu\n",
+                (unsigned long)s.frames_at[0], (unsigned long)s.frames_at[1],
+                (unsigned long)s.frames_at[2], (unsigned long)s.frames_at[3]);
+  Serial.printf("[DVFS] CPU charge/frame: %lu nC governed vs %lu nC at 240 MHz\n",
+                (unsigned long)(s.charge_uaus / 1000 / frames),
+                (unsigned long)(s.charge_fixed_uaus / 1000 / frames));
+}
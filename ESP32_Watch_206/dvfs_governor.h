@@ -0,0 +1,82 @@
+/*
+ * dvfs_governor.h - Frame-Budget CPU Frequency Governor
+ * FUSION OS Battery Optimization
+ *
+ * Replaces the idle-timer CPU steps. Every screen-on loop pass is a frame:
+ * its work time is measured and converted to cycles (work_us * MHz), and
+ * the governor picks the lowest frequency whose predicted frame time fits
+ * the frame period at DVFS_TARGET_UTIL, using the peak of the last
+ * DVFS_WINDOW frames. Going up is immediate; a deadline miss jumps to the
+ * ceiling. Going down needs DVFS_DOWN_FRAMES quiet frames in a row.
+ *
+ * Screens carry a hint (static / animation / game) that sets the floor,
+ * and touches give a short boost so a tap's redraw is not run at 80 MHz.
+ * With the screen on the floor stays at 80 MHz: below that the APB clock
+ * drops with the CPU and the display QSPI timing moves.
+ */
+
+#ifndef DVFS_GOVERNOR_H
+#define DVFS_GOVERNOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define DVFS_WINDOW             16      // Frames in the peak window
+#define DVFS_TARGET_UTIL        70      // % of the frame period work may use
+#define DVFS_DOWN_FRAMES        30      // Quiet frames before stepping down
+#define DVFS_TOUCH_BOOST_MS     250
+#define DVFS_SCREEN_ON_MIN_MHZ  80
+#define DVFS_SCREEN_OFF_MHZ     40
+#define DVFS_WIFI_MIN_MHZ       80      // The radio needs the PLL
+#define DVFS_SCREEN_SLOTS       64      // Hint override table size
+
+enum FrameHint : uint8_t {
+  FRAME_HINT_STATIC = 0,      // Redraws on input only
+  FRAME_HINT_ANIMATION,       // Periodic redraws (watchface, timer, compass)
+  FRAME_HINT_GAME             // Per-frame update + render
+};
+
+struct DvfsStats {
+  uint32_t frames;
+  uint32_t misses;            // Work exceeded the frame period
+  uint32_t switches;
+  uint32_t boosts;
+  uint32_t frames_at[4];      // 40 / 80 / 160 / 240 MHz
+  uint32_t work_max_us;
+  uint64_t work_total_us;
+  uint64_t charge_uaus;       // Modelled CPU charge spent on frame work
+  uint64_t charge_fixed_uaus; // Same cycles at a fixed 240 MHz
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void initDvfsGovernor();
+
+// Bracket the screen-on work of one loop pass
+void dvfsFrameBegin();
+void dvfsFrameEnd(uint32_t frame_period_ms);
+
+// Screen-off / Wi-Fi / power-saver changes re-evaluate the limits
+void dvfsUpdateLimits();
+
+// Touch / interaction: run at the ceiling for a moment
+void dvfsBoost(uint32_t ms = DVFS_TOUCH_BOOST_MS);
+
+// Power saver caps the governor
+void dvfsSetCeiling(uint32_t mhz);
+
+void dvfsSetScreenHint(ScreenType screen, FrameHint hint);
+FrameHint dvfsScreenHint(ScreenType screen);
+
+uint32_t dvfsCurrentMhz();
+
+const DvfsStats* getDvfsStats();
+void resetDvfsStats();
+void printDvfsStats();
+
+#endif // DVFS_GOVERNOR_H
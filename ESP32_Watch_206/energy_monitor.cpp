@@ -0,0 +1,222 @@
+/*
+ * energy_monitor.cpp - Power Residency & Energy Accounting Implementation
+ * FUSION OS Battery Optimization
+ */
+
+#include "energy_monitor.h"
+#include "config.h"
+#include "hardware.h"
+#include "imu_fifo.h"
+#include "loop_events.h"
+#include <WiFi.h>
+
+extern bool screenOn;
+
+static EnergyStats energy = {0};
+static unsigned long last_update_ms = 0;
+static uint32_t last_blocked_ms = 0;
+static unsigned long last_pmu_ms = 0;
+static int brightness_level = 255;
+
+static const char* const sub_names[ENERGY_SUB_COUNT] = {
+  "CPU", "Display", "WiFi", "Sensors", "Storage", "Base"
+};
+
+// =============================================================================
+// MODEL
+// =============================================================================
+
+static uint8_t freqBucket(uint32_t mhz) {
+  switch (mhz) {
+    case 240: return 0;
+    case 160: return 1;
+    case 80:  return 2;
+    case 40:  return 3;
+    default:  return 4;
+  }
+}
+
+uint32_t energyCpuRunUa(uint32_t mhz) {
+  if (mhz >= 240) return ENERGY_UA_CPU_240;
+  if (mhz >= 160) return ENERGY_UA_CPU_160;
+  if (mhz >= 80) return ENERGY_UA_CPU_80;
+  return ENERGY_UA_CPU_40;
+}
+
+static uint8_t brightBucket(int level) {
+  if (level <= 0) return 0;
+  return 1 + min(level, 255) / 64;
+}
+
+static void samplePmu() {
+  int pct = pmuBatteryPercent();
+  if (pct < 0) return;
+  bool charging = isCharging();
+  if (energy.pmu_start_pct < 0) energy.pmu_start_pct = pct;
+
+  if (!charging && energy.pmu_last_pct >= 0 && pct < energy.pmu_last_pct) {
+    energy.pmu_drop_pct += energy.pmu_last_pct - pct;
+  }
+  energy.pmu_last_pct = pct;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initEnergyMonitor() {
+  resetEnergyStats();
+  Serial.printf("[ENERGY] Accounting started, battery %d%%\n", energy.pmu_last_pct);
+}
+
+void resetEnergyStats() {
+  memset(&energy, 0, sizeof(energy));
+  energy.pmu_start_pct = -1;
+  energy.pmu_last_pct = -1;
+  last_update_ms = millis();
+  last_blocked_ms = getLoopEventStats()->blocked_ms;
+  last_pmu_ms = millis();
+  samplePmu();
+}
+
+// =============================================================================
+// HOOKS
+// =============================================================================
+
+void energyNoteBrightness(int level) {
+  brightness_level = constrain(level, 0, 255);
+}
+
+void energyNoteWrite(EnergyStore store, uint32_t count) {
+  if (store == ENERGY_STORE_SD) {
+    energy.sd_writes += count;
+    energy.charge_uams[ENERGY_SUB_STORAGE] += (uint64_t)ENERGY_UAMS_SD_WRITE * count;
+  } else {
+    energy.nvs_writes += count;
+    energy.charge_uams[ENERGY_SUB_STORAGE] += (uint64_t)ENERGY_UAMS_NVS_WRITE * count;
+  }
+}
+
+// =============================================================================
+// LOOP HOOK
+// =============================================================================
+
+void updateEnergyMonitor() {
+  unsigned long now = millis();
+  uint32_t dt = now - last_update_ms;
+  if (dt == 0) return;
+  last_update_ms = now;
+
+  // Blocked time since the last pass (the loop counter may have been reset)
+  uint32_t blocked_total = getLoopEventStats()->blocked_ms;
+  uint32_t blocked = blocked_total >= last_blocked_ms ? blocked_total - last_blocked_ms : blocked_total;
+  last_blocked_ms = blocked_total;
+  if (blocked > dt) blocked = dt;
+  uint32_t awake = dt - blocked;
+
+  PowerState state = screenOn ? power_manager.current_state : POWER_SCREEN_OFF;
+  uint32_t mhz = getCpuFrequencyMhz();
+  int level = screenOn ? brightness_level : 0;
+  bool wifi_on = WiFi.getMode() != WIFI_OFF;
+
+  // Residency
+  energy.elapsed_ms += dt;
+  if (state < ENERGY_POWER_STATES) energy.state_ms[state] += dt;
+  energy.freq_ms[freqBucket(mhz)] += dt;
+  energy.bright_ms[brightBucket(level)] += dt;
+  if (wifi_on) energy.wifi_ms += dt;
+  energy.awake_ms += awake;
+
+  // Charge. With the screen off the blocked time is spent in light sleep.
+  uint32_t run_ua = energyCpuRunUa(mhz);
+  uint64_t cpu = (uint64_t)run_ua * awake;
+  if (screenOn) {
+    cpu += (uint64_t)run_ua * ENERGY_WAIT_PERCENT / 100 * blocked;
+  } else {
+    cpu += (uint64_t)ENERGY_UA_LIGHT_SLEEP * blocked;
+    energy.light_sleep_ms += blocked;
+  }
+  energy.charge_uams[ENERGY_SUB_CPU] += cpu;
+  if (screenOn) {
+    energy.charge_uams[ENERGY_SUB_DISPLAY] +=
+      (uint64_t)(ENERGY_UA_DISPLAY_BASE + ENERGY_UA_DISPLAY_STEP * level) * dt;
+  }
+  if (wifi_on) energy.charge_uams[ENERGY_SUB_WIFI] += (uint64_t)ENERGY_UA_WIFI * dt;
+  if (isIMUFifoActive()) energy.charge_uams[ENERGY_SUB_SENSORS] += (uint64_t)ENERGY_UA_IMU * dt;
+  energy.charge_uams[ENERGY_SUB_BASE] += (uint64_t)ENERGY_UA_BASE * dt;
+
+  if (now - last_pmu_ms >= ENERGY_PMU_SAMPLE_MS) {
+    last_pmu_ms = now;
+    samplePmu();
+  }
+}
+
+// =============================================================================
+// RESULTS
+// =============================================================================
+
+float energySubsystemMah(EnergySubsystem sub) {
+  if (sub >= ENERGY_SUB_COUNT) return 0;
+  return energy.charge_uams[sub] / 3.6e9f;
+}
+
+float energyTotalMah() {
+  float total = 0;
+  for (int i = 0; i < ENERGY_SUB_COUNT; i++) total += energySubsystemMah((EnergySubsystem)i);
+  return total;
+}
+
+float energyAverageMa() {
+  if (energy.elapsed_ms == 0) return 0;
+  return energyTotalMah() * 3600000.0f / energy.elapsed_ms;
+}
+
+float energyProjectedHours() {
+  float ma = energyAverageMa();
+  return ma > 0 ? ENERGY_BATTERY_MAH / ma : 0;
+}
+
+const EnergyStats* getEnergyStats() {
+  return &energy;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+static float pct(uint32_t part, uint32_t whole) {
+  return whole ? part * 100.0f / whole : 0;
+}
+
+void printEnergyStats() {
+  const EnergyStats& e = energy;
+  Serial.printf("[ENERGY] %lu s accounted, est %.2f mAh, avg %.2f mA -> %.1f h on %d mAh\n",
+                (unsigned long)(e.elapsed_ms / 1000), energyTotalMah(), energyAverageMa(),
+                energyProjectedHours(), ENERGY_BATTERY_MAH);
+
+  Serial.printf("[ENERGY] state:");
+  for (int i = 0; i < ENERGY_POWER_STATES; i++) {
+    Serial.printf(" %s=%.1f%%", getPowerStateName((PowerState)i), pct(e.state_ms[i], e.elapsed_ms));
+  }
+  static const char* const freq_names[ENERGY_FREQ_BUCKETS] = {"240", "160", "80", "40", "other"};
+  Serial.printf("\n[ENERGY] cpu MHz:");
+  for (int i = 0; i < ENERGY_FREQ_BUCKETS; i++) {
+    Serial.printf(" %s=%.1f%%", freq_names[i], pct(e.freq_ms[i], e.elapsed_ms));
+  }
+  static const char* const bright_names[ENERGY_BRIGHT_BUCKETS] = {"off", "<64", "<128", "<192", "<256"};
+  Serial.printf("\n[ENERGY] brightness:");
+  for (int i = 0; i < ENERGY_BRIGHT_BUCKETS; i++) {
+    Serial.printf(" %s=%.1f%%", bright_names[i], pct(e.bright_ms[i], e.elapsed_ms));
+  }
+  Serial.printf("\n[ENERGY] awake=%.1f%% light_sleep=%.1f%% wifi=%lu s nvs_writes=%lu sd_writes=%lu\n",
+                pct(e.awake_ms, e.elapsed_ms), pct(e.light_sleep_ms, e.elapsed_ms),
+                (unsigned long)(e.wifi_ms / 1000), (unsigned long)e.nvs_writes, (unsigned long)e.sd_writes);
+
+  Serial.printf("[ENERGY] mAh:");
+  for (int i = 0; i < ENERGY_SUB_COUNT; i++) {
+    Serial.printf(" %s=%.2f", sub_names[i], energySubsystemMah((EnergySubsystem)i));
+  }
+  Serial.printf("\n[ENERGY] AXP2101 %d%% -> %d%%, discharged %d%% (~%.1f mAh)\n",
+                e.pmu_start_pct, e.pmu_last_pct, e.pmu_drop_pct,
+                e.pmu_drop_pct * ENERGY_BATTERY_MAH / 100.0f);
+}
@@ -0,0 +1,105 @@
+/*
+ * energy_monitor.h - Power Residency & Energy Accounting
+ * FUSION OS Battery Optimization
+ *
+ * Tracks where the time goes: per PowerState, CPU frequency, display
+ * brightness bucket, Wi-Fi on, light sleep vs awake, and NVS / SD writes.
+ * A configurable current model turns that into estimated mAh per
+ * subsystem, so the "2.5h -> 10h+" goal in power_manager.h can be checked
+ * against a number instead of a feeling.
+ *
+ * The AXP2101 has no coulomb counter on this board, so its fuel-gauge
+ * percentage is sampled alongside as a cross-check for the model.
+ */
+
+#ifndef ENERGY_MONITOR_H
+#define ENERGY_MONITOR_H
+
+#include <Arduino.h>
+#include "power_manager.h"
+
+// =============================================================================
+// CURRENT MODEL (uA, measured at the battery - tune per board)
+// =============================================================================
+#define ENERGY_UA_CPU_240       45000   // CPU running (awake, not waiting)
+#define ENERGY_UA_CPU_160       33000
+#define ENERGY_UA_CPU_80        22000
+#define ENERGY_UA_CPU_40        14000
+#define ENERGY_WAIT_PERCENT     60      // Awake but blocked (WFI) vs running
+#define ENERGY_UA_LIGHT_SLEEP   250
+#define ENERGY_UA_DISPLAY_BASE  6000    // Panel on at brightness 0
+#define ENERGY_UA_DISPLAY_STEP  150     // Per brightness level (0..255)
+#define ENERGY_UA_WIFI          75000   // Average with the radio on
+#define ENERGY_UA_IMU           550     // QMI8658 streaming the FIFO
+#define ENERGY_UA_BASE          350     // PMU, RTC, touch idle, leakage
+#define ENERGY_UAMS_NVS_WRITE   250000  // One NVS commit (~10 ms at +25 mA)
+#define ENERGY_UAMS_SD_WRITE    1200000 // One SD file write (~30 ms at +40 mA)
+
+#define ENERGY_BATTERY_MAH      300
+#define ENERGY_PMU_SAMPLE_MS    60000   // Fuel-gauge cross-check period
+
+// =============================================================================
+// BUCKETS
+// =============================================================================
+#define ENERGY_POWER_STATES     5       // PowerState values
+#define ENERGY_FREQ_BUCKETS     5       // 240 / 160 / 80 / 40 / other
+#define ENERGY_BRIGHT_BUCKETS   5       // off, 1-63, 64-127, 128-191, 192-255
+
+enum EnergySubsystem : uint8_t {
+  ENERGY_SUB_CPU = 0,
+  ENERGY_SUB_DISPLAY,
+  ENERGY_SUB_WIFI,
+  ENERGY_SUB_SENSORS,
+  ENERGY_SUB_STORAGE,
+  ENERGY_SUB_BASE,
+  ENERGY_SUB_COUNT
+};
+
+enum EnergyStore : uint8_t {
+  ENERGY_STORE_NVS = 0,
+  ENERGY_STORE_SD
+};
+
+struct EnergyStats {
+  uint32_t elapsed_ms;
+  uint32_t state_ms[ENERGY_POWER_STATES];
+  uint32_t freq_ms[ENERGY_FREQ_BUCKETS];
+  uint32_t bright_ms[ENERGY_BRIGHT_BUCKETS];
+  uint32_t wifi_ms;
+  uint32_t awake_ms;            // Loop running (not blocked)
+  uint32_t light_sleep_ms;
+  uint32_t nvs_writes;
+  uint32_t sd_writes;
+  uint64_t charge_uams[ENERGY_SUB_COUNT];   // uA * ms
+  // AXP2101 cross-check
+  int8_t pmu_start_pct;
+  int8_t pmu_last_pct;
+  uint16_t pmu_drop_pct;        // Summed discharge while not charging
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void initEnergyMonitor();
+
+// Loop hook - right after the loop wait, attributes the elapsed time
+void updateEnergyMonitor();
+
+// Hooks for what the monitor cannot observe itself
+void energyNoteBrightness(int level);
+void energyNoteWrite(EnergyStore store, uint32_t count = 1);
+
+// Modelled CPU current while running at `mhz`
+uint32_t energyCpuRunUa(uint32_t mhz);
+
+float energySubsystemMah(EnergySubsystem sub);
+float energyTotalMah();
+float energyAverageMa();
+float energyProjectedHours();     // Full battery at the average current
+
+const EnergyStats* getEnergyStats();
+void resetEnergyStats();
+void printEnergyStats();
+
+#endif // ENERGY_MONITOR_H
@@ -6,6 +6,7 @@
 #include "config.h"
 #include "display.h"
 #include "sd_manager.h"
+#include "kv_reader.h"
 #include <SD_MMC.h>
 #include <FS.h>
 
@@ -42,9 +43,11 @@ bool initializeFileSystem() {
     system_state.total_pdf_files = total_pdf_files;
     
     // Load saved game data from SD
+    // cards.dat is loaded (and its journal replayed) by initGachaSystem(),
+    // which setup() runs right after this mount
     loadPlayerDataFromSD();
-    loadGachaDataFromSD();
     loadBossDataFromSD();
+    printKvLoadStats();
     
     Serial.printf("[FS] SD card ready! MP3: %d, PDF: %d\n", total_music_files, total_pdf_files);
     return true;
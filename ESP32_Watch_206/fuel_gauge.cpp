@@ -0,0 +1,168 @@
+/*
+ * fuel_gauge.cpp - Battery Fuel Gauge & Low-Battery Policy Implementation
+ * FUSION OS Battery Optimization
+ */
+
+#include "fuel_gauge.h"
+#include "config.h"
+#include "hardware.h"
+#include "energy_monitor.h"
+#include <WiFi.h>
+
+extern bool screenOn;
+extern SystemState system_state;
+
+static FuelModel fuel;
+static unsigned long last_sample_ms = 0;
+static float last_total_mah = 0;
+static FuelPolicy policy = FUEL_POLICY_NORMAL;
+
+// =============================================================================
+// SAMPLING
+// =============================================================================
+
+static float loadSinceLastSample(uint32_t dt_ms) {
+  float total = energyTotalMah();
+  float delta = total - last_total_mah;
+  last_total_mah = total;
+  // The energy counters may have been reset (WIDGET_ENERGY_RESET)
+  if (delta < 0 || dt_ms == 0) return energyAverageMa();
+  return delta * 3600000.0f / dt_ms;
+}
+
+static void evaluatePolicy(const FuelSample& s) {
+  FuelPolicy old_policy = policy;
+  int soc = fuelGaugeSoc();
+  int32_t tte = fuel.count >= 5 ? fuelModelTimeToEmpty(fuel, FUEL_PROFILE_MIXED) : -1;
+
+  if (s.flags & FUEL_FLAG_CHARGING) {
+    policy = FUEL_POLICY_NORMAL;
+  } else {
+    // Entering uses the thresholds, leaving needs the hysteresis margin
+    int crit = FUEL_CRITICAL_PCT + (policy == FUEL_POLICY_CRITICAL ? FUEL_HYSTERESIS_PCT : 0);
+    int saver = FUEL_SAVER_PCT + (policy != FUEL_POLICY_NORMAL ? FUEL_HYSTERESIS_PCT : 0);
+    int32_t saver_tte = policy != FUEL_POLICY_NORMAL ? FUEL_SAVER_TTE_MIN * 5 / 4 : FUEL_SAVER_TTE_MIN;
+
+    if (soc <= crit) policy = FUEL_POLICY_CRITICAL;
+    else if (soc <= saver || (tte >= 0 && tte < saver_tte)) policy = FUEL_POLICY_SAVER;
+    else policy = FUEL_POLICY_NORMAL;
+  }
+
+  if (policy != old_policy) {
+    Serial.printf("[FUEL] Policy %s -> %s (%d%%, %ld min left)\n",
+                  fuelPolicyName(old_policy), fuelPolicyName(policy), soc, (long)tte);
+  }
+}
+
+static void takeSample() {
+  unsigned long now = millis();
+  uint32_t dt = now - last_sample_ms;
+  last_sample_ms = now;
+
+  bool charging = isCharging();
+  float load_ma = loadSinceLastSample(dt);
+
+  FuelSample s;
+  s.t_s = now / 1000;
+  s.mv = (uint16_t)getBatteryVoltage();
+  s.load_ma_x10 = (uint16_t)constrain((int)(load_ma * 10), 0, 65535);
+  s.pmu_pct = (int8_t)pmuBatteryPercent();
+  s.flags = (charging ? FUEL_FLAG_CHARGING : 0) |
+            (screenOn ? FUEL_FLAG_SCREEN_ON : 0) |
+            (WiFi.getMode() != WIFI_OFF ? FUEL_FLAG_WIFI : 0);
+
+  fuelModelAddSample(fuel, s);
+  system_state.battery_percentage = fuelGaugeSoc();
+  evaluatePolicy(s);
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initFuelGauge() {
+  fuelModelInit(fuel, ENERGY_BATTERY_MAH);
+  policy = FUEL_POLICY_NORMAL;
+  last_sample_ms = millis();
+  last_total_mah = energyTotalMah();
+  takeSample();
+  Serial.printf("[FUEL] Gauge started: %d%% (%u mV, PMU %d%%)\n",
+                fuelGaugeSoc(), fuel.ring[0].mv, fuel.ring[0].pmu_pct);
+}
+
+// =============================================================================
+// LOOP HOOK
+// =============================================================================
+
+void updateFuelGauge() {
+  if (millis() - last_sample_ms >= FUEL_SAMPLE_MS) takeSample();
+}
+
+uint32_t fuelGaugeMsUntilSample() {
+  uint32_t since = millis() - last_sample_ms;
+  return since >= FUEL_SAMPLE_MS ? 0 : FUEL_SAMPLE_MS - since;
+}
+
+// =============================================================================
+// RESULTS
+// =============================================================================
+
+bool fuelGaugeReady() {
+  return fuel.seeded;
+}
+
+int fuelGaugeSoc() {
+  return (int)(fuel.soc + 0.5f);
+}
+
+int32_t fuelGaugeTimeToEmpty(FuelProfile profile) {
+  return fuelModelTimeToEmpty(fuel, profile);
+}
+
+FuelPolicy fuelGaugePolicy() {
+  return policy;
+}
+
+const char* fuelPolicyName(FuelPolicy p) {
+  switch (p) {
+    case FUEL_POLICY_NORMAL:   return "NORMAL";
+    case FUEL_POLICY_SAVER:    return "SAVER";
+    case FUEL_POLICY_CRITICAL: return "CRITICAL";
+    default:                   return "UNKNOWN";
+  }
+}
+
+const FuelModel* getFuelModel() {
+  return &fuel;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+void printFuelStats() {
+  Serial.printf("[FUEL] SoC %.1f%% (ref %.1f%%), policy %s, %u samples, segment %u\n",
+                fuel.soc, fuel.ref_soc, fuelPolicyName(policy), fuel.count, fuel.segment_len);
+  Serial.printf("[FUEL] model scale %.2f, fitted drain %.2f %%/h, screen duty %.0f%%\n",
+                fuel.model_scale, fuel.slope_pct_h, fuel.screen_duty * 100);
+  for (int i = 0; i < FUEL_PROFILE_COUNT; i++) {
+    FuelProfile p = (FuelProfile)i;
+    int32_t tte = fuelModelTimeToEmpty(fuel, p);
+    if (tte < 0) {
+      Serial.printf("[FUEL] %-8s --\n", fuelProfileName(p));
+    } else {
+      Serial.printf("[FUEL] %-8s %6.2f mA -> %ldh%02ldm\n", fuelProfileName(p),
+                    fuelModelProfileMa(fuel, p), (long)(tte / 60), (long)(tte % 60));
+    }
+  }
+}
+
+void printFuelLog() {
+  Serial.printf("# fuel_log capacity_mah=%u samples=%u\n", fuel.capacity_mah, fuel.count);
+  Serial.println("t_s,mv,load_ma,pmu_pct,flags");
+  for (uint16_t i = 0; i < fuel.count; i++) {
+    const FuelSample& s = fuel.ring[(fuel.head + FUEL_RING_SIZE - fuel.count + i) % FUEL_RING_SIZE];
+    Serial.printf("%lu,%u,%.1f,%d,%u\n", (unsigned long)s.t_s, s.mv,
+                  s.load_ma_x10 / 10.0f, s.pmu_pct, s.flags);
+  }
+}
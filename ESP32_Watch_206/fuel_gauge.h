@@ -0,0 +1,57 @@
+/*
+ * fuel_gauge.h - Battery Fuel Gauge & Low-Battery Policy
+ * FUSION OS Battery Optimization
+ *
+ * Once a minute the battery voltage, the AXP2101 percentage, charge state
+ * and the load current from the energy model are fed to fuel_model.cpp.
+ * The resulting state of charge replaces the raw PMU percentage on screen,
+ * and the power manager asks for a policy: power saver below
+ * FUEL_SAVER_PCT (or when the mixed-use time-to-empty gets short),
+ * critical below FUEL_CRITICAL_PCT.
+ *
+ * WIDGET_FUEL_LOG dumps the sample ring as CSV so a discharge can be
+ * replayed through fuel_model.cpp on a host.
+ */
+
+#ifndef FUEL_GAUGE_H
+#define FUEL_GAUGE_H
+
+#include <Arduino.h>
+#include "fuel_model.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define FUEL_SAMPLE_MS          60000
+#define FUEL_SAVER_PCT          20      // Power saver at or below
+#define FUEL_CRITICAL_PCT       8       // Critical policy at or below
+#define FUEL_SAVER_TTE_MIN      90      // ...or when mixed use has < 90 min left
+#define FUEL_HYSTERESIS_PCT     3       // Margin before a policy is left
+
+enum FuelPolicy : uint8_t {
+  FUEL_POLICY_NORMAL = 0,
+  FUEL_POLICY_SAVER,
+  FUEL_POLICY_CRITICAL
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void initFuelGauge();
+
+// Loop hook - takes a sample when one is due
+void updateFuelGauge();
+uint32_t fuelGaugeMsUntilSample();
+
+bool fuelGaugeReady();
+int fuelGaugeSoc();                           // Rounded %
+int32_t fuelGaugeTimeToEmpty(FuelProfile profile);   // Minutes, -1 unknown
+FuelPolicy fuelGaugePolicy();
+const char* fuelPolicyName(FuelPolicy policy);
+
+const FuelModel* getFuelModel();
+void printFuelStats();
+void printFuelLog();      // CSV: # capacity header, then t_s,mv,load_ma,pmu_pct,flags
+
+#endif // FUEL_GAUGE_H
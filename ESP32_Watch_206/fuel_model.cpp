@@ -0,0 +1,188 @@
+/*
+ * fuel_model.cpp - Battery Fuel-Gauge Model Implementation
+ * FUSION OS Battery Optimization
+ */
+
+#include "fuel_model.h"
+#include <string.h>
+
+// Typical 1S Li-ion / LiPo rest curve (mV -> %)
+static const uint16_t ocv_mv[] = {3300, 3500, 3600, 3680, 3730, 3770, 3800, 3840, 3900, 3980, 4080, 4200};
+static const uint8_t ocv_pct[] = {   0,    5,   10,   20,   30,   40,   50,   60,   70,   80,   90,  100};
+#define OCV_POINTS (sizeof(ocv_mv) / sizeof(ocv_mv[0]))
+
+static float clampf(float v, float lo, float hi) {
+  return v < lo ? lo : v > hi ? hi : v;
+}
+
+float fuelOcvToSoc(float mv) {
+  if (mv <= ocv_mv[0]) return 0;
+  if (mv >= ocv_mv[OCV_POINTS - 1]) return 100;
+  for (size_t i = 1; i < OCV_POINTS; i++) {
+    if (mv < ocv_mv[i]) {
+      float f = (mv - ocv_mv[i - 1]) / (float)(ocv_mv[i] - ocv_mv[i - 1]);
+      return ocv_pct[i - 1] + f * (ocv_pct[i] - ocv_pct[i - 1]);
+    }
+  }
+  return 100;
+}
+
+// OCV under load (IR-compensated), blended with the PMU's own estimate
+static float referenceSoc(const FuelSample& s) {
+  float load_ma = s.load_ma_x10 / 10.0f;
+  float ocv = s.mv + load_ma * FUEL_R_INTERNAL_MOHM / 1000.0f;
+  float v_soc = fuelOcvToSoc(ocv);
+  if (s.pmu_pct < 0) return v_soc;
+  return (v_soc + s.pmu_pct) * 0.5f;
+}
+
+static const FuelSample& ringAt(const FuelModel& m, uint16_t back) {
+  // back = 0 is the newest sample
+  return m.ring[(m.head + FUEL_RING_SIZE - 1 - back) % FUEL_RING_SIZE];
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void fuelModelInit(FuelModel& m, uint16_t capacity_mah) {
+  memset(&m, 0, sizeof(FuelModel));
+  m.capacity_mah = capacity_mah;
+  m.model_scale = 1.0f;
+  m.slope_pct_h = 0;
+}
+
+// =============================================================================
+// DISCHARGE FIT
+// =============================================================================
+
+static void fitSegment(FuelModel& m) {
+  uint16_t n = m.segment_len < m.count ? m.segment_len : m.count;
+  if (n < 3) return;
+
+  const FuelSample& newest = ringAt(m, 0);
+  const FuelSample& oldest = ringAt(m, n - 1);
+  float span_h = (newest.t_s - oldest.t_s) / 3600.0f;
+  if (span_h * 60 < FUEL_FIT_MIN_MINUTES) return;
+
+  // Least squares y = a + b*x, x in hours from the oldest sample
+  double sx = 0, sy = 0, sxx = 0, sxy = 0, load = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    const FuelSample& s = ringAt(m, i);
+    double x = (s.t_s - oldest.t_s) / 3600.0;
+    double y = referenceSoc(s);
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+    load += s.load_ma_x10 / 10.0;
+  }
+  double den = n * sxx - sx * sx;
+  if (den <= 0) return;
+  double slope = (n * sxy - sx * sy) / den;
+
+  float drop = (float)(-slope * span_h);
+  if (drop < FUEL_FIT_MIN_DROP_PCT) return;
+  m.slope_pct_h = (float)-slope;
+
+  // Calibrate the energy model against the measured drain
+  float modelled_pct_h = (float)(load / n) * 100.0f / m.capacity_mah;
+  if (modelled_pct_h > 0) {
+    float measured = clampf(m.slope_pct_h / modelled_pct_h, FUEL_SCALE_MIN, FUEL_SCALE_MAX);
+    m.model_scale += 0.2f * (measured - m.model_scale);
+  }
+}
+
+// =============================================================================
+// SAMPLES
+// =============================================================================
+
+void fuelModelAddSample(FuelModel& m, const FuelSample& s) {
+  bool have_prev = m.count > 0;
+  FuelSample prev = have_prev ? ringAt(m, 0) : s;
+
+  m.ring[m.head] = s;
+  m.head = (m.head + 1) % FUEL_RING_SIZE;
+  if (m.count < FUEL_RING_SIZE) m.count++;
+
+  m.ref_soc = referenceSoc(s);
+  float load_ma = s.load_ma_x10 / 10.0f;
+
+  if (!m.seeded) {
+    m.soc = m.ref_soc;
+    m.seeded = true;
+  }
+
+  if (s.flags & FUEL_FLAG_CHARGING) {
+    // Terminal voltage is lifted by the charger - follow the PMU
+    if (s.pmu_pct >= 0) m.soc = s.pmu_pct;
+    m.segment_len = 0;
+    m.slope_pct_h = 0;
+    return;
+  }
+  m.segment_len++;
+
+  // Coulomb count over the interval, then pull toward the reference
+  if (have_prev && s.t_s > prev.t_s) {
+    float dt_h = (s.t_s - prev.t_s) / 3600.0f;
+    m.soc -= load_ma * m.model_scale * dt_h * 100.0f / m.capacity_mah;
+  }
+  m.soc += FUEL_REF_GAIN * (m.ref_soc - m.soc);
+  m.soc = clampf(m.soc, 0, 100);
+
+  // Per-profile modelled current
+  FuelProfile p = (s.flags & FUEL_FLAG_SCREEN_ON) ? FUEL_PROFILE_ACTIVE : FUEL_PROFILE_STANDBY;
+  if (m.profile_ma[p] <= 0) m.profile_ma[p] = load_ma;
+  else m.profile_ma[p] += FUEL_PROFILE_EMA * (load_ma - m.profile_ma[p]);
+
+  // Screen duty over the discharge samples in the ring (up to 4 h). An EMA
+  // as short as the profile one swings with the on/off pattern itself.
+  uint16_t on = 0, discharging = 0;
+  for (uint16_t i = 0; i < m.count; i++) {
+    uint8_t flags = ringAt(m, i).flags;
+    if (flags & FUEL_FLAG_CHARGING) continue;
+    discharging++;
+    if (flags & FUEL_FLAG_SCREEN_ON) on++;
+  }
+  m.screen_duty = discharging ? (float)on / discharging : 0;
+
+  fitSegment(m);
+}
+
+// =============================================================================
+// PREDICTION
+// =============================================================================
+
+float fuelModelProfileMa(const FuelModel& m, FuelProfile profile) {
+  switch (profile) {
+    case FUEL_PROFILE_TREND:
+      return m.slope_pct_h * m.capacity_mah / 100.0f;
+    case FUEL_PROFILE_STANDBY:
+    case FUEL_PROFILE_ACTIVE:
+      return m.profile_ma[profile] * m.model_scale;
+    case FUEL_PROFILE_MIXED:
+      return (m.screen_duty * m.profile_ma[FUEL_PROFILE_ACTIVE] +
+              (1 - m.screen_duty) * m.profile_ma[FUEL_PROFILE_STANDBY]) * m.model_scale;
+    default:
+      return 0;
+  }
+}
+
+int32_t fuelModelTimeToEmpty(const FuelModel& m, FuelProfile profile) {
+  if (!m.seeded) return -1;
+  float ma = fuelModelProfileMa(m, profile);
+  if (ma <= 0.01f) return -1;
+  float usable_pct = m.soc - FUEL_RESERVE_PCT;
+  if (usable_pct <= 0) return 0;
+  return (int32_t)(usable_pct * m.capacity_mah / 100.0f / ma * 60.0f);
+}
+
+const char* fuelProfileName(FuelProfile profile) {
+  switch (profile) {
+    case FUEL_PROFILE_TREND:   return "trend";
+    case FUEL_PROFILE_STANDBY: return "standby";
+    case FUEL_PROFILE_ACTIVE:  return "active";
+    case FUEL_PROFILE_MIXED:   return "mixed";
+    default:                   return "?";
+  }
+}
@@ -0,0 +1,92 @@
+/*
+ * fuel_model.h - Battery Fuel-Gauge Model
+ * FUSION OS Battery Optimization
+ *
+ * Pure math, no Arduino dependencies - fed one sample per minute by
+ * fuel_gauge.cpp on the watch, or by a recorded log (WIDGET_FUEL_LOG) on
+ * a host to check prediction accuracy.
+ *
+ * State of charge is coulomb-counted from the energy model's load current,
+ * and pulled slowly toward a reference made of the IR-compensated OCV
+ * curve and the AXP2101's own percentage. The discharge segment since the
+ * last charge is fitted with a least-squares line; its slope calibrates
+ * the energy model (actual / modelled current), and the calibrated
+ * per-profile currents give time-to-empty for each usage profile.
+ */
+
+#ifndef FUEL_MODEL_H
+#define FUEL_MODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define FUEL_RING_SIZE          240     // Samples kept (4 h at one per minute)
+#define FUEL_R_INTERNAL_MOHM    180     // Cell + path resistance for IR compensation
+#define FUEL_REF_GAIN           0.05f   // Per-sample pull toward the reference SoC
+#define FUEL_RESERVE_PCT        3       // PMU cut-off margin, not usable
+#define FUEL_FIT_MIN_MINUTES    30      // Segment length before the slope is trusted
+#define FUEL_FIT_MIN_DROP_PCT   2.0f
+#define FUEL_SCALE_MIN          0.5f    // Bounds on the model calibration
+#define FUEL_SCALE_MAX          2.0f
+#define FUEL_PROFILE_EMA        0.1f
+
+#define FUEL_FLAG_CHARGING      0x01
+#define FUEL_FLAG_SCREEN_ON     0x02
+#define FUEL_FLAG_WIFI          0x04
+
+enum FuelProfile : uint8_t {
+  FUEL_PROFILE_TREND = 0,     // Fitted slope of the current discharge
+  FUEL_PROFILE_STANDBY,       // Screen off
+  FUEL_PROFILE_ACTIVE,        // Screen on
+  FUEL_PROFILE_MIXED,         // Observed screen-on duty cycle
+  FUEL_PROFILE_COUNT
+};
+
+#pragma pack(push, 1)
+struct FuelSample {
+  uint32_t t_s;               // Monotonic seconds
+  uint16_t mv;                // Battery terminal voltage
+  uint16_t load_ma_x10;       // Modelled load current, 0.1 mA
+  int8_t pmu_pct;             // AXP2101 gauge (-1 unknown)
+  uint8_t flags;              // FUEL_FLAG_*
+};
+#pragma pack(pop)
+
+struct FuelModel {
+  uint16_t capacity_mah;
+  FuelSample ring[FUEL_RING_SIZE];
+  uint16_t head;
+  uint16_t count;
+  uint16_t segment_len;       // Samples since the last charging sample
+
+  bool seeded;
+  float soc;                  // % (0..100)
+  float ref_soc;              // Latest OCV / PMU reference
+  float model_scale;          // Actual / modelled current
+  float slope_pct_h;          // Fitted discharge rate (> 0 when draining)
+  float profile_ma[FUEL_PROFILE_COUNT];   // Modelled, before model_scale
+  float screen_duty;          // Fraction of samples with the screen on
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void fuelModelInit(FuelModel& m, uint16_t capacity_mah);
+void fuelModelAddSample(FuelModel& m, const FuelSample& s);
+
+// Open-circuit voltage -> SoC (%) on the Li-ion curve
+float fuelOcvToSoc(float mv);
+
+// Minutes to the reserve for a profile, -1 if unknown / not draining
+int32_t fuelModelTimeToEmpty(const FuelModel& m, FuelProfile profile);
+
+// Calibrated current for a profile (mA)
+float fuelModelProfileMa(const FuelModel& m, FuelProfile profile);
+
+const char* fuelProfileName(FuelProfile profile);
+
+#endif // FUEL_MODEL_H
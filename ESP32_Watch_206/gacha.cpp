@@ -15,6 +15,12 @@
 #include "navigation.h"
 #include "games.h"
 #include "xp_system.h" // FUSION OS: XP rewards
+#include "persist.h"
+#include "gacha_journal.h"
+#include "atomic_file.h"
+#include "save_schema.h"
+#include "sd_manager.h"
+#include "kv_reader.h"
 #include <SD_MMC.h>
 #include <Arduino.h>
 
@@ -103,10 +109,26 @@ const char* SERIES_CATCHPHRASES[10][10] = {
    "Hawks!", "Don't make me use it.", "Decay!", "Cremation!", "I love you!"}
 };
 
+// Journal sequence number the cards.dat checkpoint covers
+static uint32_t checkpoint_seq = 0;
+
 // =============================================================================
 // GACHA SYSTEM
 // =============================================================================
 
+// Boot replay of one journaled pull on top of the checkpoint
+static void applyJournalRecord(const GachaJournalRecord& r) {
+  if (r.type != GACHA_EVENT_PULL || r.card_id >= GACHA_TOTAL_CARDS) return;
+  if (!cards_owned[r.card_id]) {
+    cards_owned[r.card_id] = true;
+    system_state.gacha_cards_collected++;
+  } else {
+    cards_duplicates[r.card_id]++;
+  }
+  system_state.pity_counter = r.pity_epic;
+  system_state.pity_legendary_counter = r.pity_legendary;
+}
+
 void initGachaSystem() {
   Serial.println("[Gacha] Initializing gacha system...");
   initCardDatabase();
@@ -128,8 +150,13 @@ void initGachaSystem() {
       cards_duplicates[i] = 0;
       gacha_cards[i].evolution_level = 0;
     }
+    checkpoint_seq = 0;
   }
 
+  // Pulls since the last checkpoint; a torn tail or a long journal compacts now
+  gachaJournalReplay(checkpoint_seq, applyJournalRecord);
+  if (gachaJournalNeedsCompaction()) saveGachaProgress();
+
   Serial.printf("[Gacha] Init complete. Gems: %d\n", system_state.player_gems);
 }
 
@@ -201,13 +228,14 @@ void saveGachaProgress() {
     return;
   }
 
-  File dataFile = SD_MMC.open("/WATCH/gacha/cards.dat", FILE_WRITE);
+  File dataFile = atomicFileBegin(SD_MMC, SD_GACHA_DATA);
   if (!dataFile) {
     Serial.println("[Gacha] Cannot save progress");
     return;
   }
 
-  dataFile.printf("VERSION=2\n");
+  dataFile.printf("VERSION=%d\n", schemaVersion(SCHEMA_SD_CARDS));
+  dataFile.printf("JOURNAL_SEQ=%lu\n", (unsigned long)gachaJournalLastSeq());
   dataFile.printf("TOTAL_COLLECTED=%d\n", system_state.gacha_cards_collected);
   dataFile.printf("PITY_EPIC=%d\n", system_state.pity_counter);
   dataFile.printf("PITY_LEGEND=%d\n", system_state.pity_legendary_counter);
@@ -228,18 +256,59 @@ void saveGachaProgress() {
     }
   }
 
-  dataFile.close();
+  if (!atomicFileCommit(SD_MMC, SD_GACHA_DATA, dataFile)) {
+    // Journal stays: the previous checkpoint plus replay is still complete
+    Serial.println("[Gacha] Checkpoint failed, journal kept");
+    return;
+  }
+  // The checkpoint now covers every journaled pull
+  checkpoint_seq = gachaJournalLastSeq();
+  gachaJournalReset();
   Serial.println("[Gacha] Progress saved to SD card");
 }
 
+static void setCheckpointSeq(int32_t value, uint16_t index) {
+  (void)index;
+  checkpoint_seq = (uint32_t)value;
+}
+
+static void setDeckSize(int32_t value, uint16_t index) {
+  (void)index;
+  system_state.deck_size = min((int)value, MAX_DECK_SIZE);
+}
+
+static void setCardOwned(int32_t value, uint16_t index) {
+  cards_owned[index] = true;
+  cards_duplicates[index] = value;
+}
+
+static void setCardEvolution(int32_t value, uint16_t index) {
+  gacha_cards[index].evolution_level = value;
+  // Recalculate power with evolution multiplier
+  float mult = getEvolvePowerMult(value);
+  gacha_cards[index].power_rating = (int)(gacha_cards[index].power * mult);
+}
+
+static const KvField gacha_fields[] = {
+  {"JOURNAL_SEQ",     KV_FN,  NULL,                                 0,                 setCheckpointSeq},
+  {"TOTAL_COLLECTED", KV_INT, &system_state.gacha_cards_collected,  0,                 NULL},
+  {"PITY_EPIC",       KV_INT, &system_state.pity_counter,           0,                 NULL},
+  {"PITY_LEGEND",     KV_INT, &system_state.pity_legendary_counter, 0,                 NULL},
+  {"DECK_SIZE",       KV_FN,  NULL,                                 0,                 setDeckSize},
+  {"DECK_",           KV_INT, system_state.battle_deck,             MAX_DECK_SIZE,     NULL},
+  {"CARD_",           KV_FN,  NULL,                                 GACHA_TOTAL_CARDS, setCardOwned},
+  {"EVO_",            KV_FN,  NULL,                                 GACHA_TOTAL_CARDS, setCardEvolution},
+};
+static KvSchema gacha_schema = {"cards.dat", gacha_fields, KV_COUNT(gacha_fields)};
+
 bool loadGachaProgress() {
   extern bool sdCardInitialized;
   if (!sdCardInitialized) {
     return false;
   }
 
-  File dataFile = SD_MMC.open("/WATCH/gacha/cards.dat", FILE_READ);
-  if (!dataFile) {
+  atomicFileResolve(SD_MMC, SD_GACHA_DATA);
+  if (!SD_MMC.exists(SD_GACHA_DATA)) {
     Serial.println("[Gacha] No saved progress found");
     return false;
   }
@@ -254,74 +323,17 @@ bool loadGachaProgress() {
   system_state.pity_legendary_counter = 0;
   system_state.deck_size = 0;
   for (int i = 0; i < MAX_DECK_SIZE; i++) system_state.battle_deck[i] = -1;
+  checkpoint_seq = 0;   // Checkpoints older than the journal replay it all
 
-  while (dataFile.available()) {
-    String line = dataFile.readStringUntil('\n');
-    line.trim();
-
-    int eqPos = line.indexOf('=');
-    if (eqPos < 0) continue;
-
-    String key = line.substring(0, eqPos);
-    int value = line.substring(eqPos + 1).toInt();
-
-    if (key == "TOTAL_COLLECTED") {
-      system_state.gacha_cards_collected = value;
-    } else if (key == "PITY_EPIC") {
-      system_state.pity_counter = value;
-    } else if (key == "PITY_LEGEND") {
-      system_state.pity_legendary_counter = value;
-    } else if (key == "DECK_SIZE") {
-      system_state.deck_size = min(value, MAX_DECK_SIZE);
-    } else if (key.startsWith("DECK_")) {
-      int slot = key.substring(5).toInt();
-      if (slot >= 0 && slot < MAX_DECK_SIZE) {
-        system_state.battle_deck[slot] = value;
-      }
-    } else if (key.startsWith("EVO_")) {
-      int cardIndex = key.substring(4).toInt();
-      if (cardIndex >= 0 && cardIndex < GACHA_TOTAL_CARDS) {
-        gacha_cards[cardIndex].evolution_level = value;
-        // Recalculate power with evolution multiplier
-        float mult = getEvolvePowerMult(value);
-        gacha_cards[cardIndex].power_rating = (int)(gacha_cards[cardIndex].power * mult);
-      }
-    } else if (key.startsWith("CARD_")) {
-      int cardIndex = key.substring(5).toInt();
-      if (cardIndex >= 0 && cardIndex < GACHA_TOTAL_CARDS) {
-        cards_owned[cardIndex] = true;
-        cards_duplicates[cardIndex] = value;
-      }
-    }
+  if (!kvLoadFile(SD_MMC, SD_GACHA_DATA, &gacha_schema)) {
+    Serial.println("[Gacha] Cannot read saved progress");
+    return false;
   }
 
-  dataFile.close();
   Serial.printf("[Gacha] Progress loaded: %d cards collected\n", system_state.gacha_cards_collected);
   return true;
 }
 
-// Save a pulled card to collection
-void saveGachaCard(GachaCard& card) {
-  int cardId = card.id;
-
-  if (!cards_owned[cardId]) {
-    // New card!
-    cards_owned[cardId] = true;
-    cards_duplicates[cardId] = 1;
-    system_state.gacha_cards_collected++;
-    Serial.printf("[Gacha] NEW CARD: %s (%s) - %d/%d collected\n",
-                  card.character_name, card.series,
-                  system_state.gacha_cards_collected, GACHA_TOTAL_CARDS);
-  } else {
-    // Duplicate
-    cards_duplicates[cardId]++;
-    Serial.printf("[Gacha] Duplicate: %s (x%d)\n", card.character_name, cards_duplicates[cardId]);
-  }
-
-  // Auto-save to SD card
-  saveGachaProgress();
-}
-
 // =============================================================================
 // HELPER FUNCTIONS
 // =============================================================================
@@ -359,17 +371,15 @@ int getPlayerGems() {
 void addGems(int amount, const char* source) {
   system_state.player_gems += amount;
   Serial.printf("[Gacha] +%d gems from %s (Total: %d)\n", amount, source, system_state.player_gems);
-  // Persist gems to NVS immediately so they survive reboot
-  extern void saveAllGameData();
-  saveAllGameData();
+  // Persist gems (write-behind, bounded by PERSIST_MAX_AGE_MS)
+  persistMarkDirty(PERSIST_GAME);
 }
 
 bool spendGems(int amount) {
   if (system_state.player_gems >= amount) {
     system_state.player_gems -= amount;
-    // Persist gems to NVS immediately so they survive reboot
-    extern void saveAllGameData();
-    saveAllGameData();
+    // Write-behind, same as addGems()
+    persistMarkDirty(PERSIST_GAME);
     return true;
   }
   return false;
@@ -644,6 +654,11 @@ void applyPitySystem(GachaRarity& rarity) {
   }
 }
 
+// One journal record per pull; the caller commits the batch
+static void journalPull(int card_id, GachaRarity rarity, int16_t gem_delta) {
+  if (card_id >= 0) gachaJournalStage((uint8_t)card_id, (uint8_t)rarity, gem_delta);
+}
+
 GachaCard performSinglePull() {
   if (!spendGems(GACHA_SINGLE_PULL_COST)) {
     GachaCard empty;
@@ -671,7 +686,8 @@ GachaCard performSinglePull() {
         gainExperience(XP_GACHA_LEGENDARY, "Legendary Pull!");
       }
 
-      addCardToCollection(pulled);
+      journalPull(addCardToCollection(pulled), rarity, -GACHA_SINGLE_PULL_COST);
+      gachaJournalCommit();
       return pulled;
     }
     attempts++;
@@ -687,7 +703,8 @@ GachaCard performSinglePull() {
     gainExperience(XP_GACHA_LEGENDARY, "Legendary Pull!");
   }
 
-  addCardToCollection(pulled);
+  journalPull(addCardToCollection(pulled), rarity, -GACHA_SINGLE_PULL_COST);
+  gachaJournalCommit();
   return pulled;
 }
 
@@ -717,8 +734,10 @@ void performTenPull(GachaCard* results) {
     results[i] = gacha_cards[card_id];
     results[i].rarity = rarity;
 
-    addCardToCollection(results[i]);
+    journalPull(addCardToCollection(results[i]), rarity, i == 0 ? -GACHA_TEN_PULL_COST : 0);
   }
+  // All ten pulls in one append
+  gachaJournalCommit();
 
   // FUSION OS: Bonus XP for legendary pulls in 10-pull
   if (legendary_count > 0) {
@@ -747,7 +766,7 @@ bool ownsCard(int card_id) {
   return cards_owned[card_id];
 }
 
-void addCardToCollection(GachaCard& card) {
+int addCardToCollection(GachaCard& card) {
   // Find this card in the database
   for (int i = 0; i < GACHA_TOTAL_CARDS; i++) {
     if (gacha_cards[i].character_name == card.character_name &&
@@ -765,9 +784,10 @@ void addCardToCollection(GachaCard& card) {
       collection_needs_rebuild = true; // Force collection to refresh with new card
 
       checkCollectionRewards();
-      return;
+      return i;
     }
   }
+  return -1;
 }
 
 GachaCard* getCard(int card_id) {
@@ -2093,8 +2113,7 @@ void handleGachaTouch(TouchGesture& gesture) {
 
   // TAP TO CONTINUE - Handle result screen
   if (showing_gacha_result) {
-    // Save the card to collection
-    saveGachaCard(last_revealed_card);
+    // The pull already journaled the card
     showing_gacha_result = false;
     drawGachaScreen();
     return;
@@ -2117,10 +2136,6 @@ void handleGachaTouch(TouchGesture& gesture) {
     if (canPullTen()) {
       GachaCard results[10];
       performTenPull(results);
-      // Save all cards to collection
-      for (int i = 0; i < 10; i++) {
-        saveGachaCard(results[i]);
-      }
       // Show 10-card grid reveal
       drawTenPullGrid(results);
       last_revealed_card = results[9];
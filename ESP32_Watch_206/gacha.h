@@ -35,7 +35,7 @@ GachaRarity rollRarity();
 int getCardsOwned();
 int getTotalCards();
 bool ownsCard(int card_id);
-void addCardToCollection(GachaCard& card);
+int addCardToCollection(GachaCard& card);   // Card index, -1 if unknown
 GachaCard* getCard(int card_id);
 int getDuplicateCount(int card_id);
 
@@ -134,6 +134,5 @@ const char* getEvolutionName(int level);
 uint16_t getEvolutionColor(int level);
 
 // Helper function
-void saveGachaCard(GachaCard& card);
 
 #endif // GACHA_H
@@ -0,0 +1,159 @@
+/*
+ * gacha_journal.cpp - Append-Only Gacha Pull Journal Implementation
+ * FUSION OS System Layer
+ */
+
+#include "gacha_journal.h"
+#include "config.h"
+#include "sd_manager.h"
+#include "energy_monitor.h"
+#include "persist.h"
+#include <esp_rom_crc.h>
+
+extern SystemState system_state;
+
+static GachaJournalRecord staged[GACHA_JOURNAL_BATCH];
+static uint8_t staged_count = 0;
+static uint32_t last_seq = 0;
+static bool torn_tail = false;
+
+static GachaJournalStats journal_stats = {0};
+
+static uint32_t recordCrc(const GachaJournalRecord& r) {
+  return esp_rom_crc32_le(0, (const uint8_t*)&r, offsetof(GachaJournalRecord, crc));
+}
+
+// =============================================================================
+// REPLAY
+// =============================================================================
+
+uint16_t gachaJournalReplay(uint32_t checkpoint_seq, GachaJournalApply apply) {
+  last_seq = checkpoint_seq;
+  torn_tail = false;
+  journal_stats.pending = 0;
+  if (!sdCardInitialized) return 0;
+
+  File f = SD_MMC.open(SD_GACHA_JOURNAL, FILE_READ);
+  if (!f) return 0;
+
+  uint16_t applied = 0;
+  GachaJournalRecord r;
+  while (true) {
+    size_t got = f.read((uint8_t*)&r, sizeof(r));
+    if (got == 0) break;
+    if (got != sizeof(r) || r.sync != GACHA_JOURNAL_SYNC || r.crc != recordCrc(r)) {
+      torn_tail = true;
+      break;
+    }
+    journal_stats.pending++;
+    if (r.seq <= last_seq) {
+      // Written before the checkpoint that already holds it
+      journal_stats.skipped++;
+      continue;
+    }
+    apply(r);
+    last_seq = r.seq;
+    applied++;
+  }
+  f.close();
+
+  journal_stats.replayed += applied;
+  if (torn_tail) journal_stats.torn++;
+  Serial.printf("[GACHA_J] Replayed %u records (checkpoint seq %lu)%s\n", applied,
+                (unsigned long)checkpoint_seq, torn_tail ? ", torn tail dropped" : "");
+  return applied;
+}
+
+// =============================================================================
+// APPEND
+// =============================================================================
+
+void gachaJournalStage(uint8_t card_id, uint8_t rarity, int16_t gem_delta) {
+  if (staged_count >= GACHA_JOURNAL_BATCH) gachaJournalCommit();
+
+  GachaJournalRecord& r = staged[staged_count++];
+  r.sync = GACHA_JOURNAL_SYNC;
+  r.type = GACHA_EVENT_PULL;
+  r.card_id = card_id;
+  r.rarity = rarity;
+  r.pity_epic = (uint8_t)min(system_state.pity_counter, 255);
+  r.pity_legendary = (uint8_t)min(system_state.pity_legendary_counter, 255);
+  r.gem_delta = gem_delta;
+  r.seq = ++last_seq;
+  r.crc = recordCrc(r);
+}
+
+bool gachaJournalCommit() {
+  if (staged_count == 0) return true;
+  uint8_t count = staged_count;
+  staged_count = 0;
+  if (!sdCardInitialized) return false;
+
+  // Records after a damaged tail would never replay: until the checkpoint
+  // rewrite drops the journal, the pulls ride on the write-behind flush
+  if (torn_tail) {
+    persistMarkDirty(PERSIST_GACHA);
+    return false;
+  }
+
+  File f = SD_MMC.open(SD_GACHA_JOURNAL, FILE_APPEND);
+  if (!f) {
+    Serial.println("[GACHA_J] Cannot open journal");
+    persistMarkDirty(PERSIST_GACHA);
+    return false;
+  }
+  size_t len = count * sizeof(GachaJournalRecord);
+  size_t written = f.write((const uint8_t*)staged, len);
+  f.close();
+  energyNoteWrite(ENERGY_STORE_SD);
+
+  journal_stats.appends++;
+  journal_stats.records += count;
+  journal_stats.pending += count;
+  if (written != len) {
+    // Short append (card full, write error): the tail is now damaged
+    Serial.printf("[GACHA_J] Short append (%u of %u bytes)\n", (unsigned)written, (unsigned)len);
+    torn_tail = true;
+    journal_stats.torn++;
+  }
+  // Long or damaged journal: fold it into cards.dat at the next write-behind flush
+  if (gachaJournalNeedsCompaction()) persistMarkDirty(PERSIST_GACHA);
+  return written == len;
+}
+
+// =============================================================================
+// CHECKPOINT
+// =============================================================================
+
+uint32_t gachaJournalLastSeq() {
+  return last_seq;
+}
+
+bool gachaJournalNeedsCompaction() {
+  return torn_tail || journal_stats.pending >= GACHA_JOURNAL_COMPACT_RECORDS;
+}
+
+void gachaJournalReset() {
+  if (!sdCardInitialized) return;
+  if (SD_MMC.exists(SD_GACHA_JOURNAL)) SD_MMC.remove(SD_GACHA_JOURNAL);
+  torn_tail = false;
+  journal_stats.pending = 0;
+  journal_stats.compactions++;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const GachaJournalStats* getGachaJournalStats() {
+  return &journal_stats;
+}
+
+void printGachaJournalStats() {
+  const GachaJournalStats& s = journal_stats;
+  Serial.printf("[GACHA_J] appends=%lu records=%lu pending=%u seq=%lu compactions=%lu\n",
+                (unsigned long)s.appends, (unsigned long)s.records, s.pending,
+                (unsigned long)last_seq, (unsigned long)s.compactions);
+  Serial.printf("[GACHA_J] boot replay: applied=%lu skipped=%lu torn=%lu\n",
+                (unsigned long)s.replayed, (unsigned long)s.skipped, (unsigned long)s.torn);
+}
@@ -0,0 +1,87 @@
+/*
+ * gacha_journal.h - Append-Only Gacha Pull Journal
+ * FUSION OS System Layer
+ *
+ * SD_GACHA_DATA (cards.dat) is the checkpoint: the full collection,
+ * rewritten only when it is compacted. Every pull in between is one
+ * fixed-size, CRC-framed record appended to SD_GACHA_JOURNAL; a 10-pull is
+ * staged in RAM and lands as a single 160-byte append.
+ *
+ * Boot: load the checkpoint, then replay the journal records whose sequence
+ * number is newer than the checkpoint's JOURNAL_SEQ. Replay stops at the
+ * first short, unsynced or bad-CRC record - a write torn by power loss - and
+ * the collection is compacted right away so new appends never land after a
+ * damaged tail. A short append at run time (card full, write error) marks
+ * the tail damaged the same way: later pulls skip the journal and the
+ * write-behind flush checkpoints them instead. Compaction is also requested (through the write-behind
+ * cache) once the journal reaches GACHA_JOURNAL_COMPACT_RECORDS, which
+ * bounds replay time.
+ *
+ * gem_delta is an audit field: gems themselves live in NVS (PERSIST_GAME)
+ * and are not re-applied on replay.
+ */
+
+#ifndef GACHA_JOURNAL_H
+#define GACHA_JOURNAL_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define GACHA_JOURNAL_COMPACT_RECORDS  256     // 4 KB of journal
+#define GACHA_JOURNAL_BATCH            10      // Records staged per append
+#define GACHA_JOURNAL_SYNC             0xA7
+
+enum GachaJournalEvent : uint8_t {
+  GACHA_EVENT_PULL = 1
+};
+
+#pragma pack(push, 1)
+struct GachaJournalRecord {
+  uint8_t  sync;              // GACHA_JOURNAL_SYNC
+  uint8_t  type;              // GachaJournalEvent
+  uint8_t  card_id;
+  uint8_t  rarity;            // GachaRarity as rolled
+  uint8_t  pity_epic;         // Counters after this pull
+  uint8_t  pity_legendary;
+  int16_t  gem_delta;         // Pull cost on the first record of a batch
+  uint32_t seq;
+  uint32_t crc;
+};  // 16 bytes
+#pragma pack(pop)
+
+typedef void (*GachaJournalApply)(const GachaJournalRecord& rec);
+
+struct GachaJournalStats {
+  uint32_t appends;           // File writes
+  uint32_t records;           // Records written
+  uint32_t replayed;          // Applied at boot
+  uint32_t skipped;           // Already in the checkpoint
+  uint32_t torn;              // Damaged tails: found at boot or short appends
+  uint32_t compactions;
+  uint16_t pending;           // Records in the journal now
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Boot, after the SD card is mounted and the checkpoint loaded: applies
+// newer records in order
+uint16_t gachaJournalReplay(uint32_t checkpoint_seq, GachaJournalApply apply);
+
+// Stage one pull (current pity counters are captured), then append the batch
+void gachaJournalStage(uint8_t card_id, uint8_t rarity, int16_t gem_delta);
+bool gachaJournalCommit();
+
+// Checkpoint bookkeeping: the checkpoint stores gachaJournalLastSeq(), then
+// gachaJournalReset() drops the journal it now covers
+uint32_t gachaJournalLastSeq();
+bool gachaJournalNeedsCompaction();
+void gachaJournalReset();
+
+const GachaJournalStats* getGachaJournalStats();
+void printGachaJournalStats();
+
+#endif // GACHA_JOURNAL_H
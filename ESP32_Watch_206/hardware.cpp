@@ -5,6 +5,14 @@
 
 #include "hardware.h"
 #include "config.h"
+#include "i2c_bus.h"
+#include "imu_fifo.h"
+#include "reg_sequence.h"
+#include "steps_tracker.h"
+#include "wrist_wake.h"
+#include "time_service.h"
+#include "scheduler.h"
+#include "fuel_gauge.h"
 
 #define XPOWERS_CHIP_AXP2101
 #include "XPowersLib.h"
@@ -20,16 +28,18 @@ static StepData step_data = {0};
 static IMUData last_imu_data = {0};
 static bool imu_initialized = false;
 
-// RTC data
-static WatchTime current_time = {12, 0, 0, 1, 1, 2025, 0};
+// RTC data (wall-clock time is cached by time_service)
 static int timezone_offset = 0;
 
 // Timer/Stopwatch
 static unsigned long stopwatch_start = 0;
 static unsigned long stopwatch_elapsed = 0;
 static bool stopwatch_running = false;
-static int timer_remaining = 0;
-static bool timer_running = false;
+static uint32_t timer_paused_ms = 0;    // Remainder while paused (deadline lives in the scheduler)
+
+#define ALARM_SNOOZE_MS         (5 * 60 * 1000UL)
+
+static void initTimeEvents();
 
 // =============================================================================
 // POWER MANAGEMENT
@@ -38,35 +48,24 @@ static bool timer_running = false;
 void initializeHardware() {
   Serial.println("[HW] Initializing hardware...");
   
-  // Initialize I2C
-  Wire.begin(IIC_SDA, IIC_SCL);
-  Wire.setClock(400000);  // 400kHz fast mode
+  // Initialize I2C (shared bus manager - touch, IMU, RTC, PMU)
+  initI2CBus();
   
   // Initialize I/O Expander (XCA9554) - MUST be done FIRST to power peripherals
   // The Waveshare board uses an I/O expander to control power rails
   Serial.println("[HW] Initializing I/O Expander (XCA9554)...");
-  Wire.beginTransmission(EXPANDER_ADDR);
-  if (Wire.endTransmission() == 0) {
+  if (i2cProbe(EXPANDER_ADDR)) {
     Serial.println("[HW] XCA9554 found at 0x20");
     
     // Set pins 0, 1, 2 as outputs (config register 0x03, 0 = output)
-    Wire.beginTransmission(EXPANDER_ADDR);
-    Wire.write(0x03);  // Configuration register
-    Wire.write(0xF8);  // Pins 0,1,2 as output, rest input
-    Wire.endTransmission();
+    i2cWriteReg(EXPANDER_ADDR, 0x03, 0xF8);  // Pins 0,1,2 as output, rest input
     
     // Pull all LOW first (reset peripherals)
-    Wire.beginTransmission(EXPANDER_ADDR);
-    Wire.write(0x01);  // Output register
-    Wire.write(0x00);  // All low
-    Wire.endTransmission();
+    i2cWriteReg(EXPANDER_ADDR, 0x01, 0x00);  // Output register: all low
     delay(20);
     
     // Pull HIGH to power on peripherals (display, touch, PMU)
-    Wire.beginTransmission(EXPANDER_ADDR);
-    Wire.write(0x01);  // Output register
-    Wire.write(0x07);  // Pins 0,1,2 high
-    Wire.endTransmission();
+    i2cWriteReg(EXPANDER_ADDR, 0x01, 0x07);  // Output register: pins 0,1,2 high
     delay(50);  // Give peripherals time to power up
     
     Serial.println("[HW] I/O Expander configured - peripherals powered on");
@@ -88,6 +87,9 @@ void initializeHardware() {
   if (initializeRTC()) {
     Serial.println("[HW] RTC initialized");
   }
+  initTimeService();
+  initScheduler();
+  initTimeEvents();
   
   Serial.println("[HW] Hardware initialization complete");
 }
@@ -96,8 +98,35 @@ bool initializePower() {
   return initializeAXP2101();
 }
 
+// =============================================================================
+// AXP2101 POWER RAILS - ALDO1..BLDO2 voltage registers are contiguous, so the
+// six set-points go out as one burst; code = (mV - 500) / 100
+// =============================================================================
+#define AXP2101_REG_LDO_ONOFF0    0x90
+#define AXP2101_REG_ALDO1_VOL     0x92
+#define AXP2101_LDO_MV(mv)        (((mv) - 500) / 100)
+
+static const RegSeqEntry axp2101_rails[] = {
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 0, AXP2101_LDO_MV(1800), 0x1F),  // ALDO1
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 1, AXP2101_LDO_MV(2800), 0x1F),  // ALDO2
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 2, AXP2101_LDO_MV(3300), 0x1F),  // ALDO3
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 3, AXP2101_LDO_MV(3300), 0x1F),  // ALDO4
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 4, AXP2101_LDO_MV(1800), 0x1F),  // BLDO1
+  REG_WRITE_MASK(AXP2101_REG_ALDO1_VOL + 5, AXP2101_LDO_MV(3300), 0x1F),  // BLDO2
+  REG_SET_BITS(AXP2101_REG_LDO_ONOFF0, 0x3F),                             // ALDO1-4, BLDO1-2 on
+};
+
+static const RegSequence axp2101_rail_sequence =
+  REG_SEQ("AXP2101 rails", AXP2101_ADDR, axp2101_rails, true);
+
 bool initializeAXP2101() {
-  if (PMU.begin(Wire, AXP2101_ADDR, IIC_SDA, IIC_SCL)) {
+  // XPowersLib drives Wire itself - hold the bus for the whole sequence
+  if (!i2cBusLock()) {
+    Serial.println("[PMU] I2C bus busy, AXP2101 not initialized");
+    return false;
+  }
+  bool found = PMU.begin(Wire, AXP2101_ADDR, IIC_SDA, IIC_SCL);
+  if (found) {
     Serial.println("[PMU] AXP2101 initialized");
     PMU.disableIRQ(XPOWERS_AXP2101_ALL_IRQ);
     PMU.setChargeTargetVoltage(XPOWERS_AXP2101_CHG_VOL_4V2);
@@ -105,49 +134,89 @@ bool initializeAXP2101() {
     PMU.enableBattVoltageMeasure();
     
     // Enable display power rails
-    PMU.setALDO1Voltage(1800); PMU.enableALDO1();
-    PMU.setALDO2Voltage(2800); PMU.enableALDO2();
-    PMU.setALDO3Voltage(3300); PMU.enableALDO3();
-    PMU.setALDO4Voltage(3300); PMU.enableALDO4();
-    PMU.setBLDO1Voltage(1800); PMU.enableBLDO1();
-    PMU.setBLDO2Voltage(3300); PMU.enableBLDO2();
-    
-    return true;
+    runRegSequence(axp2101_rail_sequence);
   }
-  return false;
+  i2cBusUnlock();
+  return found;
 }
 
 BatteryInfo updateBatteryStatus() {
   BatteryInfo info = {0};
-  if (system_state.power_available && PMU.isBatteryConnect()) {
+  if (!system_state.power_available || !i2cBusLock()) return info;
+  if (PMU.isBatteryConnect()) {
     info.percentage = PMU.getBatteryPercent();
     info.voltage_mv = PMU.getBattVoltage();
     info.is_charging = PMU.isCharging();
     info.is_plugged = PMU.isVbusInsertOnSource();
   }
+  i2cBusUnlock();
   return info;
 }
 
+int pmuBatteryPercent() {
+  int percent = -1;
+  if (system_state.power_available && i2cBusLock()) {
+    if (PMU.isBatteryConnect()) percent = PMU.getBatteryPercent();
+    i2cBusUnlock();
+  }
+  return percent;
+}
+
+// Fuel-gauge SoC once it has a sample - no I2C on the draw path
 int getBatteryPercentage() {
-  if (system_state.power_available && PMU.isBatteryConnect())
-    return PMU.getBatteryPercent();
-  return 100;
+  if (fuelGaugeReady()) return fuelGaugeSoc();
+  int percent = pmuBatteryPercent();
+  return percent < 0 ? 100 : percent;
 }
 
 int getBatteryVoltage() {
-  if (system_state.power_available && PMU.isBatteryConnect())
-    return PMU.getBattVoltage();
-  return 4200;
+  int voltage = 4200;
+  if (system_state.power_available && i2cBusLock()) {
+    if (PMU.isBatteryConnect()) voltage = PMU.getBattVoltage();
+    i2cBusUnlock();
+  }
+  return voltage;
 }
 
 bool isCharging() {
-  if (system_state.power_available) return PMU.isCharging();
-  return false;
+  bool charging = false;
+  if (system_state.power_available && i2cBusLock()) {
+    charging = PMU.isCharging();
+    i2cBusUnlock();
+  }
+  return charging;
 }
 
 bool isPluggedIn() {
-  if (system_state.power_available) return PMU.isVbusInsertOnSource();
-  return false;
+  bool plugged = false;
+  if (system_state.power_available && i2cBusLock()) {
+    plugged = PMU.isVbusInsertOnSource();
+    i2cBusUnlock();
+  }
+  return plugged;
+}
+
+// Level 1 is 5-20 %, level 2 (the PMU's own power-off point) 0-15 %
+bool pmuEnableLowBatteryWarnings(uint8_t warn_pct, uint8_t shutdown_pct) {
+  if (!system_state.power_available || !i2cBusLock()) return false;
+  PMU.setLowBatWarnThreshold(warn_pct);
+  PMU.setLowBatShutdownThreshold(shutdown_pct);
+  PMU.clearIrqStatus();
+  PMU.enableIRQ(XPOWERS_AXP2101_WARNING_LEVEL1_IRQ | XPOWERS_AXP2101_WARNING_LEVEL2_IRQ);
+  i2cBusUnlock();
+  return true;
+}
+
+uint8_t pmuPollLowBattery() {
+  uint8_t flags = 0;
+  if (system_state.power_available && i2cBusLock()) {
+    PMU.getIrqStatus();
+    if (PMU.isDropWarningLevel1Irq()) flags |= PMU_LOWBAT_WARN;
+    if (PMU.isDropWarningLevel2Irq()) flags |= PMU_LOWBAT_SHUTDOWN;
+    if (flags) PMU.clearIrqStatus();
+    i2cBusUnlock();
+  }
+  return flags;
 }
 
 void setPowerState(PowerState state) {
@@ -203,10 +272,12 @@ bool initializeSensors() {
 bool initializeIMU() {
   Serial.println("[IMU] Initializing QMI8658...");
   
-  Wire.beginTransmission(QMI8658_ADDR);
-  if (Wire.endTransmission() == 0) {
+  if (i2cProbe(QMI8658_ADDR)) {
     Serial.println("[IMU] QMI8658 detected");
     imu_initialized = true;
+    
+    // Batched sampling: the IMU fills its FIFO, the loop drains it in bursts
+    initIMUFifo();
     return true;
   }
   Serial.println("[IMU] QMI8658 not found");
@@ -219,28 +290,33 @@ IMUData readIMU() {
   
   if (!imu_initialized) return data;
   
-  // Read accelerometer data from QMI8658
-  Wire.beginTransmission(QMI8658_ADDR);
-  Wire.write(0x35);  // Accelerometer data register
-  if (Wire.endTransmission(false) != 0) return data;
+  int16_t ax, ay, az, gx, gy, gz;
+  ImuSample latest;
   
-  Wire.requestFrom((uint8_t)QMI8658_ADDR, (uint8_t)12);
-  if (Wire.available() >= 12) {
-    int16_t ax = Wire.read() | (Wire.read() << 8);
-    int16_t ay = Wire.read() | (Wire.read() << 8);
-    int16_t az = Wire.read() | (Wire.read() << 8);
-    int16_t gx = Wire.read() | (Wire.read() << 8);
-    int16_t gy = Wire.read() | (Wire.read() << 8);
-    int16_t gz = Wire.read() | (Wire.read() << 8);
+  if (isIMUFifoActive() && imuRingLatest(latest)) {
+    // FIFO running: newest drained sample, no extra bus traffic
+    ax = latest.ax; ay = latest.ay; az = latest.az;
+    gx = latest.gx; gy = latest.gy; gz = latest.gz;
+  } else {
+    // Read accelerometer + gyro data from QMI8658 (one 12-byte burst)
+    uint8_t raw[12];
+    if (!i2cReadRegs(QMI8658_ADDR, QMI8658_AX_L, raw, sizeof(raw))) return data;
     
-    data.accel_x = ax / 16384.0;
-    data.accel_y = ay / 16384.0;
-    data.accel_z = az / 16384.0;
-    data.gyro_x = gx / 131.0;
-    data.gyro_y = gy / 131.0;
-    data.gyro_z = gz / 131.0;
+    ax = raw[0] | (raw[1] << 8);
+    ay = raw[2] | (raw[3] << 8);
+    az = raw[4] | (raw[5] << 8);
+    gx = raw[6] | (raw[7] << 8);
+    gy = raw[8] | (raw[9] << 8);
+    gz = raw[10] | (raw[11] << 8);
   }
   
+  data.accel_x = ax / (float)IMU_ACCEL_LSB_PER_G;
+  data.accel_y = ay / (float)IMU_ACCEL_LSB_PER_G;
+  data.accel_z = az / (float)IMU_ACCEL_LSB_PER_G;
+  data.gyro_x = gx / (float)IMU_GYRO_LSB_PER_DPS;
+  data.gyro_y = gy / (float)IMU_GYRO_LSB_PER_DPS;
+  data.gyro_z = gz / (float)IMU_GYRO_LSB_PER_DPS;
+  
   last_imu_data = data;
   return data;
 }
@@ -250,40 +326,24 @@ void calibrateIMU() {
   // Collect samples for calibration
 }
 
+// Register-read path into the step engine (the FIFO path is updateStepCount)
 void updateStepCounter() {
   IMUData imu = readIMU();
-  if (detectStep(imu)) {
-    step_data.daily_steps++;
-    system_state.steps_today = step_data.daily_steps;
-  }
-}
-
-bool detectStep(IMUData& imu) {
-  static float last_magnitude = 1.0;
-  static unsigned long last_step_time = 0;
-  
-  float magnitude = sqrt(imu.accel_x*imu.accel_x + imu.accel_y*imu.accel_y + imu.accel_z*imu.accel_z);
-  float delta = abs(magnitude - last_magnitude);
-  last_magnitude = magnitude;
-  
-  if (delta > MIN_STEP_THRESHOLD && millis() - last_step_time > STEP_TIME_WINDOW) {
-    last_step_time = millis();
-    step_data.last_step_time = last_step_time;
-    return true;
-  }
-  return false;
+  processAccelerometerData(imu.accel_x, imu.accel_y, imu.accel_z);
 }
 
 void resetDailySteps() {
-  step_data.daily_steps = 0;
-  system_state.steps_today = 0;
+  resetStepsToday();
 }
 
 int getDailySteps() {
-  return step_data.daily_steps;
+  return system_state.steps_today;
 }
 
 bool isMoving() {
+  ActivityLabel label = getActivityLabel();
+  if (label != ACTIVITY_UNKNOWN) return label != ACTIVITY_IDLE;
+  
   float magnitude = sqrt(last_imu_data.accel_x*last_imu_data.accel_x + 
                          last_imu_data.accel_y*last_imu_data.accel_y + 
                          last_imu_data.accel_z*last_imu_data.accel_z);
@@ -291,17 +351,19 @@ bool isMoving() {
 }
 
 bool isRunning() {
-  return isMoving() && millis() - step_data.last_step_time < 300;
+  return getActivityLabel() == ACTIVITY_RUN;
 }
 
 String getCurrentActivity() {
+  ActivityLabel label = getActivityLabel();
+  if (label != ACTIVITY_UNKNOWN) return activityLabelName(label);
   if (isRunning()) return "Running";
   if (isMoving()) return "Walking";
   return "Idle";
 }
 
 bool detectWristRaise() {
-  return last_imu_data.accel_z < -0.5 && last_imu_data.accel_y > 0.5;
+  return isWristViewingPose(last_imu_data.accel_x, last_imu_data.accel_y, last_imu_data.accel_z);
 }
 
 bool detectWristFlick() {
@@ -317,6 +379,7 @@ void processSensorData() {
 }
 
 void updateActivityMetrics() {
+  step_data.daily_steps = system_state.steps_today;
   step_data.distance_km = step_data.daily_steps * 0.0008;  // ~0.8m per step
   step_data.calories_burned = step_data.daily_steps * 0.04;  // ~0.04 cal per step
 }
@@ -337,8 +400,7 @@ uint8_t decToBcd(uint8_t dec);
 bool initializeRTC() {
   Serial.println("[RTC] Initializing PCF85063...");
   
-  Wire.beginTransmission(RTC_ADDR);
-  if (Wire.endTransmission() == 0) {
+  if (i2cProbe(RTC_ADDR)) {
     Serial.println("[RTC] PCF85063 detected");
     return true;
   }
@@ -346,23 +408,23 @@ bool initializeRTC() {
   return false;
 }
 
+bool rtcReadTime(WatchTime& out) {
+  // Read from PCF85063 (seconds..years, one 7-byte burst)
+  uint8_t raw[7];
+  if (!i2cReadRegs(RTC_ADDR, 0x04, raw, sizeof(raw))) return false;
+  out.second = bcdToDec(raw[0] & 0x7F);
+  out.minute = bcdToDec(raw[1] & 0x7F);
+  out.hour = bcdToDec(raw[2] & 0x3F);
+  out.day = bcdToDec(raw[3] & 0x3F);
+  out.weekday = raw[4] & 0x07;
+  out.month = bcdToDec(raw[5] & 0x1F);
+  out.year = 2000 + bcdToDec(raw[6]);
+  return true;
+}
+
 WatchTime getCurrentTime() {
-  // Read from PCF85063
-  Wire.beginTransmission(RTC_ADDR);
-  Wire.write(0x04);  // Seconds register
-  if (Wire.endTransmission(false) == 0) {
-    Wire.requestFrom((uint8_t)RTC_ADDR, (uint8_t)7);
-    if (Wire.available() >= 7) {
-      current_time.second = bcdToDec(Wire.read() & 0x7F);
-      current_time.minute = bcdToDec(Wire.read() & 0x7F);
-      current_time.hour = bcdToDec(Wire.read() & 0x3F);
-      current_time.day = bcdToDec(Wire.read() & 0x3F);
-      current_time.weekday = Wire.read() & 0x07;
-      current_time.month = bcdToDec(Wire.read() & 0x1F);
-      current_time.year = 2000 + bcdToDec(Wire.read());
-    }
-  }
-  return current_time;
+  // Served from RAM - the RTC is only read by the time service resync
+  return timeServiceNow();
 }
 
 uint8_t bcdToDec(uint8_t bcd) {
@@ -376,25 +438,25 @@ uint8_t decToBcd(uint8_t dec) {
 void setCurrentTime(WatchTime& time) {
   // Try up to 3 times to write to RTC
   for (int attempt = 0; attempt < 3; attempt++) {
-    Wire.beginTransmission(RTC_ADDR);
-    Wire.write(0x04);  // Start at seconds register
-    Wire.write(decToBcd(time.second));
-    Wire.write(decToBcd(time.minute));
-    Wire.write(decToBcd(time.hour));
-    Wire.write(decToBcd(time.day));
-    Wire.write(time.weekday);
-    Wire.write(decToBcd(time.month));
-    Wire.write(decToBcd(time.year - 2000));
-    
-    uint8_t result = Wire.endTransmission();
+    uint8_t raw[7] = {
+      decToBcd(time.second),
+      decToBcd(time.minute),
+      decToBcd(time.hour),
+      decToBcd(time.day),
+      (uint8_t)time.weekday,
+      decToBcd(time.month),
+      decToBcd(time.year - 2000)
+    };
+    bool result = i2cWriteRegs(RTC_ADDR, 0x04, raw, sizeof(raw));  // Start at seconds register
     
-    if (result == 0) {
+    if (result) {
       // Write successful, verify by reading back
       delay(10);  // Give RTC time to process
-      WatchTime verify = getCurrentTime();
+      WatchTime verify = {0};
+      rtcReadTime(verify);
       
       if (verify.hour == time.hour && verify.minute == time.minute) {
-        current_time = time;
+        timeServiceSet(time);
         Serial.printf("[RTC] Time set successfully: %02d:%02d:%02d\n", 
                       time.hour, time.minute, time.second);
         return;
@@ -403,7 +465,9 @@ void setCurrentTime(WatchTime& time) {
                       attempt + 1, time.hour, time.minute, verify.hour, verify.minute);
       }
     } else {
-      Serial.printf("[RTC] I2C write failed (attempt %d), error code: %d\n", attempt + 1, result);
+      const I2CDeviceStats* rtc_stats = getI2CDeviceStats(RTC_ADDR);
+      Serial.printf("[RTC] I2C write failed (attempt %d), error code: %d\n", attempt + 1,
+                    rtc_stats ? rtc_stats->last_error : -1);
     }
     
     delay(50);  // Wait before retry
@@ -411,7 +475,7 @@ void setCurrentTime(WatchTime& time) {
   
   Serial.println("[RTC] ERROR: Failed to set time after 3 attempts!");
   // Still update local time even if RTC write failed
-  current_time = time;
+  timeServiceSet(time);
 }
 
 void syncTimeWithWiFi() {
@@ -455,11 +519,29 @@ int getTimezone() {
 }
 
 void setAlarm(int id, int hour, int minute, bool enabled) {
-  // Store alarm configuration
+  if (enabled) {
+    schedulerAdd(SCHED_ALARM, id, schedulerNextDaily(hour, minute), 86400, "Alarm");
+  } else {
+    schedulerCancel(SCHED_ALARM, id);
+    schedulerCancel(SCHED_SNOOZE, id);
+  }
+}
+
+static void onAlarmEvent(const SchedEvent& ev, uint32_t late_ms) {
+  (void)late_ms;
+  triggerAlarm(ev.id);
+}
+
+static void onTimerEvent(const SchedEvent& ev, uint32_t late_ms) {
+  (void)ev;
+  (void)late_ms;
+  timer_paused_ms = 0;
+  Serial.println("[RTC] Timer finished!");
 }
 
 void checkAlarms() {
-  // Check if any alarm should trigger
+  // Alarms are deadlines in the scheduler heap
+  updateScheduler();
 }
 
 void triggerAlarm(int id) {
@@ -467,33 +549,44 @@ void triggerAlarm(int id) {
 }
 
 void snoozeAlarm(int id) {
-  // Snooze for 5 minutes
+  schedulerAddIn(SCHED_SNOOZE, id, ALARM_SNOOZE_MS, "Snooze");
 }
 
 void dismissAlarm(int id) {
-  // Dismiss alarm
+  schedulerCancel(SCHED_SNOOZE, id);
 }
 
 void startTimer(int minutes, String label) {
-  timer_remaining = minutes * 60;
-  timer_running = true;
+  timer_paused_ms = 0;
+  schedulerAddIn(SCHED_TIMER, 0, minutes * 60000UL, label.length() ? label.c_str() : "Timer");
 }
 
 void stopTimer() {
-  timer_running = false;
-  timer_remaining = 0;
+  timer_paused_ms = 0;
+  schedulerCancel(SCHED_TIMER, 0);
 }
 
 void pauseTimer() {
-  timer_running = false;
+  if (!schedulerFind(SCHED_TIMER, 0)) return;
+  timer_paused_ms = schedulerRemainingMs(SCHED_TIMER, 0);
+  schedulerCancel(SCHED_TIMER, 0);
 }
 
 void resumeTimer() {
-  timer_running = true;
+  if (timer_paused_ms == 0) return;
+  schedulerAddIn(SCHED_TIMER, 0, timer_paused_ms, "Timer");
+  timer_paused_ms = 0;
 }
 
 int getTimerRemaining() {
-  return timer_remaining;
+  uint32_t ms = schedulerFind(SCHED_TIMER, 0) ? schedulerRemainingMs(SCHED_TIMER, 0) : timer_paused_ms;
+  return (ms + 999) / 1000;
+}
+
+static void initTimeEvents() {
+  schedulerSetHandler(SCHED_ALARM, onAlarmEvent);
+  schedulerSetHandler(SCHED_SNOOZE, onAlarmEvent);
+  schedulerSetHandler(SCHED_TIMER, onTimerEvent);
 }
 
 void startStopwatch() {
@@ -527,17 +620,10 @@ unsigned long getStopwatchTime() {
   return stopwatch_elapsed;
 }
 
+bool isStopwatchRunning() {
+  return stopwatch_running;
+}
+
 void checkTimeBasedEvents() {
   checkAlarms();
-  if (timer_running && timer_remaining > 0) {
-    static unsigned long last_tick = 0;
-    if (millis() - last_tick >= 1000) {
-      timer_remaining--;
-      last_tick = millis();
-      if (timer_remaining == 0) {
-        timer_running = false;
-        Serial.println("[RTC] Timer finished!");
-      }
-    }
-  }
 }
@@ -25,10 +25,18 @@ bool initializePower();
 bool initializeAXP2101();
 BatteryInfo updateBatteryStatus();
 int getBatteryPercentage();
+int pmuBatteryPercent();        // Raw AXP2101 gauge, -1 if unavailable
 int getBatteryVoltage();
 bool isCharging();
 bool isPluggedIn();
 
+// AXP2101 low-battery warnings. The PMU IRQ line is not wired to a GPIO on
+// this board, so the status register is polled (and cleared) instead.
+#define PMU_LOWBAT_WARN         0x01    // Gauge at the level-1 threshold
+#define PMU_LOWBAT_SHUTDOWN     0x02    // Level 2: the PMU powers off next
+bool pmuEnableLowBatteryWarnings(uint8_t warn_pct, uint8_t shutdown_pct);
+uint8_t pmuPollLowBattery();
+
 void setPowerState(PowerState state);
 PowerState getCurrentPowerState();
 void enterSleepMode();
@@ -51,7 +59,6 @@ IMUData readIMU();
 void calibrateIMU();
 
 void updateStepCounter();
-bool detectStep(IMUData& imu);
 void resetDailySteps();
 int getDailySteps();
 
@@ -71,6 +78,7 @@ void updateSensors();
 // =============================================================================
 
 bool initializeRTC();
+bool rtcReadTime(WatchTime& out);     // Direct I2C read - use getCurrentTime()
 WatchTime getCurrentTime();
 void setCurrentTime(WatchTime& time);
 void syncTimeWithWiFi();
@@ -101,6 +109,7 @@ void pauseStopwatch();
 void resumeStopwatch();
 void resetStopwatch();
 unsigned long getStopwatchTime();
+bool isStopwatchRunning();
 
 void checkTimeBasedEvents();
 
@@ -0,0 +1,308 @@
+/*
+ * i2c_bus.cpp - Shared I2C Bus Manager Implementation
+ * FUSION OS Hardware Layer
+ */
+
+#include "i2c_bus.h"
+#include "config.h"
+#include <Wire.h>
+
+static SemaphoreHandle_t bus_mutex = NULL;
+static I2CBusStats bus_stats = {0};
+static unsigned long last_bus_clear = 0;
+
+// =============================================================================
+// DEVICE TABLE
+// =============================================================================
+
+static I2CDeviceStats* findDevice(uint8_t addr) {
+  for (int i = 0; i < bus_stats.device_count; i++) {
+    if (bus_stats.devices[i].addr == addr) return &bus_stats.devices[i];
+  }
+  if (bus_stats.device_count >= I2C_BUS_MAX_DEVICES) {
+    return &bus_stats.devices[I2C_BUS_MAX_DEVICES - 1];  // Overflow bucket
+  }
+  I2CDeviceStats* dev = &bus_stats.devices[bus_stats.device_count++];
+  memset(dev, 0, sizeof(I2CDeviceStats));
+  dev->addr = addr;
+  dev->name = "?";
+  return dev;
+}
+
+void i2cRegisterDevice(uint8_t addr, const char* name) {
+  if (!i2cBusLock()) return;
+  findDevice(addr)->name = name;
+  i2cBusUnlock();
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+bool initI2CBus() {
+  if (bus_mutex == NULL) {
+    bus_mutex = xSemaphoreCreateRecursiveMutex();
+  }
+
+  Wire.begin(IIC_SDA, IIC_SCL);
+  Wire.setClock(I2C_BUS_CLOCK_HZ);
+
+  i2cRegisterDevice(EXPANDER_ADDR, "XCA9554");
+  i2cRegisterDevice(AXP2101_ADDR, "AXP2101");
+  i2cRegisterDevice(FT3168_ADDR, "FT3168");
+  i2cRegisterDevice(RTC_ADDR, "PCF85063");
+  i2cRegisterDevice(QMI8658_ADDR, "QMI8658");
+  i2cRegisterDevice(ES8311_ADDR, "ES8311");
+
+  Serial.printf("[I2C] Bus manager ready (SDA=%d SCL=%d, %d kHz)\n",
+                IIC_SDA, IIC_SCL, I2C_BUS_CLOCK_HZ / 1000);
+  return bus_mutex != NULL;
+}
+
+// =============================================================================
+// LOCKING
+// =============================================================================
+
+bool i2cBusLock(uint32_t timeout_ms) {
+  if (bus_mutex == NULL) return true;  // Before init: single-threaded boot
+
+  unsigned long start = micros();
+  if (xSemaphoreTakeRecursive(bus_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    bus_stats.lock_timeouts++;
+    return false;
+  }
+  uint32_t waited = micros() - start;
+  if (waited > bus_stats.lock_wait_max_us) bus_stats.lock_wait_max_us = waited;
+  return true;
+}
+
+void i2cBusUnlock() {
+  if (bus_mutex != NULL) xSemaphoreGiveRecursive(bus_mutex);
+}
+
+// =============================================================================
+// BUS CLEAR - Release a slave holding SDA low mid-byte
+// =============================================================================
+
+static void clearBus(bool force) {
+  unsigned long now = millis();
+  if (!force && last_bus_clear != 0 && now - last_bus_clear < I2C_BUS_CLEAR_COOLDOWN_MS) {
+    return;
+  }
+  last_bus_clear = now;
+
+  Wire.end();
+
+  pinMode(IIC_SDA, INPUT_PULLUP);
+  pinMode(IIC_SCL, OUTPUT_OPEN_DRAIN);
+  digitalWrite(IIC_SCL, HIGH);
+
+  // Up to 9 clocks lets the slave finish whatever byte it thinks it is sending
+  for (int i = 0; i < 9 && digitalRead(IIC_SDA) == LOW; i++) {
+    digitalWrite(IIC_SCL, LOW);
+    delayMicroseconds(5);
+    digitalWrite(IIC_SCL, HIGH);
+    delayMicroseconds(5);
+  }
+
+  // Manual STOP condition: SDA low -> high while SCL is high
+  pinMode(IIC_SDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(IIC_SDA, LOW);
+  delayMicroseconds(5);
+  digitalWrite(IIC_SCL, HIGH);
+  delayMicroseconds(5);
+  digitalWrite(IIC_SDA, HIGH);
+  delayMicroseconds(5);
+
+  Wire.begin(IIC_SDA, IIC_SCL);
+  Wire.setClock(I2C_BUS_CLOCK_HZ);
+
+  bus_stats.bus_clears++;
+  Serial.printf("[I2C] Bus clear #%lu\n", (unsigned long)bus_stats.bus_clears);
+}
+
+bool i2cBusRecover() {
+  if (!i2cBusLock()) return false;
+  clearBus(true);
+  i2cBusUnlock();
+  return true;
+}
+
+// =============================================================================
+// SINGLE ATTEMPTS
+// =============================================================================
+
+static uint8_t attemptWrite(uint8_t addr, int reg, const uint8_t* data, size_t len) {
+  Wire.beginTransmission(addr);
+  if (reg >= 0) Wire.write((uint8_t)reg);
+  if (len > 0) Wire.write(data, len);
+  return Wire.endTransmission();
+}
+
+static uint8_t attemptRead(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len) {
+  Wire.beginTransmission(addr);
+  Wire.write(reg);
+  uint8_t err = Wire.endTransmission(false);  // Repeated start
+  if (err != I2C_ERR_OK) return err;
+
+  size_t got = Wire.requestFrom(addr, len);
+  if (got < len) {
+    while (Wire.available()) Wire.read();
+    return I2C_ERR_SHORT_READ;
+  }
+  for (size_t i = 0; i < len; i++) buf[i] = Wire.read();
+  return I2C_ERR_OK;
+}
+
+// =============================================================================
+// TRANSACTION WITH RETRY
+// =============================================================================
+
+static bool transfer(uint8_t addr, int reg, uint8_t* buf, size_t len, bool is_read) {
+  // The stats table is only touched under the lock; a lock timeout is
+  // counted in bus_stats.lock_timeouts alone
+  if (!i2cBusLock()) return false;
+
+  I2CDeviceStats* dev = findDevice(addr);
+  dev->transactions++;
+  uint8_t err = I2C_ERR_OK;
+
+  for (int attempt = 0; attempt <= I2C_BUS_MAX_RETRIES; attempt++) {
+    if (attempt > 0) {
+      dev->retries++;
+      // First retry is immediate; before the last one, clock the bus free
+      if (attempt == I2C_BUS_MAX_RETRIES) clearBus(false);
+    }
+
+    err = is_read ? attemptRead(addr, (uint8_t)reg, buf, len)
+                  : attemptWrite(addr, reg, buf, len);
+    if (err == I2C_ERR_OK) break;
+
+    if (err == I2C_ERR_NACK_ADDR || err == I2C_ERR_NACK_DATA) {
+      dev->nacks++;
+    } else if (err == I2C_ERR_TIMEOUT || err == I2C_ERR_SHORT_READ) {
+      dev->timeouts++;
+    }
+  }
+
+  if (err == I2C_ERR_OK) {
+    if (is_read) dev->bytes_read += len;
+    else dev->bytes_written += len + (reg >= 0 ? 1 : 0);
+  } else {
+    dev->errors++;
+    dev->last_error = err;
+    dev->last_error_ms = millis();
+  }
+
+  i2cBusUnlock();
+  return err == I2C_ERR_OK;
+}
+
+// =============================================================================
+// PUBLIC REGISTER ACCESS
+// =============================================================================
+
+bool i2cProbe(uint8_t addr) {
+  if (!i2cBusLock()) return false;
+  Wire.beginTransmission(addr);
+  bool found = (Wire.endTransmission() == I2C_ERR_OK);
+  i2cBusUnlock();
+  return found;
+}
+
+bool i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value) {
+  return transfer(addr, reg, &value, 1, false);
+}
+
+bool i2cWriteRegs(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len) {
+  if (!i2cBusLock()) return false;
+  bool ok = true;
+  for (size_t off = 0; ok && off < len; off += I2C_BUS_MAX_CHUNK) {
+    size_t n = min((size_t)I2C_BUS_MAX_CHUNK, len - off);
+    ok = transfer(addr, reg + off, (uint8_t*)data + off, n, false);
+  }
+  i2cBusUnlock();
+  return ok;
+}
+
+bool i2cReadReg(uint8_t addr, uint8_t reg, uint8_t* value) {
+  return transfer(addr, reg, value, 1, true);
+}
+
+bool i2cReadRegs(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len) {
+  if (!i2cBusLock()) return false;
+  bool ok = true;
+  for (size_t off = 0; ok && off < len; off += I2C_BUS_MAX_CHUNK) {
+    size_t n = min((size_t)I2C_BUS_MAX_CHUNK, len - off);
+    ok = transfer(addr, reg + off, buf + off, n, true);
+  }
+  i2cBusUnlock();
+  return ok;
+}
+
+bool i2cReadStream(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len) {
+  if (!i2cBusLock()) return false;
+  bool ok = true;
+  for (size_t off = 0; ok && off < len; off += I2C_BUS_MAX_CHUNK) {
+    size_t n = min((size_t)I2C_BUS_MAX_CHUNK, len - off);
+    ok = transfer(addr, reg, buf + off, n, true);
+  }
+  i2cBusUnlock();
+  return ok;
+}
+
+bool i2cWriteBytes(uint8_t addr, const uint8_t* data, size_t len) {
+  return transfer(addr, -1, (uint8_t*)data, len, false);
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const I2CBusStats* getI2CBusStats() {
+  return &bus_stats;
+}
+
+const I2CDeviceStats* getI2CDeviceStats(uint8_t addr) {
+  for (int i = 0; i < bus_stats.device_count; i++) {
+    if (bus_stats.devices[i].addr == addr) return &bus_stats.devices[i];
+  }
+  return NULL;
+}
+
+void resetI2CBusStats() {
+  if (!i2cBusLock()) return;
+  bus_stats.bus_clears = 0;
+  bus_stats.lock_timeouts = 0;
+  bus_stats.lock_wait_max_us = 0;
+  for (int i = 0; i < bus_stats.device_count; i++) {
+    I2CDeviceStats* dev = &bus_stats.devices[i];
+    uint8_t addr = dev->addr;
+    const char* name = dev->name;
+    memset(dev, 0, sizeof(I2CDeviceStats));
+    dev->addr = addr;
+    dev->name = name;
+  }
+  i2cBusUnlock();
+}
+
+void printI2CBusStats() {
+  Serial.println("[I2C] ===== Bus Statistics =====");
+  Serial.printf("[I2C] Bus clears: %lu | Lock timeouts: %lu | Max lock wait: %lu us\n",
+                (unsigned long)bus_stats.bus_clears,
+                (unsigned long)bus_stats.lock_timeouts,
+                (unsigned long)bus_stats.lock_wait_max_us);
+  for (int i = 0; i < bus_stats.device_count; i++) {
+    const I2CDeviceStats* dev = &bus_stats.devices[i];
+    Serial.printf("[I2C] 0x%02X %-8s tx=%lu rd=%luB wr=%luB err=%lu nack=%lu tmo=%lu retry=%lu last=%d\n",
+                  dev->addr, dev->name,
+                  (unsigned long)dev->transactions,
+                  (unsigned long)dev->bytes_read,
+                  (unsigned long)dev->bytes_written,
+                  (unsigned long)dev->errors,
+                  (unsigned long)dev->nacks,
+                  (unsigned long)dev->timeouts,
+                  (unsigned long)dev->retries,
+                  dev->last_error);
+  }
+}
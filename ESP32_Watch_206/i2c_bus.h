@@ -0,0 +1,105 @@
+/*
+ * i2c_bus.h - Shared I2C Bus Manager
+ * FUSION OS Hardware Layer
+ *
+ * One owner for the shared `Wire` bus:
+ *   FT3168 touch (0x38), QMI8658 IMU (0x6B), PCF85063 RTC (0x51),
+ *   AXP2101 PMU (0x34), XCA9554 expander (0x20)
+ *
+ * Features:
+ * - Recursive mutex: transactions from any task are serialized, callers can
+ *   hold the bus across multi-step sequences (i2cBusLock / i2cBusUnlock)
+ * - Burst register read/write helpers (auto-chunked to the Wire buffer)
+ * - Retry with SCL bus-clear on NACK / timeout
+ * - Per-device transaction, byte and error counters
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// BUS CONFIGURATION
+// =============================================================================
+#define I2C_BUS_CLOCK_HZ          400000  // 400kHz fast mode
+#define I2C_BUS_LOCK_TIMEOUT_MS   50      // Max wait for another task's transaction
+#define I2C_BUS_MAX_RETRIES       2       // Extra attempts after the first failure
+#define I2C_BUS_CLEAR_COOLDOWN_MS 250     // Min gap between two bus-clear cycles
+#define I2C_BUS_MAX_CHUNK         120     // Bytes per Wire transfer (buffer is 128)
+#define I2C_BUS_MAX_DEVICES       8
+
+// Wire.endTransmission() result codes (Arduino-ESP32)
+#define I2C_ERR_OK                0
+#define I2C_ERR_DATA_TOO_LONG     1
+#define I2C_ERR_NACK_ADDR         2
+#define I2C_ERR_NACK_DATA         3
+#define I2C_ERR_OTHER             4
+#define I2C_ERR_TIMEOUT           5
+#define I2C_ERR_SHORT_READ        6       // Bus manager: fewer bytes than requested
+#define I2C_ERR_LOCK_TIMEOUT      7       // Bus manager: mutex not acquired
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+struct I2CDeviceStats {
+  uint8_t addr;
+  const char* name;
+  uint32_t transactions;
+  uint32_t bytes_read;
+  uint32_t bytes_written;
+  uint32_t errors;           // Transactions that failed after all retries
+  uint32_t nacks;            // NACK results (per attempt)
+  uint32_t timeouts;         // Timeout / short read results (per attempt)
+  uint32_t retries;
+  uint8_t last_error;
+  unsigned long last_error_ms;
+};
+
+struct I2CBusStats {
+  uint32_t bus_clears;
+  uint32_t lock_timeouts;
+  uint32_t lock_wait_max_us;
+  uint8_t device_count;
+  I2CDeviceStats devices[I2C_BUS_MAX_DEVICES];
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Start Wire, create the bus mutex and register the known devices
+bool initI2CBus();
+
+// Hold the bus across several transactions (recursive - safe to nest)
+bool i2cBusLock(uint32_t timeout_ms = I2C_BUS_LOCK_TIMEOUT_MS);
+void i2cBusUnlock();
+
+// Name a device for the stats dump (unknown addresses are auto-registered)
+void i2cRegisterDevice(uint8_t addr, const char* name);
+
+// Address-only probe (no retries, no bus clear - absent devices are normal)
+bool i2cProbe(uint8_t addr);
+
+// Register access - all return true on success
+bool i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value);
+bool i2cWriteRegs(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len);
+bool i2cReadReg(uint8_t addr, uint8_t reg, uint8_t* value);
+bool i2cReadRegs(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len);
+
+// FIFO-style read: every chunk re-addresses the same (non-incrementing) register
+bool i2cReadStream(uint8_t addr, uint8_t reg, uint8_t* buf, size_t len);
+
+// Raw write with no register byte (e.g. I/O expander command pairs)
+bool i2cWriteBytes(uint8_t addr, const uint8_t* data, size_t len);
+
+// Clock out a stuck slave (9 SCL pulses + STOP) and restart Wire
+bool i2cBusRecover();
+
+// Diagnostics
+const I2CBusStats* getI2CBusStats();
+const I2CDeviceStats* getI2CDeviceStats(uint8_t addr);
+void resetI2CBusStats();
+void printI2CBusStats();
+
+#endif // I2C_BUS_H
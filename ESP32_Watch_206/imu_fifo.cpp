@@ -0,0 +1,371 @@
+/*
+ * imu_fifo.cpp - QMI8658 FIFO Batching Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "imu_fifo.h"
+#include "config.h"
+#include "i2c_bus.h"
+#include "reg_sequence.h"
+#include "loop_events.h"
+
+// Hardware FIFO state
+static bool fifo_active = false;
+static bool fifo_with_gyro = true;
+static uint16_t fifo_odr_hz = IMU_FIFO_ODR_HZ;
+static uint8_t fifo_ctrl_value = 0;
+static unsigned long last_status_poll = 0;
+static uint32_t status_poll_ms = IMU_FIFO_POLL_MS;
+static volatile bool watermark_flag = false;
+
+// Drain buffer: one full hardware FIFO of 6-axis sample sets
+static uint8_t drain_buf[IMU_FIFO_HW_DEPTH * 12];
+
+// Sample ring (sequence numbered, readers keep their own cursor)
+static ImuSample ring[IMU_FIFO_RING_SIZE];
+static volatile uint32_t ring_head = 0;
+static portMUX_TYPE ring_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static ImuFifoStats fifo_stats = {0};
+
+// =============================================================================
+// INTERRUPT
+// =============================================================================
+
+void IRAM_ATTR imuFifoISR() {
+  watermark_flag = true;
+  loopEventFromISR(LOOP_EVT_IMU);
+}
+
+// =============================================================================
+// CTRL9 COMMAND HANDSHAKE
+// =============================================================================
+
+bool qmi8658Command(uint8_t cmd, uint32_t timeout_ms) {
+  if (!i2cBusLock()) return false;
+
+  bool done = false;
+  if (i2cWriteReg(QMI8658_ADDR, QMI8658_CTRL9, cmd)) {
+    unsigned long start = millis();
+    while (millis() - start < timeout_ms) {
+      uint8_t status = 0;
+      if (i2cReadReg(QMI8658_ADDR, QMI8658_STATUS_INT, &status) &&
+          (status & QMI8658_STATUS_INT_CMD_DONE)) {
+        done = true;
+        break;
+      }
+      delayMicroseconds(200);
+    }
+    // ACK clears CmdDone so the next command can be issued
+    i2cWriteReg(QMI8658_ADDR, QMI8658_CTRL9, QMI8658_CMD_ACK);
+  }
+
+  i2cBusUnlock();
+  if (!done) Serial.printf("[IMU] CTRL9 command 0x%02X timed out\n", cmd);
+  return done;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+bool initIMUFifo(uint8_t odr_code, uint16_t odr_hz, bool with_gyro, uint8_t watermark) {
+  if (watermark > IMU_FIFO_HW_DEPTH) watermark = IMU_FIFO_HW_DEPTH;
+  fifo_ctrl_value = QMI8658_FIFO_MODE_STREAM | QMI8658_FIFO_SIZE_128;
+
+  const RegSeqEntry fifo_config[] = {
+    // Sensors off while reconfiguring
+    REG_WRITE(QMI8658_CTRL7, 0x00),
+
+    // Little-endian, auto-increment, FIFO watermark on INT2 (CTRL1..3 = one burst)
+    REG_WRITE(QMI8658_CTRL1, QMI8658_CTRL1_ADDR_AI | QMI8658_CTRL1_INT2_EN),
+    REG_WRITE(QMI8658_CTRL2, QMI8658_ACC_FS_4G | odr_code),
+    REG_WRITE(QMI8658_CTRL3, QMI8658_GYR_FS_512DPS | odr_code),
+
+    // CTRL9 handshake through STATUS_INT (keep any motion engines already enabled)
+    REG_SET_BITS(QMI8658_CTRL8, QMI8658_CTRL8_HANDSHAKE_STATUS),
+
+    // Stream mode: oldest samples drop on overflow, we never stall the sensor
+    REG_WRITE(QMI8658_FIFO_WTM_TH, watermark),
+    REG_WRITE(QMI8658_FIFO_CTRL, fifo_ctrl_value),
+
+    REG_WRITE(QMI8658_CTRL7, QMI8658_CTRL7_ACC_EN | (with_gyro ? QMI8658_CTRL7_GYR_EN : 0)),
+  };
+  const RegSequence fifo_sequence = REG_SEQ("QMI8658 FIFO", QMI8658_ADDR, fifo_config, true);
+
+  bool ok = runRegSequence(fifo_sequence);
+
+  ok &= qmi8658Command(QMI8658_CMD_RST_FIFO);
+
+  if (!ok) {
+    Serial.println("[IMU] FIFO configuration failed");
+    fifo_active = false;
+    return false;
+  }
+
+  fifo_with_gyro = with_gyro;
+  fifo_odr_hz = odr_hz;
+  fifo_active = true;
+  watermark_flag = false;
+  fifo_stats.last_drain_ms = millis();
+
+  #if IMU_FIFO_INT_PIN >= 0
+    pinMode(IMU_FIFO_INT_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(IMU_FIFO_INT_PIN), imuFifoISR, RISING);
+  #endif
+
+  Serial.printf("[IMU] FIFO active: %d Hz, %s, watermark %d sets\n",
+                odr_hz, with_gyro ? "accel+gyro" : "accel only", watermark);
+  return true;
+}
+
+void stopIMUFifo() {
+  if (!fifo_active) return;
+  #if IMU_FIFO_INT_PIN >= 0
+    detachInterrupt(digitalPinToInterrupt(IMU_FIFO_INT_PIN));
+  #endif
+  i2cWriteReg(QMI8658_ADDR, QMI8658_FIFO_CTRL, QMI8658_FIFO_MODE_BYPASS);
+  fifo_active = false;
+  Serial.println("[IMU] FIFO stopped");
+}
+
+bool isIMUFifoActive() {
+  return fifo_active;
+}
+
+uint16_t getIMUFifoOdrHz() {
+  return fifo_odr_hz;
+}
+
+// =============================================================================
+// DRAIN
+// =============================================================================
+
+int drainIMUFifo() {
+  if (!fifo_active) return 0;
+
+  unsigned long start_us = micros();
+  if (!i2cBusLock()) return 0;
+
+  // Sample count is in 2-byte words: FIFO_STATUS[1:0] is the MSB
+  uint8_t cnt[2];
+  if (!i2cReadRegs(QMI8658_ADDR, QMI8658_FIFO_SMPL_CNT, cnt, sizeof(cnt))) {
+    i2cBusUnlock();
+    return 0;
+  }
+  uint8_t status = cnt[1];
+  size_t bytes = (((size_t)(status & 0x03) << 8) | cnt[0]) * 2;
+
+  if (status & (QMI8658_FIFO_STATUS_FULL | QMI8658_FIFO_STATUS_OVERFLOW)) {
+    fifo_stats.hw_overflows++;
+  }
+
+  size_t set_size = fifo_with_gyro ? 12 : 6;
+  if (bytes > sizeof(drain_buf)) bytes = sizeof(drain_buf);
+  bytes -= bytes % set_size;
+
+  int sets = 0;
+  if (bytes > 0 && qmi8658Command(QMI8658_CMD_REQ_FIFO)) {
+    if (i2cReadStream(QMI8658_ADDR, QMI8658_FIFO_DATA, drain_buf, bytes)) {
+      sets = bytes / set_size;
+    }
+    // Leave FIFO read mode so the sensor can keep writing
+    i2cWriteReg(QMI8658_ADDR, QMI8658_FIFO_CTRL, fifo_ctrl_value);
+  }
+
+  i2cBusUnlock();
+
+  // Unpack into the ring (little-endian int16: accel xyz, then gyro xyz)
+  for (int i = 0; i < sets; i++) {
+    const uint8_t* p = &drain_buf[i * set_size];
+    ImuSample s;
+    s.ax = (int16_t)(p[0] | (p[1] << 8));
+    s.ay = (int16_t)(p[2] | (p[3] << 8));
+    s.az = (int16_t)(p[4] | (p[5] << 8));
+    if (fifo_with_gyro) {
+      s.gx = (int16_t)(p[6] | (p[7] << 8));
+      s.gy = (int16_t)(p[8] | (p[9] << 8));
+      s.gz = (int16_t)(p[10] | (p[11] << 8));
+    } else {
+      s.gx = s.gy = s.gz = 0;
+    }
+
+    portENTER_CRITICAL(&ring_mux);
+    ring[ring_head & (IMU_FIFO_RING_SIZE - 1)] = s;
+    ring_head++;
+    portEXIT_CRITICAL(&ring_mux);
+  }
+
+  uint32_t elapsed = micros() - start_us;
+  fifo_stats.drains++;
+  fifo_stats.samples += sets;
+  fifo_stats.bytes += bytes;
+  fifo_stats.last_drain_us = elapsed;
+  if (elapsed > fifo_stats.max_drain_us) fifo_stats.max_drain_us = elapsed;
+  fifo_stats.last_drain_ms = millis();
+
+  return sets;
+}
+
+int serviceIMUFifo() {
+  if (!fifo_active) return 0;
+
+  if (watermark_flag) {
+    watermark_flag = false;
+    fifo_stats.watermark_irqs++;
+    return drainIMUFifo();
+  }
+
+  // No INT pin: poll the watermark flag at a low rate
+  if (millis() - last_status_poll < status_poll_ms) return 0;
+  last_status_poll = millis();
+
+  uint8_t status = 0;
+  if (!i2cReadReg(QMI8658_ADDR, QMI8658_FIFO_STATUS, &status)) return 0;
+  if (status & (QMI8658_FIFO_STATUS_WTM | QMI8658_FIFO_STATUS_FULL)) {
+    return drainIMUFifo();
+  }
+  return 0;
+}
+
+uint32_t imuFifoMsUntilService() {
+  if (!fifo_active) return UINT32_MAX;
+  if (watermark_flag) return 0;
+  #if IMU_FIFO_INT_PIN >= 0
+    return UINT32_MAX;      // The watermark INT wakes the loop
+  #else
+    uint32_t elapsed = millis() - last_status_poll;
+    return elapsed >= status_poll_ms ? 0 : status_poll_ms - elapsed;
+  #endif
+}
+
+void imuFifoSetPollMs(uint32_t ms) {
+  uint16_t odr = getIMUFifoOdrHz();
+  uint32_t span = odr ? (uint32_t)IMU_FIFO_HW_DEPTH * 1000 / odr : IMU_FIFO_POLL_MS;
+  uint32_t cap = span * IMU_FIFO_MAX_POLL_PCT / 100;
+  status_poll_ms = ms > cap ? cap : ms;
+}
+
+unsigned long imuFifoLastPollMs() {
+  return last_status_poll;
+}
+
+// =============================================================================
+// RING ACCESS
+// =============================================================================
+
+uint32_t imuRingHead() {
+  return ring_head;
+}
+
+int imuRingRead(uint32_t& cursor, ImuSample* out, int max_samples) {
+  portENTER_CRITICAL(&ring_mux);
+  uint32_t head = ring_head;
+  uint32_t behind = head - cursor;
+  if (behind > IMU_FIFO_RING_SIZE) {
+    fifo_stats.ring_overruns += behind - IMU_FIFO_RING_SIZE;
+    cursor = head - IMU_FIFO_RING_SIZE;
+  }
+  int n = 0;
+  while (cursor != head && n < max_samples) {
+    out[n++] = ring[cursor & (IMU_FIFO_RING_SIZE - 1)];
+    cursor++;
+  }
+  portEXIT_CRITICAL(&ring_mux);
+  return n;
+}
+
+bool imuRingLatest(ImuSample& out) {
+  portENTER_CRITICAL(&ring_mux);
+  bool have = ring_head > 0;
+  if (have) out = ring[(ring_head - 1) & (IMU_FIFO_RING_SIZE - 1)];
+  portEXIT_CRITICAL(&ring_mux);
+  return have;
+}
+
+// Approximate capture time: the newest sample landed at the last drain
+unsigned long imuRingSampleTimeMs(uint32_t seq) {
+  uint32_t age = ring_head - 1 - seq;
+  return fifo_stats.last_drain_ms - (age * 1000UL) / fifo_odr_hz;
+}
+
+// =============================================================================
+// TRACE CAPTURE
+// =============================================================================
+static bool trace_active = false;
+static uint32_t trace_cursor = 0;
+static unsigned long trace_end_ms = 0;
+static uint32_t trace_samples = 0;
+static uint32_t trace_lost = 0;
+static char trace_label[16] = "-";
+
+void imuTraceLabel(const char* label) {
+  snprintf(trace_label, sizeof(trace_label), "%s", label && *label ? label : "-");
+}
+
+void imuTraceStart(uint16_t seconds, const char* label) {
+  if (!fifo_active) {
+    Serial.println("[IMU] Trace needs the FIFO running");
+    return;
+  }
+  seconds = constrain(seconds, 1, IMU_TRACE_MAX_S);
+  imuTraceLabel(label);
+  trace_cursor = ring_head;
+  trace_end_ms = millis() + seconds * 1000UL;
+  trace_samples = 0;
+  trace_lost = 0;
+  trace_active = true;
+  Serial.printf("# imu_trace odr_hz=%u lsb_per_g=%d seconds=%u\n",
+                fifo_odr_hz, IMU_ACCEL_LSB_PER_G, seconds);
+  Serial.println("ax,ay,az,label");
+}
+
+void imuTraceMark(const char* text) {
+  if (trace_active) Serial.printf("# %s\n", text);
+}
+
+void imuTraceStop() {
+  if (!trace_active) return;
+  trace_active = false;
+  Serial.printf("# end samples=%lu lost=%lu\n",
+                (unsigned long)trace_samples, (unsigned long)trace_lost);
+}
+
+// Loop hook after serviceIMUFifo(): prints the samples the drain added
+void serviceImuTrace() {
+  if (!trace_active) return;
+  uint32_t behind = ring_head - trace_cursor;
+  if (behind > IMU_FIFO_RING_SIZE) trace_lost += behind - IMU_FIFO_RING_SIZE;
+
+  ImuSample batch[32];
+  int n;
+  while ((n = imuRingRead(trace_cursor, batch, 32)) > 0) {
+    for (int i = 0; i < n; i++) {
+      Serial.printf("%d,%d,%d,%s\n", batch[i].ax, batch[i].ay, batch[i].az, trace_label);
+    }
+    trace_samples += n;
+  }
+  if ((long)(millis() - trace_end_ms) >= 0) imuTraceStop();
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const ImuFifoStats* getIMUFifoStats() {
+  return &fifo_stats;
+}
+
+void printIMUFifoStats() {
+  Serial.printf("[IMU] FIFO %s @ %d Hz | drains=%lu samples=%lu bytes=%lu\n",
+                fifo_active ? "ON" : "OFF", fifo_odr_hz,
+                (unsigned long)fifo_stats.drains,
+                (unsigned long)fifo_stats.samples,
+                (unsigned long)fifo_stats.bytes);
+  Serial.printf("[IMU] hw_overflows=%lu ring_overruns=%lu irqs=%lu drain=%lu us (max %lu us)\n",
+                (unsigned long)fifo_stats.hw_overflows,
+                (unsigned long)fifo_stats.ring_overruns,
+                (unsigned long)fifo_stats.watermark_irqs,
+                (unsigned long)fifo_stats.last_drain_us,
+                (unsigned long)fifo_stats.max_drain_us);
+}
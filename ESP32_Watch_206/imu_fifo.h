@@ -0,0 +1,110 @@
+/*
+ * imu_fifo.h - QMI8658 FIFO Batching
+ * FUSION OS Sensor Layer
+ *
+ * The IMU samples at a fixed ODR into its hardware FIFO. When the watermark
+ * is reached (INT pin or status poll) the whole batch is drained in one
+ * burst read into a RAM ring of fixed-point samples. Motion algorithms
+ * (pedometer, classifier, wrist raise, sleep) read the ring with their own
+ * cursor, so each one sees every sample exactly once.
+ */
+
+#ifndef IMU_FIFO_H
+#define IMU_FIFO_H
+
+#include <Arduino.h>
+#include "qmi8658_reg.h"
+
+// =============================================================================
+// FIFO CONFIGURATION
+// =============================================================================
+#define IMU_FIFO_ODR            QMI8658_ODR_56HZ
+#define IMU_FIFO_ODR_HZ         56      // Nominal rate for IMU_FIFO_ODR
+#define IMU_FIFO_WATERMARK      32      // Sample sets per drain (~0.57s @ 56Hz)
+#define IMU_FIFO_HW_DEPTH       128     // QMI8658 FIFO size (sample sets)
+#define IMU_FIFO_RING_SIZE      256     // Power of 2 (~4.5s of history @ 56Hz)
+#define IMU_FIFO_POLL_MS        250     // Status poll period when no INT pin
+#define IMU_FIFO_MAX_POLL_PCT   75      // Longest poll, % of the HW FIFO's span
+#define IMU_FIFO_INT_PIN        -1      // QMI8658 INT2 not routed on this board rev -> poll
+#define IMU_TRACE_MAX_S         600     // Longest trace capture
+
+// Fixed-point scaling (±4g, ±512 dps)
+#define IMU_ACCEL_LSB_PER_G     8192
+#define IMU_GYRO_LSB_PER_DPS    64
+#define IMU_ACCEL_MG(raw)       (((int32_t)(raw) * 1000) / IMU_ACCEL_LSB_PER_G)
+
+// =============================================================================
+// DATA TYPES
+// =============================================================================
+
+// One raw sample set - divide by the LSB constants above for g / dps
+struct ImuSample {
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;   // Zero when the FIFO runs accel-only
+};
+
+struct ImuFifoStats {
+  uint32_t drains;
+  uint32_t samples;
+  uint32_t bytes;
+  uint32_t hw_overflows;      // FIFO filled before we drained it
+  uint32_t ring_overruns;     // Samples a slow reader never saw
+  uint32_t watermark_irqs;
+  uint32_t last_drain_us;
+  uint32_t max_drain_us;
+  unsigned long last_drain_ms;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Configure ODR + FIFO (stream mode, watermark IRQ). with_gyro=false halves
+// the data and lets the IMU use its low-power accel-only rates.
+bool initIMUFifo(uint8_t odr_code = IMU_FIFO_ODR, uint16_t odr_hz = IMU_FIFO_ODR_HZ,
+                 bool with_gyro = true, uint8_t watermark = IMU_FIFO_WATERMARK);
+void stopIMUFifo();
+bool isIMUFifoActive();
+uint16_t getIMUFifoOdrHz();
+
+// Loop hook: drains when the watermark is reached. Returns samples added.
+int serviceIMUFifo();
+
+// ms until serviceIMUFifo() has work to do (loop sleep budget)
+uint32_t imuFifoMsUntilService();
+
+// Status poll period without an INT pin (screen off: stretched). Capped so
+// the hardware FIFO cannot fill between polls.
+void imuFifoSetPollMs(uint32_t ms);
+
+// millis() of the last status poll; other IMU polls ride along with it so
+// the screen-off loop wakes once per period, not once per poller
+unsigned long imuFifoLastPollMs();
+
+// Unconditional drain of everything in the hardware FIFO
+int drainIMUFifo();
+
+// Ring access - each consumer keeps its own cursor (start at imuRingHead())
+uint32_t imuRingHead();
+int imuRingRead(uint32_t& cursor, ImuSample* out, int max_samples);
+bool imuRingLatest(ImuSample& out);
+unsigned long imuRingSampleTimeMs(uint32_t seq);
+
+// Trace capture: ring samples streamed to Serial as CSV for the host replay
+// tests (host_tests/traces/imu). The label tags the rows that follow it;
+// a mark becomes a '#' line (e.g. "steps=412" counted by hand).
+void imuTraceStart(uint16_t seconds, const char* label);
+void imuTraceLabel(const char* label);
+void imuTraceMark(const char* text);
+void imuTraceStop();
+void serviceImuTrace();
+
+// CTRL9 host command with STATUS_INT handshake + ACK
+bool qmi8658Command(uint8_t cmd, uint32_t timeout_ms = 20);
+
+const ImuFifoStats* getIMUFifoStats();
+void printIMUFifoStats();
+
+void IRAM_ATTR imuFifoISR();
+
+#endif // IMU_FIFO_H
@@ -0,0 +1,233 @@
+/*
+ * kv_reader.cpp - Zero-Allocation KEY=VALUE Reader Implementation
+ * FUSION OS System Layer
+ */
+
+#include "kv_reader.h"
+
+static KvLoadStats load_stats[KV_MAX_FILES];
+static uint8_t load_stat_count = 0;
+
+// =============================================================================
+// KEY TABLE
+// =============================================================================
+
+static uint32_t hashSpan(const char* s, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void buildSchema(KvSchema* schema) {
+  memset(schema->slots, 0, sizeof(schema->slots));
+  uint8_t count = min(schema->count, (uint8_t)KV_MAX_FIELDS);
+  for (uint8_t i = 0; i < count; i++) {
+    const char* key = schema->fields[i].key;
+    uint32_t slot = hashSpan(key, strlen(key)) & (KV_SLOTS - 1);
+    while (schema->slots[slot]) slot = (slot + 1) & (KV_SLOTS - 1);
+    schema->slots[slot] = i + 1;
+  }
+  schema->built = true;
+}
+
+static const KvField* findField(KvSchema* schema, const char* key, size_t len) {
+  uint32_t slot = hashSpan(key, len) & (KV_SLOTS - 1);
+  // Fewer fields than slots: an empty slot always ends the probe
+  while (schema->slots[slot]) {
+    const KvField* f = &schema->fields[schema->slots[slot] - 1];
+    if (strlen(f->key) == len && memcmp(f->key, key, len) == 0) return f;
+    slot = (slot + 1) & (KV_SLOTS - 1);
+  }
+  return NULL;
+}
+
+// =============================================================================
+// LINES
+// =============================================================================
+
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// String::toInt() (atol) rules: leading blanks, sign, digits up to the
+// first non-digit, 0 without digits. Saturates instead of overflowing.
+static int32_t parseInt(const char* s, const char* end) {
+  while (s < end && isBlank(*s)) s++;
+  bool neg = false;
+  if (s < end && (*s == '-' || *s == '+')) neg = *s++ == '-';
+  int64_t v = 0;
+  while (s < end && *s >= '0' && *s <= '9') {
+    v = v * 10 + (*s++ - '0');
+    if (v > (int64_t)INT32_MAX + 1) v = (int64_t)INT32_MAX + 1;
+  }
+  if (neg) v = -v;
+  if (v > INT32_MAX) v = INT32_MAX;
+  return (int32_t)v;
+}
+
+static void setField(const KvField* f, int32_t value, uint16_t index) {
+  switch (f->type) {
+    case KV_INT:  ((int*)f->target)[index] = value; break;
+    case KV_U8:   ((uint8_t*)f->target)[index] = (uint8_t)value; break;
+    case KV_BOOL: ((bool*)f->target)[index] = value != 0; break;
+    case KV_FN:   if (f->set) f->set(value, index); break;
+  }
+}
+
+static void parseLine(KvParser* p, const char* s, const char* end) {
+  p->lines++;
+  while (s < end && isBlank(*s)) s++;
+  while (end > s && isBlank(end[-1])) end--;
+  if (s == end || *s == '#') return;
+
+  const char* eq = (const char*)memchr(s, '=', end - s);
+  if (!eq || eq == s) {
+    p->malformed++;
+    return;
+  }
+  size_t key_len = eq - s;
+  int32_t value = parseInt(eq + 1, end);
+
+  const KvField* f = findField(p->schema, s, key_len);
+  if (f && f->count == 0) {
+    setField(f, value, 0);
+    p->fields++;
+    return;
+  }
+
+  // PREFIX_<n>: the digits after the last '_'
+  size_t digits = key_len;
+  while (digits > 0 && s[digits - 1] >= '0' && s[digits - 1] <= '9') digits--;
+  if (digits > 0 && digits < key_len && key_len - digits <= 5 && s[digits - 1] == '_') {
+    f = findField(p->schema, s, digits);
+    int32_t index = parseInt(s + digits, s + key_len);
+    if (f && f->count > 0 && index < f->count) {
+      setField(f, value, (uint16_t)index);
+      p->fields++;
+      return;
+    }
+  }
+  p->unknown++;
+}
+
+// =============================================================================
+// PARSER
+// =============================================================================
+
+void kvBegin(KvParser* p, KvSchema* schema) {
+  memset(p, 0, sizeof(*p));
+  p->schema = schema;
+  if (!schema->built) buildSchema(schema);
+}
+
+size_t kvFeed(KvParser* p, const char* data, size_t len, bool eof) {
+  size_t pos = 0;
+  while (pos < len) {
+    const char* nl = (const char*)memchr(data + pos, '\n', len - pos);
+    if (!nl) break;
+    size_t line_end = nl - data;
+    if (p->skipping) p->skipping = false;
+    else parseLine(p, data + pos, nl);
+    pos = line_end + 1;
+  }
+  if (eof && pos < len) {
+    if (!p->skipping) parseLine(p, data + pos, data + len);
+    pos = len;
+  }
+  if (eof) p->skipping = false;
+  return pos;
+}
+
+// =============================================================================
+// FILES
+// =============================================================================
+
+static KvLoadStats* statsFor(const char* name) {
+  for (uint8_t i = 0; i < load_stat_count; i++) {
+    if (strcmp(load_stats[i].name, name) == 0) return &load_stats[i];
+  }
+  if (load_stat_count >= KV_MAX_FILES) return NULL;
+  KvLoadStats* s = &load_stats[load_stat_count++];
+  memset(s, 0, sizeof(*s));
+  s->name = name;
+  return s;
+}
+
+bool kvLoadFile(fs::FS& fs, const char* path, KvSchema* schema) {
+  uint32_t t0 = micros();
+  File f = fs.open(path, FILE_READ);
+  if (!f) return false;
+
+  KvParser p;
+  kvBegin(&p, schema);
+  char buf[KV_BLOCK_SIZE];
+  size_t have = 0;
+  uint32_t bytes = 0;
+
+  while (true) {
+    int n = f.read((uint8_t*)buf + have, sizeof(buf) - have);
+    bool eof = n <= 0;
+    if (n > 0) {
+      have += n;
+      bytes += n;
+    }
+    size_t used = kvFeed(&p, buf, have, eof);
+    if (eof) break;
+    if (used == 0 && have == sizeof(buf)) {
+      // A whole block without a newline: drop the line
+      if (!p.skipping) p.overlong++;
+      p.skipping = true;
+      have = 0;
+      continue;
+    }
+    memmove(buf, buf + used, have - used);
+    have -= used;
+  }
+  f.close();
+
+  KvLoadStats* s = statsFor(schema->name);
+  if (s) {
+    uint32_t us = micros() - t0;
+    s->loads++;
+    s->bytes = bytes;
+    s->fields = p.fields;
+    s->unknown = p.unknown;
+    s->last_us = us;
+    if (us > s->max_us) s->max_us = us;
+    s->heap_free = ESP.getFreeHeap();
+    s->heap_largest = ESP.getMaxAllocHeap();
+  }
+  if (p.malformed || p.overlong) {
+    Serial.printf("[KV] %s: %lu fields, %lu malformed, %lu overlong lines skipped\n",
+                  schema->name, (unsigned long)p.fields,
+                  (unsigned long)p.malformed, (unsigned long)p.overlong);
+  }
+  return true;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const KvLoadStats* getKvLoadStats(uint8_t* count) {
+  if (count) *count = load_stat_count;
+  return load_stats;
+}
+
+void printKvLoadStats() {
+  for (uint8_t i = 0; i < load_stat_count; i++) {
+    const KvLoadStats& s = load_stats[i];
+    uint32_t frag = s.heap_free ? 100 - (uint64_t)s.heap_largest * 100 / s.heap_free : 0;
+    Serial.printf("[KV] %-12s loads=%lu %lu bytes %lu fields (%lu unknown) last=%lu us max=%lu us\n",
+                  s.name, (unsigned long)s.loads, (unsigned long)s.bytes,
+                  (unsigned long)s.fields, (unsigned long)s.unknown,
+                  (unsigned long)s.last_us, (unsigned long)s.max_us);
+    Serial.printf("[KV] %-12s heap after: %lu free, largest block %lu (%lu%% fragmented)\n",
+                  "", (unsigned long)s.heap_free, (unsigned long)s.heap_largest,
+                  (unsigned long)frag);
+  }
+  if (load_stat_count == 0) Serial.println("[KV] No save files loaded");
+}
@@ -0,0 +1,115 @@
+/*
+ * kv_reader.h - Zero-Allocation KEY=VALUE Reader
+ * FUSION OS System Layer
+ *
+ * player.dat, cards.dat and progress.dat were loaded a line at a time
+ * with readStringUntil(), then split with indexOf/substring/toInt - three
+ * heap Strings per line, all of them at boot while the heap is filling
+ * up. The reader allocates nothing:
+ *
+ *   blocks     the file is read in KV_BLOCK_SIZE blocks into a stack
+ *              buffer; a line cut by the block end is moved to the front
+ *              before the next read
+ *   spans      each line yields a key span and a value span inside that
+ *              buffer; values are parsed in place (toInt() rules)
+ *   dispatch   a KvSchema lists its keys once; on first use they are
+ *              hashed (FNV-1a) into an open-addressed slot table, so a
+ *              key costs one hash and one compare instead of a chain of
+ *              String ==. Keys ending in _<n> match an indexed field
+ *              (DECK_3 -> "DECK_" index 3) when no exact key does;
+ *              the index may run to 65535 (CARD_<n>, EVO_<n>).
+ *   setters    typed: int, uint8_t, bool (arrays for indexed fields), or
+ *              a function for clamps and enums
+ *
+ * '#' lines (the atomic-save footer), lines without '=' and unknown keys
+ * are skipped as before; lines over KV_BLOCK_SIZE are dropped whole.
+ * kvFeed() takes any slicing of the input, so the host tests
+ * (host_tests/test_kv_reader.cpp) fuzz it against the String parser and
+ * time both without a file system.
+ *
+ * Each load records its time and the heap's free/largest block after it;
+ * WIDGET_KV prints them.
+ */
+
+#ifndef KV_READER_H
+#define KV_READER_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define KV_BLOCK_SIZE           256     // Read size and longest line
+#define KV_MAX_FIELDS           16      // Per schema
+#define KV_SLOTS                32      // Hash slots, power of two >= 2x fields
+#define KV_MAX_FILES            4       // Load timings kept
+
+#define KV_COUNT(fields)        ((uint8_t)(sizeof(fields) / sizeof((fields)[0])))
+
+enum KvType : uint8_t {
+  KV_INT = 0,                 // int*
+  KV_U8,                      // uint8_t*
+  KV_BOOL,                    // bool*, value != 0
+  KV_FN                       // KvSetter
+};
+
+// `index` is the _<n> suffix of an indexed key, 0 otherwise
+typedef void (*KvSetter)(int32_t value, uint16_t index);
+
+struct KvField {
+  const char* key;            // Exact key, or with count > 0 the "PREFIX_"
+  KvType type;
+  void* target;               // Array of `count` for indexed fields
+  uint16_t count;             // 0: exact key; n: PREFIX_0 .. PREFIX_<n-1>
+  KvSetter set;               // KV_FN
+};
+
+struct KvSchema {
+  const char* name;
+  const KvField* fields;
+  uint8_t count;
+  uint8_t slots[KV_SLOTS];    // Field index + 1, 0 empty - built on first use
+  bool built;
+};
+
+struct KvParser {
+  KvSchema* schema;
+  bool skipping;              // Dropping the rest of an overlong line
+  uint32_t lines;
+  uint32_t fields;            // Dispatched to a setter
+  uint32_t unknown;           // Well-formed, key not in the schema
+  uint32_t malformed;         // No '=' / empty key
+  uint32_t overlong;
+};
+
+struct KvLoadStats {
+  const char* name;
+  uint32_t loads;
+  uint32_t bytes;
+  uint32_t fields;
+  uint32_t unknown;           // VERSION and keys from other firmware
+  uint32_t last_us;
+  uint32_t max_us;
+  uint32_t heap_free;         // After the last load
+  uint32_t heap_largest;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+void kvBegin(KvParser* p, KvSchema* schema);
+
+// Parse whole lines in data[0..len); returns the bytes used. The rest (a
+// partial last line) must be passed again with more data; with eof set
+// it is parsed as the last line.
+size_t kvFeed(KvParser* p, const char* data, size_t len, bool eof);
+
+// Stream a file through the schema; false if it cannot be opened
+bool kvLoadFile(fs::FS& fs, const char* path, KvSchema* schema);
+
+const KvLoadStats* getKvLoadStats(uint8_t* count);
+void printKvLoadStats();
+
+#endif // KV_READER_H
@@ -0,0 +1,165 @@
+/*
+ * loop_events.cpp - Event-Driven Main Loop Implementation
+ * FUSION OS System Layer
+ */
+
+#include "loop_events.h"
+
+static EventGroupHandle_t loop_group = NULL;
+static uint32_t next_wake_ms = 0;                   // First pass runs straight away
+static LoopDeadline next_owner = LOOP_DL_COUNT;     // COUNT = the safety cap
+static unsigned long last_return_ms = 0;
+
+static LoopEventStats loop_stats = {0};
+
+static const char* const event_names[LOOP_EVT_COUNT] = {
+  "touch", "button", "imu", "rtc", "timer", "serial", "wrist"
+};
+static const char* const deadline_names[LOOP_DL_COUNT] = {
+  "frame", "scr_timeout", "save", "time", "sched", "imu_poll", "sleep_epoch", "wrist_poll", "fuel"
+};
+
+// =============================================================================
+// SERIAL RX HOOK
+// =============================================================================
+
+#if ARDUINO_USB_CDC_ON_BOOT
+static void serialRxEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+  (void)arg;
+  (void)base;
+  (void)id;
+  (void)data;
+  loopEventSet(LOOP_EVT_SERIAL);
+}
+#endif
+
+static void hookSerialRx() {
+  #if ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, serialRxEvent);
+  #elif ARDUINO_USB_CDC_ON_BOOT
+    Serial.onEvent(ARDUINO_USB_CDC_RX_EVENT, serialRxEvent);
+  #else
+    Serial.onReceive([]() { loopEventSet(LOOP_EVT_SERIAL); });
+  #endif
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initLoopEvents() {
+  loop_group = xEventGroupCreate();
+  if (!loop_group) {
+    Serial.println("[LOOP] Event group create FAILED - falling back to timed waits");
+    return;
+  }
+  hookSerialRx();
+  Serial.printf("[LOOP] Event-driven loop ready (cap %d ms)\n", LOOP_MAX_WAIT_MS);
+}
+
+// =============================================================================
+// EVENT SOURCES
+// =============================================================================
+
+void loopEventSet(uint32_t bits) {
+  if (loop_group) xEventGroupSetBits(loop_group, bits);
+}
+
+void IRAM_ATTR loopEventFromISR(uint32_t bits) {
+  if (!loop_group) return;
+  BaseType_t woken = pdFALSE;
+  xEventGroupSetBitsFromISR(loop_group, bits, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void loopWakeWithin(uint32_t ms, LoopDeadline owner) {
+  if (ms < next_wake_ms) {
+    next_wake_ms = ms;
+    next_owner = owner;
+  }
+}
+
+// =============================================================================
+// WAIT
+// =============================================================================
+
+uint32_t loopWaitEvents(LoopSleepFn sleep_fn) {
+  uint32_t budget = next_wake_ms;
+  LoopDeadline owner = next_owner;
+  next_wake_ms = LOOP_MAX_WAIT_MS;
+  next_owner = LOOP_DL_COUNT;
+
+  unsigned long start = millis();
+  uint32_t bits = 0;
+
+  if (!loop_group) {
+    if (sleep_fn) sleep_fn(budget);
+    else delay(budget);
+  } else if (sleep_fn) {
+    // Anything already pending is served without sleeping
+    bits = xEventGroupClearBits(loop_group, LOOP_EVT_ALL) & LOOP_EVT_ALL;
+    if (!bits && budget > 0) {
+      sleep_fn(budget);
+      bits = xEventGroupClearBits(loop_group, LOOP_EVT_ALL) & LOOP_EVT_ALL;
+    }
+  } else {
+    bits = xEventGroupWaitBits(loop_group, LOOP_EVT_ALL, pdTRUE, pdFALSE,
+                               pdMS_TO_TICKS(budget)) & LOOP_EVT_ALL;
+  }
+
+  unsigned long end = millis();
+  uint32_t waited = end - start;
+  loop_stats.passes++;
+  loop_stats.blocked_ms += waited;
+  if (sleep_fn && last_return_ms) {
+    loop_stats.sleep_passes++;
+    loop_stats.sleep_span_ms += end - last_return_ms;
+  }
+  last_return_ms = end;
+
+  if (bits) {
+    loop_stats.event_wakes++;
+    for (int i = 0; i < LOOP_EVT_COUNT; i++) {
+      if (bits & (1 << i)) loop_stats.by_event[i]++;
+    }
+  } else if (owner < LOOP_DL_COUNT && waited + 1 >= budget) {
+    loop_stats.deadline_wakes++;
+    loop_stats.by_deadline[owner]++;
+  } else {
+    loop_stats.idle_wakes++;
+  }
+  return bits;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const LoopEventStats* getLoopEventStats() {
+  return &loop_stats;
+}
+
+void resetLoopEventStats() {
+  memset(&loop_stats, 0, sizeof(loop_stats));
+}
+
+void printLoopEventStats() {
+  const LoopEventStats& s = loop_stats;
+  Serial.printf("[LOOP] passes=%lu events=%lu deadlines=%lu idle=%lu blocked=%lu ms\n",
+                (unsigned long)s.passes, (unsigned long)s.event_wakes,
+                (unsigned long)s.deadline_wakes, (unsigned long)s.idle_wakes,
+                (unsigned long)s.blocked_ms);
+  Serial.printf("[LOOP] events:");
+  for (int i = 0; i < LOOP_EVT_COUNT; i++) {
+    Serial.printf(" %s=%lu", event_names[i], (unsigned long)s.by_event[i]);
+  }
+  Serial.printf("\n[LOOP] deadlines:");
+  for (int i = 0; i < LOOP_DL_COUNT; i++) {
+    Serial.printf(" %s=%lu", deadline_names[i], (unsigned long)s.by_deadline[i]);
+  }
+  Serial.printf("\n");
+  uint32_t rate_x100 = s.sleep_span_ms ? (uint64_t)s.sleep_passes * 100000 / s.sleep_span_ms : 0;
+  Serial.printf("[LOOP] screen off: %lu wakes in %lu s = %lu.%02lu wakes/s\n",
+                (unsigned long)s.sleep_passes, (unsigned long)(s.sleep_span_ms / 1000),
+                (unsigned long)(rate_x100 / 100), (unsigned long)(rate_x100 % 100));
+}
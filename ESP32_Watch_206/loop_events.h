@@ -0,0 +1,92 @@
+/*
+ * loop_events.h - Event-Driven Main Loop
+ * FUSION OS System Layer
+ *
+ * loop() no longer ends in a fixed delay(). Interrupt sources (touch INT,
+ * power button, IMU watermark, RTC tick, raise-to-wake, scheduler timer,
+ * serial RX) set bits in a FreeRTOS event group, and periodic work reports
+ * how long it can wait through loopWakeWithin(). The loop then blocks on
+ * the event group until the first bit or the earliest deadline - or, with
+ * the screen off, light-sleeps for that long.
+ *
+ * Every wake is attributed to an event or a deadline. A wake that is
+ * neither (the safety cap, or the RTOS returning early) counts as idle.
+ * Light-sleep passes are also timed wake to wake, so WIDGET_LOOP reports
+ * the screen-off wake rate directly.
+ */
+
+#ifndef LOOP_EVENTS_H
+#define LOOP_EVENTS_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define LOOP_MAX_WAIT_MS        4000    // Safety cap, well inside the task WDT
+#define LOOP_TOUCH_ON_INT       1       // Poll the FT3168 only on INT / while pressed
+
+// =============================================================================
+// EVENTS (event group bits)
+// =============================================================================
+#define LOOP_EVT_TOUCH          (1 << 0)
+#define LOOP_EVT_BUTTON         (1 << 1)
+#define LOOP_EVT_IMU            (1 << 2)
+#define LOOP_EVT_RTC            (1 << 3)
+#define LOOP_EVT_TIMER          (1 << 4)
+#define LOOP_EVT_SERIAL         (1 << 5)
+#define LOOP_EVT_WRIST          (1 << 6)
+#define LOOP_EVT_COUNT          7
+#define LOOP_EVT_ALL            ((1 << LOOP_EVT_COUNT) - 1)
+
+// Deadline owners (which periodic job a timeout wake served)
+enum LoopDeadline : uint8_t {
+  LOOP_DL_FRAME = 0,          // Screen-on redraw
+  LOOP_DL_SCREEN_TIMEOUT,
+  LOOP_DL_SAVE,               // Save scheduler: write-behind, backstop, PMU poll
+  LOOP_DL_TIME,
+  LOOP_DL_SCHEDULER,
+  LOOP_DL_IMU,
+  LOOP_DL_SLEEP_EPOCH,
+  LOOP_DL_WRIST,
+  LOOP_DL_FUEL,
+  LOOP_DL_COUNT
+};
+
+typedef void (*LoopSleepFn)(uint32_t max_ms);
+
+struct LoopEventStats {
+  uint32_t passes;
+  uint32_t event_wakes;
+  uint32_t deadline_wakes;
+  uint32_t idle_wakes;          // Neither an event nor a due deadline
+  uint32_t by_event[LOOP_EVT_COUNT];
+  uint32_t by_deadline[LOOP_DL_COUNT];
+  uint32_t blocked_ms;          // Time spent waiting / sleeping
+  uint32_t sleep_passes;        // Passes that light-slept (screen off)
+  uint32_t sleep_span_ms;       // Wall time of those passes, wake to wake
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// From the loop task, before any source is armed
+void initLoopEvents();
+
+void loopEventSet(uint32_t bits);
+void IRAM_ATTR loopEventFromISR(uint32_t bits);
+
+// Lower the next wake to `ms` from now (call each pass, before the wait)
+void loopWakeWithin(uint32_t ms, LoopDeadline owner);
+
+// Block until an event or the earliest deadline. With a sleep function the
+// wait is spent in it (light sleep); events raised meanwhile are collected
+// after. Returns the event bits (cleared).
+uint32_t loopWaitEvents(LoopSleepFn sleep_fn = NULL);
+
+const LoopEventStats* getLoopEventStats();
+void resetLoopEventStats();
+void printLoopEventStats();
+
+#endif // LOOP_EVENTS_H
@@ -46,6 +46,7 @@
 #include "storyline.h"
 #include "companion.h"
 #include "xp_system.h"
+#include "compass_app.h"
 #include <Arduino.h>
 
 extern Arduino_CO5300 *gfx;
@@ -851,20 +852,9 @@ void openApp(const char* appName) {
         drawCompanionCareScreen();
     }
     else if (strcmp(appName, "COMPASS") == 0) {
-        system_state.current_screen = SCREEN_SETTINGS;
+        system_state.current_screen = SCREEN_COMPASS;
         navState.navigationLocked = true;
-        gfx->fillScreen(RGB565(2, 2, 5));
-        gfx->setTextColor(getCurrentTheme()->primary);
-        gfx->setTextSize(2);
-        gfx->setCursor(LCD_WIDTH/2 - 42, 180);
-        gfx->print("COMPASS");
-        gfx->setTextSize(1);
-        gfx->setTextColor(RGB565(100, 105, 120));
-        gfx->setCursor(LCD_WIDTH/2 - 55, 220);
-        gfx->print("Coming soon!");
-        gfx->setCursor(LCD_WIDTH/2 - 70, 240);
-        gfx->print("Requires magnetometer");
-        drawSwipeIndicator();
+        openCompassApp();
     }
     else if (strcmp(appName, "CONVERT") == 0) {
         system_state.current_screen = SCREEN_CONVERTER;
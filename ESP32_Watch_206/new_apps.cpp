@@ -4,11 +4,15 @@
  * FUSION OS RPG Features
  */
 
+#include "new_apps.h"
 #include "config.h"
 #include "display.h"
 #include "themes.h"
 #include "navigation.h"
 #include "xp_system.h"
+#include "scheduler.h"
+#include "persist.h"
+#include "save_schema.h"
 #include <Preferences.h>
 
 extern Arduino_CO5300 *gfx;
@@ -19,18 +23,65 @@ extern XPSystemState xp_system;
 // POMODORO TIMER
 // =============================================================================
 
+// Phase deadlines live in the scheduler (id 0 = work, 1 = break), so a
+// phase ends on time even while the screen is off or the watch rebooted
+#define POMO_WORK_ID    0
+#define POMO_BREAK_ID   1
+
 struct PomodoroState {
   bool active;
   bool is_break;
   int work_minutes;
   int break_minutes;
-  int seconds_remaining;
+  int seconds_remaining;      // Shown value; the live remainder while active
   int sessions_completed;
-  unsigned long last_tick;
+  unsigned long last_tick;    // Last once-a-second redraw
 };
 
 static PomodoroState pomo = {false, false, 25, 5, 25 * 60, 0, 0};
 
+static void schedulePomodoroPhase(uint32_t ms) {
+  uint8_t id = pomo.is_break ? POMO_BREAK_ID : POMO_WORK_ID;
+  schedulerAddIn(SCHED_POMODORO, id, ms, pomo.is_break ? "Break" : "Focus");
+}
+
+static void onPomodoroPhaseEnd(const SchedEvent& ev, uint32_t late_ms) {
+  (void)late_ms;
+  if (ev.id == POMO_WORK_ID) {
+    // Work session complete - reward!
+    pomo.sessions_completed++;
+    system_state.player_gems += 25;
+    gainExperience(15, "Pomodoro Complete");
+
+    // Switch to break
+    pomo.is_break = true;
+    pomo.seconds_remaining = pomo.break_minutes * 60;
+    Serial.printf("[POMO] Work done! Session %d. Break time.\n", pomo.sessions_completed);
+  } else {
+    // Break complete - back to work
+    pomo.is_break = false;
+    pomo.seconds_remaining = pomo.work_minutes * 60;
+    Serial.println("[POMO] Break over! Back to work.");
+  }
+  pomo.active = true;
+  schedulePomodoroPhase(pomo.seconds_remaining * 1000UL);
+
+  if (system_state.current_screen == SCREEN_POMODORO) {
+    drawPomodoroApp();
+  }
+}
+
+void initPomodoroTimer() {
+  schedulerSetHandler(SCHED_POMODORO, onPomodoroPhaseEnd);
+
+  // Resume a phase that was running before the reboot
+  if (schedulerFind(SCHED_POMODORO, POMO_WORK_ID) || schedulerFind(SCHED_POMODORO, POMO_BREAK_ID)) {
+    pomo.active = true;
+    pomo.is_break = schedulerFind(SCHED_POMODORO, POMO_BREAK_ID) != NULL;
+    pomo.seconds_remaining = schedulerRemainingMs(SCHED_POMODORO, pomo.is_break ? POMO_BREAK_ID : POMO_WORK_ID) / 1000;
+  }
+}
+
 void initPomodoroApp() {
   if (!pomo.active) {
     pomo.seconds_remaining = pomo.work_minutes * 60;
@@ -134,37 +185,17 @@ void drawPomodoroApp() {
   drawSwipeIndicator();
 }
 
+// Display refresh only, called while SCREEN_POMODORO is showing; phase
+// changes come from the scheduler
 void updatePomodoro() {
   if (!pomo.active) return;
-  
+
   unsigned long now = millis();
   if (now - pomo.last_tick >= 1000) {
     pomo.last_tick = now;
-    pomo.seconds_remaining--;
-    
-    if (pomo.seconds_remaining <= 0) {
-      if (!pomo.is_break) {
-        // Work session complete - reward!
-        pomo.sessions_completed++;
-        system_state.player_gems += 25;
-        gainExperience(15, "Pomodoro Complete");
-        
-        // Switch to break
-        pomo.is_break = true;
-        pomo.seconds_remaining = pomo.break_minutes * 60;
-        Serial.printf("[POMO] Work done! Session %d. Break time.\n", pomo.sessions_completed);
-      } else {
-        // Break complete - back to work
-        pomo.is_break = false;
-        pomo.seconds_remaining = pomo.work_minutes * 60;
-        Serial.println("[POMO] Break over! Back to work.");
-      }
-    }
-    
-    // Redraw if on pomodoro screen
-    if (system_state.current_screen == SCREEN_POMODORO) {
-      drawPomodoroApp();
-    }
+    uint8_t id = pomo.is_break ? POMO_BREAK_ID : POMO_WORK_ID;
+    pomo.seconds_remaining = (schedulerRemainingMs(SCHED_POMODORO, id) + 999) / 1000;
+    drawPomodoroApp();
   }
 }
 
@@ -178,7 +209,15 @@ void handlePomodoroTouch(int x, int y) {
   // Start/Pause button
   if (x >= btnX && x < btnX + btnW && y >= btnY && y < btnY + btnH) {
     pomo.active = !pomo.active;
-    if (pomo.active) pomo.last_tick = millis();
+    if (pomo.active) {
+      pomo.last_tick = millis();
+      schedulePomodoroPhase(pomo.seconds_remaining * 1000UL);
+    } else {
+      // Pause: keep the remainder, drop the deadline
+      uint8_t id = pomo.is_break ? POMO_BREAK_ID : POMO_WORK_ID;
+      pomo.seconds_remaining = (schedulerRemainingMs(SCHED_POMODORO, id) + 999) / 1000;
+      schedulerCancel(SCHED_POMODORO, id);
+    }
     drawPomodoroApp();
     return;
   }
@@ -187,6 +226,8 @@ void handlePomodoroTouch(int x, int y) {
   int rstBtnY = btnY + btnH + 15;
   if (x >= btnX && x < btnX + btnW && y >= rstBtnY && y < rstBtnY + 35) {
     pomo.active = false;
+    schedulerCancel(SCHED_POMODORO, POMO_WORK_ID);
+    schedulerCancel(SCHED_POMODORO, POMO_BREAK_ID);
     pomo.is_break = false;
     pomo.seconds_remaining = pomo.work_minutes * 60;
     drawPomodoroApp();
@@ -198,8 +239,6 @@ void handlePomodoroTouch(int x, int y) {
 // HABIT TRACKER
 // =============================================================================
 
-#define MAX_HABITS 6
-
 struct Habit {
   const char* name;
   const char* icon;
@@ -219,63 +258,87 @@ static Habit habits[MAX_HABITS] = {
 
 static int habits_last_day = -1;
 
+void saveHabitsData();
+
 void initHabitsApp() {
   // Load from NVS
+  HabitBlob b;
   Preferences hPrefs;
   hPrefs.begin("habits", true);
-  int saved_day = hPrefs.getInt("last_day", -1);
+  if (!schemaGetBytes(hPrefs, HABIT_BLOB_KEY, SCHEMA_NS_HABITS, &b, sizeof(b))) {
+    memset(&b, 0, sizeof(b));
+    b.last_day = -1;
+  }
+  hPrefs.end();
+  int saved_day = b.last_day;
   
   WatchTime current = getCurrentTime();
   bool is_new_day = (saved_day != current.day);
   
   for (int i = 0; i < MAX_HABITS; i++) {
-    char key[12];
-    snprintf(key, sizeof(key), "h%d_str", i);
-    habits[i].current_streak = hPrefs.getInt(key, 0);
-    snprintf(key, sizeof(key), "h%d_best", i);
-    habits[i].best_streak = hPrefs.getInt(key, 0);
-    snprintf(key, sizeof(key), "h%d_done", i);
-    habits[i].completed_today = is_new_day ? false : hPrefs.getBool(key, false);
+    habits[i].current_streak = b.habits[i].current_streak;
+    habits[i].best_streak = b.habits[i].best_streak;
+    habits[i].completed_today = is_new_day ? false : b.habits[i].done;
   }
   habits_last_day = saved_day;
-  hPrefs.end();
   
   // If new day, check if habits were NOT completed yesterday (streak break)
   if (is_new_day && habits_last_day >= 0) {
-    Preferences hSave;
-    hSave.begin("habits", false);
     for (int i = 0; i < MAX_HABITS; i++) {
-      char key[12];
-      snprintf(key, sizeof(key), "h%d_done", i);
-      bool was_done = hSave.getBool(key, false);
-      if (!was_done) {
+      if (!b.habits[i].done) {
         habits[i].current_streak = 0; // Streak broken
       }
-      // Reset today's status
-      hSave.putBool(key, false);
     }
-    hSave.putInt("last_day", current.day);
-    hSave.end();
+    // Today's status reset, stamped with today
+    saveHabitsData();
   }
 }
 
 void saveHabitsData() {
-  Preferences hPrefs;
-  hPrefs.begin("habits", false);
+  HabitBlob b;
   WatchTime current = getCurrentTime();
-  hPrefs.putInt("last_day", current.day);
+  b.last_day = current.day;
   for (int i = 0; i < MAX_HABITS; i++) {
-    char key[12];
-    snprintf(key, sizeof(key), "h%d_str", i);
-    hPrefs.putInt(key, habits[i].current_streak);
-    snprintf(key, sizeof(key), "h%d_best", i);
-    hPrefs.putInt(key, habits[i].best_streak);
-    snprintf(key, sizeof(key), "h%d_done", i);
-    hPrefs.putBool(key, habits[i].completed_today);
+    b.habits[i].done = habits[i].completed_today;
+    b.habits[i].current_streak = habits[i].current_streak;
+    b.habits[i].best_streak = habits[i].best_streak;
   }
+  Preferences hPrefs;
+  hPrefs.begin("habits", false);
+  schemaPutBytes(hPrefs, HABIT_BLOB_KEY, SCHEMA_NS_HABITS, &b, sizeof(b));
   hPrefs.end();
 }
 
+// The v1 keys, packed into HabitBlob. The blob lands before any key is
+// removed; a rerun after a reset in between only finishes the cleanup.
+bool habitsKeysToBlob(Preferences& prefs) {
+  if (!prefs.isKey(HABIT_BLOB_KEY)) {
+    HabitBlob b;
+    b.last_day = prefs.getInt("last_day", -1);
+    for (int i = 0; i < MAX_HABITS; i++) {
+      char key[12];
+      snprintf(key, sizeof(key), "h%d_str", i);
+      b.habits[i].current_streak = prefs.getInt(key, 0);
+      snprintf(key, sizeof(key), "h%d_best", i);
+      b.habits[i].best_streak = prefs.getInt(key, 0);
+      snprintf(key, sizeof(key), "h%d_done", i);
+      b.habits[i].done = prefs.getBool(key, false);
+    }
+    if (schemaPutBytes(prefs, HABIT_BLOB_KEY, SCHEMA_NS_HABITS, &b, sizeof(b)) == 0) return false;
+  }
+
+  prefs.remove("last_day");
+  for (int i = 0; i < MAX_HABITS; i++) {
+    static const char* fields[] = {"str", "best", "done"};
+    for (const char* f : fields) {
+      char key[12];
+      snprintf(key, sizeof(key), "h%d_%s", i, f);
+      prefs.remove(key);
+    }
+  }
+  return true;
+}
+
 void drawHabitsApp() {
   gfx->fillScreen(RGB565(2, 2, 5));
   for (int y = 0; y < LCD_HEIGHT; y += 4) {
@@ -686,15 +749,13 @@ void handleDungeonTouch(int x, int y) {
         gainExperience(100, "Dungeon Full Clear");
         saveDungeonData();
         
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
         
         Serial.println("[DUNGEON] FULL CLEAR! +200 bonus gems");
       } else {
         // Next room
         dungeon.current_room++;
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
       }
     }
     
@@ -955,8 +1016,7 @@ void handleCraftTouch(int x, int y) {
         system_state.player_gems += r->gem_reward;
         if (r->xp_reward > 0) gainExperience(r->xp_reward, "Card Crafting");
         
-        extern void saveAllGameData();
-        saveAllGameData();
+        persistMarkDirty(PERSIST_GAME);
         
         Serial.printf("[CRAFT] Crafted: %s\n", r->name);
       }
@@ -6,16 +6,39 @@
 #ifndef NEW_APPS_H
 #define NEW_APPS_H
 
+#include <stdint.h>
+
 // Pomodoro Timer
 void initPomodoroApp();
+void initPomodoroTimer();
 void drawPomodoroApp();
 void updatePomodoro();
 void handlePomodoroTouch(int x, int y);
 
 // Habit Tracker
+#define MAX_HABITS 6
+
+// "habits" namespace from schema v2: one blob instead of 19 keys
+#define HABIT_BLOB_KEY "d"
+
+#pragma pack(push, 1)
+struct HabitBlob {
+  int8_t last_day;            // -1 before the first save
+  struct {
+    uint8_t done;
+    uint16_t current_streak;
+    uint16_t best_streak;
+  } habits[MAX_HABITS];
+};
+#pragma pack(pop)
+
+class Preferences;
+
 void initHabitsApp();
 void drawHabitsApp();
 void handleHabitsTouch(int x, int y);
+// Schema v1 -> v2 step (save_schema.cpp)
+bool habitsKeysToBlob(Preferences& prefs);
 
 // Daily Dungeon
 void initDungeonApp();
@@ -0,0 +1,495 @@
+/*
+ * nvs_inspector.cpp - NVS Usage Inspector Implementation
+ * FUSION OS System Layer
+ */
+
+#include "nvs_inspector.h"
+#include "display.h"
+#include "navigation.h"
+#include "time_service.h"
+#include "xp_system.h"
+#include "persist.h"
+#include <nvs.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+// Page header (ESP-IDF nvs_page.hpp): state word first, the 2-bit entry
+// state table after the 32-byte header
+#define PAGE_STATE_EMPTY        0xFFFFFFFF
+#define PAGE_STATE_ACTIVE       0xFFFFFFFE
+#define PAGE_STATE_FULL         0xFFFFFFFC
+#define PAGE_STATE_FREEING      0xFFFFFFF8
+#define PAGE_TABLE_OFFSET       32
+#define ENTRY_STATE_EMPTY       3
+#define ENTRY_STATE_WRITTEN     2
+
+extern Arduino_CO5300 *gfx;
+extern SystemState system_state;
+
+struct HotKey {
+  uint32_t id;                // CRC of "namespace/key"
+  uint32_t fingerprint;       // CRC of the value at the last sample
+  uint16_t changes;
+  uint16_t intervals;         // Sample intervals the key was seen across
+};
+
+static NvsReport report;
+static HotKey hot[NVS_HOT_MAX_KEYS];
+static NvsInspectorStats inspector_stats = {0};
+static uint8_t value_buf[NVS_SAMPLE_BUF];
+
+// Open handle for the namespace the iterator is in
+static nvs_handle_t cur_handle = 0;
+static char cur_ns[16] = "";
+static bool cur_open = false;
+
+// =============================================================================
+// ENTRIES
+// =============================================================================
+
+static uint32_t keyId(const nvs_entry_info_t& info) {
+  uint32_t c = esp_rom_crc32_le(0, (const uint8_t*)info.namespace_name, strlen(info.namespace_name));
+  c = esp_rom_crc32_le(c, (const uint8_t*)"/", 1);
+  return esp_rom_crc32_le(c, (const uint8_t*)info.key, strlen(info.key));
+}
+
+static void closeNamespace() {
+  if (cur_open) nvs_close(cur_handle);
+  cur_open = false;
+  cur_ns[0] = '\0';
+}
+
+static bool openNamespace(const char* ns) {
+  if (cur_open && strcmp(cur_ns, ns) == 0) return true;
+  closeNamespace();
+  if (nvs_open(ns, NVS_READONLY, &cur_handle) != ESP_OK) return false;
+  strncpy(cur_ns, ns, sizeof(cur_ns) - 1);
+  cur_ns[sizeof(cur_ns) - 1] = '\0';
+  cur_open = true;
+  return true;
+}
+
+// Payload length of a string/blob entry, 0 for integers
+static size_t variableLength(const nvs_entry_info_t& info) {
+  size_t len = 0;
+  if (info.type != NVS_TYPE_STR && info.type != NVS_TYPE_BLOB) return 0;
+  if (!openNamespace(info.namespace_name)) return 0;
+  if (info.type == NVS_TYPE_STR) nvs_get_str(cur_handle, info.key, NULL, &len);
+  else nvs_get_blob(cur_handle, info.key, NULL, &len);
+  return len;
+}
+
+// Entries the item occupies: one header, plus 32-byte data entries
+static uint16_t entrySpan(size_t len) {
+  return 1 + (len + NVS_ENTRY_BYTES - 1) / NVS_ENTRY_BYTES;
+}
+
+static bool readFingerprint(const nvs_entry_info_t& info, uint32_t* fp) {
+  if (!openNamespace(info.namespace_name)) return false;
+  uint64_t v = 0;
+  esp_err_t err;
+  switch (info.type) {
+    case NVS_TYPE_U8:  err = nvs_get_u8(cur_handle, info.key, (uint8_t*)&v); break;
+    case NVS_TYPE_I8:  err = nvs_get_i8(cur_handle, info.key, (int8_t*)&v); break;
+    case NVS_TYPE_U16: err = nvs_get_u16(cur_handle, info.key, (uint16_t*)&v); break;
+    case NVS_TYPE_I16: err = nvs_get_i16(cur_handle, info.key, (int16_t*)&v); break;
+    case NVS_TYPE_U32: err = nvs_get_u32(cur_handle, info.key, (uint32_t*)&v); break;
+    case NVS_TYPE_I32: err = nvs_get_i32(cur_handle, info.key, (int32_t*)&v); break;
+    case NVS_TYPE_U64: err = nvs_get_u64(cur_handle, info.key, &v); break;
+    case NVS_TYPE_I64: err = nvs_get_i64(cur_handle, info.key, (int64_t*)&v); break;
+    case NVS_TYPE_STR:
+    case NVS_TYPE_BLOB: {
+      // A large value is read whole from the heap: an edit that keeps the
+      // length must still move the fingerprint
+      size_t len = variableLength(info);
+      uint8_t* buf = len > sizeof(value_buf) ? (uint8_t*)malloc(len) : value_buf;
+      if (!buf) return false;
+      err = info.type == NVS_TYPE_STR
+          ? nvs_get_str(cur_handle, info.key, (char*)buf, &len)
+          : nvs_get_blob(cur_handle, info.key, buf, &len);
+      if (err == ESP_OK) *fp = esp_rom_crc32_le(len, buf, len);
+      if (buf != value_buf) free(buf);
+      return err == ESP_OK;
+    }
+    default:
+      return false;
+  }
+  if (err != ESP_OK) return false;
+  *fp = esp_rom_crc32_le(info.type, (const uint8_t*)&v, sizeof(v));
+  return true;
+}
+
+// Calls fn for every entry in the default partition
+template <typename Fn>
+static void forEachEntry(Fn fn) {
+  nvs_iterator_t it = NULL;
+  esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, NULL, NVS_TYPE_ANY, &it);
+  while (err == ESP_OK) {
+    nvs_entry_info_t info;
+    nvs_entry_info(it, &info);
+    fn(info);
+    err = nvs_entry_next(&it);
+  }
+  nvs_release_iterator(it);
+  closeNamespace();
+}
+
+// =============================================================================
+// REPORT
+// =============================================================================
+
+static NvsNamespaceUsage* usageFor(const char* ns) {
+  for (uint8_t i = 0; i < report.ns_count; i++) {
+    if (strcmp(report.ns[i].name, ns) == 0) return &report.ns[i];
+  }
+  if (report.ns_count >= NVS_INSPECT_MAX_NS) return NULL;
+  NvsNamespaceUsage* u = &report.ns[report.ns_count++];
+  memset(u, 0, sizeof(*u));
+  strncpy(u->name, ns, sizeof(u->name) - 1);
+  return u;
+}
+
+static uint8_t pageState(uint32_t word) {
+  switch (word) {
+    case PAGE_STATE_EMPTY:   return NVS_PAGE_EMPTY;
+    case PAGE_STATE_ACTIVE:  return NVS_PAGE_ACTIVE;
+    case PAGE_STATE_FULL:    return NVS_PAGE_FULL;
+    case PAGE_STATE_FREEING: return NVS_PAGE_FREEING;
+    default:                 return NVS_PAGE_CORRUPT;
+  }
+}
+
+// Every page's header: 36 bytes read per 4 KB page
+static void scanPages() {
+  const esp_partition_t* part = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, NVS_DEFAULT_PART_NAME);
+  if (!part) return;
+  report.pages = part->size / NVS_PAGE_BYTES;
+
+  uint8_t table[(NVS_ENTRIES_PER_PAGE + 3) / 4];
+  for (uint16_t p = 0; p < report.pages; p++) {
+    uint32_t base = (uint32_t)p * NVS_PAGE_BYTES, word;
+    if (esp_partition_read(part, base, &word, sizeof(word)) != ESP_OK ||
+        esp_partition_read(part, base + PAGE_TABLE_OFFSET, table, sizeof(table)) != ESP_OK) {
+      continue;
+    }
+    NvsPageUsage u = {pageState(word), 0, 0, 0};
+    for (int e = 0; e < NVS_ENTRIES_PER_PAGE; e++) {
+      uint8_t bits = (table[e / 4] >> ((e % 4) * 2)) & 3;
+      if (bits == ENTRY_STATE_EMPTY) u.free++;
+      else if (bits == ENTRY_STATE_WRITTEN) u.used++;
+      else u.erased++;
+    }
+    if (u.state == NVS_PAGE_EMPTY) report.free_pages++;
+    if (report.page_count < NVS_INSPECT_MAX_PAGES) report.page[report.page_count++] = u;
+  }
+}
+
+const NvsReport* nvsInspect() {
+  memset(&report, 0, sizeof(report));
+
+  nvs_stats_t st;
+  if (nvs_get_stats(NULL, &st) == ESP_OK) {
+    report.used_entries = st.used_entries;
+    report.free_entries = st.free_entries;
+    report.total_entries = st.total_entries;
+    report.namespaces = st.namespace_count;
+  }
+  scanPages();
+
+  forEachEntry([](const nvs_entry_info_t& info) {
+    report.keys++;
+    NvsNamespaceUsage* u = usageFor(info.namespace_name);
+    if (!u) return;
+    size_t len = variableLength(info);
+    u->keys++;
+    u->entries += len ? entrySpan(len) : 1;
+    u->data_bytes += len;
+  });
+
+  // Most entries first (insertion sort, a couple of dozen rows)
+  for (uint8_t i = 1; i < report.ns_count; i++) {
+    NvsNamespaceUsage u = report.ns[i];
+    int j = i - 1;
+    while (j >= 0 && report.ns[j].entries < u.entries) {
+      report.ns[j + 1] = report.ns[j];
+      j--;
+    }
+    report.ns[j + 1] = u;
+  }
+
+  inspector_stats.scans++;
+  return &report;
+}
+
+// =============================================================================
+// HOT KEYS
+// =============================================================================
+
+static HotKey* hotFor(uint32_t id, bool* added) {
+  *added = false;
+  for (uint16_t i = 0; i < inspector_stats.tracked; i++) {
+    if (hot[i].id == id) return &hot[i];
+  }
+  if (inspector_stats.tracked >= NVS_HOT_MAX_KEYS) {
+    inspector_stats.untracked++;
+    return NULL;
+  }
+  HotKey* h = &hot[inspector_stats.tracked++];
+  h->id = id;
+  h->changes = 0;
+  h->intervals = 0;
+  *added = true;
+  return h;
+}
+
+void nvsHotKeySample() {
+  uint32_t t0 = micros();
+  bool first = inspector_stats.samples == 0;
+  inspector_stats.untracked = 0;
+
+  forEachEntry([first](const nvs_entry_info_t& info) {
+    uint32_t fp;
+    if (!readFingerprint(info, &fp)) return;
+    bool added;
+    HotKey* h = hotFor(keyId(info), &added);
+    if (!h) return;
+    if (added) {
+      // New since the last sample: a write, unless this is the baseline
+      if (!first) h->changes = h->intervals = 1;
+    } else if (h->intervals < 0xFFFF) {
+      h->intervals++;
+      if (h->fingerprint != fp) h->changes++;
+    }
+    h->fingerprint = fp;
+  });
+
+  inspector_stats.samples++;
+  uint32_t us = micros() - t0;
+  if (us > inspector_stats.sample_max_us) inspector_stats.sample_max_us = us;
+}
+
+static void onMinute(uint8_t events, const WatchTime& now) {
+  (void)events;
+  if (now.minute % NVS_HOT_SAMPLE_MIN == 0) nvsHotKeySample();
+}
+
+// Changes per sampled hour x10
+static uint32_t hotRate10(const HotKey& h) {
+  uint32_t minutes = (h.intervals ? h.intervals : 1) * NVS_HOT_SAMPLE_MIN;
+  return (uint32_t)h.changes * 600 / minutes;
+}
+
+// Changed in every interval: the real rate can be anything above
+static bool hotSaturated(const HotKey& h) {
+  return h.intervals > 0 && h.changes >= h.intervals;
+}
+
+static const char* pageStateName(uint8_t state) {
+  static const char* const names[] = {"empty", "active", "full", "freeing", "corrupt"};
+  return state <= NVS_PAGE_CORRUPT ? names[state] : "?";
+}
+
+struct HotKeyRow {
+  uint16_t index;             // hot[]
+  char name[34];              // "namespace/key"
+};
+
+// The busiest keys, names resolved in one iterator pass
+static uint8_t topHotKeys(HotKeyRow* rows, uint8_t max) {
+  uint8_t n = 0;
+  for (uint16_t i = 0; i < inspector_stats.tracked; i++) {
+    if (hot[i].changes == 0) continue;
+    uint8_t pos = n < max ? n++ : max;
+    while (pos > 0 && hot[rows[pos - 1].index].changes < hot[i].changes) {
+      if (pos < max) rows[pos] = rows[pos - 1];
+      pos--;
+    }
+    if (pos < max) rows[pos].index = i;
+  }
+  for (uint8_t r = 0; r < n; r++) strcpy(rows[r].name, "?");
+
+  forEachEntry([rows, n](const nvs_entry_info_t& info) {
+    uint32_t id = keyId(info);
+    for (uint8_t r = 0; r < n; r++) {
+      if (hot[rows[r].index].id == id) {
+        snprintf(rows[r].name, sizeof(rows[r].name), "%s/%s", info.namespace_name, info.key);
+      }
+    }
+  });
+  return n;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initNvsInspector() {
+  nvsHotKeySample();
+  timeSubscribe(TIME_EVENT_MINUTE, onMinute);
+  const NvsReport* r = nvsInspect();
+  Serial.printf("[NVS] %lu/%lu entries used, %u free pages, %u namespaces, %u keys\n",
+                (unsigned long)r->used_entries, (unsigned long)r->total_entries,
+                r->free_pages, r->namespaces, r->keys);
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const NvsInspectorStats* getNvsInspectorStats() {
+  return &inspector_stats;
+}
+
+void printNvsReport() {
+  const NvsReport* r = nvsInspect();
+  Serial.printf("[NVS] entries: %lu used, %lu free, %lu total (%u%%)\n",
+                (unsigned long)r->used_entries, (unsigned long)r->free_entries,
+                (unsigned long)r->total_entries,
+                r->total_entries ? (unsigned)(r->used_entries * 100 / r->total_entries) : 0);
+  Serial.printf("[NVS] pages: %u, %u free; %u namespaces, %u keys\n",
+                r->pages, r->free_pages, r->namespaces, r->keys);
+  for (uint8_t i = 0; i < r->page_count; i++) {
+    const NvsPageUsage& p = r->page[i];
+    Serial.printf("[NVS]   page %2u %-7s %3u used %3u erased %3u free\n",
+                  i, pageStateName(p.state), p.used, p.erased, p.free);
+  }
+  for (uint8_t i = 0; i < r->ns_count; i++) {
+    const NvsNamespaceUsage& u = r->ns[i];
+    Serial.printf("[NVS]   %-15s %3u keys %4u entries %6lu data bytes\n",
+                  u.name, u.keys, u.entries, (unsigned long)u.data_bytes);
+  }
+
+  // Exact counts from the write-behind cache, at any rate
+  const PersistStats* ps = getPersistStats();
+  uint32_t up_min = (millis() - ps->started_ms) / 60000;
+  Serial.printf("[NVS] records written (%lu min):", (unsigned long)up_min);
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) {
+    uint32_t rate10 = (uint64_t)ps->record_writes[i] * 600 / (up_min ? up_min : 1);
+    Serial.printf(" %s=%lu (%lu.%lu/h)", persistRecordName((PersistRecord)i),
+                  (unsigned long)ps->record_writes[i],
+                  (unsigned long)(rate10 / 10), (unsigned long)(rate10 % 10));
+  }
+  Serial.println();
+
+  const NvsInspectorStats& s = inspector_stats;
+  Serial.printf("[NVS] hot keys: %lu samples every %d min, %u tracked",
+                (unsigned long)s.samples, NVS_HOT_SAMPLE_MIN, s.tracked);
+  if (s.untracked) Serial.printf(", %u untracked (table full)", s.untracked);
+  Serial.printf(", sample max %lu us\n", (unsigned long)s.sample_max_us);
+
+  HotKeyRow rows[NVS_HOT_SHOW];
+  uint8_t n = topHotKeys(rows, NVS_HOT_SHOW);
+  for (uint8_t i = 0; i < n; i++) {
+    const HotKey& h = hot[rows[i].index];
+    uint32_t rate = hotRate10(h);
+    Serial.printf("[NVS]   %-32s %5u changes %2s%3lu.%lu/h%s\n", rows[i].name, h.changes,
+                  hotSaturated(h) ? ">=" : "",
+                  (unsigned long)(rate / 10), (unsigned long)(rate % 10),
+                  rate >= NVS_HOT_PER_HOUR * 10 ? " HOT" : "");
+  }
+  if (n == 0) Serial.println("[NVS]   no changes sampled yet");
+}
+
+// =============================================================================
+// SCREEN
+// =============================================================================
+
+void drawNvsInspectorScreen() {
+  const NvsReport* r = nvsInspect();
+
+  gfx->fillScreen(RGB565(2, 2, 5));
+  for (int y = 0; y < LCD_HEIGHT; y += 4) {
+    gfx->drawFastHLine(0, y, LCD_WIDTH, RGB565(4, 4, 7));
+  }
+
+  int centerX = LCD_WIDTH / 2;
+  uint16_t accent = RGB565(80, 200, 255);
+
+  // Header
+  int headerH = 55;
+  gfx->fillRect(0, 0, LCD_WIDTH, headerH, RGB565(10, 12, 18));
+  for (int x = 0; x < LCD_WIDTH; x += 8) {
+    gfx->fillRect(x, headerH - 3, 6, 3, accent);
+  }
+  gfx->setTextSize(3);
+  gfx->setTextColor(RGB565(30, 35, 50));
+  gfx->setCursor(centerX - 63 + 2, 14);
+  gfx->print("STORAGE");
+  gfx->setTextColor(accent);
+  gfx->setCursor(centerX - 63, 12);
+  gfx->print("STORAGE");
+
+  // Partition card
+  int cardY = headerH + 10;
+  uint8_t pct = r->total_entries ? r->used_entries * 100 / r->total_entries : 0;
+  uint16_t barColor = pct >= 90 ? RGB565(200, 60, 60)
+                    : pct >= 75 ? RGB565(255, 200, 60) : RGB565(0, 200, 80);
+  gfx->fillRect(20, cardY, LCD_WIDTH - 40, 80, RGB565(12, 14, 20));
+  gfx->drawRect(20, cardY, LCD_WIDTH - 40, 80, RGB565(40, 45, 60));
+  gfx->fillRect(20, cardY, 5, 5, accent);
+  gfx->setTextSize(2);
+  gfx->setTextColor(RGB565(200, 205, 220));
+  gfx->setCursor(35, cardY + 10);
+  gfx->printf("NVS %lu/%lu (%u%%)", (unsigned long)r->used_entries,
+              (unsigned long)r->total_entries, pct);
+  int barW = LCD_WIDTH - 70;
+  gfx->fillRect(35, cardY + 34, barW, 10, RGB565(25, 28, 38));
+  gfx->fillRect(35, cardY + 34, barW * pct / 100, 10, barColor);
+  gfx->setTextSize(1);
+  gfx->setTextColor(RGB565(130, 135, 150));
+  gfx->setCursor(35, cardY + 56);
+  gfx->printf("%u pages, %u free   %u namespaces, %u keys",
+              r->pages, r->free_pages, r->namespaces, r->keys);
+
+  // Namespaces, most entries first
+  int listY = cardY + 92;
+  int rows = min((int)r->ns_count, 10);
+  gfx->fillRect(20, listY, LCD_WIDTH - 40, 26 + rows * 16, RGB565(12, 14, 20));
+  gfx->drawRect(20, listY, LCD_WIDTH - 40, 26 + rows * 16, RGB565(40, 45, 60));
+  gfx->setTextColor(RGB565(130, 135, 150));
+  gfx->setCursor(35, listY + 8);
+  gfx->print("NAMESPACE        KEYS  ENTRIES   BYTES");
+  for (int i = 0; i < rows; i++) {
+    const NvsNamespaceUsage& u = r->ns[i];
+    gfx->setTextColor(RGB565(200, 205, 220));
+    gfx->setCursor(35, listY + 24 + i * 16);
+    gfx->printf("%-15s %5u %8u %7lu", u.name, u.keys, u.entries, (unsigned long)u.data_bytes);
+  }
+
+  // Hot keys
+  int hotY = listY + 36 + rows * 16;
+  HotKeyRow hot_rows[4];
+  uint8_t n = topHotKeys(hot_rows, 4);
+  gfx->setTextColor(accent);
+  gfx->setCursor(35, hotY);
+  gfx->printf("HOT KEYS (%lu samples)", (unsigned long)inspector_stats.samples);
+  for (uint8_t i = 0; i < n; i++) {
+    const HotKey& h = hot[hot_rows[i].index];
+    uint32_t rate = hotRate10(h);
+    gfx->setTextColor(rate >= NVS_HOT_PER_HOUR * 10 ? RGB565(255, 120, 60) : RGB565(200, 205, 220));
+    gfx->setCursor(35, hotY + 16 + i * 14);
+    gfx->printf("%-32s %s%lu.%lu/h", hot_rows[i].name, hotSaturated(h) ? ">=" : "",
+                (unsigned long)(rate / 10), (unsigned long)(rate % 10));
+  }
+  if (n == 0) {
+    gfx->setTextColor(RGB565(80, 85, 100));
+    gfx->setCursor(35, hotY + 16);
+    gfx->print("No changes sampled yet");
+  }
+
+  gfx->setTextColor(RGB565(80, 85, 100));
+  gfx->setCursor(35, LCD_HEIGHT - 40);
+  gfx->print("Tap to rescan");
+
+  drawSwipeIndicator();
+}
+
+void handleNvsInspectorTouch(TouchGesture& gesture) {
+  if (gesture.event == TOUCH_TAP) {
+    drawNvsInspectorScreen();
+  } else if (gesture.event == TOUCH_SWIPE_LEFT || gesture.event == TOUCH_SWIPE_DOWN) {
+    system_state.current_screen = SCREEN_SD_BACKUP;
+    showSDBackupMenu();
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * nvs_inspector.h - NVS Usage Inspector
+ * FUSION OS System Layer
+ *
+ * Most modules keep state in the NVS partition and nothing showed how
+ * full it was until a put failed. The inspector reports:
+ *
+ *   partition     used / free / total entries (nvs_get_stats), and per
+ *                 page its state and used / erased / free entries, read
+ *                 from the page headers; a free page is one never
+ *                 initialized, every entry free
+ *   namespaces    keys, 32-byte entries and string/blob bytes of each,
+ *                 from one pass of the entry iterator
+ *   records       writes of each write-behind record (persist.h), counted
+ *                 by the cache at every writer call - exact at any rate
+ *   hot keys      every NVS_HOT_SAMPLE_MIN minutes each value is read
+ *                 back in full and fingerprinted; a key whose fingerprint
+ *                 moved between samples was written in between. Keys
+ *                 changing NVS_HOT_PER_HOUR times an hour or more are
+ *                 flagged - they wear their pages and are the next
+ *                 candidates for the write-behind cache. Sampling sees at
+ *                 most one change per interval: a key that changed in
+ *                 every interval is shown as a lower bound (">=")
+ *
+ * Scattered key sets are repacked offline: the quests and habits
+ * namespaces are at schema v2, one blob per module, migrated once at boot
+ * by initSaveSchema() before anything opens them (save_schema.h).
+ *
+ * WIDGET_NVS prints the report; the STORAGE button on the backup menu
+ * shows it on SCREEN_NVS_INSPECTOR.
+ */
+
+#ifndef NVS_INSPECTOR_H
+#define NVS_INSPECTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define NVS_INSPECT_MAX_NS      24
+#define NVS_ENTRY_BYTES         32
+#define NVS_ENTRIES_PER_PAGE    126
+#define NVS_PAGE_BYTES          4096
+#define NVS_INSPECT_MAX_PAGES   32      // Per-page rows kept
+#define NVS_HOT_SAMPLE_MIN      10      // Minutes between value samples
+#define NVS_HOT_MAX_KEYS        160     // Fingerprint table
+#define NVS_HOT_PER_HOUR        3       // Changes per sampled hour to flag
+#define NVS_HOT_SHOW            8
+#define NVS_SAMPLE_BUF          512     // Larger values are read into the heap
+
+struct NvsNamespaceUsage {
+  char name[16];
+  uint16_t keys;
+  uint16_t entries;           // Including string/blob data entries
+  uint32_t data_bytes;        // String/blob payload
+};
+
+enum NvsPageState : uint8_t {
+  NVS_PAGE_EMPTY = 0,         // Never initialized: every entry free
+  NVS_PAGE_ACTIVE,            // Being written
+  NVS_PAGE_FULL,
+  NVS_PAGE_FREEING,           // Garbage collection moving it out
+  NVS_PAGE_CORRUPT
+};
+
+struct NvsPageUsage {
+  uint8_t state;              // NvsPageState
+  uint8_t used;               // Written entries
+  uint8_t erased;             // Stale entries until the page is reclaimed
+  uint8_t free;
+};
+
+struct NvsReport {
+  uint32_t used_entries;
+  uint32_t free_entries;
+  uint32_t total_entries;
+  uint16_t namespaces;
+  uint16_t pages;
+  uint16_t free_pages;        // NVS_PAGE_EMPTY pages
+  uint16_t keys;
+  uint8_t page_count;         // page[] rows, partition order
+  uint8_t ns_count;           // ns[] rows, most entries first
+  NvsPageUsage page[NVS_INSPECT_MAX_PAGES];
+  NvsNamespaceUsage ns[NVS_INSPECT_MAX_NS];
+};
+
+struct NvsInspectorStats {
+  uint32_t scans;
+  uint32_t samples;
+  uint32_t sample_max_us;
+  uint16_t tracked;           // Keys in the fingerprint table
+  uint16_t untracked;         // Seen with the table full
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// After initTimeService(): starts the hot-key samples
+void initNvsInspector();
+
+// Fresh scan; the report lives until the next call
+const NvsReport* nvsInspect();
+
+// One fingerprint pass (also run every NVS_HOT_SAMPLE_MIN minutes)
+void nvsHotKeySample();
+
+const NvsInspectorStats* getNvsInspectorStats();
+void printNvsReport();
+
+void drawNvsInspectorScreen();
+void handleNvsInspectorTouch(TouchGesture& gesture);
+
+#endif // NVS_INSPECTOR_H
@@ -0,0 +1,214 @@
+/*
+ * persist.cpp - Write-Behind Persistence Implementation
+ * FUSION OS System Layer
+ */
+
+#include "persist.h"
+#include "energy_monitor.h"
+#include "fuel_gauge.h"
+#include <esp_system.h>
+
+static PersistWriter writers[PERSIST_RECORD_COUNT] = {0};
+static uint32_t dirty_mask = 0;
+static unsigned long oldest_mark_ms = 0;     // Valid while dirty_mask != 0
+static uint16_t marks_pending = 0;
+static bool flushing = false;
+static bool stepping = false;                // persistFlushStep() pass open
+
+static PersistStats persist_stats = {0};
+
+static const char* const record_names[PERSIST_RECORD_COUNT] = {
+  "game", "xp", "steps", "quests", "gacha", "boss", "training", "story"
+};
+static const char* const reason_names[PERSIST_REASON_COUNT] = {
+  "age", "marks", "screen_off", "battery", "shutdown", "manual", "emergency"
+};
+
+static void shutdownFlush() {
+  persistFlush(PERSIST_REASON_SHUTDOWN);
+}
+
+static uint32_t maxAgeMs() {
+  switch (fuelGaugePolicy()) {
+    case FUEL_POLICY_CRITICAL: return 0;
+    case FUEL_POLICY_SAVER:    return PERSIST_SAVER_AGE_MS;
+    default:                   return PERSIST_MAX_AGE_MS;
+  }
+}
+
+// Due point inside the window; the rest is left for a quiet moment
+static uint32_t dueAgeMs(uint32_t limit) {
+  return limit / 100 * PERSIST_DUE_PCT;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initPersist() {
+  persist_stats.started_ms = millis();
+  // esp_restart() runs these before the reset - covers every ESP.restart()
+  esp_register_shutdown_handler(shutdownFlush);
+  Serial.printf("[PERSIST] Write-behind cache, %lu ms loss window\n",
+                (unsigned long)PERSIST_MAX_AGE_MS);
+}
+
+void persistSetWriter(PersistRecord rec, PersistWriter writer) {
+  if (rec < PERSIST_RECORD_COUNT) writers[rec] = writer;
+}
+
+// =============================================================================
+// MARKING
+// =============================================================================
+
+void persistMarkDirty(PersistRecord rec) {
+  if (rec >= PERSIST_RECORD_COUNT) return;
+  if (dirty_mask == 0) oldest_mark_ms = millis();
+  dirty_mask |= 1UL << rec;
+  marks_pending++;
+  persist_stats.marks++;
+  persist_stats.record_marks[rec]++;
+}
+
+bool persistIsDirty(PersistRecord rec) {
+  return rec < PERSIST_RECORD_COUNT && (dirty_mask & (1UL << rec));
+}
+
+// =============================================================================
+// FLUSH
+// =============================================================================
+
+void persistFlushMask(uint32_t mask, PersistReason reason) {
+  if (!(dirty_mask & mask) || flushing) return;
+  flushing = true;
+
+  uint32_t age = millis() - oldest_mark_ms;
+  if (age > persist_stats.max_age_ms) persist_stats.max_age_ms = age;
+
+  uint32_t pending = dirty_mask & mask;
+  dirty_mask &= ~mask;
+  if (dirty_mask == 0) {
+    marks_pending = 0;
+    stepping = false;
+  }
+  uint32_t written = 0;
+
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) {
+    if (!(pending & (1UL << i))) continue;
+    if (!writers[i]) {
+      // No writer yet: keep it for a later flush
+      if (dirty_mask == 0) oldest_mark_ms = millis();
+      dirty_mask |= 1UL << i;
+      continue;
+    }
+    writers[i]();
+    written++;
+    persist_stats.record_writes[i]++;
+  }
+
+  persist_stats.writes += written;
+  if (reason < PERSIST_REASON_COUNT) persist_stats.flushes[reason]++;
+  energyNoteWrite(ENERGY_STORE_NVS, written);
+  flushing = false;
+}
+
+void persistFlush(PersistReason reason) {
+  persistFlushMask(UINT32_MAX, reason);
+}
+
+bool persistFlushStep(PersistReason reason) {
+  if (flushing) return true;
+  int rec = -1;
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) {
+    if ((dirty_mask & (1UL << i)) && writers[i]) {
+      rec = i;
+      break;
+    }
+  }
+  if (rec < 0) {
+    // Only writer-less records left: restart their age like persistFlush()
+    if (dirty_mask != 0) oldest_mark_ms = millis();
+    marks_pending = 0;
+    stepping = false;
+    return false;
+  }
+
+  if (!stepping) {
+    stepping = true;
+    uint32_t age = millis() - oldest_mark_ms;
+    if (age > persist_stats.max_age_ms) persist_stats.max_age_ms = age;
+    if (reason < PERSIST_REASON_COUNT) persist_stats.flushes[reason]++;
+    marks_pending = 0;
+  }
+
+  // Cleared first: a mark made by the writer itself stays for the next step
+  flushing = true;
+  dirty_mask &= ~(1UL << rec);
+  writers[rec]();
+  flushing = false;
+  if (dirty_mask == 0) stepping = false;
+  persist_stats.writes++;
+  persist_stats.record_writes[rec]++;
+  energyNoteWrite(ENERGY_STORE_NVS);
+  return true;
+}
+
+// =============================================================================
+// POLICY
+// =============================================================================
+
+PersistReason persistDueReason() {
+  if (dirty_mask == 0) return PERSIST_REASON_COUNT;
+  if (stepping) return PERSIST_REASON_AGE;     // Finish the open pass
+  uint32_t limit = maxAgeMs();
+  if (marks_pending >= PERSIST_MAX_MARKS) return PERSIST_REASON_MARKS;
+  if (millis() - oldest_mark_ms >= dueAgeMs(limit)) {
+    return limit < PERSIST_MAX_AGE_MS ? PERSIST_REASON_BATTERY : PERSIST_REASON_AGE;
+  }
+  return PERSIST_REASON_COUNT;
+}
+
+uint32_t persistMsUntilFlush() {
+  if (dirty_mask == 0) return UINT32_MAX;
+  uint32_t age = millis() - oldest_mark_ms;
+  uint32_t due = dueAgeMs(maxAgeMs());
+  return age >= due ? 0 : due - age;
+}
+
+uint32_t persistMsUntilOverdue() {
+  if (dirty_mask == 0) return UINT32_MAX;
+  uint32_t age = millis() - oldest_mark_ms;
+  uint32_t limit = maxAgeMs();
+  return age >= limit ? 0 : limit - age;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const PersistStats* getPersistStats() {
+  return &persist_stats;
+}
+
+const char* persistRecordName(PersistRecord rec) {
+  return rec < PERSIST_RECORD_COUNT ? record_names[rec] : "?";
+}
+
+void printPersistStats() {
+  const PersistStats& s = persist_stats;
+  float hours = (millis() - s.started_ms) / 3600000.0f;
+  Serial.printf("[PERSIST] marks=%lu writes=%lu (%.1f/h) dirty=0x%02lx max age %lu ms\n",
+                (unsigned long)s.marks, (unsigned long)s.writes,
+                hours > 0 ? s.writes / hours : 0.0f, (unsigned long)dirty_mask,
+                (unsigned long)s.max_age_ms);
+  Serial.printf("[PERSIST] flushes:");
+  for (int i = 0; i < PERSIST_REASON_COUNT; i++) {
+    Serial.printf(" %s=%lu", reason_names[i], (unsigned long)s.flushes[i]);
+  }
+  Serial.printf("\n[PERSIST] marks/writes:");
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) {
+    Serial.printf(" %s=%lu/%lu", record_names[i],
+                  (unsigned long)s.record_marks[i], (unsigned long)s.record_writes[i]);
+  }
+  Serial.println();
+}
@@ -0,0 +1,114 @@
+/*
+ * persist.h - Write-Behind Persistence
+ * FUSION OS System Layer
+ *
+ * Gameplay counters change far more often than they need to reach flash:
+ * every XP gain, every 100 steps and every quest tick used to run a full
+ * Preferences save, and Preferences commits each key on its own. Modules
+ * now change their RAM records and call persistMarkDirty(); the record's
+ * writer (its existing save*() function) runs once for any number of
+ * marks, when the flush policy says so:
+ *
+ *   age        oldest mark older than PERSIST_DUE_PCT of PERSIST_MAX_AGE_MS
+ *              (or of the battery window)
+ *   marks      PERSIST_MAX_MARKS marks since the last flush
+ *   screen-off the user put the watch down
+ *   battery    saver shortens the window, critical flushes at once
+ *   shutdown   esp_restart() (theme switch, backup restore)
+ *
+ * The age / marks / battery flushes are driven by save_scheduler.cpp, one
+ * record per step, so a flush due in the middle of a game waits for a
+ * quiet moment and is spread over several loop passes. That wait ends when
+ * the oldest mark reaches the full window (persistMsUntilOverdue()), so
+ * PERSIST_MAX_AGE_MS, not the scheduler's SAVE_MAX_DEFER_MS, bounds what a
+ * crash or watchdog reset can lose.
+ *
+ * Saves that must land before something else happens (migration, restore
+ * before reboot) still call their writer directly.
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define PERSIST_MAX_AGE_MS      60000   // Loss window: never deferred past it
+#define PERSIST_SAVER_AGE_MS    10000   // Window with the battery low
+#define PERSIST_DUE_PCT         75      // Age flush due at this much of the window
+#define PERSIST_MAX_MARKS       64      // Marks before a forced flush
+
+enum PersistRecord : uint8_t {
+  PERSIST_GAME = 0,           // saveAllGameData: universal + per-theme economy
+  PERSIST_XP,
+  PERSIST_STEPS,
+  PERSIST_QUESTS,
+  PERSIST_GACHA,
+  PERSIST_BOSS,
+  PERSIST_TRAINING,
+  PERSIST_STORY,
+  PERSIST_RECORD_COUNT
+};
+
+enum PersistReason : uint8_t {
+  PERSIST_REASON_AGE = 0,
+  PERSIST_REASON_MARKS,
+  PERSIST_REASON_SCREEN_OFF,
+  PERSIST_REASON_BATTERY,
+  PERSIST_REASON_SHUTDOWN,
+  PERSIST_REASON_MANUAL,      // Autosave / serial command
+  PERSIST_REASON_EMERGENCY,   // PMU low-battery warning: NVS records only
+  PERSIST_REASON_COUNT
+};
+
+typedef void (*PersistWriter)();
+
+struct PersistStats {
+  uint32_t marks;
+  uint32_t writes;            // Writer calls
+  uint32_t flushes[PERSIST_REASON_COUNT];
+  uint32_t record_marks[PERSIST_RECORD_COUNT];
+  uint32_t record_writes[PERSIST_RECORD_COUNT];
+  uint32_t max_age_ms;        // Oldest dirty mark at flush time
+  uint32_t started_ms;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Early in setup, before any module can mark a record
+void initPersist();
+
+// Records marked before their writer is set stay dirty until it is
+void persistSetWriter(PersistRecord rec, PersistWriter writer);
+
+void persistMarkDirty(PersistRecord rec);
+bool persistIsDirty(PersistRecord rec);
+
+// Write every dirty record now
+void persistFlush(PersistReason reason);
+
+// Write the dirty records in `mask` (1 << PersistRecord) now
+void persistFlushMask(uint32_t mask, PersistReason reason);
+
+// Write one dirty record; false once none is left. The steps of one
+// flush count once, under the reason of the first step.
+bool persistFlushStep(PersistReason reason);
+
+// Age / marks / battery policy: the reason a flush is due, or
+// PERSIST_REASON_COUNT when none is
+PersistReason persistDueReason();
+uint32_t persistMsUntilFlush();
+
+// ms until the oldest mark reaches the loss window (0 = overdue, must not
+// wait for a quiet moment any longer; UINT32_MAX when nothing is dirty)
+uint32_t persistMsUntilOverdue();
+
+const PersistStats* getPersistStats();
+const char* persistRecordName(PersistRecord rec);
+void printPersistStats();
+
+#endif // PERSIST_H
@@ -6,6 +6,9 @@
 #include "power_manager.h"
 #include "display.h"  // For Arduino_CO5300 type definition
 #include "config.h"
+#include "energy_monitor.h"
+#include "dvfs_governor.h"
+#include "fuel_gauge.h"
 #include <esp32-hal-cpu.h>
 
 extern Arduino_CO5300 *gfx;
@@ -23,6 +26,21 @@ PowerManagerState power_manager = {
   .needs_redraw = false
 };
 
+// Panel brightness, mirrored into the energy model
+static void setPanelBrightness(int level) {
+  gfx->setBrightness(level);
+  energyNoteBrightness(level);
+}
+
+// Power saver was switched on by the fuel gauge, not the user
+static bool auto_saver = false;
+
+// The gauge policy acts on transitions only; a saver toggle by the user
+// while a policy is active holds until the policy changes again
+static FuelPolicy applied_policy = FUEL_POLICY_NORMAL;
+static bool policy_overridden = false;
+static bool critical_dimmed = false;      // Applied once per entry / screen-on
+
 static AnimationState animation_state = {
   .enabled = true,
   .constant_animation = false,
@@ -61,6 +79,7 @@ void initPowerManager() {
 void recordInteraction() {
   unsigned long now = millis();
   power_manager.last_interaction = now;
+  dvfsBoost();
   
   // If we were in a low-power state, transition back to ACTIVE
   if (power_manager.current_state != POWER_ACTIVE) {
@@ -72,12 +91,9 @@ void recordInteraction() {
     
     // Restore brightness
     if (screenOn) {
-      gfx->setBrightness(power_manager.original_brightness);
+      setPanelBrightness(power_manager.original_brightness);
     }
     
-    // Restore CPU frequency
-    setCpuFrequencyMhz(CPU_FREQ_ACTIVE);
-    
     // Trigger wake animation burst
     triggerAnimationBurst(300);
     
@@ -92,14 +108,41 @@ void updatePowerState() {
   // Don't manage power if screen is off
   if (!screenOn) {
     power_manager.current_state = POWER_SCREEN_OFF;
+    critical_dimmed = false;    // Screen-on restores the user brightness
     return;
   }
   
-  // === POWER SAVER MODE ===
-  // Auto-enable power saver at 20% battery
-  if (system_state.battery_percentage <= 20 && !system_state.power_saver_enabled) {
-    system_state.power_saver_enabled = true;
-    Serial.println("[POWER] Auto power saver: battery <= 20%");
+  // === FUEL-GAUGE POLICY ===
+  // On a policy change only: saver is switched on by the gauge and, if it
+  // was, off again on charge
+  FuelPolicy policy = fuelGaugePolicy();
+  if (policy != applied_policy) {
+    applied_policy = policy;
+    policy_overridden = false;
+    critical_dimmed = false;
+    if (policy != FUEL_POLICY_NORMAL && !system_state.power_saver_enabled) {
+      system_state.power_saver_enabled = true;
+      auto_saver = true;
+      Serial.printf("[POWER] Auto power saver: %s\n", fuelPolicyName(policy));
+    } else if (policy == FUEL_POLICY_NORMAL && auto_saver) {
+      togglePowerSaver();
+    }
+  }
+  
+  if (policy == FUEL_POLICY_CRITICAL && !policy_overridden) {
+    // CRITICAL: dim, slow and capped - keep the watch alive
+    power_manager.current_state = POWER_DIMMED;
+    power_manager.current_delay = FPS_DIMMED;
+    power_manager.sensor_poll_interval = SENSOR_POLL_IDLE;
+    power_manager.animations_active = false;
+    if (!critical_dimmed) {
+      int dimBrightness = power_manager.original_brightness / 4;
+      if (dimBrightness < 20) dimBrightness = 20;
+      setPanelBrightness(dimBrightness);
+      critical_dimmed = true;
+    }
+    dvfsSetCeiling(CPU_FREQ_DIMMED);
+    return;
   }
   
   if (system_state.power_saver_enabled) {
@@ -113,11 +156,11 @@ void updatePowerState() {
     if (screenOn) {
       int dimBrightness = power_manager.original_brightness / 2;
       if (dimBrightness < 30) dimBrightness = 30;  // Minimum visible
-      gfx->setBrightness(dimBrightness);
+      setPanelBrightness(dimBrightness);
     }
     
-    // Lower CPU frequency
-    setCpuFrequencyMhz(CPU_FREQ_IDLE);  // 160 MHz instead of 240
+    // Cap the governor
+    dvfsSetCeiling(CPU_FREQ_IDLE);  // 160 MHz instead of 240
     return;
   }
   
@@ -126,6 +169,7 @@ void updatePowerState() {
   power_manager.current_delay = FPS_ACTIVE;
   power_manager.sensor_poll_interval = SENSOR_POLL_ACTIVE;
   power_manager.animations_active = true;
+  dvfsSetCeiling(CPU_FREQ_ACTIVE);
 }
 
 // =============================================================================
@@ -139,27 +183,9 @@ int getPowerLoopDelay() {
 // APPLY CPU FREQUENCY SCALING
 // =============================================================================
 void applyCPUFrequency() {
-  int target_freq;
-  
-  switch (power_manager.current_state) {
-    case POWER_ACTIVE:
-      target_freq = CPU_FREQ_ACTIVE;
-      break;
-    case POWER_IDLE:
-      target_freq = CPU_FREQ_IDLE;
-      break;
-    case POWER_DIMMED:
-      target_freq = CPU_FREQ_DIMMED;
-      break;
-    case POWER_MINIMAL:
-    case POWER_SCREEN_OFF:
-      target_freq = CPU_FREQ_MINIMAL;
-      break;
-    default:
-      target_freq = CPU_FREQ_ACTIVE;
-  }
-  
-  setCpuFrequencyMhz(target_freq);
+  // Frequency follows measured frame work (dvfs_governor); the power state
+  // only moves the ceiling, which updatePowerState() already maintains
+  dvfsUpdateLimits();
 }
 
 // =============================================================================
@@ -188,7 +214,7 @@ void applyBrightnessDimming() {
       target_brightness = power_manager.original_brightness;
   }
   
-  gfx->setBrightness(target_brightness);
+  setPanelBrightness(target_brightness);
 }
 
 // =============================================================================
@@ -234,9 +260,9 @@ void forceActiveState() {
     power_manager.current_delay = FPS_ACTIVE;
     power_manager.animations_active = true;
     
-    setCpuFrequencyMhz(CPU_FREQ_ACTIVE);
+    dvfsBoost();
     if (screenOn) {
-      gfx->setBrightness(power_manager.original_brightness);
+      setPanelBrightness(power_manager.original_brightness);
     }
   }
 }
@@ -279,6 +305,9 @@ const char* getPowerStateName(PowerState state) {
 // POWER SAVER MODE TOGGLE
 // =============================================================================
 void togglePowerSaver() {
+  auto_saver = false;
+  // A user toggle under an active gauge policy wins until the policy moves
+  policy_overridden = applied_policy != FUEL_POLICY_NORMAL;
   system_state.power_saver_enabled = !system_state.power_saver_enabled;
   
   if (system_state.power_saver_enabled) {
@@ -289,9 +318,9 @@ void togglePowerSaver() {
     power_manager.current_state = POWER_ACTIVE;
     power_manager.current_delay = FPS_ACTIVE;
     power_manager.animations_active = true;
-    setCpuFrequencyMhz(CPU_FREQ_ACTIVE);
+    dvfsSetCeiling(CPU_FREQ_ACTIVE);
     if (screenOn) {
-      gfx->setBrightness(power_manager.original_brightness);
+      setPanelBrightness(power_manager.original_brightness);
     }
   }
 }
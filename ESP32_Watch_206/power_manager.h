@@ -7,7 +7,7 @@
  * Features:
  * - Smart Idle Engine (5s/10s/15s thresholds)
  * - Adaptive FPS (60/30/15/1 FPS based on activity)
- * - CPU Frequency Scaling (240/160/80/40 MHz)
+ * - CPU Frequency: frame-budget governor (dvfs_governor.h)
  * - Brightness Auto-Dim
  * - Moment-Based Animations
  * - Smart Sensor Polling
@@ -107,7 +107,7 @@ void recordInteraction();
 // Get appropriate loop delay for current power state
 int getPowerLoopDelay();
 
-// Apply CPU frequency scaling
+// Re-apply the governor's limits (frequency itself is set by dvfs_governor)
 void applyCPUFrequency();
 
 // Apply brightness dimming
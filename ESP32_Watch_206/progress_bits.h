@@ -0,0 +1,36 @@
+/*
+ * progress_bits.h - Packed Progress Bitsets
+ * FUSION OS System Layer
+ *
+ * Unlock/defeat/claim flags stored one bit each. Used by the story and
+ * Boss Rush save blobs, which go to NVS with a single putBytes instead of
+ * one Preferences key per flag. No Arduino dependencies.
+ */
+
+#ifndef PROGRESS_BITS_H
+#define PROGRESS_BITS_H
+
+#include <stdint.h>
+
+#define PROGRESS_BITS_BYTES(n)  (((n) + 7) / 8)
+
+static inline bool progressBitGet(const uint8_t* bits, uint16_t i) {
+  return (bits[i >> 3] >> (i & 7)) & 1;
+}
+
+static inline void progressBitSet(uint8_t* bits, uint16_t i, bool v) {
+  if (v) bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+  else   bits[i >> 3] &= (uint8_t)~(1 << (i & 7));
+}
+
+static inline uint16_t progressBitCount(const uint8_t* bits, uint16_t n) {
+  uint16_t c = 0;
+  for (uint16_t i = 0; i < PROGRESS_BITS_BYTES(n); i++) {
+    uint8_t b = bits[i];
+    if (i == n >> 3) b &= (uint8_t)((1 << (n & 7)) - 1);  // Partial last byte
+    c += __builtin_popcount(b);
+  }
+  return c;
+}
+
+#endif // PROGRESS_BITS_H
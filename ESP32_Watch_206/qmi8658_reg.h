@@ -0,0 +1,163 @@
+/*
+ * qmi8658_reg.h - QMI8658 IMU Register Map
+ * 6-axis accelerometer + gyroscope (QST), I2C address 0x6B
+ */
+
+#pragma once
+
+/*
+ *   QMI8658_REGISTER NAME                REGISTER ADDRESS
+ */
+#define QMI8658_WHO_AM_I                0x00 /* device id, reads 0x05 */
+#define QMI8658_REVISION_ID             0x01
+
+/*
+ * Setup and Control
+ */
+#define QMI8658_CTRL1                   0x02 /* serial interface, address auto-increment, INT pin enable */
+#define QMI8658_CTRL2                   0x03 /* accel self-test, full scale, ODR */
+#define QMI8658_CTRL3                   0x04 /* gyro self-test, full scale, ODR */
+#define QMI8658_CTRL5                   0x06 /* low pass filter */
+#define QMI8658_CTRL7                   0x08 /* sensor enable */
+#define QMI8658_CTRL8                   0x09 /* motion detection / pedometer enable */
+#define QMI8658_CTRL9                   0x0A /* host command register */
+
+/*
+ * Host controlled calibration (CTRL9 command parameters)
+ */
+#define QMI8658_CAL1_L                  0x0B
+#define QMI8658_CAL1_H                  0x0C
+#define QMI8658_CAL2_L                  0x0D
+#define QMI8658_CAL2_H                  0x0E
+#define QMI8658_CAL3_L                  0x0F
+#define QMI8658_CAL3_H                  0x10
+#define QMI8658_CAL4_L                  0x11
+#define QMI8658_CAL4_H                  0x12
+
+/*
+ * FIFO
+ */
+#define QMI8658_FIFO_WTM_TH             0x13 /* watermark, in ODR sample sets */
+#define QMI8658_FIFO_CTRL               0x14 /* mode, size, read mode */
+#define QMI8658_FIFO_SMPL_CNT           0x15 /* sample count LSB (x2 = bytes) */
+#define QMI8658_FIFO_STATUS             0x16 /* full / watermark / overflow flags, count MSB */
+#define QMI8658_FIFO_DATA               0x17 /* data port - does not auto-increment */
+
+/*
+ * Status
+ */
+#define QMI8658_STATUS_INT              0x2D /* CTRL9 command done, data locked / available */
+#define QMI8658_STATUS0                 0x2E /* accel / gyro data available */
+#define QMI8658_STATUS1                 0x2F /* motion engine events */
+
+/*
+ * Data output
+ */
+#define QMI8658_TIMESTAMP_L             0x30
+#define QMI8658_TEMP_L                  0x33
+#define QMI8658_AX_L                    0x35 /* AX..GZ: 12 bytes, little-endian */
+#define QMI8658_GX_L                    0x3B
+#define QMI8658_TAP_STATUS              0x59
+#define QMI8658_STEP_CNT_L              0x5A /* 24-bit step count, 3 bytes */
+#define QMI8658_RESET                   0x60 /* write 0xB0 for soft reset */
+
+/*
+ * CTRL1 bits
+ */
+#define QMI8658_CTRL1_ADDR_AI           0x40 /* register address auto-increment */
+#define QMI8658_CTRL1_BE                0x20 /* big-endian data (we use little-endian) */
+#define QMI8658_CTRL1_INT2_EN           0x10
+#define QMI8658_CTRL1_INT1_EN           0x08
+#define QMI8658_CTRL1_FIFO_INT1         0x04 /* route FIFO interrupt to INT1 instead of INT2 */
+
+/*
+ * CTRL2 / CTRL3 full scale (bits 6:4) and ODR (bits 3:0)
+ */
+#define QMI8658_ACC_FS_2G               0x00
+#define QMI8658_ACC_FS_4G               0x10
+#define QMI8658_ACC_FS_8G               0x20
+#define QMI8658_ACC_FS_16G              0x30
+#define QMI8658_GYR_FS_256DPS           0x40
+#define QMI8658_GYR_FS_512DPS           0x50
+#define QMI8658_GYR_FS_1024DPS          0x60
+
+#define QMI8658_ODR_112HZ               0x06 /* 6-axis mode rates */
+#define QMI8658_ODR_56HZ                0x07
+#define QMI8658_ODR_28HZ                0x08
+#define QMI8658_ODR_LP_128HZ            0x0C /* accel-only low power rates */
+#define QMI8658_ODR_LP_21HZ             0x0D
+#define QMI8658_ODR_LP_11HZ             0x0E
+#define QMI8658_ODR_LP_3HZ              0x0F
+
+/*
+ * CTRL7 bits
+ */
+#define QMI8658_CTRL7_ACC_EN            0x01
+#define QMI8658_CTRL7_GYR_EN            0x02
+
+/*
+ * CTRL8 bits
+ */
+#define QMI8658_CTRL8_HANDSHAKE_STATUS  0x80 /* CTRL9 handshake via STATUS_INT instead of INT1 */
+#define QMI8658_CTRL8_ACTIVITY_INT1     0x40 /* motion engine interrupts on INT1 instead of INT2 */
+#define QMI8658_CTRL8_PEDO_EN           0x10
+#define QMI8658_CTRL8_SIG_MOTION_EN     0x08
+#define QMI8658_CTRL8_NO_MOTION_EN      0x04
+#define QMI8658_CTRL8_ANY_MOTION_EN     0x02
+#define QMI8658_CTRL8_TAP_EN            0x01
+
+/*
+ * FIFO_CTRL / FIFO_STATUS bits
+ */
+#define QMI8658_FIFO_MODE_BYPASS        0x00
+#define QMI8658_FIFO_MODE_FIFO          0x01
+#define QMI8658_FIFO_MODE_STREAM        0x02
+#define QMI8658_FIFO_SIZE_16            0x00
+#define QMI8658_FIFO_SIZE_32            0x04
+#define QMI8658_FIFO_SIZE_64            0x08
+#define QMI8658_FIFO_SIZE_128           0x0C
+#define QMI8658_FIFO_RD_MODE            0x80
+
+#define QMI8658_FIFO_STATUS_FULL        0x80
+#define QMI8658_FIFO_STATUS_WTM         0x40
+#define QMI8658_FIFO_STATUS_OVERFLOW    0x20
+#define QMI8658_FIFO_STATUS_NOT_EMPTY   0x10
+
+/*
+ * STATUS_INT / STATUS1 bits
+ */
+#define QMI8658_STATUS_INT_CMD_DONE     0x80
+#define QMI8658_STATUS1_SIG_MOTION      0x80
+#define QMI8658_STATUS1_NO_MOTION       0x40
+#define QMI8658_STATUS1_ANY_MOTION      0x20
+#define QMI8658_STATUS1_PEDOMETER       0x10
+#define QMI8658_STATUS1_WOM             0x04
+#define QMI8658_STATUS1_TAP             0x02
+
+/*
+ * Motion engine mode (CAL4_L of the first CONFIGURE_MOTION pass)
+ */
+#define QMI8658_MOTION_ANY_X            0x01
+#define QMI8658_MOTION_ANY_Y            0x02
+#define QMI8658_MOTION_ANY_Z            0x04
+#define QMI8658_MOTION_ANY_AND          0x08 /* all enabled axes must exceed (default: any) */
+
+/*
+ * CTRL9 host commands
+ */
+#define QMI8658_CMD_ACK                 0x00
+#define QMI8658_CMD_RST_FIFO            0x04
+#define QMI8658_CMD_REQ_FIFO            0x05
+#define QMI8658_CMD_WRITE_WOM_SETTING   0x08
+#define QMI8658_CMD_CONFIGURE_TAP       0x0C
+#define QMI8658_CMD_CONFIGURE_PEDOMETER 0x0D
+#define QMI8658_CMD_CONFIGURE_MOTION    0x0E
+#define QMI8658_CMD_RESET_PEDOMETER     0x0F
+
+/*
+ * CTRL9 command as reg_sequence table entries: write, wait for CmdDone, ACK
+ */
+#define QMI8658_SEQ_CMD(cmd) \
+  REG_COMMAND(QMI8658_CTRL9, cmd), \
+  REG_POLL(QMI8658_STATUS_INT, QMI8658_STATUS_INT_CMD_DONE, QMI8658_STATUS_INT_CMD_DONE, 20), \
+  REG_COMMAND(QMI8658_CTRL9, QMI8658_CMD_ACK)
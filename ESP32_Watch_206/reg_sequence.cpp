@@ -0,0 +1,164 @@
+/*
+ * reg_sequence.cpp - Table-Driven Register Programming Implementation
+ * FUSION OS Hardware Layer
+ */
+
+#include "reg_sequence.h"
+#include "i2c_bus.h"
+
+// =============================================================================
+// BURST WRITE + VERIFY
+// =============================================================================
+
+// Length of the run of plain writes starting at `start` that can share one
+// transaction: contiguous registers, no settle delay before the last one.
+// A command write stands alone: CTRL9's ACK (0x0A) must not run into the
+// next pass's CAL1_L (0x0B).
+static int burstLength(const RegSequence& seq, int start) {
+  int len = 1;
+  if (!seq.burst || seq.entries[start].op != REG_OP_WRITE) return len;
+  while (start + len < seq.count && len < REG_SEQ_MAX_BURST) {
+    const RegSeqEntry& prev = seq.entries[start + len - 1];
+    const RegSeqEntry& next = seq.entries[start + len];
+    if (prev.delay_ms != 0) break;
+    if (next.op != REG_OP_WRITE || next.reg != prev.reg + 1) break;
+    len++;
+  }
+  return len;
+}
+
+static bool writeAndVerify(const RegSequence& seq, int start, int len, RegSeqResult& res) {
+  uint8_t data[REG_SEQ_MAX_BURST];
+  uint8_t readback[REG_SEQ_MAX_BURST];
+  bool needs_verify = false;
+
+  for (int i = 0; i < len; i++) {
+    data[i] = seq.entries[start + i].value;
+    if (seq.entries[start + i].verify_mask) needs_verify = true;
+  }
+  uint8_t first_reg = seq.entries[start].reg;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    res.i2c_writes++;
+    if (!i2cWriteRegs(seq.addr, first_reg, data, len)) {
+      Serial.printf("[REGSEQ] %s: write 0x%02X (+%d) failed\n", seq.name, first_reg, len - 1);
+      return false;
+    }
+
+    uint16_t settle = seq.entries[start + len - 1].delay_ms;
+    if (settle) delay(settle);
+
+    if (!needs_verify) return true;
+
+    if (!i2cReadRegs(seq.addr, first_reg, readback, len)) {
+      Serial.printf("[REGSEQ] %s: read-back 0x%02X failed\n", seq.name, first_reg);
+      return false;
+    }
+
+    int bad = -1;
+    for (int i = 0; i < len; i++) {
+      uint8_t mask = seq.entries[start + i].verify_mask;
+      if ((readback[i] & mask) != (data[i] & mask)) { bad = i; break; }
+    }
+    if (bad < 0) {
+      for (int i = 0; i < len; i++) {
+        if (seq.entries[start + i].verify_mask) res.verified++;
+      }
+      return true;
+    }
+
+    res.verify_failures++;
+    Serial.printf("[REGSEQ] %s: reg 0x%02X wrote 0x%02X read 0x%02X%s\n",
+                  seq.name, first_reg + bad, data[bad], readback[bad],
+                  attempt == 0 ? " - retrying" : "");
+  }
+  return false;
+}
+
+// =============================================================================
+// SINGLE-REGISTER OPS
+// =============================================================================
+
+static bool modifyBits(const RegSequence& seq, const RegSeqEntry& e, RegSeqResult& res) {
+  uint8_t value = 0;
+  if (!i2cReadReg(seq.addr, e.reg, &value)) return false;
+
+  uint8_t target = (e.op == REG_OP_SET_BITS) ? (value | e.value) : (value & ~e.value);
+  if (target != value) {
+    res.i2c_writes++;
+    if (!i2cWriteReg(seq.addr, e.reg, target)) return false;
+    if (e.delay_ms) delay(e.delay_ms);
+  }
+
+  uint8_t check = 0;
+  if (!i2cReadReg(seq.addr, e.reg, &check)) return false;
+  if ((check & e.verify_mask) != (target & e.verify_mask)) {
+    res.verify_failures++;
+    Serial.printf("[REGSEQ] %s: reg 0x%02X expected 0x%02X read 0x%02X\n",
+                  seq.name, e.reg, target, check);
+    return false;
+  }
+  res.verified++;
+  return true;
+}
+
+static bool pollRegister(const RegSequence& seq, const RegSeqEntry& e) {
+  unsigned long start = millis();
+  do {
+    uint8_t value = 0;
+    if (i2cReadReg(seq.addr, e.reg, &value) && (value & e.verify_mask) == e.value) {
+      return true;
+    }
+    delayMicroseconds(200);
+  } while (millis() - start < e.delay_ms);
+
+  Serial.printf("[REGSEQ] %s: poll 0x%02X timed out after %d ms\n", seq.name, e.reg, e.delay_ms);
+  return false;
+}
+
+// =============================================================================
+// EXECUTOR
+// =============================================================================
+
+bool runRegSequence(const RegSequence& seq, RegSeqResult* result) {
+  RegSeqResult res = {false, 0, 0, 0, 0, 0};
+  unsigned long start_us = micros();
+
+  if (!i2cBusLock()) {
+    if (result) *result = res;
+    return false;
+  }
+
+  bool ok = true;
+  int i = 0;
+  while (ok && i < seq.count) {
+    const RegSeqEntry& e = seq.entries[i];
+
+    if (e.op == REG_OP_WRITE || e.op == REG_OP_COMMAND) {
+      int len = burstLength(seq, i);
+      ok = writeAndVerify(seq, i, len, res);
+      res.registers += len;
+      i += len;
+      continue;
+    }
+
+    if (e.op == REG_OP_POLL) {
+      ok = pollRegister(seq, e);
+    } else {
+      ok = modifyBits(seq, e, res);
+      res.registers++;
+    }
+    i++;
+  }
+
+  i2cBusUnlock();
+
+  res.ok = ok;
+  res.elapsed_us = micros() - start_us;
+  if (result) *result = res;
+
+  Serial.printf("[REGSEQ] %s: %s - %d regs in %d writes, %d verified, %lu us\n",
+                seq.name, ok ? "OK" : "FAILED", res.registers, res.i2c_writes,
+                res.verified, (unsigned long)res.elapsed_us);
+  return ok;
+}
@@ -0,0 +1,77 @@
+/*
+ * reg_sequence.h - Table-Driven Register Programming
+ * FUSION OS Hardware Layer
+ *
+ * Chip bring-up is written as a const table of (register, value, verify
+ * mask, delay) entries instead of hand-rolled Wire blocks. The executor:
+ * - merges writes to contiguous registers into one burst transaction
+ *   (REG_COMMAND entries - command and ACK writes - are never merged)
+ * - reads every verified register back and retries a mismatching burst once
+ * - supports read-modify-write and poll-until entries (CTRL9 handshakes)
+ * - holds the shared I2C bus for the whole sequence
+ */
+
+#ifndef REG_SEQUENCE_H
+#define REG_SEQUENCE_H
+
+#include <Arduino.h>
+
+#define REG_SEQ_MAX_BURST   16      // Registers merged into one write
+
+// =============================================================================
+// TABLE FORMAT
+// =============================================================================
+enum RegSeqOp : uint8_t {
+  REG_OP_WRITE = 0,     // reg = value (burst-merged with contiguous neighbours)
+  REG_OP_SET_BITS,      // reg |= value
+  REG_OP_CLEAR_BITS,    // reg &= ~value
+  REG_OP_POLL,          // wait until (reg & verify_mask) == value, delay_ms = timeout
+  REG_OP_COMMAND        // reg = value in a transaction of its own (handshakes)
+};
+
+struct RegSeqEntry {
+  uint8_t op;
+  uint8_t reg;
+  uint8_t value;
+  uint8_t verify_mask;  // Bits compared on read-back (0 = write-only register)
+  uint16_t delay_ms;    // Settle time after the write (ends a burst)
+};
+
+struct RegSequence {
+  const char* name;
+  uint8_t addr;
+  const RegSeqEntry* entries;
+  uint8_t count;
+  bool burst;           // Device auto-increments its register pointer
+};
+
+struct RegSeqResult {
+  bool ok;
+  uint16_t registers;
+  uint16_t i2c_writes;
+  uint16_t verified;
+  uint16_t verify_failures;
+  uint32_t elapsed_us;
+};
+
+// Table helpers
+#define REG_WRITE(r, v)             { REG_OP_WRITE, (uint8_t)(r), (uint8_t)(v), 0xFF, 0 }
+#define REG_WRITE_MASK(r, v, m)     { REG_OP_WRITE, (uint8_t)(r), (uint8_t)(v), (uint8_t)(m), 0 }
+#define REG_WRITE_ONLY(r, v)        { REG_OP_WRITE, (uint8_t)(r), (uint8_t)(v), 0x00, 0 }
+#define REG_WRITE_DELAY(r, v, ms)   { REG_OP_WRITE, (uint8_t)(r), (uint8_t)(v), 0xFF, (ms) }
+#define REG_SET_BITS(r, bits)       { REG_OP_SET_BITS, (uint8_t)(r), (uint8_t)(bits), (uint8_t)(bits), 0 }
+#define REG_CLEAR_BITS(r, bits)     { REG_OP_CLEAR_BITS, (uint8_t)(r), (uint8_t)(bits), (uint8_t)(bits), 0 }
+#define REG_POLL(r, m, v, tmo_ms)   { REG_OP_POLL, (uint8_t)(r), (uint8_t)(v), (uint8_t)(m), (tmo_ms) }
+#define REG_COMMAND(r, v)           { REG_OP_COMMAND, (uint8_t)(r), (uint8_t)(v), 0x00, 0 }
+
+#define REG_SEQ(name, addr, table, burst) \
+  { (name), (addr), (table), (uint8_t)(sizeof(table) / sizeof((table)[0])), (burst) }
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Run a sequence; stops at the first failed write, verify or poll
+bool runRegSequence(const RegSequence& seq, RegSeqResult* result = NULL);
+
+#endif // REG_SEQUENCE_H
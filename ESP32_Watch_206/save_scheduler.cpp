@@ -0,0 +1,253 @@
+/*
+ * save_scheduler.cpp - Deferred Save Scheduler Implementation
+ * FUSION OS System Layer
+ */
+
+#include "save_scheduler.h"
+#include "config.h"
+#include "hardware.h"
+#include "dvfs_governor.h"
+#include "fuel_gauge.h"
+
+extern SystemState system_state;
+
+struct SaveStepEntry {
+  const char* name;
+  SaveStep step;
+  EnergyStore store;
+};
+
+static SaveStepEntry full_steps[SAVE_MAX_STEPS];
+static uint8_t full_step_count = 0;
+
+static unsigned long last_full_ms = 0;
+static bool active_since_full = false;
+static bool full_due = false;
+static bool full_running = false;
+static uint8_t full_next = 0;                 // Next full_steps[] entry
+static uint16_t full_passes = 0;              // Loop passes the running save took
+
+static unsigned long pending_since_ms = 0;    // Valid while work is pending
+static bool pending = false;
+static bool deferred = false;                 // Last pass left due work waiting
+
+static unsigned long last_pmu_poll_ms = 0;
+static bool last_screen_on = true;
+static bool charging = false;
+static bool low_battery = false;              // Level-1 warning, until charging
+
+static SaveSchedStats sched_stats = {0};
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initSaveScheduler() {
+  last_full_ms = millis();
+  last_pmu_poll_ms = millis();
+  bool armed = pmuEnableLowBatteryWarnings(SAVE_PMU_WARN_PCT, SAVE_PMU_SHUTDOWN_PCT);
+  Serial.printf("[SAVE] Scheduler: %u us/frame budget, PMU warnings %s (%d%% / %d%%)\n",
+                SAVE_STEP_BUDGET_US, armed ? "armed" : "unavailable",
+                SAVE_PMU_WARN_PCT, SAVE_PMU_SHUTDOWN_PCT);
+}
+
+void saveSchedAddStep(const char* name, SaveStep step, EnergyStore store) {
+  if (full_step_count >= SAVE_MAX_STEPS) return;
+  full_steps[full_step_count++] = {name, step, store};
+}
+
+// =============================================================================
+// STEPS
+// =============================================================================
+
+static void startFullSave() {
+  // Every write-behind record, dirty or not, then the registered steps
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) persistMarkDirty((PersistRecord)i);
+  full_due = false;
+  full_running = true;
+  full_next = 0;
+  full_passes = 1;
+}
+
+static void runFullStep(uint8_t i) {
+  if (full_steps[i].step()) energyNoteWrite(full_steps[i].store);
+}
+
+// One unit of work; false when nothing is left
+static bool runStep(PersistReason reason) {
+  if (full_due && !full_running) startFullSave();
+  if (persistFlushStep(full_running ? PERSIST_REASON_MANUAL : reason)) {
+    sched_stats.steps++;
+    return true;
+  }
+  if (!full_running) return false;
+  if (full_next < full_step_count) {
+    runFullStep(full_next++);
+    sched_stats.steps++;
+  }
+  if (full_next >= full_step_count) {
+    full_running = false;
+    sched_stats.full_saves++;
+    Serial.printf("[SAVE] Full save done over %u loop passes\n", full_passes);
+  }
+  return true;
+}
+
+// Below level 1 the level-2 warning can come at any time, screen on or off
+static uint32_t pmuPollInterval(bool screen_on) {
+  bool near_empty = low_battery || fuelGaugeSoc() <= SAVE_PMU_WARN_PCT;
+  return (screen_on || near_empty) ? SAVE_PMU_POLL_MS : SAVE_PMU_POLL_OFF_MS;
+}
+
+static void pollPmu(bool screen_on) {
+  if (millis() - last_pmu_poll_ms < pmuPollInterval(screen_on)) return;
+  last_pmu_poll_ms = millis();
+
+  charging = isCharging();
+  if (charging) low_battery = false;
+
+  uint8_t flags = pmuPollLowBattery();
+  if (flags & PMU_LOWBAT_SHUTDOWN) {
+    // Seconds left at best: NVS only, no SD card, no stepping
+    sched_stats.emergency++;
+    Serial.println("[SAVE] PMU level-2 warning - emergency flush");
+    persistFlushMask(SAVE_EMERGENCY_RECORDS, PERSIST_REASON_EMERGENCY);
+  }
+  if ((flags & (PMU_LOWBAT_WARN | PMU_LOWBAT_SHUTDOWN)) && !low_battery) {
+    low_battery = true;
+    full_due = true;
+    Serial.println("[SAVE] PMU low-battery warning - saves no longer deferred");
+  }
+}
+
+// =============================================================================
+// LOOP HOOK
+// =============================================================================
+
+void updateSaveScheduler(bool screen_on, uint32_t idle_ms) {
+  last_screen_on = screen_on;
+  pollPmu(screen_on);
+
+  // Full-save backstop for state changed without a mark - skipped while
+  // the screen stayed off (marked records flush on their own)
+  if (screen_on) active_since_full = true;
+  if (millis() - last_full_ms >= SAVE_FULL_INTERVAL_MS) {
+    last_full_ms = millis();
+    if (active_since_full) full_due = true;
+    active_since_full = screen_on;
+  }
+
+  PersistReason reason = persistDueReason();
+  if (!full_due && !full_running && reason == PERSIST_REASON_COUNT) {
+    pending = false;
+    deferred = false;
+    return;
+  }
+  if (!pending) {
+    pending = true;
+    pending_since_ms = millis();
+  }
+
+  bool game = dvfsScreenHint(system_state.current_screen) == FRAME_HINT_GAME;
+  bool quiet = !screen_on || (!game && (charging || idle_ms >= SAVE_IDLE_MS));
+  bool urgent = low_battery || fuelGaugePolicy() == FUEL_POLICY_CRITICAL ||
+                persistMsUntilOverdue() == 0 ||
+                millis() - pending_since_ms >= SAVE_MAX_DEFER_MS;
+  if (!quiet && !urgent) {
+    if (!deferred) sched_stats.deferrals++;
+    deferred = true;
+    return;
+  }
+  if (!quiet && deferred) sched_stats.forced++;
+  deferred = false;
+
+  // Screen off: no frame to protect, run it all
+  uint32_t t0 = micros();
+  if (full_running) full_passes++;      // Passes after the one that started it
+  while (runStep(reason)) {
+    if (screen_on && micros() - t0 >= SAVE_STEP_BUDGET_US) break;
+  }
+  if (!full_due && !full_running && persistDueReason() == PERSIST_REASON_COUNT) {
+    pending = false;
+  }
+
+  if (screen_on) {
+    uint32_t us = micros() - t0;
+    sched_stats.frames++;
+    sched_stats.frame_total_us += us;
+    if (us > sched_stats.frame_max_us) sched_stats.frame_max_us = us;
+    if (us > SAVE_HITCH_US) sched_stats.frame_hitches++;
+  }
+}
+
+static uint32_t msLeft(unsigned long since, uint32_t period) {
+  uint32_t elapsed = millis() - since;
+  return elapsed >= period ? 0 : period - elapsed;
+}
+
+uint32_t saveSchedMsUntilNext() {
+  uint32_t wait = msLeft(last_pmu_poll_ms, pmuPollInterval(last_screen_on));
+  wait = min(wait, msLeft(last_full_ms, SAVE_FULL_INTERVAL_MS));
+  if (!pending) return min(wait, persistMsUntilFlush());
+  // Deferred work waits for a touch-free moment (the frame deadline
+  // re-checks it) or the defer limit; running work continues next pass
+  if (!deferred) return 0;
+  wait = min(wait, persistMsUntilOverdue());
+  return min(wait, msLeft(pending_since_ms, SAVE_MAX_DEFER_MS));
+}
+
+// =============================================================================
+// IMMEDIATE SAVE
+// =============================================================================
+
+void saveSchedSaveNow(bool screen_on) {
+  uint32_t t0 = micros();
+  for (int i = 0; i < PERSIST_RECORD_COUNT; i++) persistMarkDirty((PersistRecord)i);
+  persistFlush(PERSIST_REASON_MANUAL);
+  for (uint8_t i = 0; i < full_step_count; i++) runFullStep(i);
+
+  // Covers any backstop pass that was due or half done
+  full_due = false;
+  full_running = false;
+  last_full_ms = millis();
+  active_since_full = screen_on;
+  sched_stats.full_saves++;
+
+  if (screen_on) {
+    uint32_t us = micros() - t0;
+    sched_stats.blocking++;
+    if (us > sched_stats.blocking_max_us) sched_stats.blocking_max_us = us;
+    if (us > SAVE_HITCH_US) sched_stats.blocking_hitches++;
+  }
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const SaveSchedStats* getSaveSchedStats() {
+  return &sched_stats;
+}
+
+void resetSaveSchedStats() {
+  memset(&sched_stats, 0, sizeof(sched_stats));
+}
+
+void printSaveSchedStats() {
+  const SaveSchedStats& s = sched_stats;
+  Serial.printf("[SAVE] full=%lu steps=%lu deferred=%lu forced=%lu emergency=%lu%s%s\n",
+                (unsigned long)s.full_saves, (unsigned long)s.steps,
+                (unsigned long)s.deferrals, (unsigned long)s.forced,
+                (unsigned long)s.emergency, charging ? " charging" : "",
+                low_battery ? " low-battery" : "");
+  Serial.printf("[SAVE] scheduled: %lu frames, avg %lu us, max %lu us, %lu over %u us\n",
+                (unsigned long)s.frames,
+                (unsigned long)(s.frames ? s.frame_total_us / s.frames : 0),
+                (unsigned long)s.frame_max_us, (unsigned long)s.frame_hitches, SAVE_HITCH_US);
+  Serial.printf("[SAVE] blocking (screen on): %lu saves, max %lu us, %lu over %u us\n",
+                (unsigned long)s.blocking, (unsigned long)s.blocking_max_us,
+                (unsigned long)s.blocking_hitches, SAVE_HITCH_US);
+  Serial.printf("[SAVE] full-save steps: %d records", PERSIST_RECORD_COUNT);
+  for (uint8_t i = 0; i < full_step_count; i++) Serial.printf(", %s", full_steps[i].name);
+  Serial.println();
+}
@@ -0,0 +1,97 @@
+/*
+ * save_scheduler.h - Deferred Save Scheduler
+ * FUSION OS System Layer
+ *
+ * The loop used to run saveAllData() every five minutes wherever
+ * the user was - a few NVS commits and two SD files in one frame, a
+ * visible hitch in the middle of a game. Saves are now split into steps
+ * (one write-behind record, or one registered full-save step each) and
+ * run from the loop when the moment is quiet:
+ *
+ *   screen off   everything at once
+ *   idle         no touch for SAVE_IDLE_MS, or on the charger - not on a
+ *                game screen (FRAME_HINT_GAME)
+ *   otherwise    deferred, for at most SAVE_MAX_DEFER_MS - and never once
+ *                a write-behind record reaches PERSIST_MAX_AGE_MS, so the
+ *                persist loss window holds while a game is running
+ *
+ * With the screen on, one loop pass runs steps until SAVE_STEP_BUDGET_US
+ * is spent, so a full save is spread over several frames. Critical battery
+ * and the AXP2101 level-1 warning stop deferring; the level-2 warning
+ * (the PMU powers off next) writes the NVS records at once and skips the
+ * SD card. The PMU is polled every SAVE_PMU_POLL_MS with the screen on or
+ * at or below the level-1 threshold, so the level-2 warning is not missed
+ * behind the slow screen-off poll.
+ *
+ * Hitches are measured in both paths: the save work done inside screen-on
+ * frames by the scheduler, and direct saveAllData() calls made with the
+ * screen on (the old autosave behaviour, still used by the serial SAVE
+ * command). WIDGET_SAVE_SCHED prints both.
+ */
+
+#ifndef SAVE_SCHEDULER_H
+#define SAVE_SCHEDULER_H
+
+#include <Arduino.h>
+#include "persist.h"
+#include "energy_monitor.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define SAVE_FULL_INTERVAL_MS   300000  // Full-save backstop (was the loop autosave)
+#define SAVE_MAX_DEFER_MS       120000  // Longest wait for a quiet moment
+#define SAVE_IDLE_MS            3000    // No touch for this long is idle
+#define SAVE_STEP_BUDGET_US     4000    // Save work per screen-on loop pass
+#define SAVE_HITCH_US           16000   // Save work above one 60 fps frame
+#define SAVE_MAX_STEPS          8       // Registered full-save steps
+#define SAVE_PMU_POLL_MS        5000    // Low-battery status, screen on or below level 1
+#define SAVE_PMU_POLL_OFF_MS    60000   // ...screen off above level 1 (flushed already)
+#define SAVE_PMU_WARN_PCT       10      // AXP2101 level 1: stop deferring
+#define SAVE_PMU_SHUTDOWN_PCT   3       // AXP2101 level 2: emergency flush
+
+// NVS-only records: quick enough to land before the PMU cuts power
+#define SAVE_EMERGENCY_RECORDS  ((1UL << PERSIST_GAME) | (1UL << PERSIST_XP) | \
+                                 (1UL << PERSIST_STEPS) | (1UL << PERSIST_QUESTS) | \
+                                 (1UL << PERSIST_STORY))
+
+// One full-save step; true if it wrote something
+typedef bool (*SaveStep)();
+
+struct SaveSchedStats {
+  uint32_t full_saves;        // Backstop passes completed
+  uint32_t steps;
+  uint32_t deferrals;         // Due work that waited for a quiet moment
+  uint32_t forced;            // Ran on a game screen (defer limit / battery)
+  uint32_t emergency;         // Level-2 flushes
+  uint32_t frames;            // Screen-on loop passes with save work
+  uint32_t frame_max_us;
+  uint64_t frame_total_us;
+  uint32_t frame_hitches;     // Passes over SAVE_HITCH_US
+  uint32_t blocking;          // saveAllData() with the screen on
+  uint32_t blocking_max_us;
+  uint32_t blocking_hitches;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// After initPersist(); arms the AXP2101 low-battery warnings
+void initSaveScheduler();
+
+// Full-save steps after the write-behind records, run in order
+void saveSchedAddStep(const char* name, SaveStep step, EnergyStore store);
+
+// Loop hook, every pass
+void updateSaveScheduler(bool screen_on, uint32_t idle_ms);
+uint32_t saveSchedMsUntilNext();
+
+// Everything now, in this call (saveAllData)
+void saveSchedSaveNow(bool screen_on);
+
+const SaveSchedStats* getSaveSchedStats();
+void resetSaveSchedStats();
+void printSaveSchedStats();
+
+#endif // SAVE_SCHEDULER_H
@@ -0,0 +1,220 @@
+/*
+ * save_schema.cpp - Versioned Save Schema Registry Implementation
+ * FUSION OS System Layer
+ */
+
+#include "save_schema.h"
+#include "xp_system.h"
+#include "storyline.h"
+#include "boss_rush.h"
+#include "daily_quests.h"
+#include "new_apps.h"
+
+// Frozen payload sizes. A layout change without a version bump and a
+// migration step fails here instead of misreading saves in the field.
+static_assert(sizeof(CompactXPSave) == 85, "CompactXPSave changed: bump SCHEMA_XP and add a migration");
+static_assert(sizeof(StoryBlob) == 90, "StoryBlob changed: bump SCHEMA_STORY and add a migration");
+static_assert(sizeof(BossBlob) == 5, "BossBlob changed: bump SCHEMA_BOSS and add a migration");
+static_assert(sizeof(SDBackupData) == 114, "SDBackupData changed: bump SCHEMA_SD_BACKUP and add a migration");
+static_assert(sizeof(QuestBlob) == 39, "QuestBlob changed: bump SCHEMA_NS_QUESTS and add a migration");
+static_assert(sizeof(HabitBlob) == 31, "HabitBlob changed: bump SCHEMA_NS_HABITS and add a migration");
+
+struct SchemaEntry {
+  const char* name;
+  const char* ns;                         // NVS namespace of a key set
+  uint8_t version;                        // Current
+  uint16_t size;                          // Current payload size (binary records)
+  uint16_t v1_size;                       // Headerless pre-registry blob size
+  const SchemaBlobMigration* blob_steps;  // [v - 1] upgrades v -> v + 1
+  const SchemaKeysMigration* key_steps;
+};
+
+// v2 of the quests and habits key sets: scattered keys repacked into one
+// blob per module (the step is owned by the module)
+static const SchemaKeysMigration quests_key_steps[] = {questsKeysToBlob};
+static const SchemaKeysMigration habits_key_steps[] = {habitsKeysToBlob};
+
+// SD backup steps must also recompute SDBackupData::checksum. Only the XP
+// blob shipped headerless, so only it has a v1 size to adopt; the story and
+// boss blobs were framed by the registry from their first release.
+static const SchemaEntry registry[SCHEMA_RECORD_COUNT] = {
+  {"xp",        NULL,        1, 85,  85,  NULL, NULL},
+  {"story",     NULL,        1, 90,  0,   NULL, NULL},
+  {"boss",      NULL,        1, 5,   0,   NULL, NULL},
+  {"watchgame", "watchgame", 1, 0,   0,   NULL, NULL},
+  {"quests",    "quests",    2, 39,  0,   NULL, quests_key_steps},
+  {"habits",    "habits",    2, 31,  0,   NULL, habits_key_steps},
+  {"player.dat", NULL,       1, 0,   0,   NULL, NULL},
+  {"cards.dat", NULL,        2, 0,   0,   NULL, NULL},
+  {"progress.dat", NULL,     1, 0,   0,   NULL, NULL},
+  {"backup",    NULL,        1, 114, 0,   NULL, NULL},
+};
+
+static SchemaStats schema_stats = {0};
+
+// =============================================================================
+// KEY SETS
+// =============================================================================
+
+static void checkKeySet(SchemaRecord rec) {
+  const SchemaEntry& e = registry[rec];
+  Preferences prefs;
+  if (!prefs.begin(e.ns, false)) return;
+
+  // Written before the registry: version 1
+  bool stamped = prefs.isKey(SCHEMA_VERSION_KEY);
+  uint8_t from = stamped ? prefs.getUChar(SCHEMA_VERSION_KEY, 1) : 1;
+  uint8_t v = from;
+  if (v > e.version) {
+    schema_stats.refused++;
+    Serial.printf("[SCHEMA] %s v%u is newer than v%u - left as is\n", e.name, v, e.version);
+    prefs.end();
+    return;
+  }
+  while (v < e.version) {
+    SchemaKeysMigration step = e.key_steps ? e.key_steps[v - 1] : NULL;
+    if (!step || !step(prefs)) {
+      schema_stats.refused++;
+      Serial.printf("[SCHEMA] %s: migration v%u -> v%u failed\n", e.name, v, v + 1);
+      break;
+    }
+    v++;
+  }
+  if (v != from) {
+    schema_stats.migrations++;
+    Serial.printf("[SCHEMA] %s migrated v%u -> v%u\n", e.name, from, v);
+  }
+  if (!stamped || v != from) prefs.putUChar(SCHEMA_VERSION_KEY, v);
+  prefs.end();
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initSaveSchema() {
+  for (int i = 0; i < SCHEMA_RECORD_COUNT; i++) {
+    if (registry[i].ns) checkKeySet((SchemaRecord)i);
+  }
+}
+
+uint8_t schemaVersion(SchemaRecord rec) {
+  return rec < SCHEMA_RECORD_COUNT ? registry[rec].version : 0;
+}
+
+const char* schemaName(SchemaRecord rec) {
+  return rec < SCHEMA_RECORD_COUNT ? registry[rec].name : "?";
+}
+
+// =============================================================================
+// MIGRATION
+// =============================================================================
+
+bool schemaUpgrade(SchemaRecord rec, uint8_t version, uint8_t* data, uint16_t* size, uint16_t cap) {
+  if (rec >= SCHEMA_RECORD_COUNT) return false;
+  const SchemaEntry& e = registry[rec];
+  if (version == 0 || version > e.version) {
+    Serial.printf("[SCHEMA] %s v%u unknown (current v%u) - refused\n", e.name, version, e.version);
+    return false;
+  }
+  if (version == e.version) return true;
+
+  uint8_t from = version;
+  for (; version < e.version; version++) {
+    SchemaBlobMigration step = e.blob_steps ? e.blob_steps[version - 1] : NULL;
+    if (!step || !step(data, size, cap)) {
+      Serial.printf("[SCHEMA] %s: migration v%u -> v%u failed\n", e.name, version, version + 1);
+      return false;
+    }
+  }
+  schema_stats.migrations++;
+  Serial.printf("[SCHEMA] %s migrated v%u -> v%u\n", e.name, from, e.version);
+  return true;
+}
+
+// =============================================================================
+// NVS BLOBS
+// =============================================================================
+
+size_t schemaPutBytes(Preferences& prefs, const char* key, SchemaRecord rec,
+                      const void* data, size_t size) {
+  uint8_t buf[sizeof(SchemaHeader) + SCHEMA_MAX_PAYLOAD];
+  if (rec >= SCHEMA_RECORD_COUNT || size > SCHEMA_MAX_PAYLOAD) return 0;
+
+  SchemaHeader h = {SCHEMA_MAGIC, rec, registry[rec].version, 0, (uint16_t)size};
+  memcpy(buf, &h, sizeof(h));
+  memcpy(buf + sizeof(h), data, size);
+  return prefs.putBytes(key, buf, sizeof(h) + size);
+}
+
+bool schemaGetBytes(Preferences& prefs, const char* key, SchemaRecord rec,
+                    void* out, size_t size) {
+  uint8_t buf[sizeof(SchemaHeader) + SCHEMA_MAX_PAYLOAD];
+  if (rec >= SCHEMA_RECORD_COUNT) return false;
+  const SchemaEntry& e = registry[rec];
+
+  size_t len = prefs.getBytesLength(key);
+  if (len == 0) return false;
+  if (len > sizeof(buf)) {
+    schema_stats.refused++;
+    return false;
+  }
+  prefs.getBytes(key, buf, len);
+
+  SchemaHeader h;
+  memcpy(&h, buf, min(len, sizeof(h)));
+  uint8_t* payload;
+  uint16_t psize;
+  uint8_t version;
+  if (len >= sizeof(h) && h.magic == SCHEMA_MAGIC && h.record == rec &&
+      h.size == len - sizeof(h)) {
+    payload = buf + sizeof(h);
+    psize = h.size;
+    version = h.version;
+    if (version == e.version && psize == size) {
+      memcpy(out, payload, size);
+      schema_stats.fast_loads++;
+      return true;
+    }
+  } else if (e.v1_size && len == e.v1_size) {
+    payload = buf;
+    psize = len;
+    version = 1;
+    schema_stats.adopted++;
+  } else {
+    schema_stats.refused++;
+    Serial.printf("[SCHEMA] %s: unrecognized %u-byte record\n", e.name, (unsigned)len);
+    return false;
+  }
+
+  uint16_t cap = sizeof(buf) - (payload - buf);
+  if (!schemaUpgrade(rec, version, payload, &psize, cap) || psize != size) {
+    schema_stats.refused++;
+    return false;
+  }
+  memcpy(out, payload, size);
+  // Cache the upgraded form: migrations run once per device
+  schemaPutBytes(prefs, key, rec, out, size);
+  return true;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const SchemaStats* getSchemaStats() {
+  return &schema_stats;
+}
+
+void printSchemaStats() {
+  const SchemaStats& s = schema_stats;
+  Serial.printf("[SCHEMA] fast=%lu migrated=%lu adopted=%lu refused=%lu\n",
+                (unsigned long)s.fast_loads, (unsigned long)s.migrations,
+                (unsigned long)s.adopted, (unsigned long)s.refused);
+  for (int i = 0; i < SCHEMA_RECORD_COUNT; i++) {
+    const SchemaEntry& e = registry[i];
+    Serial.printf("[SCHEMA] %-12s v%u", e.name, e.version);
+    if (e.size) Serial.printf(" %u bytes", e.size);
+    Serial.println();
+  }
+}
@@ -0,0 +1,104 @@
+/*
+ * save_schema.h - Versioned Save Schema Registry
+ * FUSION OS System Layer
+ *
+ * Every persisted record has one entry here: its current version and, for
+ * binary records, its current payload size. Changing a saved struct means
+ * bumping its version and adding one migration step to its chain in
+ * save_schema.cpp - never editing the layout in place.
+ *
+ *   NVS blobs       stored as [SchemaHeader][payload]. Current data takes
+ *                   the fast path: one read, header compared, memcpy.
+ *                   Older data runs the chain v -> v+1 -> ... once and is
+ *                   written back, so the next boot is on the fast path.
+ *                   Headerless blobs from before the registry (the XP
+ *                   blob) are adopted as version 1 when they have the v1
+ *                   size. The header is the only version: payloads carry
+ *                   no version byte or CRC of their own (NVS checksums
+ *                   every entry).
+ *   NVS key sets    (per-theme economy, quests, habits) carry a "_sv" key,
+ *                   checked once at boot by initSaveSchema(); a missing key
+ *                   is version 1. A key set repacked into a blob (quests,
+ *                   habits at v2) keeps the "_sv" key and stores the blob
+ *                   under its own record with the header above.
+ *   SD files        KEY=VALUE files write VERSION=schemaVersion(); they are
+ *                   self-describing (unknown keys are skipped) so they load
+ *                   at any version. The XP backup slot keeps its version
+ *                   byte and goes through schemaUpgrade().
+ *
+ * Binary data from a newer firmware (version above current) is refused
+ * instead of being misread; key sets are left untouched.
+ */
+
+#ifndef SAVE_SCHEMA_H
+#define SAVE_SCHEMA_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define SCHEMA_MAGIC            0xF5
+#define SCHEMA_MAX_PAYLOAD      256     // Migration scratch buffer
+#define SCHEMA_VERSION_KEY      "_sv"
+
+enum SchemaRecord : uint8_t {
+  SCHEMA_XP = 0,              // "xp"/"d"          CompactXPSave
+  SCHEMA_STORY,               // "story_data"/"blob" StoryBlob
+  SCHEMA_BOSS,                // "bossrush"/"bits" BossBlob
+  SCHEMA_NS_GAME,             // "watchgame" key set (t%d_* per-theme economy)
+  SCHEMA_NS_QUESTS,           // "quests" key set; v2: "d" QuestBlob
+  SCHEMA_NS_HABITS,           // "habits" key set; v2: "d" HabitBlob
+  SCHEMA_SD_PLAYER,           // player.dat
+  SCHEMA_SD_CARDS,            // cards.dat (gacha checkpoint)
+  SCHEMA_SD_BOSS,             // progress.dat
+  SCHEMA_SD_BACKUP,           // XP backup slot (SDBackupData)
+  SCHEMA_RECORD_COUNT
+};
+
+#pragma pack(push, 1)
+struct SchemaHeader {
+  uint8_t magic;              // SCHEMA_MAGIC
+  uint8_t record;             // SchemaRecord
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t size;              // Payload bytes that follow
+};
+#pragma pack(pop)
+
+// One step: upgrade `data` in place from version N to N+1, updating `size`
+typedef bool (*SchemaBlobMigration)(uint8_t* data, uint16_t* size, uint16_t cap);
+typedef bool (*SchemaKeysMigration)(Preferences& prefs);
+
+struct SchemaStats {
+  uint32_t fast_loads;        // Current version, no work
+  uint32_t migrations;        // Records upgraded (then cached)
+  uint32_t adopted;           // Headerless blobs taken as version 1
+  uint32_t refused;           // Newer version or failed migration
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Boot, before the loads: version-checks and migrates the NVS key sets
+void initSaveSchema();
+
+uint8_t schemaVersion(SchemaRecord rec);
+const char* schemaName(SchemaRecord rec);
+
+// NVS blobs with a header. `size` must be the current payload size.
+size_t schemaPutBytes(Preferences& prefs, const char* key, SchemaRecord rec,
+                      const void* data, size_t size);
+bool schemaGetBytes(Preferences& prefs, const char* key, SchemaRecord rec,
+                    void* out, size_t size);
+
+// Records with their own version field (SD files): upgrade a payload read
+// at `version` to the current one. False if it cannot be used.
+bool schemaUpgrade(SchemaRecord rec, uint8_t version, uint8_t* data, uint16_t* size, uint16_t cap);
+
+const SchemaStats* getSchemaStats();
+void printSchemaStats();
+
+#endif // SAVE_SCHEMA_H
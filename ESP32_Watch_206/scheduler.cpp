@@ -0,0 +1,428 @@
+/*
+ * scheduler.cpp - Timed Event Scheduler Implementation
+ * FUSION OS System Layer
+ */
+
+#include "scheduler.h"
+#include "time_service.h"
+#include "i2c_bus.h"
+#include "loop_events.h"
+#include "energy_monitor.h"
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+
+#define SCHED_EARLY_MS          2       // esp_timer may fire a hair early
+
+// PCF85063 alarm registers
+#define PCF85063_REG_CTRL2      0x01
+#define PCF85063_REG_ALARM_SEC  0x0B    // sec, min, hour, day, weekday
+#define PCF85063_ALARM_DISABLE  0x80
+#define PCF85063_CTRL2_AIE      0x80
+#define PCF85063_CTRL2_AF       0x40
+
+static SchedEvent heap[SCHED_MAX_EVENTS];
+static uint8_t heap_count = 0;
+static SchedHandler handlers[SCHED_TYPE_COUNT] = {0};
+
+static esp_timer_handle_t deadline_timer = NULL;
+static volatile bool deadline_fired = false;
+static volatile bool rebase_pending = false;
+static uint64_t rtc_programmed_due = 0;
+
+// Wall-clock ms minus monotonic ms, cached so the heap order only changes
+// when the time service rebases (refreshed in updateScheduler)
+static int64_t wall_base = 0;
+
+static SchedulerStats sched_stats = {0};
+
+#pragma pack(push, 1)
+struct SchedBlob {
+  uint8_t version;
+  uint8_t count;
+  SchedEvent events[SCHED_MAX_EVENTS];
+  uint32_t crc;
+};
+#pragma pack(pop)
+
+// =============================================================================
+// TIME BASES
+// =============================================================================
+
+static uint64_t monoMs() {
+  return (uint64_t)(esp_timer_get_time() / 1000);
+}
+
+static void refreshWallBase() {
+  wall_base = (int64_t)timeServiceEpochMs() - (int64_t)monoMs();
+}
+
+// Deadline on the monotonic clock (heap key); wall deadlines from before
+// boot clamp to 0 = overdue
+static uint64_t monoDue(const SchedEvent& ev) {
+  if (ev.clock == SCHED_CLOCK_MONO) return ev.due_ms;
+  int64_t due = (int64_t)ev.due_ms - wall_base;
+  return due > 0 ? (uint64_t)due : 0;
+}
+
+static uint64_t wallDue(const SchedEvent& ev) {
+  if (ev.clock == SCHED_CLOCK_WALL) return ev.due_ms;
+  return (uint64_t)((int64_t)ev.due_ms + wall_base);
+}
+
+// =============================================================================
+// BINARY MIN-HEAP (by monotonic deadline)
+// =============================================================================
+
+static void heapSwap(int a, int b) {
+  SchedEvent t = heap[a];
+  heap[a] = heap[b];
+  heap[b] = t;
+}
+
+static void siftUp(int i) {
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (monoDue(heap[parent]) <= monoDue(heap[i])) break;
+    heapSwap(parent, i);
+    i = parent;
+  }
+}
+
+static void siftDown(int i) {
+  while (true) {
+    int l = 2 * i + 1;
+    int r = l + 1;
+    int m = i;
+    if (l < heap_count && monoDue(heap[l]) < monoDue(heap[m])) m = l;
+    if (r < heap_count && monoDue(heap[r]) < monoDue(heap[m])) m = r;
+    if (m == i) break;
+    heapSwap(i, m);
+    i = m;
+  }
+}
+
+static void heapRemoveAt(int i) {
+  heap_count--;
+  if (i == heap_count) return;
+  heap[i] = heap[heap_count];
+  siftDown(i);
+  siftUp(i);
+}
+
+// Wall deadlines move against monotonic ones when the clock is set
+static void heapRebuild() {
+  for (int i = heap_count / 2 - 1; i >= 0; i--) siftDown(i);
+}
+
+static int heapFind(uint8_t type, uint8_t id) {
+  for (int i = 0; i < heap_count; i++) {
+    if (heap[i].type == type && heap[i].id == id) return i;
+  }
+  return -1;
+}
+
+// =============================================================================
+// PERSISTENCE
+// =============================================================================
+
+static uint32_t blobCrc(const SchedBlob* blob) {
+  return esp_rom_crc32_le(0, (const uint8_t*)blob, offsetof(SchedBlob, crc));
+}
+
+static void saveSchedule() {
+  SchedBlob* blob = (SchedBlob*)calloc(1, sizeof(SchedBlob));
+  if (!blob) return;
+  blob->version = SCHED_BLOB_VERSION;
+  blob->count = heap_count;
+  memcpy(blob->events, heap, heap_count * sizeof(SchedEvent));
+  // esp_timer restarts at boot: monotonic deadlines go out as wall time
+  for (int i = 0; i < heap_count; i++) blob->events[i].due_ms = wallDue(heap[i]);
+  blob->crc = blobCrc(blob);
+
+  Preferences prefs;
+  prefs.begin("sched", false);
+  prefs.putBytes("heap", blob, sizeof(SchedBlob));
+  prefs.end();
+  free(blob);
+  sched_stats.saves++;
+  energyNoteWrite(ENERGY_STORE_NVS);
+}
+
+static void loadSchedule() {
+  SchedBlob* blob = (SchedBlob*)malloc(sizeof(SchedBlob));
+  if (!blob) return;
+
+  Preferences prefs;
+  prefs.begin("sched", true);
+  size_t n = prefs.getBytes("heap", blob, sizeof(SchedBlob));
+  prefs.end();
+
+  heap_count = 0;
+  if (n == sizeof(SchedBlob) && blob->version == SCHED_BLOB_VERSION &&
+      blob->count <= SCHED_MAX_EVENTS && blob->crc == blobCrc(blob)) {
+    for (int i = 0; i < blob->count; i++) {
+      SchedEvent& ev = heap[heap_count];
+      ev = blob->events[i];
+      if (ev.clock == SCHED_CLOCK_MONO) {
+        int64_t due = (int64_t)ev.due_ms - wall_base;
+        ev.due_ms = due > 0 ? (uint64_t)due : 0;
+      } else {
+        ev.clock = SCHED_CLOCK_WALL;
+      }
+      siftUp(heap_count++);
+    }
+  }
+  free(blob);
+}
+
+// =============================================================================
+// DEADLINE TIMER + RTC ALARM
+// =============================================================================
+
+static void deadlineCallback(void* arg) {
+  (void)arg;
+  deadline_fired = true;
+  loopEventSet(LOOP_EVT_TIMER);
+}
+
+#if SCHED_RTC_ALARM
+static uint8_t toBcd(int v) {
+  return ((v / 10) << 4) | (v % 10);
+}
+
+static void programRtcAlarm() {
+  uint64_t due = heap_count ? wallDue(heap[0]) : 0;
+  if (due == rtc_programmed_due) return;
+  rtc_programmed_due = due;
+
+  uint8_t alarm[5] = {PCF85063_ALARM_DISABLE, PCF85063_ALARM_DISABLE, PCF85063_ALARM_DISABLE,
+                      PCF85063_ALARM_DISABLE, PCF85063_ALARM_DISABLE};
+  if (due) {
+    WatchTime t;
+    timeFromEpoch((uint32_t)(due / 1000), t);
+    alarm[0] = toBcd(t.second);
+    alarm[1] = toBcd(t.minute);
+    alarm[2] = toBcd(t.hour);
+    alarm[3] = toBcd(t.day);     // Weekday stays disabled
+  }
+
+  uint8_t ctrl2 = 0;
+  if (!i2cReadReg(RTC_ADDR, PCF85063_REG_CTRL2, &ctrl2)) return;
+  ctrl2 &= ~PCF85063_CTRL2_AF;
+  if (due) ctrl2 |= PCF85063_CTRL2_AIE;
+  else ctrl2 &= ~PCF85063_CTRL2_AIE;
+
+  if (i2cWriteRegs(RTC_ADDR, PCF85063_REG_ALARM_SEC, alarm, sizeof(alarm)) &&
+      i2cWriteReg(RTC_ADDR, PCF85063_REG_CTRL2, ctrl2)) {
+    sched_stats.rtc_programs++;
+  }
+}
+#endif
+
+static void armDeadline() {
+  if (deadline_timer) esp_timer_stop(deadline_timer);
+
+  #if SCHED_RTC_ALARM
+    programRtcAlarm();
+  #endif
+
+  if (heap_count == 0 || !deadline_timer) return;
+
+  uint64_t now = monoMs();
+  uint64_t due = monoDue(heap[0]);
+  uint64_t delay_ms = due > now ? due - now : 0;
+  esp_timer_start_once(deadline_timer, delay_ms * 1000 + 1);
+  sched_stats.timer_arms++;
+}
+
+void schedulerRearm() {
+  // Re-key wall deadlines, dispatch anything the jump made due, then re-arm.
+  // Monotonic (relative) deadlines are unaffected.
+  rebase_pending = true;
+  deadline_fired = true;
+  loopEventSet(LOOP_EVT_TIMER);
+}
+
+// =============================================================================
+// DISPATCH
+// =============================================================================
+
+static void dispatchDue() {
+  uint64_t now = monoMs();
+  bool changed = false;
+
+  while (heap_count && monoDue(heap[0]) <= now + SCHED_EARLY_MS) {
+    SchedEvent ev = heap[0];
+    uint64_t due = monoDue(ev);
+    uint32_t late = now > due ? (uint32_t)(now - due) : 0;
+
+    if (ev.period_s) {
+      // Next future occurrence, skipping any missed while asleep / off
+      uint64_t period = (uint64_t)ev.period_s * 1000;
+      uint64_t behind = now > due ? now - due : 0;
+      heap[0].due_ms += period * (behind / period + 1);
+      siftDown(0);
+    } else {
+      heapRemoveAt(0);
+    }
+    changed = true;
+
+    sched_stats.fired++;
+    sched_stats.last_late_ms = late;
+    if (late > sched_stats.max_late_ms) sched_stats.max_late_ms = late;
+    Serial.printf("[SCHED] %s #%d '%s' fired (%lu ms late)\n",
+                  ev.type == SCHED_ALARM ? "Alarm" : ev.type == SCHED_SNOOZE ? "Snooze" :
+                  ev.type == SCHED_TIMER ? "Timer" : ev.type == SCHED_POMODORO ? "Pomodoro" :
+                  ev.type == SCHED_REMINDER ? "Reminder" : "Daily",
+                  ev.id, ev.label, (unsigned long)late);
+
+    // Handlers may add / cancel events - the heap is consistent here
+    if (ev.type < SCHED_TYPE_COUNT && handlers[ev.type]) handlers[ev.type](ev, late);
+    now = monoMs();
+  }
+
+  if (changed) saveSchedule();
+}
+
+void updateScheduler() {
+  if (!deadline_fired) return;
+  deadline_fired = false;
+  if (rebase_pending) {
+    rebase_pending = false;
+    refreshWallBase();
+    heapRebuild();
+  }
+  dispatchDue();
+  armDeadline();
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initScheduler() {
+  esp_timer_create_args_t args = {};
+  args.callback = deadlineCallback;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "sched";
+  if (esp_timer_create(&args, &deadline_timer) != ESP_OK) {
+    deadline_timer = NULL;
+    Serial.println("[SCHED] esp_timer create FAILED");
+  }
+
+  refreshWallBase();
+  loadSchedule();
+  Serial.printf("[SCHED] %d events restored\n", heap_count);
+
+  // Overdue events fire on the first updateScheduler() pass, once the
+  // modules have registered their handlers
+  deadline_fired = true;
+}
+
+void schedulerSetHandler(SchedType type, SchedHandler handler) {
+  if (type < SCHED_TYPE_COUNT) handlers[type] = handler;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+static bool addEvent(SchedType type, uint8_t id, SchedClock clock, uint64_t due_ms,
+                     uint32_t period_s, const char* label) {
+  int i = heapFind(type, id);
+  if (i >= 0) heapRemoveAt(i);
+  if (heap_count >= SCHED_MAX_EVENTS) {
+    Serial.println("[SCHED] Heap full, event dropped");
+    return false;
+  }
+
+  SchedEvent& ev = heap[heap_count];
+  memset(&ev, 0, sizeof(SchedEvent));
+  ev.due_ms = due_ms;
+  ev.period_s = period_s;
+  ev.type = type;
+  ev.id = id;
+  ev.clock = clock;
+  if (label) strncpy(ev.label, label, SCHED_LABEL_LEN - 1);
+  siftUp(heap_count++);
+
+  saveSchedule();
+  armDeadline();
+  return true;
+}
+
+bool schedulerAdd(SchedType type, uint8_t id, uint64_t due_ms, uint32_t period_s, const char* label) {
+  return addEvent(type, id, SCHED_CLOCK_WALL, due_ms, period_s, label);
+}
+
+bool schedulerAddIn(SchedType type, uint8_t id, uint32_t delay_ms, const char* label) {
+  return addEvent(type, id, SCHED_CLOCK_MONO, monoMs() + delay_ms, 0, label);
+}
+
+bool schedulerCancel(SchedType type, uint8_t id) {
+  int i = heapFind(type, id);
+  if (i < 0) return false;
+  heapRemoveAt(i);
+  saveSchedule();
+  armDeadline();
+  return true;
+}
+
+const SchedEvent* schedulerFind(SchedType type, uint8_t id) {
+  int i = heapFind(type, id);
+  return i >= 0 ? &heap[i] : NULL;
+}
+
+uint32_t schedulerRemainingMs(SchedType type, uint8_t id) {
+  int i = heapFind(type, id);
+  if (i < 0) return 0;
+  uint64_t now = monoMs();
+  uint64_t due = monoDue(heap[i]);
+  return due > now ? (uint32_t)(due - now) : 0;
+}
+
+uint32_t schedulerMsUntilNext() {
+  if (heap_count == 0) return UINT32_MAX;
+  uint64_t now = monoMs();
+  uint64_t due = monoDue(heap[0]);
+  if (due <= now) return 0;
+  uint64_t d = due - now;
+  return d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+}
+
+uint64_t schedulerNextDaily(int hour, int minute) {
+  uint32_t now = timeServiceEpoch();
+  uint32_t midnight = now - now % 86400UL;
+  uint32_t due = midnight + hour * 3600UL + minute * 60UL;
+  if (due <= now) due += 86400UL;
+  return (uint64_t)due * 1000;
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const SchedulerStats* getSchedulerStats() {
+  return &sched_stats;
+}
+
+void printScheduler() {
+  uint64_t now = monoMs();
+  Serial.printf("[SCHED] %d/%d events, fired=%lu arms=%lu rtc=%lu saves=%lu late last=%lu max=%lu ms\n",
+                heap_count, SCHED_MAX_EVENTS,
+                (unsigned long)sched_stats.fired, (unsigned long)sched_stats.timer_arms,
+                (unsigned long)sched_stats.rtc_programs, (unsigned long)sched_stats.saves,
+                (unsigned long)sched_stats.last_late_ms, (unsigned long)sched_stats.max_late_ms);
+  for (int i = 0; i < heap_count; i++) {
+    const SchedEvent& ev = heap[i];
+    WatchTime t;
+    timeFromEpoch((uint32_t)(wallDue(ev) / 1000), t);
+    uint64_t due = monoDue(ev);
+    long in_s = due > now ? (long)((due - now) / 1000) : 0;
+    Serial.printf("[SCHED]  type=%d id=%d %02d-%02d %02d:%02d:%02d (in %ld s) every %lu s %s '%s'\n",
+                  ev.type, ev.id, t.month, t.day, t.hour, t.minute, t.second, in_s,
+                  (unsigned long)ev.period_s, ev.clock == SCHED_CLOCK_MONO ? "mono" : "wall",
+                  ev.label);
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * scheduler.h - Timed Event Scheduler
+ * FUSION OS System Layer
+ *
+ * Alarms, snoozes, the countdown timer, Pomodoro phases, reminders and the
+ * daily reset live in one binary min-heap. Alarms, reminders and the daily
+ * reset are wall-clock deadlines (ms since 2000-01-01, from the time
+ * service) and follow clock changes. Relative events added with
+ * schedulerAddIn() (snooze, timer, Pomodoro) are monotonic deadlines on the
+ * esp_timer clock, so setting or resyncing the clock never stretches,
+ * shortens or fires them. The heap is ordered on the monotonic clock, with
+ * wall deadlines mapped through the time service's current base.
+ *
+ * Nothing polls the heap: a one-shot esp_timer is armed for the head, its
+ * callback raises a flag, and updateScheduler() dispatches everything due
+ * from loop context. The PCF85063 alarm is programmed for the same head so
+ * the chip can raise INT for deep sleep, and schedulerMsUntilNext() bounds
+ * light-sleep periods.
+ *
+ * The heap is persisted to NVS on every change. Monotonic deadlines are
+ * saved as their wall-clock equivalent, since esp_timer restarts at boot.
+ * Events that came due while the watch was off fire at boot with their
+ * lateness; repeating events skip forward to their next future occurrence.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define SCHED_MAX_EVENTS        16
+#define SCHED_LABEL_LEN         13
+#define SCHED_RTC_ALARM         1       // Mirror the head into the PCF85063 alarm
+#define SCHED_BLOB_VERSION      1
+
+enum SchedType : uint8_t {
+  SCHED_ALARM = 0,
+  SCHED_SNOOZE,
+  SCHED_TIMER,
+  SCHED_POMODORO,
+  SCHED_REMINDER,
+  SCHED_DAILY_RESET,
+  SCHED_TYPE_COUNT
+};
+
+enum SchedClock : uint8_t {
+  SCHED_CLOCK_WALL = 0,       // due_ms is ms since 2000-01-01
+  SCHED_CLOCK_MONO            // due_ms is esp_timer ms since boot
+};
+
+#pragma pack(push, 1)
+struct SchedEvent {
+  uint64_t due_ms;            // On the `clock` time base
+  uint32_t period_s;          // Repeat interval (0 = one-shot)
+  uint8_t type;               // SchedType
+  uint8_t id;                 // Per-type instance (alarm slot, ...)
+  uint8_t clock;              // SchedClock (was reserved, 0 = wall)
+  char label[SCHED_LABEL_LEN];
+};
+#pragma pack(pop)
+
+// late_ms: how far past the deadline it was dispatched
+typedef void (*SchedHandler)(const SchedEvent& ev, uint32_t late_ms);
+
+struct SchedulerStats {
+  uint32_t fired;
+  uint32_t timer_arms;
+  uint32_t rtc_programs;
+  uint32_t saves;
+  uint32_t max_late_ms;
+  uint32_t last_late_ms;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// After the time service: load the heap, fire overdue events, arm
+void initScheduler();
+
+// Loop hook - returns immediately unless the deadline timer fired
+void updateScheduler();
+
+void schedulerSetHandler(SchedType type, SchedHandler handler);
+
+// Add or replace the (type, id) event at a wall-clock deadline
+bool schedulerAdd(SchedType type, uint8_t id, uint64_t due_ms, uint32_t period_s = 0,
+                  const char* label = NULL);
+// ...or delay_ms from now on the monotonic clock
+bool schedulerAddIn(SchedType type, uint8_t id, uint32_t delay_ms, const char* label = NULL);
+bool schedulerCancel(SchedType type, uint8_t id);
+const SchedEvent* schedulerFind(SchedType type, uint8_t id);
+
+// ms until the (type, id) deadline, 0 if due or not scheduled
+uint32_t schedulerRemainingMs(SchedType type, uint8_t id);
+
+// ms until the next deadline (UINT32_MAX when empty) - sleep budget
+uint32_t schedulerMsUntilNext();
+
+// Next wall-clock occurrence of hour:minute (today or tomorrow)
+uint64_t schedulerNextDaily(int hour, int minute);
+
+// Called by the time service whenever its base moves (set, RTC resync)
+void schedulerRearm();
+
+const SchedulerStats* getSchedulerStats();
+void printScheduler();
+
+#endif // SCHEDULER_H
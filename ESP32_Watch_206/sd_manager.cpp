@@ -9,6 +9,27 @@
 #include "themes.h"
 #include "hardware.h"
 #include "gacha.h"
+#include "i2c_bus.h"
+#include "imu_fifo.h"
+#include "steps_tracker.h"
+#include "activity_history.h"
+#include "wrist_wake.h"
+#include "compass_app.h"
+#include "sleep_tracker.h"
+#include "time_service.h"
+#include "scheduler.h"
+#include "loop_events.h"
+#include "energy_monitor.h"
+#include "dvfs_governor.h"
+#include "fuel_gauge.h"
+#include "persist.h"
+#include "gacha_journal.h"
+#include "atomic_file.h"
+#include "save_schema.h"
+#include "save_scheduler.h"
+#include "backup_store.h"
+#include "nvs_inspector.h"
+#include "kv_reader.h"
 
 extern Arduino_CO5300 *gfx;
 extern SystemState system_state;
@@ -120,6 +141,8 @@ bool createSDFolderStructure() {
     SD_MUSIC_PATH,
     SD_WIFI_PATH,
     SD_BACKUP_PATH,
+    SD_BACKUP_CHUNKS,
+    SD_BACKUP_SNAPS,
     SD_FIRMWARE_PATH,
     SD_LOGS_PATH,
     SD_WALLPAPERS_PATH,
@@ -127,7 +150,8 @@ bool createSDFolderStructure() {
     SD_TRAINING_PATH,
     SD_BOSS_PATH,
     SD_THEMES_PATH,
-    SD_ASSETS_PATH
+    SD_ASSETS_PATH,
+    SD_SLEEP_PATH
   };
   
   int numFolders = sizeof(folders) / sizeof(folders[0]);
@@ -508,10 +532,10 @@ void logToBootLog(const char* message) {
 bool savePlayerDataToSD() {
   if (!sdCardInitialized) return false;
   
-  File dataFile = SD_MMC.open(SD_PLAYER_DATA, FILE_WRITE);
+  File dataFile = atomicFileBegin(SD_MMC, SD_PLAYER_DATA);
   if (!dataFile) return false;
   
-  dataFile.printf("VERSION=1\n");
+  dataFile.printf("VERSION=%d\n", schemaVersion(SCHEMA_SD_PLAYER));
   dataFile.printf("LEVEL=%d\n", system_state.player_level);
   dataFile.printf("XP=%d\n", system_state.player_xp);
   dataFile.printf("GEMS=%d\n", system_state.player_gems);
@@ -521,43 +545,42 @@ bool savePlayerDataToSD() {
   dataFile.printf("STEPS=%d\n", system_state.steps_today);
   dataFile.printf("THEME=%d\n", (int)system_state.current_theme);
   dataFile.printf("BRIGHTNESS=%d\n", system_state.brightness);
-  dataFile.close();
+  if (!atomicFileCommit(SD_MMC, SD_PLAYER_DATA, dataFile)) {
+    sdHealth.writeErrors++;
+    return false;
+  }
   
   Serial.println("[SD] Player data saved");
   return true;
 }
 
+static void setPlayerTheme(int32_t value, uint16_t index) {
+  (void)index;
+  system_state.current_theme = (ThemeType)value;
+}
+
+static const KvField player_fields[] = {
+  {"LEVEL",      KV_INT, &system_state.player_level,          0, NULL},
+  {"XP",         KV_INT, &system_state.player_xp,             0, NULL},
+  {"GEMS",       KV_INT, &system_state.player_gems,           0, NULL},
+  {"CARDS",      KV_INT, &system_state.gacha_cards_collected, 0, NULL},
+  {"BOSSES",     KV_INT, &system_state.bosses_defeated,       0, NULL},
+  {"STREAK",     KV_INT, &system_state.training_streak,       0, NULL},
+  {"STEPS",      KV_INT, &system_state.steps_today,           0, NULL},
+  {"THEME",      KV_FN,  NULL,                                0, setPlayerTheme},
+  {"BRIGHTNESS", KV_U8,  &system_state.brightness,            0, NULL},
+};
+static KvSchema player_schema = {"player.dat", player_fields, KV_COUNT(player_fields)};
+
 bool loadPlayerDataFromSD() {
   if (!sdCardInitialized) return false;
   
-  File dataFile = SD_MMC.open(SD_PLAYER_DATA, FILE_READ);
-  if (!dataFile) {
+  atomicFileResolve(SD_MMC, SD_PLAYER_DATA);  // Finish or roll back a torn save
+  if (!kvLoadFile(SD_MMC, SD_PLAYER_DATA, &player_schema)) {
     Serial.println("[SD] No player data found, using defaults");
     return false;
   }
   
-  while (dataFile.available()) {
-    String line = dataFile.readStringUntil('\n');
-    line.trim();
-    
-    int eqPos = line.indexOf('=');
-    if (eqPos < 0) continue;
-    
-    String key = line.substring(0, eqPos);
-    int value = line.substring(eqPos + 1).toInt();
-    
-    if (key == "LEVEL") system_state.player_level = value;
-    else if (key == "XP") system_state.player_xp = value;
-    else if (key == "GEMS") system_state.player_gems = value;
-    else if (key == "CARDS") system_state.gacha_cards_collected = value;
-    else if (key == "BOSSES") system_state.bosses_defeated = value;
-    else if (key == "STREAK") system_state.training_streak = value;
-    else if (key == "STEPS") system_state.steps_today = value;
-    else if (key == "THEME") system_state.current_theme = (ThemeType)value;
-    else if (key == "BRIGHTNESS") system_state.brightness = value;
-  }
-  
-  dataFile.close();
   Serial.println("[SD] Player data loaded");
   return true;
 }
@@ -566,64 +589,12 @@ bool loadPlayerDataFromSD() {
 // GACHA DATA PERSISTENCE (SD Card)
 // =============================================================================
 
-bool saveGachaDataToSD() {
-  if (!sdCardInitialized) return false;
-  
-  File dataFile = SD_MMC.open(SD_GACHA_DATA, FILE_WRITE);
-  if (!dataFile) {
-    Serial.println("[SD] Failed to write gacha data!");
-    sdHealth.writeErrors++;
-    return false;
-  }
-  
-  dataFile.printf("VERSION=1\n");
-  dataFile.printf("TOTAL_CARDS=%d\n", system_state.gacha_cards_collected);
-  dataFile.printf("PITY=%d\n", system_state.pity_counter);
-  dataFile.printf("PITY_LEGENDARY=%d\n", system_state.pity_legendary_counter);
-  
-  // Save deck
-  dataFile.printf("DECK_SIZE=%d\n", system_state.deck_size);
-  for (int i = 0; i < 5; i++) {
-    dataFile.printf("DECK_%d=%d\n", i, system_state.battle_deck[i]);
-  }
-  
-  dataFile.close();
-  Serial.println("[SD] Gacha data saved");
-  return true;
-}
-
+// cards.dat is gacha.cpp's checkpoint (JOURNAL_SEQ, PITY_EPIC, CARD_<n>,
+// EVO_<n>, ...) and saveGachaProgress() its only writer; a restore reloads
+// it through the same schema.
 bool loadGachaDataFromSD() {
   if (!sdCardInitialized) return false;
-  
-  File dataFile = SD_MMC.open(SD_GACHA_DATA, FILE_READ);
-  if (!dataFile) {
-    Serial.println("[SD] No gacha data found, using defaults");
-    return false;
-  }
-  
-  while (dataFile.available()) {
-    String line = dataFile.readStringUntil('\n');
-    line.trim();
-    
-    int eqPos = line.indexOf('=');
-    if (eqPos < 0) continue;
-    
-    String key = line.substring(0, eqPos);
-    int value = line.substring(eqPos + 1).toInt();
-    
-    if (key == "TOTAL_CARDS") system_state.gacha_cards_collected = value;
-    else if (key == "PITY") system_state.pity_counter = value;
-    else if (key == "PITY_LEGENDARY") system_state.pity_legendary_counter = value;
-    else if (key == "DECK_SIZE") system_state.deck_size = constrain(value, 0, 5);
-    else if (key.startsWith("DECK_")) {
-      int idx = key.substring(5).toInt();
-      if (idx >= 0 && idx < 5) system_state.battle_deck[idx] = value;
-    }
-  }
-  
-  dataFile.close();
-  Serial.println("[SD] Gacha data loaded");
-  return true;
+  return loadGachaProgress();
 }
 
 // =============================================================================
@@ -633,14 +604,14 @@ bool loadGachaDataFromSD() {
 bool saveBossDataToSD() {
   if (!sdCardInitialized) return false;
   
-  File dataFile = SD_MMC.open(SD_BOSS_DATA, FILE_WRITE);
+  File dataFile = atomicFileBegin(SD_MMC, SD_BOSS_DATA);
   if (!dataFile) {
     Serial.println("[SD] Failed to write boss data!");
     sdHealth.writeErrors++;
     return false;
   }
   
-  dataFile.printf("VERSION=1\n");
+  dataFile.printf("VERSION=%d\n", schemaVersion(SCHEMA_SD_BOSS));
   dataFile.printf("BOSSES_DEFEATED=%d\n", system_state.bosses_defeated);
   
   // Save individual boss defeat status
@@ -649,40 +620,31 @@ bool saveBossDataToSD() {
     dataFile.printf("BOSS_%d=%d\n", i, bosses_defeated[i] ? 1 : 0);
   }
   
-  dataFile.close();
+  if (!atomicFileCommit(SD_MMC, SD_BOSS_DATA, dataFile)) {
+    sdHealth.writeErrors++;
+    return false;
+  }
   Serial.println("[SD] Boss data saved");
   return true;
 }
 
+extern bool bosses_defeated[];
+
+static const KvField boss_fields[] = {
+  {"BOSSES_DEFEATED", KV_INT,  &system_state.bosses_defeated, 0,            NULL},
+  {"BOSS_",           KV_BOOL, bosses_defeated,               TOTAL_BOSSES, NULL},
+};
+static KvSchema boss_schema = {"progress.dat", boss_fields, KV_COUNT(boss_fields)};
+
 bool loadBossDataFromSD() {
   if (!sdCardInitialized) return false;
   
-  File dataFile = SD_MMC.open(SD_BOSS_DATA, FILE_READ);
-  if (!dataFile) {
+  atomicFileResolve(SD_MMC, SD_BOSS_DATA);  // Finish or roll back a torn save
+  if (!kvLoadFile(SD_MMC, SD_BOSS_DATA, &boss_schema)) {
     Serial.println("[SD] No boss data found, using defaults");
     return false;
   }
   
-  extern bool bosses_defeated[];
-  
-  while (dataFile.available()) {
-    String line = dataFile.readStringUntil('\n');
-    line.trim();
-    
-    int eqPos = line.indexOf('=');
-    if (eqPos < 0) continue;
-    
-    String key = line.substring(0, eqPos);
-    int value = line.substring(eqPos + 1).toInt();
-    
-    if (key == "BOSSES_DEFEATED") system_state.bosses_defeated = value;
-    else if (key.startsWith("BOSS_")) {
-      int idx = key.substring(5).toInt();
-      if (idx >= 0 && idx < TOTAL_BOSSES) bosses_defeated[idx] = (value != 0);
-    }
-  }
-  
-  dataFile.close();
   Serial.println("[SD] Boss data loaded");
   return true;
 }
@@ -691,6 +653,17 @@ bool loadBossDataFromSD() {
 // BACKUP SYSTEM
 // =============================================================================
 
+// Files a snapshot holds; the first BACKUP_RESTORE_FILES are restored
+static const BackupFile backup_files[] = {
+  {"player.dat", SD_PLAYER_DATA},
+  {"cards.dat", SD_GACHA_DATA},
+  {"progress.dat", SD_BOSS_DATA},
+  {"config.txt", SD_WIFI_CONFIG},
+  {"nights.dat", SD_SLEEP_DATA},
+};
+#define BACKUP_FILE_COUNT       (sizeof(backup_files) / sizeof(backup_files[0]))
+#define BACKUP_RESTORE_FILES    3
+
 bool performAutoBackup() {
   if (!autoBackupEnabled || !sdCardInitialized) return false;
   
@@ -712,53 +685,26 @@ bool performAutoBackup() {
   bool success = createBackup(backupName);
   if (success) {
     lastAutoBackup = millis();
+    cleanOldBackups(BACKUP_KEEP_RECENT);
   }
   
   return success;
 }
 
 bool createBackup(const char* backupName) {
-  char backupDir[128];
-  sprintf(backupDir, "%s/%s", SD_BACKUP_PATH, backupName);
-  
-  if (!SD_MMC.mkdir(backupDir)) {
-    Serial.printf("[SD] Failed to create backup dir: %s\n", backupDir);
+  // Incremental snapshot: unchanged files and chunks are not written again
+  if (!backupCreate(backupName, backup_files, BACKUP_FILE_COUNT)) {
+    Serial.printf("[SD] Backup failed: %s\n", backupName);
     return false;
   }
-  
-  int filesCopied = 0;
-  
-  // Helper lambda to copy a file
-  auto copyFile = [&](const char* srcPath, const char* fileName) {
-    char destPath[128];
-    sprintf(destPath, "%s/%s", backupDir, fileName);
-    
-    File src = SD_MMC.open(srcPath, FILE_READ);
-    if (!src) return;
-    
-    File dst = SD_MMC.open(destPath, FILE_WRITE);
-    if (!dst) { src.close(); return; }
-    
-    while (src.available()) {
-      dst.write(src.read());
-    }
-    
-    src.close();
-    dst.close();
-    filesCopied++;
-    Serial.printf("[SD] Backed up: %s\n", fileName);
-  };
-  
-  // Backup all game data files
-  copyFile(SD_PLAYER_DATA, "player.dat");
-  copyFile(SD_GACHA_DATA, "cards.dat");
-  copyFile(SD_BOSS_DATA, "progress.dat");
-  copyFile(SD_WIFI_CONFIG, "config.txt");
-  
-  Serial.printf("[SD] Backup created: %s (%d files)\n", backupName, filesCopied);
   logToBootLog("Backup created");
-  
-  return filesCopied > 0;
+  return true;
+}
+
+// Atomic-save generation of a live file; a restore commits a new one
+static uint32_t savedGeneration(const char* path) {
+  AtomicStamp st;
+  return atomicFileStamp(SD_MMC, path, &st) ? st.gen : 0;
 }
 
 bool restoreFromBackup(const char* backupName) {
@@ -766,34 +712,32 @@ bool restoreFromBackup(const char* backupName) {
   sprintf(backupBase, "%s/%s", SD_BACKUP_PATH, backupName);
   
   int filesRestored = 0;
+  uint32_t cardsGen = savedGeneration(SD_GACHA_DATA);
   
-  // Helper lambda to restore a file
+  // Helper lambda to restore a file from a pre-snapshot backup directory
   auto restoreFile = [&](const char* fileName, const char* destPath) {
     char srcPath[128];
     sprintf(srcPath, "%s/%s", backupBase, fileName);
     
     if (!SD_MMC.exists(srcPath)) return;
     
-    File src = SD_MMC.open(srcPath, FILE_READ);
-    if (!src) return;
-    
-    File dst = SD_MMC.open(destPath, FILE_WRITE);
-    if (!dst) { src.close(); return; }
-    
-    while (src.available()) {
-      dst.write(src.read());
+    // Chunked copy through a verified commit - a bad backup never
+    // replaces the live save
+    if (!atomicFileCopy(SD_MMC, srcPath, destPath)) {
+      Serial.printf("[SD] Restore of %s failed, kept current\n", fileName);
+      return;
     }
-    
-    src.close();
-    dst.close();
     filesRestored++;
     Serial.printf("[SD] Restored: %s\n", fileName);
   };
   
-  // Restore all game data files
-  restoreFile("player.dat", SD_PLAYER_DATA);
-  restoreFile("cards.dat", SD_GACHA_DATA);
-  restoreFile("progress.dat", SD_BOSS_DATA);
+  if (backupExists(backupName)) {
+    filesRestored = max(0, backupRestore(backupName, backup_files, BACKUP_RESTORE_FILES));
+  } else {
+    restoreFile("player.dat", SD_PLAYER_DATA);
+    restoreFile("cards.dat", SD_GACHA_DATA);
+    restoreFile("progress.dat", SD_BOSS_DATA);
+  }
   
   if (filesRestored == 0) {
     Serial.printf("[SD] Backup not found or empty: %s\n", backupName);
@@ -802,7 +746,13 @@ bool restoreFromBackup(const char* backupName) {
   
   // Reload all data into memory
   loadPlayerDataFromSD();
-  loadGachaDataFromSD();
+  if (savedGeneration(SD_GACHA_DATA) != cardsGen) {
+    // The journal holds pulls made on top of the replaced collection:
+    // replayed over the restored checkpoint at the next boot they would
+    // mix the two
+    loadGachaDataFromSD();
+    gachaJournalReset();
+  }
   loadBossDataFromSD();
   
   Serial.printf("[SD] Restored from backup: %s (%d files)\n", backupName, filesRestored);
@@ -817,10 +767,14 @@ void listBackups() {
   }
   
   Serial.println("[SD] Available backups:");
+  backupList();
+  
+  // Directory backups from before the snapshot store
   File entry;
   while (entry = backupDir.openNextFile()) {
-    if (entry.isDirectory()) {
-      Serial.printf("  - %s\n", entry.name());
+    const char* name = entry.name();
+    if (entry.isDirectory() && strcmp(name, "chunks") != 0 && strcmp(name, "snaps") != 0) {
+      Serial.printf("  - %s (legacy)\n", name);
     }
     entry.close();
   }
@@ -828,9 +782,8 @@ void listBackups() {
 }
 
 void cleanOldBackups(int keepCount) {
-  // Keep only the most recent backups
-  Serial.printf("[SD] Cleaning old backups, keeping %d\n", keepCount);
-  // Implementation would list, sort by date, and delete oldest
+  // keepCount newest, plus the daily and weekly tiers
+  backupPrune(keepCount, BACKUP_KEEP_DAILY, BACKUP_KEEP_WEEKLY);
 }
 
 // =============================================================================
@@ -1014,6 +967,153 @@ void processSerialCommand(const String& command) {
     Serial.println("BACKUP_COMPLETE");
     return;
   }
+  if (cmd == "WIDGET_BACKUP_STATS") {
+    printBackupStats();
+    return;
+  }
+  
+  // ========== DIAGNOSTICS ==========
+  if (cmd == "WIDGET_I2C_STATS") {
+    printI2CBusStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_IMU_STATS") {
+    printIMUFifoStats();
+    return;
+  }
+  
+  // WIDGET_IMU_TRACE:<seconds>[:<label>] - raw samples as CSV
+  if (cmd.startsWith("WIDGET_IMU_TRACE:")) {
+    String args = cmd.substring(17);
+    int colon = args.indexOf(':');
+    String label = colon >= 0 ? args.substring(colon + 1) : String("-");
+    imuTraceStart((uint16_t)args.toInt(), label.c_str());
+    return;
+  }
+  
+  if (cmd.startsWith("WIDGET_IMU_LABEL:")) {
+    imuTraceLabel(cmd.substring(17).c_str());
+    return;
+  }
+  
+  if (cmd.startsWith("WIDGET_IMU_MARK:")) {
+    imuTraceMark(cmd.substring(16).c_str());
+    return;
+  }
+  
+  if (cmd == "WIDGET_IMU_TRACE_STOP") {
+    imuTraceStop();
+    return;
+  }
+  
+  if (cmd == "WIDGET_STEP_STATS") {
+    printStepEngineStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_HISTORY") {
+    printActivityHistory();
+    return;
+  }
+  
+  if (cmd == "WIDGET_WRIST_STATS") {
+    printWristWakeStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_COMPASS") {
+    printCompassStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_SLEEP") {
+    printSleepTracker();
+    return;
+  }
+  
+  if (cmd == "WIDGET_SLEEP_COUNTS") {
+    printSleepCounts();
+    return;
+  }
+  
+  if (cmd == "WIDGET_TIME") {
+    printTimeServiceStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_SCHEDULER") {
+    printScheduler();
+    return;
+  }
+  
+  if (cmd == "WIDGET_ENERGY") {
+    printEnergyStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_ENERGY_RESET") {
+    resetEnergyStats();
+    Serial.println("[ENERGY] Counters reset");
+    return;
+  }
+  
+  if (cmd == "WIDGET_DVFS") {
+    printDvfsStats();
+    resetDvfsStats();
+    return;
+  }
+  if (cmd == "WIDGET_FUEL") {
+    printFuelStats();
+    return;
+  }
+  if (cmd == "WIDGET_FUEL_LOG") {
+    printFuelLog();
+    return;
+  }
+  if (cmd == "WIDGET_PERSIST") {
+    printPersistStats();
+    return;
+  }
+  if (cmd == "WIDGET_SAVE_SCHED") {
+    printSaveSchedStats();
+    resetSaveSchedStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_KV") {
+    printKvLoadStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_NVS") {
+    printNvsReport();
+    return;
+  }
+  
+  if (cmd == "WIDGET_NVS_SAMPLE") {
+    nvsHotKeySample();
+    printNvsReport();
+    return;
+  }
+  if (cmd == "WIDGET_GACHA_JOURNAL") {
+    printGachaJournalStats();
+    return;
+  }
+  if (cmd == "WIDGET_SAVES") {
+    printAtomicFileStats();
+    return;
+  }
+  if (cmd == "WIDGET_SCHEMA") {
+    printSchemaStats();
+    return;
+  }
+  
+  if (cmd == "WIDGET_LOOP") {
+    printLoopEventStats();
+    resetLoopEventStats();
+    return;
+  }
   
   if (cmd == "WIDGET_SYNC_TIME") {
     if (syncTimeFromNTP()) {
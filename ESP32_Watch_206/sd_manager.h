@@ -33,6 +33,8 @@ struct TouchGesture;
 #define SD_MUSIC_PATH           "/WATCH/music"
 #define SD_WIFI_PATH            "/WATCH/wifi"
 #define SD_BACKUP_PATH          "/WATCH/BACKUPS"
+#define SD_BACKUP_CHUNKS        "/WATCH/BACKUPS/chunks"
+#define SD_BACKUP_SNAPS         "/WATCH/BACKUPS/snaps"
 #define SD_FIRMWARE_PATH        "/WATCH/FIRMWARE"
 #define SD_LOGS_PATH            "/WATCH/LOGS"
 #define SD_WALLPAPERS_PATH      "/WATCH/WALLPAPERS"
@@ -41,12 +43,15 @@ struct TouchGesture;
 #define SD_BOSS_PATH            "/WATCH/boss_rush"
 #define SD_THEMES_PATH          "/WATCH/themes"
 #define SD_ASSETS_PATH          "/WATCH/assets"
+#define SD_SLEEP_PATH           "/WATCH/sleep"
 
 #define SD_WIFI_CONFIG          "/WATCH/wifi/config.txt"
 #define SD_PLAYER_DATA          "/WATCH/data/player.dat"
 #define SD_GACHA_DATA           "/WATCH/gacha/cards.dat"
+#define SD_GACHA_JOURNAL        "/WATCH/gacha/pulls.jnl"
 #define SD_BOSS_DATA            "/WATCH/boss_rush/progress.dat"
 #define SD_BOOT_LOG             "/WATCH/LOGS/boot.log"
+#define SD_SLEEP_DATA           "/WATCH/sleep/nights.dat"
 
 // =============================================================================
 // SD CARD STATUS
@@ -121,7 +126,6 @@ bool saveWiFiToSD();
 bool loadPlayerDataFromSD();
 bool savePlayerDataToSD();
 bool loadGachaDataFromSD();
-bool saveGachaDataToSD();
 bool loadBossDataFromSD();
 bool saveBossDataToSD();
 
@@ -0,0 +1,237 @@
+/*
+ * sleep_tracker.cpp - Nightly Sleep Tracking Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "sleep_tracker.h"
+#include "imu_fifo.h"
+#include "sd_manager.h"
+#include "energy_monitor.h"
+#include <esp_rom_crc.h>
+
+static bool night_active = false;
+static ActigraphyCounter counter;
+static uint32_t sleep_ring_cursor = 0;
+static uint16_t counts[ACTI_MAX_EPOCHS];
+static uint16_t epochs = 0;
+static WatchTime night_start;
+static unsigned long epoch_start_ms = 0;
+
+static SleepSummary last_summary;
+static bool have_last_summary = false;
+static uint32_t nights_stored = 0;
+
+// =============================================================================
+// NIGHT WINDOW
+// =============================================================================
+
+static bool isNightHour(int hour) {
+  if (SLEEP_NIGHT_START_HOUR > SLEEP_NIGHT_END_HOUR) {
+    return hour >= SLEEP_NIGHT_START_HOUR || hour < SLEEP_NIGHT_END_HOUR;
+  }
+  return hour >= SLEEP_NIGHT_START_HOUR && hour < SLEEP_NIGHT_END_HOUR;
+}
+
+static void startNight(const WatchTime& t) {
+  actigraphyCounterInit(counter, getIMUFifoOdrHz(), IMU_ACCEL_LSB_PER_G);
+  sleep_ring_cursor = imuRingHead();
+  epochs = 0;
+  night_start = t;
+  night_active = true;
+  Serial.printf("[SLEEP] Night started %02d:%02d\n", t.hour, t.minute);
+}
+
+// =============================================================================
+// SD STORAGE
+// =============================================================================
+
+static bool appendNightRecord(const uint8_t* packed, uint16_t len) {
+  if (!sdCardInitialized) return false;
+  if (!SD_MMC.exists(SD_SLEEP_PATH)) SD_MMC.mkdir(SD_SLEEP_PATH);
+
+  File f = SD_MMC.open(SD_SLEEP_DATA, FILE_APPEND);
+  if (!f) return false;
+
+  uint32_t crc = esp_rom_crc32_le(0, packed, len);
+  size_t written = f.write((const uint8_t*)&len, sizeof(len));
+  written += f.write(packed, len);
+  written += f.write((const uint8_t*)&crc, sizeof(crc));
+  written += f.write((const uint8_t*)&len, sizeof(len));
+  f.close();
+  energyNoteWrite(ENERGY_STORE_SD);
+
+  return written == len + sizeof(crc) + 2 * sizeof(len);
+}
+
+// Newest record, found through the trailing length
+static bool readLastNightRecord(SleepNight& night) {
+  if (!sdCardInitialized) return false;
+
+  File f = SD_MMC.open(SD_SLEEP_DATA, FILE_READ);
+  if (!f) return false;
+
+  bool ok = false;
+  size_t size = f.size();
+  uint16_t len = 0;
+  if (size >= 8 && f.seek(size - sizeof(len)) && f.read((uint8_t*)&len, sizeof(len)) == sizeof(len) &&
+      len > 0 && len <= ACTI_PACKED_MAX && size >= (size_t)len + 8) {
+    uint8_t packed[ACTI_PACKED_MAX];
+    uint32_t crc = 0;
+    size_t start = size - sizeof(len) - sizeof(crc) - len;
+    if (f.seek(start) && f.read(packed, len) == len &&
+        f.read((uint8_t*)&crc, sizeof(crc)) == sizeof(crc) &&
+        crc == esp_rom_crc32_le(0, packed, len)) {
+      ok = actigraphyUnpack(packed, len, night) > 0;
+    }
+  }
+  f.close();
+  return ok;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initSleepTracker() {
+  SleepNight* night = (SleepNight*)malloc(sizeof(SleepNight));
+  if (night && readLastNightRecord(*night)) {
+    last_summary = night->summary;
+    have_last_summary = true;
+    Serial.printf("[SLEEP] Last night %04d-%02d-%02d: %d min asleep, eff %d%%\n",
+                  night->year, night->month, night->day,
+                  last_summary.total_sleep, last_summary.efficiency);
+  } else {
+    Serial.println("[SLEEP] No stored nights");
+  }
+  free(night);
+  epoch_start_ms = millis();
+}
+
+// =============================================================================
+// SCORING + STORE
+// =============================================================================
+
+void finishSleepNight() {
+  if (!night_active) return;
+  night_active = false;
+
+  if (epochs < SLEEP_MIN_EPOCHS) {
+    Serial.printf("[SLEEP] Night too short (%d min), discarded\n", epochs);
+    return;
+  }
+
+  SleepNight* night = (SleepNight*)malloc(sizeof(SleepNight));
+  uint8_t* packed = (uint8_t*)malloc(ACTI_PACKED_MAX);
+  if (!night || !packed) {
+    free(night);
+    free(packed);
+    Serial.println("[SLEEP] Out of memory, night lost");
+    return;
+  }
+
+  uint32_t t0 = micros();
+  memset(night, 0, sizeof(SleepNight));
+  night->year = night_start.year;
+  night->month = night_start.month;
+  night->day = night_start.day;
+  night->start_minute = night_start.hour * 60 + night_start.minute;
+
+  actigraphyScore(counts, epochs, night->sleep);
+  actigraphyRescore(night->sleep, epochs);
+  actigraphySummarize(night->sleep, epochs, night->summary);
+  for (uint16_t i = 0; i < epochs; i++) night->level[i] = actigraphyLevel(counts[i]);
+  uint32_t score_us = micros() - t0;
+
+  size_t len = actigraphyPack(*night, packed, ACTI_PACKED_MAX);
+  bool stored = len > 0 && appendNightRecord(packed, (uint16_t)len);
+  if (stored) nights_stored++;
+
+  last_summary = night->summary;
+  have_last_summary = true;
+
+  const SleepSummary& s = night->summary;
+  Serial.printf("[SLEEP] Night %d min: asleep %d, WASO %d, %d awakenings, eff %d%% (scored in %lu us)\n",
+                s.epochs, s.total_sleep, s.waso, s.awakenings, s.efficiency, (unsigned long)score_us);
+  Serial.printf("[SLEEP] Record %d bytes %s\n", (int)len, stored ? "saved to SD" : "NOT saved");
+
+  free(packed);
+  free(night);
+}
+
+// =============================================================================
+// LOOP HOOK
+// =============================================================================
+
+void updateSleepTracker() {
+  if (night_active) {
+    ImuSample batch[32];
+    int n;
+    while ((n = imuRingRead(sleep_ring_cursor, batch, 32)) > 0) {
+      for (int i = 0; i < n; i++) {
+        actigraphyAddSample(counter, batch[i].ax, batch[i].ay, batch[i].az);
+      }
+    }
+  }
+
+  if (millis() - epoch_start_ms < SLEEP_EPOCH_MS) return;
+  epoch_start_ms += SLEEP_EPOCH_MS;
+  if (millis() - epoch_start_ms >= SLEEP_EPOCH_MS) epoch_start_ms = millis();
+
+  WatchTime t = getCurrentTime();
+  bool in_window = isNightHour(t.hour);
+
+  if (night_active) {
+    counts[epochs++] = actigraphyCloseEpoch(counter);
+    if (!in_window || epochs >= ACTI_MAX_EPOCHS) finishSleepNight();
+  } else if (in_window && isIMUFifoActive()) {
+    startNight(t);
+  }
+}
+
+// =============================================================================
+// ACCESSORS / DIAGNOSTICS
+// =============================================================================
+
+uint32_t sleepTrackerMsUntilEpoch() {
+  uint32_t elapsed = millis() - epoch_start_ms;
+  return elapsed >= SLEEP_EPOCH_MS ? 0 : SLEEP_EPOCH_MS - elapsed;
+}
+
+bool isSleepTracking() {
+  return night_active;
+}
+
+uint16_t getSleepEpochCount() {
+  return epochs;
+}
+
+bool getLastSleepSummary(SleepSummary& out) {
+  if (!have_last_summary) return false;
+  out = last_summary;
+  return true;
+}
+
+void printSleepTracker() {
+  Serial.printf("[SLEEP] %s, window %02d:00-%02d:00, %d epochs, %lu nights stored this boot\n",
+                night_active ? "TRACKING" : "idle",
+                SLEEP_NIGHT_START_HOUR, SLEEP_NIGHT_END_HOUR,
+                night_active ? epochs : 0, (unsigned long)nights_stored);
+  if (night_active && epochs > 0) {
+    Serial.printf("[SLEEP] Last counts:");
+    for (int i = epochs > 10 ? epochs - 10 : 0; i < epochs; i++) Serial.printf(" %d", counts[i]);
+    Serial.printf("\n");
+  }
+  if (have_last_summary) {
+    const SleepSummary& s = last_summary;
+    Serial.printf("[SLEEP] Last night: %d min, onset +%d, asleep %d, WASO %d, %d awakenings, eff %d%%\n",
+                  s.epochs, s.onset, s.total_sleep, s.waso, s.awakenings, s.efficiency);
+  }
+}
+
+void printSleepCounts() {
+  Serial.printf("# sleep_counts date=%04d-%02d-%02d start=%02d:%02d epochs=%d\n",
+                night_start.year, night_start.month, night_start.day,
+                night_start.hour, night_start.minute, epochs);
+  Serial.println("count,label");
+  for (uint16_t i = 0; i < epochs; i++) Serial.printf("%d,-\n", counts[i]);
+}
@@ -0,0 +1,62 @@
+/*
+ * sleep_tracker.h - Nightly Sleep Tracking
+ * FUSION OS Sensor Layer
+ *
+ * During night hours the tracker keeps its own cursor on the IMU FIFO ring
+ * and folds every drained sample into a minute activity count (see
+ * actigraphy.h). Per loop pass that is a few integer ops per sample, so it
+ * fits the short light-sleep wakeups while the screen is off; the RTC is
+ * only read once a minute when an epoch closes.
+ *
+ * When the night window ends the epochs are scored (Cole-Kripke + Webster
+ * rescoring), summarized and appended to SD_SLEEP_DATA as one bit-packed
+ * record:
+ *   [u16 len][packed night][u32 crc32][u16 len]
+ * The trailing length lets readers walk the file backwards from the end.
+ * One file instead of one per night keeps FAT cluster waste down.
+ */
+
+#ifndef SLEEP_TRACKER_H
+#define SLEEP_TRACKER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "actigraphy.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define SLEEP_NIGHT_START_HOUR    21      // Window opens (local time)
+#define SLEEP_NIGHT_END_HOUR      9       // Window closes
+#define SLEEP_EPOCH_MS            60000
+#define SLEEP_MIN_EPOCHS          60      // Shorter windows are not stored
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Boot: reads the newest stored night for getLastSleepSummary()
+void initSleepTracker();
+
+// Loop hook (screen on or off) - right after serviceIMUFifo()
+void updateSleepTracker();
+
+// ms until the current epoch closes (loop sleep budget)
+uint32_t sleepTrackerMsUntilEpoch();
+
+bool isSleepTracking();
+uint16_t getSleepEpochCount();
+
+// Newest stored night; false if none
+bool getLastSleepSummary(SleepSummary& out);
+
+// Force-close the current night (scores and stores it)
+void finishSleepNight();
+
+void printSleepTracker();
+
+// Epoch counts of the current (or last) night as CSV - add the sleep diary
+// labels by hand and drop it in host_tests/traces/sleep for the replay test
+void printSleepCounts();
+
+#endif // SLEEP_TRACKER_H
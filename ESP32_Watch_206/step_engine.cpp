@@ -0,0 +1,163 @@
+/*
+ * step_engine.cpp - Fixed-Point Software Pedometer Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "step_engine.h"
+#include <math.h>
+#include <string.h>
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+uint32_t stepEngineSqrt(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > v) bit >>= 2;
+  while (bit != 0) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void stepEngineInit(StepEngine& e, uint16_t odr_hz, int32_t lsb_per_g) {
+  memset(&e, 0, sizeof(StepEngine));
+  e.odr_hz = odr_hz ? odr_hz : 50;
+  e.lsb_per_g = lsb_per_g;
+
+  // RBJ band-pass (0 dB peak gain), coefficients computed once in float
+  float w0 = 2.0f * (float)M_PI * STEP_ENGINE_F0_HZ / (float)e.odr_hz;
+  float alpha = sinf(w0) / (2.0f * STEP_ENGINE_Q);
+  float a0 = 1.0f + alpha;
+  float scale = (float)(1L << STEP_ENGINE_COEF_SHIFT);
+
+  e.b0 = (int32_t)lroundf(alpha / a0 * scale);
+  e.a1 = (int32_t)lroundf(-2.0f * cosf(w0) / a0 * scale);
+  e.a2 = (int32_t)lroundf((1.0f - alpha) / a0 * scale);
+
+  e.peak_avg_mg = STEP_ENGINE_MIN_PEAK_MG * 2;
+  e.threshold_mg = STEP_ENGINE_MIN_PEAK_MG;
+}
+
+// =============================================================================
+// PEAK HANDLING
+// =============================================================================
+
+static void endBout(StepEngine& e) {
+  if (!e.walking) e.rejected_peaks += e.pending;
+  e.walking = false;
+  e.pending = 0;
+  e.interval_avg_ms = 0;
+  e.cadence_spm = 0;
+}
+
+static int onPeak(StepEngine& e, int32_t peak_mg) {
+  // Adaptive threshold tracks the current gait's amplitude
+  e.peak_avg_mg += (peak_mg - e.peak_avg_mg) >> 2;
+  e.threshold_mg = e.peak_avg_mg * STEP_ENGINE_PEAK_RATIO_PCT / 100;
+  if (e.threshold_mg < STEP_ENGINE_MIN_PEAK_MG) e.threshold_mg = STEP_ENGINE_MIN_PEAK_MG;
+
+  uint32_t dt = e.now_ms - e.last_peak_ms;
+
+  if (!e.have_peak || dt > STEP_ENGINE_MAX_INTERVAL_MS) {
+    endBout(e);
+    e.have_peak = true;
+    e.last_peak_ms = e.now_ms;
+    e.pending = 1;
+    return 0;
+  }
+
+  if (dt < STEP_ENGINE_MIN_INTERVAL_MS) {
+    e.rejected_peaks++;  // Ringing / double peak within one step
+    return 0;
+  }
+
+  e.last_peak_ms = e.now_ms;
+
+  if (e.interval_avg_ms == 0) {
+    e.interval_avg_ms = dt;
+  } else {
+    int32_t dev = (int32_t)dt - (int32_t)e.interval_avg_ms;
+    if (dev < 0) dev = -dev;
+    bool regular = dev * 100 <= (int32_t)e.interval_avg_ms * STEP_ENGINE_REGULARITY_PCT;
+
+    if (!regular && !e.walking) {
+      // Restart the candidate bout from the last two peaks
+      e.rejected_peaks += e.pending - 1;
+      e.pending = 2;
+      e.interval_avg_ms = dt;
+      return 0;
+    }
+    e.interval_avg_ms += ((int32_t)dt - (int32_t)e.interval_avg_ms) / 4;
+  }
+
+  e.cadence_spm = 60000UL / e.interval_avg_ms;
+
+  if (e.walking) {
+    e.steps++;
+    return 1;
+  }
+
+  e.pending++;
+  if (e.pending >= STEP_ENGINE_CONFIRM_STEPS) {
+    int credited = e.pending;
+    e.walking = true;
+    e.pending = 0;
+    e.steps += credited;
+    return credited;
+  }
+  return 0;
+}
+
+// =============================================================================
+// PER-SAMPLE UPDATE
+// =============================================================================
+
+int stepEngineUpdate(StepEngine& e, int16_t ax, int16_t ay, int16_t az) {
+  // Sample clock
+  e.ms_frac += 1000;
+  e.now_ms += e.ms_frac / e.odr_hz;
+  e.ms_frac %= e.odr_hz;
+
+  // Magnitude in mg (orientation independent)
+  uint32_t sq = (uint32_t)((int32_t)ax * ax) + (uint32_t)((int32_t)ay * ay) +
+                (uint32_t)((int32_t)az * az);
+  int32_t mag_mg = (int32_t)(stepEngineSqrt(sq) * 1000 / e.lsb_per_g);
+
+  // Band-pass: removes gravity and hand tremor
+  int32_t y = (e.b0 * (mag_mg - e.x2) - e.a1 * e.y1 - e.a2 * e.y2) >> STEP_ENGINE_COEF_SHIFT;
+  e.x2 = e.x1;
+  e.x1 = mag_mg;
+
+  int credited = 0;
+
+  // Local maximum one sample back
+  if (e.y1 > y && e.y1 >= e.y2 && e.y1 > e.threshold_mg) {
+    credited = onPeak(e, e.y1);
+  }
+
+  e.y2 = e.y1;
+  e.y1 = y;
+
+  // Bout timed out without a new peak
+  if (e.have_peak && e.pending + (e.walking ? 1 : 0) > 0 &&
+      e.now_ms - e.last_peak_ms > STEP_ENGINE_MAX_INTERVAL_MS) {
+    endBout(e);
+    e.peak_avg_mg -= e.peak_avg_mg >> 1;
+    if (e.peak_avg_mg < STEP_ENGINE_MIN_PEAK_MG * 2) e.peak_avg_mg = STEP_ENGINE_MIN_PEAK_MG * 2;
+    e.threshold_mg = STEP_ENGINE_MIN_PEAK_MG;
+  }
+
+  return credited;
+}
@@ -0,0 +1,81 @@
+/*
+ * step_engine.h - Fixed-Point Software Pedometer
+ * FUSION OS Sensor Layer
+ *
+ * Runs on raw accelerometer samples (from the IMU FIFO ring):
+ *   |a| -> band-pass biquad (~2 Hz) -> peak detector with adaptive threshold
+ *       -> interval regularity check -> step count + cadence
+ * A walking bout only starts counting after STEP_ENGINE_CONFIRM_STEPS
+ * regularly spaced peaks, then credits them all at once, so random wrist
+ * motion never reaches the step total.
+ *
+ * Integer-only per sample and free of Arduino dependencies, so the same
+ * file can be compiled on a PC and fed recorded accelerometer traces.
+ */
+
+#ifndef STEP_ENGINE_H
+#define STEP_ENGINE_H
+
+#include <stdint.h>
+
+// =============================================================================
+// TUNING
+// =============================================================================
+#define STEP_ENGINE_F0_HZ             2.0f  // Band-pass centre (walking 1.4-2.5 Hz)
+#define STEP_ENGINE_Q                 0.7f  // Wide enough for slow walk to run
+#define STEP_ENGINE_MIN_PEAK_MG       60    // Floor of the adaptive threshold
+#define STEP_ENGINE_PEAK_RATIO_PCT    50    // Threshold = % of recent average peak
+#define STEP_ENGINE_MIN_INTERVAL_MS   250   // 240 spm ceiling
+#define STEP_ENGINE_MAX_INTERVAL_MS   2000  // Longer gap ends the bout
+#define STEP_ENGINE_CONFIRM_STEPS     4     // Regular peaks before a bout counts
+#define STEP_ENGINE_REGULARITY_PCT    35    // Allowed deviation from mean interval
+#define STEP_ENGINE_COEF_SHIFT        14    // Biquad coefficients in Q14
+
+// =============================================================================
+// STATE
+// =============================================================================
+struct StepEngine {
+  // Input format
+  uint16_t odr_hz;
+  int32_t lsb_per_g;
+
+  // Band-pass biquad, direct form I (b1 = 0, b2 = -b0)
+  int32_t b0, a1, a2;
+  int32_t x1, x2, y1, y2;
+
+  // Sample clock (exact at any ODR, no drift)
+  uint32_t now_ms;
+  uint32_t ms_frac;
+
+  // Peak detector
+  int32_t peak_avg_mg;
+  int32_t threshold_mg;
+  uint32_t last_peak_ms;
+  bool have_peak;
+
+  // Bout tracking
+  uint16_t interval_avg_ms;
+  uint8_t pending;          // Peaks in the current unconfirmed bout
+  bool walking;
+
+  // Output
+  uint32_t steps;
+  uint32_t rejected_peaks;  // Too close, too irregular or never confirmed
+  uint16_t cadence_spm;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// lsb_per_g is the accelerometer scale of the raw samples (8192 for +-4g)
+void stepEngineInit(StepEngine& e, uint16_t odr_hz, int32_t lsb_per_g);
+
+// Feed one raw sample; returns the steps credited by it (0, 1, or a whole
+// bout on confirmation)
+int stepEngineUpdate(StepEngine& e, int16_t ax, int16_t ay, int16_t az);
+
+// Integer square root used for the magnitude
+uint32_t stepEngineSqrt(uint32_t v);
+
+#endif // STEP_ENGINE_H
@@ -11,20 +11,23 @@
 #include "navigation.h"
 #include "hardware.h"
 #include "xp_system.h"  // FUSION OS: XP rewards
-#include <Wire.h>
+#include "i2c_bus.h"
+#include "qmi8658_reg.h"
+#include "reg_sequence.h"
+#include "imu_fifo.h"
+#include "step_engine.h"
+#include "activity_history.h"
+#include "daily_quests.h"
+#include "persist.h"
 #include <Preferences.h>
 
 extern Arduino_CO5300 *gfx;
 extern SystemState system_state;
 
 StepsData steps_data = {0, 10000, 0.0, 0, 0, 0, {}, {}, 0};
-// ULTRA SENSITIVE: Lowest possible threshold (0.15), shortest cooldown (100ms)
-// Any wrist movement will register as a step
+// Step detection thresholds live in step_engine.h; only the stride is used here
 ActivityThresholds activity_config = {0.15, 100, 0.65};
 
-static float last_magnitude = 1.0;
-static unsigned long last_step_time = 0;
-
 // FUSION OS: XP tracking
 static int last_xp_steps = 0;       // Last step count when XP was awarded
 static bool goal_reached_today = false;
@@ -46,6 +49,7 @@ void forceStepsCardRedraw() {
 
 void initStepsTracker() {
   loadStepsData();
+  initActivityHistory();
   WatchTime current_time = getCurrentTime();
   if (current_time.hour == 0 && steps_data.current_hour != 0) {
     for (int i = 6; i > 0; i--) {
@@ -240,10 +244,14 @@ void drawStepsCard() {
   
   const char* days[] = {"M", "T", "W", "T", "F", "S", "S"};
   
+  // Daily totals straight from the history store (week[6] = today)
+  uint32_t week[7];
+  historySeries(HISTORY_DAY, week, 7);
+  
   for (int i = 0; i < 7; i++) {
     int x = chartStartX + i * (barW + 6);
     int y = chartY + 15;
-    uint32_t daySteps = steps_data.weekly_steps[6 - i];
+    uint32_t daySteps = week[i];
     // FIX: Cast to same type to avoid max() template deduction error
     int barH = (daySteps * barMaxH) / max((uint32_t)1, steps_data.steps_goal);
     if (barH > barMaxH) barH = barMaxH;
@@ -321,139 +329,172 @@ void drawRetroStatCard(int x, int y, int w, int h, const char* label, float valu
   gfx->print(unit);
 }
 
+// =====================================================
+// QMI8658 PEDOMETER CONFIG - SUPER SENSITIVE MODE
+// Two CONFIGURE_PEDOMETER passes through CAL1..CAL4, each finished with the
+// CTRL9 handshake. Thresholds lowered for maximum step detection.
+// =====================================================
+static const RegSeqEntry pedometer_config[] = {
+  // Phase 1: detection thresholds
+  REG_WRITE(QMI8658_CAL1_L, 0x20),   // ped_sample_cnt low: 32 samples batch (was 80)
+  REG_WRITE(QMI8658_CAL1_H, 0x00),   // ped_sample_cnt high
+  REG_WRITE(QMI8658_CAL2_L, 0x14),   // peak2peak threshold low (20mg, was 50mg) ULTRA SENSITIVE
+  REG_WRITE(QMI8658_CAL2_H, 0x00),   // peak2peak threshold high
+  REG_WRITE(QMI8658_CAL3_L, 0x0F),   // peak threshold low (15mg, was 30mg) ULTRA SENSITIVE
+  REG_WRITE(QMI8658_CAL3_H, 0x00),   // peak threshold high
+  REG_WRITE(QMI8658_CAL4_L, 0x00),   // unused - keeps the block contiguous for one burst
+  REG_WRITE(QMI8658_CAL4_H, 0x01),   // first phase config
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_PEDOMETER),
+
+  // Phase 2: timing parameters - FASTER DETECTION
+  REG_WRITE(QMI8658_CAL1_L, 0x19),   // time_up low (0.5s @ 50Hz = 25, was 0.8s)
+  REG_WRITE(QMI8658_CAL1_H, 0x00),   // time_up high
+  REG_WRITE(QMI8658_CAL2_L, 0x05),   // time_low (0.1s @ 50Hz = 5, was 0.15s)
+  REG_WRITE(QMI8658_CAL2_H, 0x01),   // time_cnt_entry (1 step to confirm, was 2) INSTANT
+  REG_WRITE(QMI8658_CAL3_L, 0x00),   // precision (0)
+  REG_WRITE(QMI8658_CAL3_H, 0x01),   // sig_count (report every step, was 4) INSTANT
+  REG_WRITE(QMI8658_CAL4_L, 0x00),
+  REG_WRITE(QMI8658_CAL4_H, 0x02),   // second phase config
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_PEDOMETER),
+
+  // Enable the engine without touching the FIFO/motion bits
+  REG_SET_BITS(QMI8658_CTRL8, QMI8658_CTRL8_HANDSHAKE_STATUS | QMI8658_CTRL8_PEDO_EN),
+};
+
+static const RegSequence pedometer_sequence =
+  REG_SEQ("QMI8658 pedometer", QMI8658_ADDR, pedometer_config, true);
+
+// =====================================================
+// SOFTWARE STEP ENGINE + ACTIVITY CLASSIFIER - fed from the IMU FIFO ring
+// =====================================================
+static StepEngine step_engine;
+static ActivityClassifier activity_classifier;
+static bool step_engine_ready = false;
+static uint32_t step_ring_cursor = 0;
+static StepEngineStats step_stats = {0};
+
+// Both engines start together at the FIFO rate; the classifier's window
+// length comes from the ODR, so it must never run uninitialized
+static void initMotionEngines(uint16_t odr) {
+  stepEngineInit(step_engine, odr, IMU_ACCEL_LSB_PER_G);
+  activityClassifierInit(activity_classifier, odr, IMU_ACCEL_LSB_PER_G);
+  step_ring_cursor = imuRingHead();
+  step_engine_ready = true;
+}
+
+// Runs every new ring sample through the step engine and the classifier.
+// Returns steps credited; active_done is set to +1/-1 when a minute closes,
+// lost to the samples the ring overwrote before they were read.
+static uint32_t processMotionSamples(int& active_done, uint32_t& lost) {
+  uint16_t odr = getIMUFifoOdrHz();
+  if (!step_engine_ready || step_engine.odr_hz != odr) initMotionEngines(odr);
+  uint32_t behind = imuRingHead() - step_ring_cursor;
+  lost = behind > IMU_FIFO_RING_SIZE ? behind - IMU_FIFO_RING_SIZE : 0;
+
+  ImuSample batch[32];
+  uint32_t credited = 0;
+  active_done = 0;
+  int n;
+  while ((n = imuRingRead(step_ring_cursor, batch, 32)) > 0) {
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < n; i++) {
+      credited += stepEngineUpdate(step_engine, batch[i].ax, batch[i].ay, batch[i].az);
+    }
+    uint32_t mid = ESP.getCycleCount();
+    for (int i = 0; i < n; i++) {
+      int done = activityClassifierUpdate(activity_classifier, batch[i].ax, batch[i].ay, batch[i].az);
+      if (done != 0) active_done = done;
+    }
+    step_stats.cycles += mid - start;
+    step_stats.classifier_cycles += ESP.getCycleCount() - mid;
+    step_stats.samples += n;
+  }
+  return credited;
+}
+
+// Called on every loop pass, screen on or off. With the FIFO running it
+// works whenever a drain added ring samples; the register fallback keeps
+// the power manager's sensor poll interval.
 void updateStepCount() {
-  // =====================================================
-  // USE QMI8658 HARDWARE PEDOMETER - SUPER SENSITIVE MODE
-  // Lowered all thresholds for maximum step detection
-  // =====================================================
-  
   static bool pedometer_initialized = false;
+  static bool hw_baseline_taken = false;
   static uint32_t last_hw_steps = 0;
+  static unsigned long last_poll_ms = 0;
+  
+  bool software = STEPS_USE_SOFTWARE_ENGINE && isIMUFifoActive();
+  if (software) {
+    if (step_engine_ready && imuRingHead() == step_ring_cursor) return;
+  } else {
+    if (millis() - last_poll_ms < (unsigned long)getSensorPollInterval()) return;
+  }
+  last_poll_ms = millis();
   
   if (!pedometer_initialized) {
-    // Configure QMI8658 pedometer - SUPER SENSITIVE SETTINGS
-    
-    // Step 1: Configure pedometer parameters via CAL registers
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0B);  // CAL1_L - ped_sample_cnt low
-    Wire.write(0x20);  // 32 samples batch (was 80) - faster response
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0C);  // CAL1_H - ped_sample_cnt high  
-    Wire.write(0x00);
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0D);  // CAL2_L - peak2peak threshold low (20mg = 0x14) ULTRA SENSITIVE
-    Wire.write(0x14);  // Was 0x32 (50mg) - now 20mg for any tiny movement!
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0E);  // CAL2_H - peak2peak threshold high
-    Wire.write(0x00);
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0F);  // CAL3_L - peak threshold low (15mg = 0x0F) ULTRA SENSITIVE
-    Wire.write(0x0F);  // Was 0x1E (30mg) - now 15mg for any tiny movement!
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x10);  // CAL3_H - peak threshold high
-    Wire.write(0x00);
-    Wire.endTransmission();
-    
-    // Configure timing via CTRL9 command
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x11);  // CAL4_H
-    Wire.write(0x01);  // First phase config
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0A);  // CTRL9 - send CONFIGURE_PEDOMETER command
-    Wire.write(0x0D);
-    Wire.endTransmission();
-    delay(10);
-    
-    // Phase 2: Timing parameters - FASTER DETECTION
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0B);  // CAL1_L - time_up low (0.5s @ 50Hz = 25)
-    Wire.write(0x19);  // Was 0x28 (0.8s) - now 0.5s for even faster step window
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0C);  // CAL1_H - time_up high
-    Wire.write(0x00);
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0D);  // CAL2_L - time_low (0.1s @ 50Hz = 5)
-    Wire.write(0x05);  // Was 0x07 (0.15s) - even faster minimum step time
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0E);  // CAL2_H - time_cnt_entry (1 step to confirm) INSTANT
-    Wire.write(0x01);  // Was 0x02 (2 steps) - now just 1 step to start counting!
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0F);  // CAL3_L - precision (0)
-    Wire.write(0x00);
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x10);  // CAL3_H - sig_count (report every 1 step) INSTANT
-    Wire.write(0x01);  // Was 0x04 (every 4 steps) - now report EVERY step!
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x11);  // CAL4_H
-    Wire.write(0x02);  // Second phase config
-    Wire.endTransmission();
-    
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x0A);  // CTRL9 - send CONFIGURE_PEDOMETER command
-    Wire.write(0x0D);
-    Wire.endTransmission();
-    delay(10);
-    
-    // Enable pedometer in CTRL8
-    Wire.beginTransmission(QMI8658_ADDR);
-    Wire.write(0x08);  // CTRL8
-    uint8_t ctrl8 = 0x80 | 0x10;  // STATUS_INT handshake + Pedometer enable
-    Wire.write(ctrl8);
-    Wire.endTransmission();
-    
-    pedometer_initialized = true;
-    Serial.println("[Steps] QMI8658 SUPER SENSITIVE pedometer initialized");
+    pedometer_initialized = runRegSequence(pedometer_sequence);
+    if (pedometer_initialized) {
+      Serial.println("[Steps] QMI8658 SUPER SENSITIVE pedometer initialized");
+    }
   }
   
-  // Read step count from QMI8658 pedometer registers (0x58, 0x59, 0x5A)
-  Wire.beginTransmission(QMI8658_ADDR);
-  Wire.write(0x58);  // STEP_CNT_LOW
-  Wire.endTransmission(false);
-  Wire.requestFrom(QMI8658_ADDR, 3);
+  // Read step count from QMI8658 pedometer registers (0x5A, 0x5B, 0x5C)
+  uint32_t hw_new = 0;
+  bool hw_valid = false;
+  uint8_t raw[3];
+  if (i2cReadRegs(QMI8658_ADDR, QMI8658_STEP_CNT_L, raw, sizeof(raw))) {  // STEP_CNT_LOW..HIGH
+    uint32_t hw_steps = (uint32_t)raw[0] | ((uint32_t)raw[1] << 8) | ((uint32_t)raw[2] << 16);
+    if (hw_baseline_taken && hw_steps > last_hw_steps) hw_new = hw_steps - last_hw_steps;
+    hw_valid = hw_baseline_taken;
+    last_hw_steps = hw_steps;
+    hw_baseline_taken = true;
+    step_stats.hw_steps += hw_new;
+  }
   
-  if (Wire.available() >= 3) {
-    uint8_t low = Wire.read();
-    uint8_t mid = Wire.read();
-    uint8_t high = Wire.read();
-    
-    uint32_t hw_steps = (uint32_t)low | ((uint32_t)mid << 8) | ((uint32_t)high << 16);
-    
-    // Add new steps to today's count
-    if (hw_steps > last_hw_steps) {
-      uint32_t new_steps = hw_steps - last_hw_steps;
-      steps_data.steps_today += new_steps;
-      steps_data.hourly_steps[steps_data.current_hour] += new_steps;
-      
-      if (new_steps > 0) {
-        steps_data.active_minutes++;
-        Serial.printf("[Steps] +%d steps (total: %d)\n", new_steps, steps_data.steps_today);
+  // Software engine is authoritative while the FIFO runs; the hardware
+  // pedometer is the fallback and a cross-check. Samples lost to a ring
+  // overrun are credited at the engine's own cadence - the over-sensitive
+  // hardware count only caps that estimate.
+  uint32_t new_steps;
+  int active_done = 0;
+  if (software) {
+    uint32_t lost = 0;
+    uint32_t sw_new = processMotionSamples(active_done, lost);
+    new_steps = sw_new;
+    if (lost > 0) {
+      step_stats.overrun_passes++;
+      uint32_t gap = 0;
+      if (step_engine.walking && step_engine.odr_hz > 0) {
+        gap = (uint32_t)((uint64_t)step_engine.cadence_spm * lost / (step_engine.odr_hz * 60u));
       }
+      if (hw_valid) gap = min(gap, hw_new > sw_new ? hw_new - sw_new : 0);
+      step_stats.overrun_steps += gap;
+      new_steps += gap;
     }
-    last_hw_steps = hw_steps;
+    step_stats.sw_steps += new_steps;
+  } else {
+    new_steps = hw_new;
+  }
+  
+  // Keep the history rings on the wall clock; persist once per hour
+  static int history_saved_hour = -1;
+  WatchTime now = getCurrentTime();
+  historyTick(historyMinuteOf(now));
+  historyAddSteps(new_steps);
+  if (history_saved_hour != now.hour) {
+    if (history_saved_hour >= 0) saveActivityHistory();
+    history_saved_hour = now.hour;
+  }
+  
+  // Active minutes come from the classifier; without it, any minute-ish
+  // update with steps counts as before
+  if (active_done > 0 || (!software && new_steps > 0)) {
+    steps_data.active_minutes++;
+    historySetActive();
+    updateQuestProgress(QUEST_ACTIVE_TIME, 1);
+  }
+  
+  if (new_steps > 0) {
+    steps_data.steps_today += new_steps;
+    steps_data.hourly_steps[steps_data.current_hour] += new_steps;
   }
   
   // Calculate derived metrics
@@ -478,33 +519,61 @@ void updateStepCount() {
     Serial.println("[Steps] 🎉 Daily goal reached! +50 XP bonus");
   }
   
-  // Save periodically
-  if (steps_data.steps_today % 100 == 0 && steps_data.steps_today > 0) {
-    saveStepsData();
+  // Write-behind: marks are free, the flush policy bounds the writes
+  if (new_steps > 0) {
+    persistMarkDirty(PERSIST_STEPS);
   }
 }
 
+// Single-sample entry point (g units) for callers outside the FIFO path
 void processAccelerometerData(float ax, float ay, float az) {
-  float magnitude = sqrt(ax*ax + ay*ay + az*az);
-  
-  if (detectStep(magnitude)) {
-    steps_data.steps_today++;
-    steps_data.hourly_steps[steps_data.current_hour]++;
-    
-    if (millis() - last_step_time < 60000) {
-      steps_data.active_minutes++;
-    }
-    last_step_time = millis();
+  if (!step_engine_ready) initMotionEngines(getIMUFifoOdrHz());
+  int16_t x = (int16_t)constrain(ax * IMU_ACCEL_LSB_PER_G, -32768, 32767);
+  int16_t y = (int16_t)constrain(ay * IMU_ACCEL_LSB_PER_G, -32768, 32767);
+  int16_t z = (int16_t)constrain(az * IMU_ACCEL_LSB_PER_G, -32768, 32767);
+  int credited = stepEngineUpdate(step_engine, x, y, z);
+  activityClassifierUpdate(activity_classifier, x, y, z);
+  if (credited > 0) {
+    steps_data.steps_today += credited;
+    steps_data.hourly_steps[steps_data.current_hour] += credited;
+    system_state.steps_today = steps_data.steps_today;
   }
-  last_magnitude = magnitude;
 }
 
-bool detectStep(float magnitude) {
-  unsigned long now = millis();
-  if (now - last_step_time < activity_config.step_cooldown_ms) return false;
-  
-  float delta = magnitude - last_magnitude;
-  return (delta > activity_config.step_threshold);
+ActivityLabel getActivityLabel() {
+  return step_engine_ready ? activity_classifier.label : ACTIVITY_UNKNOWN;
+}
+
+const StepEngineStats* getStepEngineStats() {
+  step_stats.cadence_spm = step_engine.cadence_spm;
+  step_stats.walking = step_engine.walking;
+  step_stats.rejected_peaks = step_engine.rejected_peaks;
+  return &step_stats;
+}
+
+uint16_t getStepCadence() {
+  return step_engine.cadence_spm;
+}
+
+void printStepEngineStats() {
+  const StepEngineStats* st = getStepEngineStats();
+  uint32_t cps = st->samples ? st->cycles / st->samples : 0;
+  Serial.printf("[Steps] Engine: sw=%lu hw=%lu rejected=%lu | %s, cadence %d spm\n",
+                (unsigned long)st->sw_steps, (unsigned long)st->hw_steps,
+                (unsigned long)st->rejected_peaks,
+                st->walking ? "walking" : "idle", st->cadence_spm);
+  Serial.printf("[Steps] %lu samples, %lu cycles/sample, %lu overrun passes (%lu steps at cadence)\n",
+                (unsigned long)st->samples, (unsigned long)cps,
+                (unsigned long)st->overrun_passes, (unsigned long)st->overrun_steps);
+  
+  const ActivityFeatures& f = activity_classifier.features;
+  uint32_t ccps = st->samples ? st->classifier_cycles / st->samples : 0;
+  Serial.printf("[Activity] %s (window: %s) std=%ld mg, %d.%d Hz @ %d%% | %lu active min\n",
+                activityLabelName(getActivityLabel()), activityLabelName(activity_classifier.raw_label),
+                (long)f.std_mg, f.dominant_dhz / 10, f.dominant_dhz % 10, f.periodic_pct,
+                (unsigned long)activity_classifier.active_minutes);
+  Serial.printf("[Activity] %lu windows, %lu cycles/sample\n",
+                (unsigned long)activity_classifier.windows, (unsigned long)ccps);
 }
 
 void resetStepsToday() {
@@ -518,7 +587,7 @@ void resetStepsToday() {
   last_xp_steps = 0;
   goal_reached_today = false;
   
-  saveStepsData();
+  persistMarkDirty(PERSIST_STEPS);
 }
 
 uint32_t getTodaySteps() { return steps_data.steps_today; }
@@ -564,7 +633,7 @@ void handleStepsCardTouch(TouchGesture& gesture) {
         break;
       }
     }
-    saveStepsData();
+    persistMarkDirty(PERSIST_STEPS);
     drawStepsCard();
   }
 }
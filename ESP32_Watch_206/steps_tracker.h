@@ -8,6 +8,7 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "activity_classifier.h"
 
 // Step data structure
 struct StepsData {
@@ -29,6 +30,23 @@ struct ActivityThresholds {
   float stride_length_m;
 };
 
+// Software step engine diagnostics
+struct StepEngineStats {
+  uint32_t sw_steps;        // Credited by the software engine
+  uint32_t hw_steps;        // Counted by the QMI8658 pedometer (cross-check)
+  uint32_t rejected_peaks;
+  uint32_t samples;
+  uint64_t cycles;          // CPU cycles spent in the engine
+  uint64_t classifier_cycles;
+  uint32_t overrun_passes;  // Ring overran and samples were lost
+  uint32_t overrun_steps;   // Credited for them at the engine's cadence
+  uint16_t cadence_spm;
+  bool walking;
+};
+
+// 1 = count with the FIFO-fed software engine, 0 = QMI8658 hardware pedometer
+#define STEPS_USE_SOFTWARE_ENGINE 1
+
 // Function declarations
 void initStepsTracker();
 void drawStepsCard();
@@ -43,6 +61,9 @@ uint16_t getCaloriesBurned();
 void saveStepsData();
 void loadStepsData();
 void processAccelerometerData(float ax, float ay, float az);
-bool detectStep(float magnitude);
+uint16_t getStepCadence();
+ActivityLabel getActivityLabel();   // Debounced classifier output
+const StepEngineStats* getStepEngineStats();
+void printStepEngineStats();
 
 #endif
@@ -10,7 +10,8 @@
 #include "gacha.h"
 #include "display.h"
 #include "touch.h"
-#include "navigation.h"  
+#include "navigation.h"
+#include "save_schema.h"
 
 StorySystemState story_system;
 CharacterStory stories[THEME_COUNT];
@@ -1099,51 +1100,68 @@ void initStorySystem() {
 }
 
 // =============================================================================
-// NVS SAVE/LOAD (same as before)
+// NVS SAVE/LOAD - packed blob, migrated from the per-flag key layout
 // =============================================================================
-void saveStoryProgress() {
- if (!story_system.nvs_initialized) return;
- for (int i = 0; i < THEME_COUNT; i++) saveStoryProgressForCharacter((ThemeType)i);
- story_system.prefs.putInt("last_event_day", story_system.last_event_check_day);
- for (int i = 0; i < 4; i++) {
-   char key[20]; snprintf(key, sizeof(key), "event_%d_done", i);
-   story_system.prefs.putBool(key, story_system.daily_events[i].completed_today);
+static inline uint16_t storyFlagBit(int t, int ch, int flag) {
+ return (uint16_t)((t * MAX_CHAPTERS_PER_CHARACTER + ch) * STORY_CHAPTER_FLAGS + flag);
+}
+
+static void packStoryBlob(StoryBlob& b) {
+ memset(&b, 0, sizeof(b));
+ for (int i = 0; i < THEME_COUNT; i++) {
+   const CharacterStory* st = &stories[i];
+   b.current_chapter[i] = (uint8_t)constrain(st->current_chapter, 0, MAX_CHAPTERS_PER_CHARACTER);
+   b.chapters_completed[i] = (uint8_t)constrain(st->chapters_completed, 0, MAX_CHAPTERS_PER_CHARACTER);
+   progressBitSet(b.story_done, i, st->story_completed);
+   for (int j = 0; j < MAX_CHAPTERS_PER_CHARACTER; j++) {
+     progressBitSet(b.chapter_bits, storyFlagBit(i, j, 0), st->chapters[j].completed);
+     progressBitSet(b.chapter_bits, storyFlagBit(i, j, 1), st->chapters[j].boss_defeated);
+     progressBitSet(b.chapter_bits, storyFlagBit(i, j, 2), st->chapters[j].rewards_claimed);
+   }
+ }
+ b.yugo_path = (uint8_t)stories[THEME_YUGO_WAKFU].yugo_path;
+ b.last_event_day = (int16_t)story_system.last_event_check_day;
+ for (int i = 0; i < STORY_EVENT_COUNT; i++) {
+   if (story_system.daily_events[i].completed_today) b.events_done |= 1 << i;
  }
- story_system.prefs.putBool("initialized", true);
 }
 
-void saveStoryProgressForCharacter(ThemeType character) {
- if (!story_system.nvs_initialized || character >= THEME_COUNT) return;
- CharacterStory* st = &stories[character]; char key[32];
- getCharKey(character, "chapter", key, sizeof(key)); story_system.prefs.putInt(key, st->current_chapter);
- getCharKey(character, "completed", key, sizeof(key)); story_system.prefs.putInt(key, st->chapters_completed);
- getCharKey(character, "done", key, sizeof(key)); story_system.prefs.putBool(key, st->story_completed);
- if (character == THEME_YUGO_WAKFU) story_system.prefs.putInt("yugo_path", (int)st->yugo_path);
+static void unpackStoryCharacter(const StoryBlob& b, int i) {
+ CharacterStory* st = &stories[i];
+ st->current_chapter = b.current_chapter[i];
+ st->chapters_completed = b.chapters_completed[i];
+ st->story_completed = progressBitGet(b.story_done, i);
  for (int j = 0; j < MAX_CHAPTERS_PER_CHARACTER; j++) {
-   getChKey(character, j, "done", key, sizeof(key)); story_system.prefs.putBool(key, st->chapters[j].completed);
-   getChKey(character, j, "boss", key, sizeof(key)); story_system.prefs.putBool(key, st->chapters[j].boss_defeated);
-   getChKey(character, j, "reward", key, sizeof(key)); story_system.prefs.putBool(key, st->chapters[j].rewards_claimed);
+   st->chapters[j].completed = progressBitGet(b.chapter_bits, storyFlagBit(i, j, 0));
+   st->chapters[j].boss_defeated = progressBitGet(b.chapter_bits, storyFlagBit(i, j, 1));
+   st->chapters[j].rewards_claimed = progressBitGet(b.chapter_bits, storyFlagBit(i, j, 2));
+ }
+ if (i == THEME_YUGO_WAKFU) {
+   YugoStoryPath p = (YugoStoryPath)b.yugo_path;
+   st->yugo_path = p; if (p != YUGO_PATH_UNDECIDED) loadYugoPathStory(p);
  }
- // FIX: Also set initialized flag so loadStoryProgress() works after reboot
- story_system.prefs.putBool("initialized", true);
- Serial.printf("[Story] Saved progress for character %d (completed: %d)\n", (int)character, st->chapters_completed);
 }
 
-void loadStoryProgress() {
- if (!story_system.nvs_initialized) return;
- // FIX: Removed "initialized" check - if NVS has no data, getBool/getInt
- // return defaults anyway. The old check caused chapter progress to be lost
- // because saveStoryProgressForCharacter() didn't set the flag.
- for (int i = 0; i < THEME_COUNT; i++) loadStoryProgressForCharacter((ThemeType)i);
- story_system.last_event_check_day = story_system.prefs.getInt("last_event_day", -1);
- for (int i = 0; i < 4; i++) {
-   char key[20]; snprintf(key, sizeof(key), "event_%d_done", i);
-   story_system.daily_events[i].completed_today = story_system.prefs.getBool(key, false);
+static void unpackStoryBlob(const StoryBlob& b) {
+ for (int i = 0; i < THEME_COUNT; i++) unpackStoryCharacter(b, i);
+ story_system.last_event_check_day = b.last_event_day;
+ for (int i = 0; i < STORY_EVENT_COUNT; i++) {
+   story_system.daily_events[i].completed_today = b.events_done & (1 << i);
  }
 }
 
-void loadStoryProgressForCharacter(ThemeType character) {
- if (!story_system.nvs_initialized || character >= THEME_COUNT) return;
+static void writeStoryBlob() {
+ StoryBlob b;
+ packStoryBlob(b);
+ schemaPutBytes(story_system.prefs, STORY_BLOB_KEY, SCHEMA_STORY, &b, sizeof(b));
+}
+
+static bool readStoryBlob(StoryBlob& b) {
+ return schemaGetBytes(story_system.prefs, STORY_BLOB_KEY, SCHEMA_STORY, &b, sizeof(b));
+}
+
+// Pre-blob layout: one key per flag
+static void loadLegacyStoryCharacter(ThemeType character) {
  CharacterStory* st = &stories[character]; char key[32];
  getCharKey(character, "chapter", key, sizeof(key)); st->current_chapter = story_system.prefs.getInt(key, 0);
  getCharKey(character, "completed", key, sizeof(key)); st->chapters_completed = story_system.prefs.getInt(key, 0);
@@ -1159,6 +1177,48 @@ void loadStoryProgressForCharacter(ThemeType character) {
  }
 }
 
+static void migrateLegacyStoryKeys() {
+ // "initialized" was only ever written by the old saves; a partial old save
+ // without it still has per-character keys
+ if (!story_system.prefs.isKey("initialized") && !story_system.prefs.isKey("s0_chapter") &&
+     !story_system.prefs.isKey("yugo_path")) return;
+ for (int i = 0; i < THEME_COUNT; i++) loadLegacyStoryCharacter((ThemeType)i);
+ story_system.last_event_check_day = story_system.prefs.getInt("last_event_day", -1);
+ for (int i = 0; i < STORY_EVENT_COUNT; i++) {
+   char key[20]; snprintf(key, sizeof(key), "event_%d_done", i);
+   story_system.daily_events[i].completed_today = story_system.prefs.getBool(key, false);
+ }
+ // The namespace holds nothing else: drop the old entries, keep the blob
+ story_system.prefs.clear();
+ writeStoryBlob();
+ Serial.println("[Story] Migrated per-flag keys to packed blob");
+}
+
+void saveStoryProgress() {
+ if (!story_system.nvs_initialized) return;
+ writeStoryBlob();
+}
+
+void saveStoryProgressForCharacter(ThemeType character) {
+ if (!story_system.nvs_initialized || character >= THEME_COUNT) return;
+ // One blob holds every character - same single write either way
+ writeStoryBlob();
+ Serial.printf("[Story] Saved progress for character %d (completed: %d)\n", (int)character, stories[character].chapters_completed);
+}
+
+void loadStoryProgress() {
+ if (!story_system.nvs_initialized) return;
+ StoryBlob b;
+ if (readStoryBlob(b)) unpackStoryBlob(b);
+ else migrateLegacyStoryKeys();
+}
+
+void loadStoryProgressForCharacter(ThemeType character) {
+ if (!story_system.nvs_initialized || character >= THEME_COUNT) return;
+ StoryBlob b;
+ if (readStoryBlob(b)) unpackStoryCharacter(b, character);
+}
+
 void clearAllStoryProgress() {
  if (!story_system.nvs_initialized) return;
  story_system.prefs.clear();
@@ -1308,7 +1368,7 @@ void claimBossRewards() {
 void setYugoPath(YugoStoryPath p) {
  if (stories[THEME_YUGO_WAKFU].yugo_path == YUGO_PATH_UNDECIDED) {
    stories[THEME_YUGO_WAKFU].yugo_path = p; loadYugoPathStory(p);
-   if (story_system.nvs_initialized) story_system.prefs.putInt("yugo_path", (int)p);
+   saveStoryProgress();
  }
 }
 YugoStoryPath getYugoPath() { return stories[THEME_YUGO_WAKFU].yugo_path; }
@@ -12,6 +12,7 @@
 #include <Preferences.h>
 #include "config.h"
 #include "types.h"
+#include "progress_bits.h"
 
 // =============================================================================
 // STORY CONSTANTS - EXPANDED TO 15 CHAPTERS
@@ -46,6 +47,30 @@
 
 #define STORY_NVS_NAMESPACE "story_data"
 
+// =============================================================================
+// PACKED SAVE BLOB - whole story state in one NVS entry
+// =============================================================================
+// Replaces ~500 per-flag keys (s<t>_c<j>_done/boss/reward). Old key layouts
+// are migrated on first load and then cleared from the namespace.
+// Stored through save_schema (SCHEMA_STORY): the header carries the
+// version and NVS checksums the entry, so the blob holds payload only.
+#define STORY_BLOB_KEY     "blob"
+#define STORY_EVENT_COUNT  4
+#define STORY_CHAPTER_FLAGS 3       // completed, boss_defeated, rewards_claimed
+#define STORY_FLAG_BITS    (THEME_COUNT * MAX_CHAPTERS_PER_CHARACTER * STORY_CHAPTER_FLAGS)
+
+#pragma pack(push, 1)
+struct StoryBlob {
+    uint8_t  current_chapter[THEME_COUNT];
+    uint8_t  chapters_completed[THEME_COUNT];
+    uint8_t  story_done[PROGRESS_BITS_BYTES(THEME_COUNT)];
+    uint8_t  yugo_path;
+    int16_t  last_event_day;
+    uint8_t  events_done;       // Bit per daily event
+    uint8_t  chapter_bits[PROGRESS_BITS_BYTES(STORY_FLAG_BITS)];
+};  // 90 bytes
+#pragma pack(pop)
+
 // =============================================================================
 // CHAPTER UNLOCK NOTIFICATION SYSTEM
 // =============================================================================
@@ -21,6 +21,7 @@
 #include "ochobot.h"
 #include "navigation.h"
 #include "companion.h"
+#include "persist.h"
 
 extern Arduino_CO5300 *gfx;
 extern SystemState system_state;
@@ -4098,7 +4099,9 @@ static void applyThemeAndReboot(ThemeType newTheme) {
   
   // ---------------------------------------------------------------
   // STEP 1 — Save old character's per-theme data (no "theme" key).
+  // Pending write-behind records go first, under the old theme.
   // ---------------------------------------------------------------
+  persistFlush(PERSIST_REASON_SHUTDOWN);
   savePerThemeDataOnly();
   feedWatchdog();
   
@@ -4364,8 +4367,8 @@ void equipTitleBySlot(int slot) {
   if (unlocked_index >= 0) {
     char_xp->equipped_title_index = unlocked_index;
     
-    // Save to NVS - using correct function from xp_system.h
-    saveXPData();
+    // Write-behind save (xp_system.h record)
+    persistMarkDirty(PERSIST_XP);
     
     Serial.printf("[TITLES] Equipped: %s\n", char_xp->titles[unlocked_index].name);
   }
@@ -0,0 +1,329 @@
+/*
+ * time_service.cpp - Cached Wall-Clock Time Implementation
+ * FUSION OS System Layer
+ */
+
+#include "time_service.h"
+#include "hardware.h"
+#include "i2c_bus.h"
+#include "loop_events.h"
+#include "scheduler.h"
+
+#define TIME_PHASE_POLL_MS      20      // Seconds-register poll while hunting the edge
+#define TIME_PHASE_TIMEOUT_MS   2500
+#define PCF85063_REG_CTRL2      0x01
+#define PCF85063_REG_SECONDS    0x04
+#define PCF85063_COF_MASK       0x07
+#define PCF85063_COF_1HZ        0x06
+
+// Interpolation base: base_epoch was current at millis() == base_ms
+static uint32_t base_epoch = 0;
+static unsigned long base_ms = 0;
+
+static uint32_t cached_epoch = 0xFFFFFFFF;
+static WatchTime cached_time;
+
+static unsigned long last_resync_ms = 0;
+static volatile unsigned long rtc_edge_ms = 0;
+static volatile bool rtc_edge_seen = false;
+
+// Sub-second phase hunt (no INT pin): poll seconds until it ticks
+static bool hunting = false;
+static uint8_t hunt_second = 0;
+static unsigned long hunt_start_ms = 0;
+static unsigned long hunt_last_ms = 0;
+
+static uint32_t last_minute_index = 0;
+static uint32_t last_hour_index = 0;
+static uint32_t last_day_index = 0;
+
+struct TimeSubscriber {
+  uint8_t events;
+  TimeEventCallback cb;
+};
+static TimeSubscriber subscribers[TIME_MAX_SUBSCRIBERS];
+
+static TimeServiceStats time_stats = {0};
+
+// =============================================================================
+// CALENDAR (days_from_civil / civil_from_days)
+// =============================================================================
+
+static int32_t daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  int32_t era = y / 400;
+  int32_t yoe = y - era * 400;
+  int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+#define DAYS_1970_TO_2000  10957
+
+uint32_t timeToEpoch(const WatchTime& t) {
+  uint32_t days = daysFromCivil(t.year, t.month, t.day) - DAYS_1970_TO_2000;
+  return days * 86400UL + t.hour * 3600UL + t.minute * 60UL + t.second;
+}
+
+void timeFromEpoch(uint32_t epoch, WatchTime& out) {
+  uint32_t secs = epoch % 86400UL;
+  int32_t z = epoch / 86400UL + DAYS_1970_TO_2000;
+
+  out.hour = secs / 3600;
+  out.minute = (secs / 60) % 60;
+  out.second = secs % 60;
+  out.weekday = (z + 4) % 7;    // 1970-01-01 was a Thursday, 0 = Sunday
+
+  z += 719468;
+  int32_t era = z / 146097;
+  int32_t doe = z - era * 146097;
+  int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int32_t mp = (5 * doy + 2) / 153;
+  out.day = doy - (153 * mp + 2) / 5 + 1;
+  out.month = mp < 10 ? mp + 3 : mp - 9;
+  out.year = yoe + era * 400 + (out.month <= 2);
+}
+
+static bool isPlausible(WatchTime t) {
+  return t.year >= 2000 && t.year <= 2099 && t.month >= 1 && t.month <= 12 &&
+         t.day >= 1 && t.day <= 31 && isValidTime(t);
+}
+
+// =============================================================================
+// INTERPOLATION
+// =============================================================================
+
+uint32_t timeServiceEpoch() {
+  return base_epoch + (millis() - base_ms) / 1000;
+}
+
+uint64_t timeServiceEpochMs() {
+  return (uint64_t)base_epoch * 1000 + (millis() - base_ms);
+}
+
+WatchTime timeServiceNow() {
+  time_stats.queries++;
+  uint32_t epoch = timeServiceEpoch();
+  if (epoch != cached_epoch) {
+    timeFromEpoch(epoch, cached_time);
+    cached_epoch = epoch;
+    time_stats.conversions++;
+  }
+  return cached_time;
+}
+
+// Every change of the time base goes through here. The scheduler's
+// one-shot timer was armed as a delay on the old base, so it re-arms too.
+static void rebase(uint32_t epoch, unsigned long at_ms) {
+  base_epoch = epoch;
+  base_ms = at_ms;
+  cached_epoch = 0xFFFFFFFF;
+  schedulerRearm();
+}
+
+void timeServiceSet(const WatchTime& t) {
+  // Writing the PCF85063 seconds register restarts its prescaler, so the
+  // new second starts now
+  rebase(timeToEpoch(t), millis());
+  hunting = false;
+}
+
+// =============================================================================
+// RTC RESYNC
+// =============================================================================
+
+static bool readRtcEpoch(uint32_t& epoch, uint8_t& second) {
+  WatchTime t;
+  time_stats.rtc_reads++;
+  if (!rtcReadTime(t) || !isPlausible(t)) {
+    time_stats.rtc_errors++;
+    return false;
+  }
+  epoch = timeToEpoch(t);
+  second = t.second;
+  return true;
+}
+
+bool timeServiceResync() {
+  uint32_t rtc;
+  uint8_t second;
+  if (!readRtcEpoch(rtc, second)) return false;
+
+  unsigned long now = millis();
+  last_resync_ms = now;
+
+  #if TIME_RTC_INT_PIN >= 0
+    // The last 1 Hz edge is where this second began
+    if (rtc_edge_seen && now - rtc_edge_ms < 1000) {
+      if (rtc != base_epoch + (rtc_edge_ms - base_ms) / 1000) {
+        time_stats.corrections++;
+        time_stats.last_drift_s = (int32_t)(rtc - timeServiceEpoch());
+      }
+      rebase(rtc, rtc_edge_ms);
+      return true;
+    }
+  #endif
+
+  uint32_t interp = timeServiceEpoch();
+  if (rtc == interp) return true;
+
+  time_stats.corrections++;
+  time_stats.last_drift_s = (int32_t)(rtc - interp);
+  rebase(rtc, now);
+
+  #if TIME_RTC_INT_PIN < 0
+    // Phase is only known to a second - find the next tick
+    hunting = true;
+    hunt_second = second;
+    hunt_start_ms = now;
+    hunt_last_ms = now;
+  #endif
+  return true;
+}
+
+static void huntPhase() {
+  if (millis() - hunt_last_ms < TIME_PHASE_POLL_MS) return;
+  hunt_last_ms = millis();
+
+  if (millis() - hunt_start_ms > TIME_PHASE_TIMEOUT_MS) {
+    hunting = false;
+    return;
+  }
+
+  uint8_t raw = 0;
+  if (!i2cReadReg(RTC_ADDR, PCF85063_REG_SECONDS, &raw)) return;
+  uint8_t second = (raw >> 4 & 0x07) * 10 + (raw & 0x0F);
+  if (second == hunt_second) return;
+
+  // The RTC just ticked: read the full time and pin the base to this edge
+  hunting = false;
+  uint32_t rtc;
+  if (readRtcEpoch(rtc, second)) rebase(rtc, millis() - TIME_PHASE_POLL_MS / 2);
+}
+
+void IRAM_ATTR timeRtcISR() {
+  rtc_edge_ms = millis();
+  rtc_edge_seen = true;
+  loopEventFromISR(LOOP_EVT_RTC);
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+void initTimeService() {
+  WatchTime fallback = {12, 0, 0, 1, 1, 2025, 0};
+  rebase(timeToEpoch(fallback), millis());
+
+  #if TIME_RTC_INT_PIN >= 0
+    // 1 Hz square wave on CLKOUT
+    uint8_t ctrl2 = 0;
+    if (i2cReadReg(RTC_ADDR, PCF85063_REG_CTRL2, &ctrl2)) {
+      i2cWriteReg(RTC_ADDR, PCF85063_REG_CTRL2, (ctrl2 & ~PCF85063_COF_MASK) | PCF85063_COF_1HZ);
+    }
+    pinMode(TIME_RTC_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(TIME_RTC_INT_PIN), timeRtcISR, FALLING);
+  #endif
+
+  bool ok = timeServiceResync();
+  time_stats.corrections = 0;     // Boot seed is not drift
+  time_stats.last_drift_s = 0;
+
+  uint32_t epoch = timeServiceEpoch();
+  last_minute_index = epoch / 60;
+  last_hour_index = epoch / 3600;
+  last_day_index = epoch / 86400;
+
+  WatchTime now = timeServiceNow();
+  Serial.printf("[TIME] %s %04d-%02d-%02d %02d:%02d:%02d, resync every %d s (%s)\n",
+                ok ? "RTC" : "Fallback", now.year, now.month, now.day,
+                now.hour, now.minute, now.second, TIME_RESYNC_MS / 1000,
+                TIME_RTC_INT_PIN >= 0 ? "1 Hz INT" : "millis");
+}
+
+// =============================================================================
+// SUBSCRIBERS
+// =============================================================================
+
+bool timeSubscribe(uint8_t events, TimeEventCallback cb) {
+  for (int i = 0; i < TIME_MAX_SUBSCRIBERS; i++) {
+    if (subscribers[i].cb == NULL || subscribers[i].cb == cb) {
+      subscribers[i].events = events;
+      subscribers[i].cb = cb;
+      return true;
+    }
+  }
+  Serial.println("[TIME] Subscriber table full");
+  return false;
+}
+
+void timeUnsubscribe(TimeEventCallback cb) {
+  for (int i = 0; i < TIME_MAX_SUBSCRIBERS; i++) {
+    if (subscribers[i].cb == cb) {
+      subscribers[i].cb = NULL;
+      subscribers[i].events = 0;
+    }
+  }
+}
+
+// =============================================================================
+// LOOP HOOK
+// =============================================================================
+
+void updateTimeService() {
+  if (hunting) huntPhase();
+  if (millis() - last_resync_ms >= TIME_RESYNC_MS) timeServiceResync();
+
+  uint32_t epoch = timeServiceEpoch();
+  uint32_t minute = epoch / 60;
+  if (minute == last_minute_index) return;
+
+  uint8_t events = TIME_EVENT_MINUTE;
+  if (epoch / 3600 != last_hour_index) events |= TIME_EVENT_HOUR;
+  if (epoch / 86400 != last_day_index) events |= TIME_EVENT_DAY;
+  last_minute_index = minute;
+  last_hour_index = epoch / 3600;
+  last_day_index = epoch / 86400;
+
+  time_stats.events++;
+  WatchTime now = timeServiceNow();
+  for (int i = 0; i < TIME_MAX_SUBSCRIBERS; i++) {
+    if (subscribers[i].cb && (subscribers[i].events & events)) {
+      subscribers[i].cb(events, now);
+    }
+  }
+}
+
+uint32_t timeServiceMsUntilNext() {
+  if (hunting) return TIME_PHASE_POLL_MS;
+
+  uint64_t now_ms = timeServiceEpochMs();
+  uint32_t to_minute = 60000 - (uint32_t)(now_ms % 60000);
+  uint32_t since_resync = millis() - last_resync_ms;
+  uint32_t to_resync = since_resync >= TIME_RESYNC_MS ? 0 : TIME_RESYNC_MS - since_resync;
+  return min(to_minute, to_resync);
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const TimeServiceStats* getTimeServiceStats() {
+  return &time_stats;
+}
+
+void printTimeServiceStats() {
+  WatchTime now = timeServiceNow();
+  Serial.printf("[TIME] %02d:%02d:%02d epoch=%lu%s\n", now.hour, now.minute, now.second,
+                (unsigned long)timeServiceEpoch(), hunting ? " (phase hunt)" : "");
+  Serial.printf("[TIME] queries=%lu conversions=%lu rtc_reads=%lu errors=%lu\n",
+                (unsigned long)time_stats.queries,
+                (unsigned long)time_stats.conversions,
+                (unsigned long)time_stats.rtc_reads,
+                (unsigned long)time_stats.rtc_errors);
+  Serial.printf("[TIME] corrections=%lu last_drift=%ld s events=%lu\n",
+                (unsigned long)time_stats.corrections,
+                (long)time_stats.last_drift_s,
+                (unsigned long)time_stats.events);
+}
@@ -0,0 +1,88 @@
+/*
+ * time_service.h - Cached Wall-Clock Time
+ * FUSION OS System Layer
+ *
+ * The PCF85063 is read once at boot. After that the time is interpolated
+ * from millis() (seconds since 2000-01-01 + elapsed ms) and resynced from
+ * the RTC once per TIME_RESYNC_MS, so getCurrentTime() costs no I2C. With
+ * the RTC CLKOUT/INT line routed (TIME_RTC_INT_PIN) each 1 Hz edge also
+ * pins the sub-second phase.
+ *
+ * Minute / hour / day changes are published from the loop hook to
+ * subscribers, so modules stop polling the clock to notice them.
+ */
+
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define TIME_RESYNC_MS          60000   // RTC read period
+#define TIME_RTC_INT_PIN        -1      // PCF85063 INT/CLKOUT GPIO (-1: not routed)
+#define TIME_MAX_SUBSCRIBERS    8
+
+// =============================================================================
+// EVENTS
+// =============================================================================
+enum TimeEvent : uint8_t {
+  TIME_EVENT_MINUTE = 0x01,
+  TIME_EVENT_HOUR   = 0x02,
+  TIME_EVENT_DAY    = 0x04
+};
+
+// `events` holds every TimeEvent bit that fired on this change
+typedef void (*TimeEventCallback)(uint8_t events, const WatchTime& now);
+
+struct TimeServiceStats {
+  uint32_t queries;           // getCurrentTime() calls served from RAM
+  uint32_t conversions;       // Epoch -> WatchTime (once per new second)
+  uint32_t rtc_reads;
+  uint32_t rtc_errors;
+  uint32_t corrections;       // Resyncs that moved the clock
+  int32_t last_drift_s;       // RTC - interpolated at the last correction
+  uint32_t events;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Seed from the RTC (after initializeRTC)
+void initTimeService();
+
+// Loop hook: periodic resync + event dispatch
+void updateTimeService();
+
+// Cached time (what getCurrentTime() returns)
+WatchTime timeServiceNow();
+
+// Seconds since 2000-01-01 00:00:00 (local)
+uint32_t timeServiceEpoch();
+uint64_t timeServiceEpochMs();
+
+// Re-seed after the RTC was written
+void timeServiceSet(const WatchTime& t);
+
+// ms until the next minute event / resync / phase poll (loop sleep budget)
+uint32_t timeServiceMsUntilNext();
+
+// Force an RTC read now
+bool timeServiceResync();
+
+bool timeSubscribe(uint8_t events, TimeEventCallback cb);
+void timeUnsubscribe(TimeEventCallback cb);
+
+// Calendar helpers (2000..2099)
+uint32_t timeToEpoch(const WatchTime& t);
+void timeFromEpoch(uint32_t epoch, WatchTime& out);
+
+const TimeServiceStats* getTimeServiceStats();
+void printTimeServiceStats();
+
+void IRAM_ATTR timeRtcISR();
+
+#endif // TIME_SERVICE_H
@@ -8,7 +8,8 @@
 
 #include "touch.h"
 #include "config.h"
-#include <Wire.h>
+#include "i2c_bus.h"
+#include "reg_sequence.h"
 
 // Touch state tracking
 static bool touchPressed = false;
@@ -27,20 +28,16 @@ static int digitalCrownValue = 0;
 // LOW-LEVEL TOUCH READ - FT3168 returns screen coordinates directly!
 // =============================================================================
 bool touchRead(uint16_t &x, uint16_t &y) {
-  Wire.beginTransmission(FT3168_ADDR);
-  Wire.write(0x02);  // Touch data register
-  if (Wire.endTransmission(false) != 0) return false;
+  uint8_t raw[5];
+  if (!i2cReadRegs(FT3168_ADDR, 0x02, raw, sizeof(raw))) return false;  // Touch data register
   
-  Wire.requestFrom((uint8_t)FT3168_ADDR, (uint8_t)5);
-  if (Wire.available() < 5) return false;
-  
-  uint8_t touches = Wire.read();
+  uint8_t touches = raw[0];
   if (touches == 0 || touches > 2) return false;
   
-  uint8_t xh = Wire.read();
-  uint8_t xl = Wire.read();
-  uint8_t yh = Wire.read();
-  uint8_t yl = Wire.read();
+  uint8_t xh = raw[1];
+  uint8_t xl = raw[2];
+  uint8_t yh = raw[3];
+  uint8_t yl = raw[4];
   
   // FT3168 returns coordinates in screen pixels directly!
   x = ((xh & 0x0F) << 8) | xl;
@@ -54,6 +51,14 @@ bool touchReadEx(uint16_t &x, uint16_t &y, uint8_t &pressure) {
   return touchRead(x, y);
 }
 
+// FT3168 start-up state: working mode, stay active (no auto-monitor)
+static const RegSeqEntry ft3168_init[] = {
+  REG_WRITE(0x00, 0x00),    // DEVICE_MODE - normal working mode
+  REG_WRITE(0xA5, 0x00),    // POWER_MODE - active
+};
+
+static const RegSequence ft3168_sequence = REG_SEQ("FT3168", FT3168_ADDR, ft3168_init, true);
+
 // =============================================================================
 // INITIALIZE TOUCH - With reset pin support for 2.06" board
 // =============================================================================
@@ -68,12 +73,14 @@ bool initializeTouch() {
     Serial.println("[TOUCH] Touch controller reset via TP_RST");
   #endif
   
-  Wire.beginTransmission(FT3168_ADDR);
-  if (Wire.endTransmission() != 0) {
+  if (!i2cProbe(FT3168_ADDR)) {
     Serial.println("[TOUCH] FT3168 not found!");
     return false;
   }
   
+  // Not fatal: the controller boots into the same state on its own
+  runRegSequence(ft3168_sequence);
+  
   Serial.println("[TOUCH] FT3168 initialized (2.06\" board)");
   Serial.printf("[TOUCH] Swipe threshold: %d pixels\n", TOUCH_SWIPE_THRESHOLD);
   return true;
@@ -262,18 +269,13 @@ void loadTouchCalibration() { }
 int getDigitalCrownValue() { return digitalCrownValue; }
 void resetDigitalCrown() { digitalCrownValue = 0; }
 
-// I2C recovery
+// I2C recovery - bus-clear through the shared bus manager (other devices keep their state)
 bool recoverTouchI2C() {
-  Wire.end();
-  delay(10);
-  Wire.begin(IIC_SDA, IIC_SCL);
-  Wire.setClock(400000);
-  return true;
+  return i2cBusRecover();
 }
 
 bool checkAndRecoverTouchI2C() {
-  Wire.beginTransmission(FT3168_ADDR);
-  if (Wire.endTransmission() != 0) {
+  if (!i2cProbe(FT3168_ADDR)) {
     return recoverTouchI2C();
   }
   return true;
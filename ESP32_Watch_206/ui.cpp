@@ -13,6 +13,7 @@
 #include "daily_quests.h"  // FUSION OS: For drawDailyQuestsScreen()
 #include "hardware.h"
 #include "navigation.h"
+#include "energy_monitor.h"
 
 // Forward declarations
 void drawSplashScreen();
@@ -213,6 +214,37 @@ void drawAboutScreen() {
   gfx->setCursor(38, 292);
   gfx->print("WiFi + BT | SD Card | IMU");
   
+  // Battery usage card (energy model since boot / last reset)
+  const EnergyStats* e = getEnergyStats();
+  uint32_t elapsed = e->elapsed_ms ? e->elapsed_ms : 1;
+  gfx->fillRect(20, 320, LCD_WIDTH - 40, 130, RGB565(22, 24, 32));
+  gfx->drawRect(20, 320, LCD_WIDTH - 40, 130, RGB565(50, 52, 65));
+  
+  gfx->setTextColor(theme->primary);
+  gfx->setCursor(38, 335);
+  gfx->print("Battery Usage");
+  
+  gfx->setTextColor(RGB565(160, 160, 170));
+  gfx->setCursor(38, 355);
+  gfx->printf("%lum: %.1f mAh, avg %.1f mA (~%.1f h)",
+              (unsigned long)(e->elapsed_ms / 60000), energyTotalMah(),
+              energyAverageMa(), energyProjectedHours());
+  gfx->setCursor(38, 373);
+  gfx->printf("Screen on %lu%%  Sleep %lu%%  WiFi %lum",
+              (unsigned long)(100 - e->state_ms[POWER_SCREEN_OFF] * 100ULL / elapsed),
+              (unsigned long)(e->light_sleep_ms * 100ULL / elapsed),
+              (unsigned long)(e->wifi_ms / 60000));
+  gfx->setCursor(38, 391);
+  gfx->printf("Disp %.1f  CPU %.1f  WiFi %.1f mAh",
+              energySubsystemMah(ENERGY_SUB_DISPLAY), energySubsystemMah(ENERGY_SUB_CPU),
+              energySubsystemMah(ENERGY_SUB_WIFI));
+  gfx->setCursor(38, 409);
+  gfx->printf("Sens %.2f  Store %.2f  Base %.2f mAh",
+              energySubsystemMah(ENERGY_SUB_SENSORS), energySubsystemMah(ENERGY_SUB_STORAGE),
+              energySubsystemMah(ENERGY_SUB_BASE));
+  gfx->setCursor(38, 427);
+  gfx->printf("AXP2101 %d%% -> %d%%", e->pmu_start_pct, e->pmu_last_pct);
+  
   drawSwipeIndicator();
 }
 
@@ -0,0 +1,294 @@
+/*
+ * wrist_wake.cpp - Raise-to-Wake Implementation
+ * FUSION OS Sensor Layer
+ */
+
+#include "wrist_wake.h"
+#include "config.h"
+#include "i2c_bus.h"
+#include "imu_fifo.h"
+#include "reg_sequence.h"
+#include "loop_events.h"
+#include <driver/gpio.h>
+
+static bool wrist_ready = false;
+static volatile bool motion_irq = false;
+static unsigned long last_poll = 0;
+static unsigned long last_motion_ms = 0;
+static WristWakeStats wrist_stats = {0};
+
+// Confirmation window, advanced one read per loop pass
+enum WristState : uint8_t { WRIST_IDLE = 0, WRIST_CONFIRMING };
+static WristState wrist_state = WRIST_IDLE;
+static unsigned long confirm_start = 0;
+static unsigned long confirm_next_read = 0;
+static unsigned long motion_start = 0;      // Capture time of the pre-raise pose
+static float start_x, start_y, start_z;     // Pose before the raise
+static uint8_t confirm_good = 0;
+
+// =============================================================================
+// MOTION ENGINE CONFIG - two CONFIGURE_MOTION passes, then enable any-motion
+// =============================================================================
+static const RegSeqEntry motion_config[] = {
+  // Pass 1: thresholds + mode
+  REG_WRITE(QMI8658_CAL1_L, WRIST_MOTION_THRESHOLD),   // any-motion X
+  REG_WRITE(QMI8658_CAL1_H, WRIST_MOTION_THRESHOLD),   // any-motion Y
+  REG_WRITE(QMI8658_CAL2_L, WRIST_MOTION_THRESHOLD),   // any-motion Z
+  REG_WRITE(QMI8658_CAL2_H, 0x00),                     // no-motion X/Y/Z unused
+  REG_WRITE(QMI8658_CAL3_L, 0x00),
+  REG_WRITE(QMI8658_CAL3_H, 0x00),
+  REG_WRITE(QMI8658_CAL4_L, QMI8658_MOTION_ANY_X | QMI8658_MOTION_ANY_Y | QMI8658_MOTION_ANY_Z),
+  REG_WRITE(QMI8658_CAL4_H, 0x01),
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_MOTION),
+
+  // Pass 2: windows (significant motion unused)
+  REG_WRITE(QMI8658_CAL1_L, WRIST_MOTION_WINDOW),      // any-motion window
+  REG_WRITE(QMI8658_CAL1_H, 0x00),                     // no-motion window
+  REG_WRITE(QMI8658_CAL2_L, 0x00),
+  REG_WRITE(QMI8658_CAL2_H, 0x00),
+  REG_WRITE(QMI8658_CAL3_L, 0x00),
+  REG_WRITE(QMI8658_CAL3_H, 0x00),
+  REG_WRITE(QMI8658_CAL4_L, 0x00),
+  REG_WRITE(QMI8658_CAL4_H, 0x02),
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_MOTION),
+
+  REG_SET_BITS(QMI8658_CTRL8, QMI8658_CTRL8_ANY_MOTION_EN),
+};
+
+static const RegSequence motion_sequence =
+  REG_SEQ("QMI8658 any-motion", QMI8658_ADDR, motion_config, true);
+
+#if WRIST_WAKE_INT_PIN >= 0
+// Motion engine events on INT1
+static const RegSeqEntry motion_int1[] = {
+  REG_SET_BITS(QMI8658_CTRL1, QMI8658_CTRL1_INT1_EN),
+  REG_SET_BITS(QMI8658_CTRL8, QMI8658_CTRL8_ACTIVITY_INT1),
+};
+
+static const RegSequence motion_int1_sequence =
+  REG_SEQ("QMI8658 INT1 route", QMI8658_ADDR, motion_int1, true);
+#endif
+
+// =============================================================================
+// INTERRUPT
+// =============================================================================
+
+void IRAM_ATTR wristWakeISR() {
+  motion_irq = true;
+  loopEventFromISR(LOOP_EVT_WRIST);
+}
+
+// =============================================================================
+// INITIALIZATION
+// =============================================================================
+
+bool initWristWake() {
+  wrist_ready = runRegSequence(motion_sequence);
+
+  #if WRIST_WAKE_INT_PIN >= 0
+    if (wrist_ready) wrist_ready = runRegSequence(motion_int1_sequence);
+    pinMode(WRIST_WAKE_INT_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(WRIST_WAKE_INT_PIN), wristWakeISR, RISING);
+  #endif
+
+  Serial.printf("[WRIST] Raise-to-wake %s (%s)\n", wrist_ready ? "armed" : "FAILED",
+                WRIST_WAKE_INT_PIN >= 0 ? "INT1" : "STATUS1 poll");
+  return wrist_ready;
+}
+
+void enableWristWakeSource() {
+  #if WRIST_WAKE_INT_PIN >= 0
+    gpio_wakeup_enable((gpio_num_t)WRIST_WAKE_INT_PIN, GPIO_INTR_HIGH_LEVEL);
+  #endif
+}
+
+// No INT pin and the FIFO polling: read STATUS1 on the FIFO's wake
+static bool ridesFifoPoll() {
+  return WRIST_WAKE_INT_PIN < 0 && IMU_FIFO_INT_PIN < 0 && isIMUFifoActive();
+}
+
+uint32_t getWristPollMs() {
+  return millis() - last_motion_ms >= WRIST_STILL_MS ? WRIST_STILL_POLL_MS : WRIST_POLL_MS;
+}
+
+uint32_t getWristSleepMs() {
+  if (wrist_state == WRIST_CONFIRMING) {
+    long wait = (long)(confirm_next_read - millis());
+    return wait > 0 ? wait : 0;
+  }
+  if (WRIST_WAKE_INT_PIN >= 0 || ridesFifoPoll()) return UINT32_MAX;
+  uint32_t elapsed = millis() - last_poll;
+  uint32_t period = getWristPollMs();
+  return elapsed >= period ? 0 : period - elapsed;
+}
+
+// =============================================================================
+// POSE
+// =============================================================================
+
+static bool readAccelG(float& ax, float& ay, float& az) {
+  uint8_t raw[6];
+  if (!i2cReadRegs(QMI8658_ADDR, QMI8658_AX_L, raw, sizeof(raw))) return false;
+  ax = (int16_t)(raw[0] | (raw[1] << 8)) / (float)IMU_ACCEL_LSB_PER_G;
+  ay = (int16_t)(raw[2] | (raw[3] << 8)) / (float)IMU_ACCEL_LSB_PER_G;
+  az = (int16_t)(raw[4] | (raw[5] << 8)) / (float)IMU_ACCEL_LSB_PER_G;
+  return true;
+}
+
+bool isWristViewingPose(float ax, float ay, float az) {
+  (void)ay;
+  return WRIST_FACE_UP_SIGN * az >= WRIST_FACE_UP_MIN_G && fabsf(ax) <= WRIST_SIDE_MAX_G;
+}
+
+static float angleBetweenDeg(float ax, float ay, float az, float bx, float by, float bz) {
+  float na = sqrtf(ax * ax + ay * ay + az * az);
+  float nb = sqrtf(bx * bx + by * by + bz * bz);
+  if (na < 0.1f || nb < 0.1f) return 0;
+  float c = (ax * bx + ay * by + az * bz) / (na * nb);
+  c = constrain(c, -1.0f, 1.0f);
+  return acosf(c) * 180.0f / (float)M_PI;
+}
+
+// The trigger can lag the raise by a whole poll period, so the pose at the
+// trigger is often already the viewing pose. Search the ring back over the
+// lag plus a raise for the sample furthest from the current pose.
+static bool preTriggerPose(float& x, float& y, float& z, unsigned long& at_ms) {
+  ImuSample now;
+  if (!isIMUFifoActive() || !imuRingLatest(now)) return false;
+  float nx = now.ax / (float)IMU_ACCEL_LSB_PER_G;
+  float ny = now.ay / (float)IMU_ACCEL_LSB_PER_G;
+  float nz = now.az / (float)IMU_ACCEL_LSB_PER_G;
+
+  uint32_t head = imuRingHead();
+  uint32_t span = (WRIST_LOOKBACK_MS + getWristPollMs()) * getIMUFifoOdrHz() / 1000;
+  span = min(span, (uint32_t)(IMU_FIFO_RING_SIZE - IMU_FIFO_WATERMARK));  // Clear of the next drain
+  span = min(span, head);
+  uint32_t cursor = head - span;
+
+  ImuSample batch[32];
+  float best = -1.0f;
+  uint32_t best_seq = head - 1;
+  int n;
+  while ((n = imuRingRead(cursor, batch, 32)) > 0) {
+    for (int i = 0; i < n; i++) {
+      float bx = batch[i].ax / (float)IMU_ACCEL_LSB_PER_G;
+      float by = batch[i].ay / (float)IMU_ACCEL_LSB_PER_G;
+      float bz = batch[i].az / (float)IMU_ACCEL_LSB_PER_G;
+      float angle = angleBetweenDeg(bx, by, bz, nx, ny, nz);
+      if (angle > best) {
+        best = angle;
+        best_seq = cursor - n + i;
+        x = bx;
+        y = by;
+        z = bz;
+      }
+    }
+  }
+  if (best < 0) return false;
+  at_ms = imuRingSampleTimeMs(best_seq);
+  return true;
+}
+
+// =============================================================================
+// TRIGGER + CONFIRMATION
+// =============================================================================
+
+static bool motionTriggered() {
+  if (motion_irq) {
+    motion_irq = false;
+    last_motion_ms = millis();
+    return true;
+  }
+  #if WRIST_WAKE_INT_PIN < 0
+    if (ridesFifoPoll()) {
+      if (last_poll == imuFifoLastPollMs()) return false;
+      last_poll = imuFifoLastPollMs();
+    } else {
+      if (millis() - last_poll < getWristPollMs()) return false;
+      last_poll = millis();
+    }
+    uint8_t status = 0;
+    if (i2cReadReg(QMI8658_ADDR, QMI8658_STATUS1, &status) &&
+        (status & QMI8658_STATUS1_ANY_MOTION)) {
+      last_motion_ms = millis();
+      return true;
+    }
+  #endif
+  return false;
+}
+
+// A trigger opens the window; each later call past confirm_next_read takes
+// one accel read, so the loop keeps serving the FIFO, serial and saves
+// between reads (getWristSleepMs() wakes it for the next one).
+bool pollWristRaise(unsigned long* trigger_ms) {
+  if (!wrist_ready) return false;
+
+  if (wrist_state == WRIST_IDLE) {
+    if (!motionTriggered()) return false;
+    wrist_stats.triggers++;
+    if (!preTriggerPose(start_x, start_y, start_z, motion_start)) {
+      // FIFO off: the pose now is the best there is
+      if (!readAccelG(start_x, start_y, start_z)) return false;
+      motion_start = last_motion_ms;
+    }
+    confirm_start = millis();
+    confirm_next_read = confirm_start + WRIST_CONFIRM_READ_MS;
+    confirm_good = 0;
+    wrist_state = WRIST_CONFIRMING;
+    return false;
+  }
+
+  if ((long)(millis() - confirm_next_read) < 0) return false;
+  confirm_next_read = millis() + WRIST_CONFIRM_READ_MS;
+
+  // Hold the viewing pose for a few reads, having rotated into it
+  float ax, ay, az;
+  bool read_ok = readAccelG(ax, ay, az);
+  if (read_ok && isWristViewingPose(ax, ay, az) &&
+      angleBetweenDeg(start_x, start_y, start_z, ax, ay, az) >= WRIST_MIN_TILT_DEG) {
+    if (++confirm_good >= WRIST_CONFIRM_READS) {
+      wrist_state = WRIST_IDLE;
+      wrist_stats.wakes++;
+      wrist_stats.last_confirm_ms = millis() - motion_start;
+      if (trigger_ms) *trigger_ms = motion_start;
+      return true;
+    }
+  } else {
+    confirm_good = 0;
+  }
+
+  if (!read_ok || millis() - confirm_start >= WRIST_CONFIRM_WINDOW_MS) {
+    wrist_state = WRIST_IDLE;
+    wrist_stats.rejected++;
+  }
+  return false;
+}
+
+void recordWristWakeLatency(unsigned long trigger_ms) {
+  uint32_t latency = millis() - trigger_ms;
+  wrist_stats.last_latency_ms = latency;
+  wrist_stats.total_latency_ms += latency;
+  if (latency > wrist_stats.max_latency_ms) wrist_stats.max_latency_ms = latency;
+  Serial.printf("[WRIST] Raise -> visible in %lu ms (confirm %lu ms)\n",
+                (unsigned long)latency, (unsigned long)wrist_stats.last_confirm_ms);
+}
+
+// =============================================================================
+// DIAGNOSTICS
+// =============================================================================
+
+const WristWakeStats* getWristWakeStats() {
+  return &wrist_stats;
+}
+
+void printWristWakeStats() {
+  uint32_t avg = wrist_stats.wakes ? wrist_stats.total_latency_ms / wrist_stats.wakes : 0;
+  Serial.printf("[WRIST] triggers=%lu wakes=%lu rejected=%lu\n",
+                (unsigned long)wrist_stats.triggers,
+                (unsigned long)wrist_stats.wakes,
+                (unsigned long)wrist_stats.rejected);
+  Serial.printf("[WRIST] latency last=%lu ms avg=%lu ms max=%lu ms\n",
+                (unsigned long)wrist_stats.last_latency_ms,
+                (unsigned long)avg,
+                (unsigned long)wrist_stats.max_latency_ms);
+}
@@ -0,0 +1,102 @@
+/*
+ * wrist_wake.h - Raise-to-Wake
+ * FUSION OS Sensor Layer
+ *
+ * The QMI8658 any-motion engine watches the accelerometer while the screen
+ * is off, so the ESP32 can sit in light sleep. A motion event (INT pin, or
+ * the latched STATUS1 flag when the pin is not routed) opens a short
+ * confirmation window: the watch must end up face-up and tilted well away
+ * from where it started, held for a few reads, before the screen turns on.
+ * The window is a state machine stepped by the loop, one read per pass,
+ * never a blocking wait.
+ * Shakes, arm swings while walking and table bumps fail that check.
+ *
+ * Without the INT pin, STATUS1 is read on the IMU FIFO's status poll
+ * rather than on a timer of its own, and the .ino stretches that shared
+ * poll to WRIST_POLL_MS while the screen is off (WRIST_STILL_POLL_MS on a
+ * still wrist): the screen-off loop then wakes ~2x a second, not ~14x.
+ * The STATUS1 motion flag is latched, so a raise between polls is not
+ * missed - it is seen up to one poll period late, often after the raise
+ * has finished. The start pose is therefore taken from the FIFO ring: of
+ * the samples in the poll period plus WRIST_LOOKBACK_MS before the
+ * trigger, the one furthest from the current pose. Its capture time is
+ * when the motion started.
+ *
+ * Motion -> visible latency (poll lag included) is measured for every wake.
+ */
+
+#ifndef WRIST_WAKE_H
+#define WRIST_WAKE_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+#define WRIST_WAKE_INT_PIN        -1      // QMI8658 INT1 GPIO (-1: not routed, poll STATUS1)
+#define WRIST_LIGHT_SLEEP         1       // Light sleep between polls while the screen is off
+#define WRIST_POLL_MS             500     // STATUS1 poll without an INT pin (screen off)
+#define WRIST_STILL_POLL_MS       1500    // ...once no motion was seen for WRIST_STILL_MS
+#define WRIST_STILL_MS            120000
+
+// Motion engine (thresholds in 1/32 g, windows in samples)
+#define WRIST_MOTION_THRESHOLD    6       // ~0.19 g on any axis
+#define WRIST_MOTION_WINDOW       2
+
+// Confirmation window
+#define WRIST_CONFIRM_WINDOW_MS   450     // Give up after this long
+#define WRIST_CONFIRM_READ_MS     30      // Accel read period inside the window
+#define WRIST_CONFIRM_READS       3       // Consecutive face-up reads required
+#define WRIST_FACE_UP_SIGN        -1      // Sign of Z when the display faces up
+#define WRIST_FACE_UP_MIN_G       0.45f   // Z component in the viewing cone (~<63 deg)
+#define WRIST_SIDE_MAX_G          0.65f   // Max X component (watch rolled sideways)
+#define WRIST_MIN_TILT_DEG        25.0f   // Rotation from the pre-raise pose
+#define WRIST_LOOKBACK_MS         1000    // Raise duration searched before the poll lag
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+struct WristWakeStats {
+  uint32_t triggers;          // Motion events seen with the screen off
+  uint32_t wakes;             // Confirmed raises
+  uint32_t rejected;          // Failed the confirmation window
+  uint32_t last_confirm_ms;   // Motion start -> confirmed
+  uint32_t last_latency_ms;   // Motion start -> screen visible
+  uint32_t max_latency_ms;
+  uint32_t total_latency_ms;
+};
+
+// =============================================================================
+// FUNCTIONS
+// =============================================================================
+
+// Program the motion engine (after the IMU FIFO is running)
+bool initWristWake();
+
+// Loop hook while the screen is off; never blocks. Returns true on a
+// confirmed raise and sets trigger_ms to when the motion started (the
+// pre-raise pose's capture time, not the later poll that saw it).
+bool pollWristRaise(unsigned long* trigger_ms);
+
+// Call once the screen is visible after a confirmed raise
+void recordWristWakeLatency(unsigned long trigger_ms);
+
+// Arm the IMU pin as a light-sleep wake source (no-op without a pin)
+void enableWristWakeSource();
+
+// Timer wake needed while the screen is off: the next confirmation read,
+// the next own STATUS1 poll, or UINT32_MAX while riding the FIFO poll
+uint32_t getWristSleepMs();
+
+// Screen-off motion poll period (still wrists poll slower)
+uint32_t getWristPollMs();
+
+// Face-up viewing pose check on an accel vector in g
+bool isWristViewingPose(float ax, float ay, float az);
+
+const WristWakeStats* getWristWakeStats();
+void printWristWakeStats();
+
+void IRAM_ATTR wristWakeISR();
+
+#endif // WRIST_WAKE_H
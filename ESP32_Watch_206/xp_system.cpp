@@ -11,6 +11,8 @@
 #include "xp_system.h"
 #include "display.h"
 #include "themes.h"
+#include "persist.h"
+#include "save_schema.h"
 #include <Preferences.h>
 #include <nvs_flash.h>
 #include <SD_MMC.h>
@@ -285,7 +287,7 @@ void gainExperience(int amount, const char* source) {
   system_state.player_level = char_data->level;
   system_state.player_xp = char_data->xp;
 
-  saveXPData();
+  persistMarkDirty(PERSIST_XP);
 
   extern SystemState system_state;
   if (system_state.current_screen == SCREEN_CHARACTER_STATS) {
@@ -343,7 +345,7 @@ void equipTitle(int title_index) {
       char_data->titles[title_index].unlocked) {
     char_data->equipped_title_index = title_index;
     Serial.printf("[XP] Equipped title: \"%s\"\n", char_data->titles[title_index].name);
-    saveXPData();
+    persistMarkDirty(PERSIST_XP);
   }
 }
 
@@ -407,7 +409,7 @@ void checkDailyLoginBonus() {
     gainExperience(xp_reward, "Daily Login");
     system_state.daily_login_count++;
 
-    saveXPData();
+    persistMarkDirty(PERSIST_XP);
   }
 }
 
@@ -461,8 +463,8 @@ void saveXPData() {
   save.streak_month = (uint8_t)((xp_system.last_streak_month < 0) ? 0 : xp_system.last_streak_month);
   save.longest_streak = (uint8_t)min(xp_system.longest_streak, 255);
 
-  // Single write operation - 85 bytes!
-  prefs.putBytes("d", &save, sizeof(save));
+  // Single write operation - 85 bytes + schema header
+  schemaPutBytes(prefs, "d", SCHEMA_XP, &save, sizeof(save));
 
   // Also save hourly claim hour (not in compact struct as it's volatile)
   prefs.putInt("last_hr", xp_system.last_hourly_claim_hour);
@@ -480,13 +482,11 @@ void saveXPData() {
 // =============================================================================
 void loadXPData() {
   Preferences prefs;
-  prefs.begin("xp", true);  // read-only
+  prefs.begin("xp", false);  // writable: schema upgrades are cached in place
 
   // Try to load new compact format first
   CompactXPSave save;
-  size_t loaded = prefs.getBytes("d", &save, sizeof(save));
-
-  if (loaded == sizeof(save) && save.version == 1) {
+  if (schemaGetBytes(prefs, "d", SCHEMA_XP, &save, sizeof(save)) && save.version == 1) {
     // NEW FORMAT - Unpack compact data
     Serial.println("[XP] Loading compact NVS format");
 
@@ -566,7 +566,7 @@ void loadXPData() {
     prefs.end();
 
     // Now save in new compact format (migration!)
-    saveXPData();
+    persistMarkDirty(PERSIST_XP);
     Serial.println("[XP] Migration complete! Old data converted to compact format.");
   }
 
@@ -985,7 +985,7 @@ bool saveStatsToSD(int slot) {
   SDBackupData backup;
   memset(&backup, 0, sizeof(backup));
   backup.magic = BACKUP_MAGIC;
-  backup.version = 1;
+  backup.version = schemaVersion(SCHEMA_SD_BACKUP);
   backup.timestamp = millis();  // Simple timestamp (could use RTC)
 
   // Pack current XP data
@@ -1059,7 +1059,7 @@ bool loadStatsFromSD(int slot) {
   size_t read_bytes = file.read((uint8_t*)&backup, sizeof(backup));
   file.close();
 
-  if (read_bytes != sizeof(backup)) {
+  if (read_bytes <= offsetof(SDBackupData, version)) {
     Serial.printf("[BACKUP] Read failed! Expected %d, got %d\n", sizeof(backup), read_bytes);
     return false;
   }
@@ -1070,6 +1070,14 @@ bool loadStatsFromSD(int slot) {
     return false;
   }
 
+  // Older slot layouts are upgraded; slots from a newer firmware are refused
+  uint16_t size = read_bytes;
+  if (!schemaUpgrade(SCHEMA_SD_BACKUP, backup.version, (uint8_t*)&backup, &size, sizeof(backup)) ||
+      size != sizeof(backup)) {
+    Serial.printf("[BACKUP] Unsupported backup version %d!\n", backup.version);
+    return false;
+  }
+
   // Validate checksum
   uint32_t expected = calculateChecksum(&backup);
   if (backup.checksum != expected) {
@@ -1265,6 +1273,15 @@ void showSDBackupMenu() {
   gfx->setCursor(centerX - 25, backY + 12);
   gfx->print("BACK");
 
+  // STORAGE button - NVS usage (nvs_inspector.h)
+  int storageY = backY + 50;
+  gfx->fillRect(centerX - 70, storageY, 140, 36, RGB565(15, 18, 25));
+  gfx->drawRect(centerX - 70, storageY, 140, 36, RGB565(80, 200, 255));
+  gfx->setTextSize(2);
+  gfx->setTextColor(RGB565(80, 200, 255));
+  gfx->setCursor(centerX - 47, storageY + 10);
+  gfx->print("STORAGE");
+
   extern void drawSwipeIndicator();
   drawSwipeIndicator();
 }
@@ -1408,6 +1425,15 @@ void handleSDBackupTouch(int x, int y) {
     drawSettingsApp();
     return;
   }
+
+  // STORAGE button
+  int storageY = backY + 50;
+  if (x >= centerX - 70 && x < centerX + 70 && y >= storageY && y < storageY + 36) {
+    system_state.current_screen = SCREEN_NVS_INSPECTOR;
+    extern void drawNvsInspectorScreen();
+    drawNvsInspectorScreen();
+    return;
+  }
 }
 
 void handleBackupListTouch(int x, int y) {
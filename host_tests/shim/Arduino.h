@@ -0,0 +1,121 @@
+/*
+ * Arduino.h - Host shim for the firmware's host tests
+ *
+ * Just enough of the Arduino-ESP32 core and FreeRTOS for the modules
+ * under test to build with plain g++. Time is a manual clock the tests
+ * advance (hostAdvanceMs); Serial output is printed only with V=1.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define IRAM_ATTR
+
+// -----------------------------------------------------------------------------
+// Clock
+// -----------------------------------------------------------------------------
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void hostAdvanceMs(unsigned long ms);
+
+// -----------------------------------------------------------------------------
+// GPIO (recorded for the tests)
+// -----------------------------------------------------------------------------
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// -----------------------------------------------------------------------------
+// Serial
+// -----------------------------------------------------------------------------
+class String : public std::string {
+ public:
+  String() {}
+  String(const char* s) : std::string(s) {}
+  String(const std::string& s) : std::string(s) {}
+};
+
+class HostSerial {
+ public:
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s);
+  size_t println(const char* s = "");
+  void onReceive(std::function<void()> fn) { (void)fn; }
+};
+extern HostSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+extern EspClass ESP;
+
+// -----------------------------------------------------------------------------
+// FreeRTOS recursive mutex
+// -----------------------------------------------------------------------------
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct HostMutex {
+  int depth;
+  bool held_elsewhere;        // Test hook: another task owns it
+};
+typedef HostMutex* SemaphoreHandle_t;
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m);
+
+// -----------------------------------------------------------------------------
+// FreeRTOS event group (single task: a wait with nothing set runs the clock)
+// -----------------------------------------------------------------------------
+typedef uint32_t EventBits_t;
+struct HostEventGroup {
+  EventBits_t bits;
+};
+typedef HostEventGroup* EventGroupHandle_t;
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits);
+EventBits_t xEventGroupSetBitsFromISR(EventGroupHandle_t g, EventBits_t bits, BaseType_t* woken);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t ticks);
+#define portYIELD_FROM_ISR() do {} while (0)
+
+#endif // HOST_ARDUINO_H
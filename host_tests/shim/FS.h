@@ -0,0 +1,86 @@
+/*
+ * FS.h - Host shim: in-memory file system with power-cut injection
+ *
+ * Files are strings in host_files. Every mutation (a byte written, a file
+ * created, truncated, removed or renamed) spends one unit of
+ * host_fs_budget; when it runs out the operation throws HostPowerCut, the
+ * way the power going away would stop the firmware mid-save. A negative
+ * budget is unlimited.
+ *
+ * Directories are the paths made by mkdir() plus the parents of every
+ * file; opening one lists its entries in name order (openNextFile). A
+ * written file takes host_fs_time as its modification time.
+ */
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <map>
+#include <set>
+#include <time.h>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+struct HostPowerCut {};
+
+extern std::map<std::string, std::string> host_files;
+extern std::map<std::string, time_t> host_mtimes;
+extern std::set<std::string> host_dirs;
+extern long host_fs_budget;
+extern time_t host_fs_time;
+
+void hostFsSpend(long units);
+
+namespace fs {
+
+class File {
+ public:
+  File() {}
+  File(const std::string& path, size_t pos) : path_(path), pos_(pos), open_(true) {}
+  static File directory(const std::string& path);
+
+  operator bool() const { return open_; }
+  const char* name() const;
+  bool isDirectory() const { return dir_; }
+  File openNextFile();
+  time_t getLastWrite() const;
+  size_t size() const;
+  bool seek(uint32_t pos);
+  size_t position() const { return pos_; }
+  int available() const;
+  size_t read(uint8_t* buf, size_t len);
+  int read();
+  size_t readBytesUntil(char terminator, char* buf, size_t len);
+  size_t write(const uint8_t* buf, size_t len);
+  size_t write(uint8_t b) { return write(&b, 1); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  void flush() {}
+  void close() { open_ = false; }
+
+ private:
+  std::string path_;
+  size_t pos_ = 0;
+  bool open_ = false;
+  bool dir_ = false;
+  std::string last_;          // Directory: entry openNextFile() returned last
+};
+
+class FS {
+ public:
+  File open(const char* path, const char* mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+};
+
+}  // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
@@ -0,0 +1,10 @@
+/*
+ * HTTPClient.h - Host shim: declarations only, for headers that include it
+ */
+
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+
+#endif // HOST_HTTPCLIENT_H
@@ -0,0 +1,35 @@
+/*
+ * Preferences.h - Host shim: NVS namespaces in memory
+ *
+ * Blobs live in host_nvs["namespace/key"]. A put is copy-on-write like
+ * NVS: the new value must fit in host_nvs_capacity next to the old one
+ * before the old one is released (a negative capacity is unlimited).
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+
+extern std::map<std::string, std::string> host_nvs;
+extern long host_nvs_capacity;
+extern uint32_t host_nvs_puts;
+
+class Preferences {
+ public:
+  bool begin(const char* name, bool read_only = false);
+  void end() { open_ = false; }
+  size_t putBytes(const char* key, const void* value, size_t len);
+  size_t getBytes(const char* key, void* buf, size_t max_len);
+  size_t getBytesLength(const char* key);
+  bool isKey(const char* key) { return host_nvs.count(ns_ + "/" + key) > 0; }
+  bool remove(const char* key);
+
+ private:
+  std::string ns_;
+  bool read_only_ = false;
+  bool open_ = false;
+};
+
+#endif // HOST_PREFERENCES_H
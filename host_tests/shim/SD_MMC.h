@@ -0,0 +1,16 @@
+/*
+ * SD_MMC.h - Host shim: the SD card is the in-memory file system of FS.h
+ */
+
+#ifndef HOST_SD_MMC_H
+#define HOST_SD_MMC_H
+
+#include <FS.h>
+
+namespace fs {
+class SDMMCFS : public FS {};
+}  // namespace fs
+
+extern fs::SDMMCFS SD_MMC;
+
+#endif // HOST_SD_MMC_H
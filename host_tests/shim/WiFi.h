@@ -0,0 +1,10 @@
+/*
+ * WiFi.h - Host shim: declarations only, for headers that include it
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+
+#endif // HOST_WIFI_H
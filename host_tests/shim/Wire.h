@@ -0,0 +1,53 @@
+/*
+ * Wire.h - Host shim: scripted I2C bus
+ *
+ * Devices are register files in host_wire. A test can make the next
+ * transactions fail (host_wire.fail, one result per endTransmission) or
+ * return short reads, to drive the bus manager's retry and bus-clear
+ * paths.
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+struct HostWire {
+  bool present[128];
+  uint8_t regs[128][256];
+  uint8_t pointer[128];
+  std::deque<uint8_t> fail;   // Results forced on the next endTransmission calls
+  int short_reads;            // Next requestFrom calls that return one byte short
+  int begins;                 // Wire.begin() calls (bus clears restart Wire)
+  int transmissions;
+  int reads;
+  std::vector<std::vector<uint8_t>> writes;   // Register pointer + data, per transaction
+};
+extern HostWire host_wire;
+
+class TwoWire {
+ public:
+  bool begin(int sda, int scl);
+  void end();
+  void setClock(uint32_t hz);
+  void beginTransmission(uint8_t addr);
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t len);
+  uint8_t endTransmission(bool stop = true);
+  size_t requestFrom(uint8_t addr, size_t len);
+  int available();
+  int read();
+
+ private:
+  uint8_t addr_ = 0;
+  uint8_t tx_[256];
+  size_t tx_len_ = 0;
+  uint8_t rx_[256];
+  size_t rx_len_ = 0;
+  size_t rx_pos_ = 0;
+};
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,114 @@
+/*
+ * arduino_shim.cpp - Host shim definitions
+ */
+
+#include <Arduino.h>
+#include "host_check.h"
+
+HostSerial Serial;
+EspClass ESP;
+
+static unsigned long host_us = 0;
+
+unsigned long millis() { return host_us / 1000; }
+unsigned long micros() { return host_us; }
+void delay(unsigned long ms) { host_us += ms * 1000; }
+void delayMicroseconds(unsigned int us) { host_us += us; }
+void hostAdvanceMs(unsigned long ms) { host_us += ms * 1000; }
+
+static bool verbose() {
+  static int v = -1;
+  if (v < 0) v = getenv("V") != NULL;
+  return v;
+}
+
+size_t HostSerial::printf(const char* fmt, ...) {
+  if (!verbose()) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vprintf(fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+size_t HostSerial::print(const char* s) {
+  return verbose() ? fputs(s, stdout) : 0;
+}
+
+size_t HostSerial::println(const char* s) {
+  return verbose() ? ::printf("%s\n", s) : 0;
+}
+
+uint32_t EspClass::getFreeHeap() { return 200000; }
+uint32_t EspClass::getMaxAllocHeap() { return 110000; }
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  static HostMutex m;
+  return &m;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticks) {
+  if (m->held_elsewhere) {
+    hostAdvanceMs(ticks);
+    return pdFALSE;
+  }
+  m->depth++;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m) {
+  if (m->depth == 0) return pdFALSE;
+  m->depth--;
+  return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate() {
+  static HostEventGroup g;
+  return &g;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+  g->bits |= bits;
+  return g->bits;
+}
+
+EventBits_t xEventGroupSetBitsFromISR(EventGroupHandle_t g, EventBits_t bits, BaseType_t* woken) {
+  g->bits |= bits;
+  if (woken) *woken = pdFALSE;
+  return pdTRUE;
+}
+
+// Returns the bits as they were before clearing, like FreeRTOS
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+  EventBits_t was = g->bits;
+  g->bits &= ~bits;
+  return was;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t ticks) {
+  (void)all;
+  EventBits_t was = g->bits;
+  if (!(was & bits)) hostAdvanceMs(ticks);
+  if (clear) g->bits &= ~bits;
+  return was;
+}
+
+// GPIO: the tests script SDA through host_gpio
+HostGpio host_gpio;
+
+void pinMode(uint8_t pin, uint8_t mode) { host_gpio.mode[pin] = mode; }
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  host_gpio.level[pin] = val;
+  // A stuck slave releases SDA after host_gpio.stuck_clocks SCL pulses
+  if (pin == host_gpio.scl_pin && val == LOW && host_gpio.stuck_clocks > 0) {
+    host_gpio.scl_pulses++;
+    host_gpio.stuck_clocks--;
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin == host_gpio.sda_pin && host_gpio.stuck_clocks > 0) return LOW;
+  return host_gpio.level[pin];
+}
@@ -0,0 +1,19 @@
+/*
+ * esp_rom_crc.h - Host shim: the ROM's CRC-32 (IEEE 802.3, little endian)
+ */
+
+#ifndef HOST_ESP_ROM_CRC_H
+#define HOST_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+#endif // HOST_ESP_ROM_CRC_H
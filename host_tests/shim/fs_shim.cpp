@@ -0,0 +1,166 @@
+/*
+ * fs_shim.cpp - Host shim: in-memory file system
+ */
+
+#include <FS.h>
+#include <SD_MMC.h>
+
+std::map<std::string, std::string> host_files;
+std::map<std::string, time_t> host_mtimes;
+std::set<std::string> host_dirs;
+long host_fs_budget = -1;
+time_t host_fs_time = 1;
+
+fs::SDMMCFS SD_MMC;
+
+void hostFsSpend(long units) {
+  if (host_fs_budget < 0) return;
+  if (host_fs_budget < units) {
+    host_fs_budget = 0;
+    throw HostPowerCut();
+  }
+  host_fs_budget -= units;
+}
+
+// Direct entries of `dir`: its files and subdirectories, full paths
+static std::set<std::string> dirEntries(const std::string& dir) {
+  std::string prefix = dir + "/";
+  std::set<std::string> entries;
+  auto add = [&](const std::string& path) {
+    if (path.compare(0, prefix.size(), prefix) != 0 || path.size() == prefix.size()) return;
+    size_t slash = path.find('/', prefix.size());
+    entries.insert(slash == std::string::npos ? path : path.substr(0, slash));
+  };
+  for (const auto& f : host_files) add(f.first);
+  for (const auto& d : host_dirs) add(d);
+  return entries;
+}
+
+static bool isDir(const std::string& path) {
+  return host_dirs.count(path) > 0 || !dirEntries(path).empty();
+}
+
+namespace fs {
+
+File File::directory(const std::string& path) {
+  File f(path, 0);
+  f.dir_ = true;
+  return f;
+}
+
+const char* File::name() const {
+  size_t slash = path_.rfind('/');
+  return path_.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File File::openNextFile() {
+  if (!dir_) return File();
+  std::set<std::string> entries = dirEntries(path_);
+  auto it = entries.upper_bound(last_);
+  if (it == entries.end()) return File();
+  last_ = *it;
+  return host_files.count(*it) ? File(*it, 0) : directory(*it);
+}
+
+time_t File::getLastWrite() const {
+  auto it = host_mtimes.find(path_);
+  return it == host_mtimes.end() ? 0 : it->second;
+}
+
+size_t File::size() const {
+  auto it = host_files.find(path_);
+  return it == host_files.end() ? 0 : it->second.size();
+}
+
+bool File::seek(uint32_t pos) {
+  if (pos > size()) return false;
+  pos_ = pos;
+  return true;
+}
+
+int File::available() const {
+  return pos_ < size() ? (int)(size() - pos_) : 0;
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+  const std::string& s = host_files[path_];
+  size_t n = pos_ >= s.size() ? 0 : std::min(len, s.size() - pos_);
+  memcpy(buf, s.data() + pos_, n);
+  pos_ += n;
+  return n;
+}
+
+int File::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+size_t File::readBytesUntil(char terminator, char* buf, size_t len) {
+  size_t n = 0;
+  int c;
+  while (n < len && (c = read()) >= 0 && c != terminator) buf[n++] = (char)c;
+  return n;
+}
+
+size_t File::write(const uint8_t* buf, size_t len) {
+  // Byte by byte, so a cut can land anywhere in a block
+  for (size_t i = 0; i < len; i++) {
+    hostFsSpend(1);
+    host_files[path_].push_back(buf[i]);
+  }
+  host_mtimes[path_] = host_fs_time;
+  pos_ += len;
+  return len;
+}
+
+size_t File::printf(const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  return write((const uint8_t*)buf, n);
+}
+
+File FS::open(const char* path, const char* mode) {
+  if (mode[0] == 'r') {
+    if (host_files.count(path)) return File(path, 0);
+    return isDir(path) ? File::directory(path) : File();
+  }
+  hostFsSpend(1);
+  if (mode[0] == 'w') {
+    host_files[path].clear();
+    host_mtimes[path] = host_fs_time;
+  }
+  std::string& s = host_files[path];
+  return File(path, mode[0] == 'a' ? s.size() : 0);
+}
+
+bool FS::exists(const char* path) {
+  return host_files.count(path) > 0 || isDir(path);
+}
+
+bool FS::mkdir(const char* path) {
+  host_dirs.insert(path);
+  return true;
+}
+
+bool FS::remove(const char* path) {
+  if (!host_files.count(path)) return false;
+  hostFsSpend(1);
+  host_files.erase(path);
+  host_mtimes.erase(path);
+  return true;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  if (!host_files.count(from) || host_files.count(to)) return false;
+  hostFsSpend(1);
+  host_files[to] = host_files[from];
+  host_mtimes[to] = host_mtimes[from];
+  host_files.erase(from);
+  host_mtimes.erase(from);
+  return true;
+}
+
+}  // namespace fs
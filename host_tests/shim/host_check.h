@@ -0,0 +1,43 @@
+/*
+ * host_check.h - Minimal assertions for the host tests
+ */
+
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      exit(1);                                                              \
+    }                                                                       \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                      \
+  do {                                                                      \
+    long long _a = (long long)(a), _b = (long long)(b);                     \
+    if (_a != _b) {                                                         \
+      fprintf(stderr, "%s:%d: CHECK_EQ failed: %s = %lld, %s = %lld\n",     \
+              __FILE__, __LINE__, #a, _a, #b, _b);                          \
+      exit(1);                                                              \
+    }                                                                       \
+  } while (0)
+
+// GPIO state for bus-clear tests
+struct HostGpio {
+  uint8_t mode[64];
+  uint8_t level[64];
+  uint8_t sda_pin;
+  uint8_t scl_pin;
+  int stuck_clocks;           // SCL pulses until a stuck SDA is released
+  int scl_pulses;
+};
+extern HostGpio host_gpio;
+
+void hostAdvanceMs(unsigned long ms);
+
+#endif // HOST_CHECK_H
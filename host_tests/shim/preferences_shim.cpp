@@ -0,0 +1,47 @@
+/*
+ * preferences_shim.cpp - Host shim: NVS namespaces in memory
+ */
+
+#include <Preferences.h>
+
+std::map<std::string, std::string> host_nvs;
+long host_nvs_capacity = -1;
+uint32_t host_nvs_puts = 0;
+
+static size_t nvsUsed() {
+  size_t used = 0;
+  for (const auto& kv : host_nvs) used += kv.second.size();
+  return used;
+}
+
+bool Preferences::begin(const char* name, bool read_only) {
+  ns_ = name;
+  read_only_ = read_only;
+  open_ = true;
+  return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!open_ || read_only_) return 0;
+  host_nvs_puts++;
+  if (host_nvs_capacity >= 0 && (long)(nvsUsed() + len) > host_nvs_capacity) return 0;
+  host_nvs[ns_ + "/" + key].assign((const char*)value, len);
+  return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t max_len) {
+  auto it = host_nvs.find(ns_ + "/" + key);
+  if (!open_ || it == host_nvs.end() || it->second.size() > max_len) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  auto it = host_nvs.find(ns_ + "/" + key);
+  return it == host_nvs.end() ? 0 : it->second.size();
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open_ || read_only_) return false;
+  return host_nvs.erase(ns_ + "/" + key) > 0;
+}
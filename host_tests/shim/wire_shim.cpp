@@ -0,0 +1,75 @@
+/*
+ * wire_shim.cpp - Host shim: scripted I2C bus
+ */
+
+#include <Wire.h>
+
+HostWire host_wire;
+TwoWire Wire;
+
+bool TwoWire::begin(int, int) {
+  host_wire.begins++;
+  return true;
+}
+
+void TwoWire::end() {}
+void TwoWire::setClock(uint32_t) {}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  addr_ = addr & 0x7F;
+  tx_len_ = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (tx_len_ >= sizeof(tx_)) return 0;
+  tx_[tx_len_++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+  size_t n = 0;
+  while (n < len && write(data[n])) n++;
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  host_wire.transmissions++;
+  if (!host_wire.fail.empty()) {
+    uint8_t err = host_wire.fail.front();
+    host_wire.fail.pop_front();
+    if (err) return err;
+  }
+  if (!host_wire.present[addr_]) return 2;  // NACK on the address
+  if (tx_len_ == 0) return 0;
+
+  // First byte sets the register pointer, the rest auto-increment
+  uint8_t reg = tx_[0];
+  if (tx_len_ > 1) host_wire.writes.emplace_back(tx_, tx_ + tx_len_);
+  for (size_t i = 1; i < tx_len_; i++) host_wire.regs[addr_][(uint8_t)(reg + i - 1)] = tx_[i];
+  host_wire.pointer[addr_] = reg;
+  return 0;
+}
+
+size_t TwoWire::requestFrom(uint8_t addr, size_t len) {
+  host_wire.reads++;
+  addr &= 0x7F;
+  rx_len_ = rx_pos_ = 0;
+  if (!host_wire.present[addr]) return 0;
+  size_t n = min(len, sizeof(rx_));
+  if (host_wire.short_reads > 0) {
+    host_wire.short_reads--;
+    n = n ? n - 1 : 0;
+  }
+  uint8_t reg = host_wire.pointer[addr];
+  for (size_t i = 0; i < n; i++) rx_[i] = host_wire.regs[addr][(uint8_t)(reg + i)];
+  rx_len_ = n;
+  return n;
+}
+
+int TwoWire::available() {
+  return (int)(rx_len_ - rx_pos_);
+}
+
+int TwoWire::read() {
+  return rx_pos_ < rx_len_ ? rx_[rx_pos_++] : -1;
+}
@@ -0,0 +1,139 @@
+/*
+ * test_actigraphy.cpp - Activity counts, Cole-Kripke + Webster scoring,
+ * night record packing
+ *
+ * A scripted 10 h night is generated at the sample level (56 Hz): awake
+ * before bed, sleep with the odd turn-over, a 20-minute awakening, sleep,
+ * awake again. The summary must land on the script within the few minutes
+ * the rescoring rules are allowed to move the edges.
+ *
+ * Synthetic by construction, so it pins behaviour rather than accuracy;
+ * recorded traces are scored by test_trace_replay.
+ */
+
+#include "actigraphy.h"
+#include "host_check.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int FS = 56;
+static const int LSB = 8192;
+
+static double uniform(double lo, double hi) {
+  return lo + (hi - lo) * (rand() % 10000) / 10000.0;
+}
+
+enum Phase { AWAKE, ASLEEP };
+
+// One minute of samples; asleep minutes are still apart from a 2 s turn
+static uint16_t minute(ActigraphyCounter& c, Phase p, bool turn) {
+  for (int i = 0; i < FS * 60; i++) {
+    double t = (double)i / FS;
+    double x = 0, z = 1.0 + uniform(-0.004, 0.004);   // Noise inside the dead band
+    if (p == AWAKE) {
+      z += 0.15 * sin(2 * M_PI * uniform(0.3, 2.0) * t) + uniform(-0.1, 0.1);
+      x = 0.3 * sin(2 * M_PI * 0.2 * t);
+    } else if (turn && i < FS * 2) {
+      z += 0.3 * sin(2 * M_PI * 1.0 * t);
+      x = 0.5;
+    }
+    actigraphyAddSample(c, (int16_t)(x * LSB), 0, (int16_t)(z * LSB));
+  }
+  return actigraphyCloseEpoch(c);
+}
+
+static bool within(int v, int lo, int hi) {
+  return v >= lo && v <= hi;
+}
+
+int main() {
+  srand(3);
+
+  // Counter: a still wrist scores zero, motion scores
+  ActigraphyCounter c;
+  actigraphyCounterInit(c, FS, LSB);
+  minute(c, ASLEEP, false);
+  CHECK_EQ(minute(c, ASLEEP, false), 0);
+  uint16_t turn = minute(c, ASLEEP, true);
+  uint16_t awake = minute(c, AWAKE, false);
+  printf("  counts: still 0, turn-over %u, awake %u\n", turn, awake);
+  CHECK(turn > 0 && turn < 5);      // A turn-over alone does not score wake
+  CHECK(awake >= 20);
+
+  // Levels: 0, then 1 + log2, capped at 15
+  CHECK_EQ(actigraphyLevel(0), 0);
+  CHECK_EQ(actigraphyLevel(1), 1);
+  CHECK_EQ(actigraphyLevel(2), 2);
+  CHECK_EQ(actigraphyLevel(3), 2);
+  CHECK_EQ(actigraphyLevel(1000), 10);
+  CHECK_EQ(actigraphyLevel(65535), 15);
+
+  // The night: 0-29 awake, 30-239 asleep, 240-259 awake, 260-569 asleep,
+  // 570-599 awake; a turn-over every 40 minutes of sleep
+  static const int N = 600;
+  static uint16_t counts[N];
+  for (int m = 0; m < N; m++) {
+    bool asleep = (m >= 30 && m < 240) || (m >= 260 && m < 570);
+    counts[m] = minute(c, asleep ? ASLEEP : AWAKE, asleep && m % 40 == 0);
+  }
+
+  static SleepNight night;
+  memset(&night, 0, sizeof(night));
+  actigraphyScore(counts, N, night.sleep);
+  actigraphyRescore(night.sleep, N);
+  actigraphySummarize(night.sleep, N, night.summary);
+  for (int m = 0; m < N; m++) night.level[m] = actigraphyLevel(counts[m]);
+
+  const SleepSummary& s = night.summary;
+  printf("  onset %u offset %u sleep %u min WASO %u min, %u awakenings, %u%% efficient\n",
+         s.onset, s.offset, s.total_sleep, s.waso, s.awakenings, s.efficiency);
+  CHECK(within(s.onset, 30, 40));
+  CHECK(within(s.offset, 565, 572));
+  CHECK(within(s.waso, 18, 34));
+  CHECK(within(s.total_sleep, 490, 525));
+  CHECK_EQ(s.awakenings, 1);
+  CHECK(within(s.efficiency, 80, 88));
+
+  // Webster: a 5-minute "sleep" island inside long wake is wake
+  uint8_t island[60] = {};
+  for (int m = 25; m < 30; m++) island[m] = 1;
+  actigraphyRescore(island, 60);
+  for (int m = 0; m < 60; m++) CHECK_EQ(island[m], 0);
+
+  // No sustained sleep: onset stays at the end
+  SleepSummary none;
+  actigraphySummarize(island, 60, none);
+  CHECK_EQ(none.onset, 60);
+  CHECK_EQ(none.total_sleep, 0);
+
+  // Record round trip
+  night.year = 2026;
+  night.month = 10;
+  night.day = 18;
+  night.start_minute = 21 * 60;
+  static uint8_t packed[ACTI_PACKED_MAX];
+  size_t len = actigraphyPack(night, packed, sizeof(packed));
+  printf("  %d epochs packed into %u bytes\n", N, (unsigned)len);
+  CHECK_EQ(len, (110 + N * 5 + 7) / 8);      // 110-bit header
+  CHECK(len <= ACTI_PACKED_MAX);
+
+  static SleepNight back;
+  CHECK_EQ(actigraphyUnpack(packed, len, back), len);
+  CHECK_EQ(back.year, 2026);
+  CHECK_EQ(back.month, 10);
+  CHECK_EQ(back.day, 18);
+  CHECK_EQ(back.start_minute, 21 * 60);
+  CHECK(memcmp(&back.summary, &night.summary, sizeof(SleepSummary)) == 0);
+  CHECK(memcmp(back.sleep, night.sleep, N) == 0);
+  CHECK(memcmp(back.level, night.level, N) == 0);
+
+  // Truncated, wrong magic, too small a buffer
+  CHECK_EQ(actigraphyUnpack(packed, len - 1, back), 0);
+  packed[0] ^= 0xFF;
+  CHECK_EQ(actigraphyUnpack(packed, len, back), 0);
+  CHECK_EQ(actigraphyPack(night, packed, len - 1), 0);
+
+  printf("actigraphy: OK\n");
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * test_activity_classifier.cpp - Offline evaluation of the activity tree
+ *
+ * Labelled synthetic segments (rest, walk, run, irregular arm motion) with
+ * randomised cadence, amplitude and noise are played back in random order.
+ * Every window's raw label is scored against the segment it came from
+ * (the first window after a change is skipped - it straddles both), and
+ * the debounced label and the active-minute count are checked on top.
+ *
+ * Synthetic by construction, so it pins behaviour rather than accuracy;
+ * recorded traces are scored by test_trace_replay.
+ */
+
+#include "activity_classifier.h"
+#include "host_check.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int FS = 56;
+static const int LSB = 8192;
+static const int CLASSES = 5;       // Indexed by ActivityLabel
+
+static double uniform(double lo, double hi) {
+  return lo + (hi - lo) * (rand() % 10000) / 10000.0;
+}
+
+struct Segment {
+  ActivityLabel truth;
+  double f, amp, noise;
+};
+
+static Segment randomSegment() {
+  Segment s;
+  s.truth = (ActivityLabel)(ACTIVITY_IDLE + rand() % 4);
+  switch (s.truth) {
+    case ACTIVITY_IDLE: s.f = 0;                    s.amp = 0;                    s.noise = uniform(0.002, 0.01); break;
+    case ACTIVITY_WALK: s.f = uniform(1.3, 2.3);    s.amp = uniform(0.1, 0.45);   s.noise = uniform(0.02, 0.1);  break;
+    case ACTIVITY_RUN:  s.f = uniform(2.4, 3.3);    s.amp = uniform(0.5, 1.2);    s.noise = uniform(0.05, 0.2);  break;
+    default:            s.f = 0;                    s.amp = uniform(0.05, 0.5);   s.noise = uniform(0.05, 0.35); break;
+  }
+  return s;
+}
+
+// One sample of the segment at time t (s)
+static void sample(const Segment& s, double t, int16_t& ax, int16_t& az) {
+  double n = s.noise * (uniform(0, 2) - 1);
+  double a = 1.0 + n;
+  // Gait: fundamental plus a heel-strike harmonic. Other: random-phase
+  // jerks over a slow sway.
+  if (s.f > 0) a += s.amp * (sin(2 * M_PI * s.f * t) + 0.3 * sin(4 * M_PI * s.f * t));
+  else if (s.truth == ACTIVITY_OTHER) {
+    a += s.amp * sin(2 * M_PI * uniform(0.2, 4.0) * t + uniform(0, 6)) + 0.1 * sin(2 * M_PI * 0.5 * t);
+  }
+  ax = (int16_t)(0.1 * LSB * sin(t));
+  az = (int16_t)(a * LSB);
+}
+
+int main() {
+  srand(7);
+
+  ActivityClassifier c;
+  activityClassifierInit(c, FS, LSB);
+  CHECK(c.window_len > 0);
+  CHECK_EQ(c.label, ACTIVITY_UNKNOWN);
+
+  // Zero-length window: features cleared, no division
+  ActivityFeatures f;
+  memset(&f, 0xAA, sizeof(f));
+  activityExtractFeatures(c, c.window, 0, f);
+  CHECK_EQ(f.std_mg, 0);
+
+  // Confusion matrix over raw window labels
+  uint32_t confusion[CLASSES][CLASSES] = {};
+  uint32_t held = 0, held_right = 0;
+  double t = 0;
+  for (int seg = 0; seg < 200; seg++) {
+    Segment s = randomSegment();
+    int secs = 10 + rand() % 20;
+    uint32_t first = c.windows;
+    uint32_t seen = c.windows;
+    for (int i = 0; i < FS * secs; i++, t += 1.0 / FS) {
+      int16_t ax, az;
+      sample(s, t, ax, az);
+      activityClassifierUpdate(c, ax, 0, az);
+      if (c.windows == seen) continue;
+      seen = c.windows;
+      if (c.windows <= first + 1) continue;
+      confusion[s.truth][c.raw_label]++;
+      // Debounced label: settled once the hold streak has passed
+      if (c.windows > first + 1 + CLASSIFIER_HOLD_WINDOWS) {
+        held++;
+        if (c.label == s.truth) held_right++;
+      }
+    }
+  }
+
+  printf("  truth \\ raw   idle  walk   run other\n");
+  uint32_t right = 0, total = 0;
+  for (int a = ACTIVITY_IDLE; a < CLASSES; a++) {
+    uint32_t row = 0;
+    for (int b = ACTIVITY_IDLE; b < CLASSES; b++) row += confusion[a][b];
+    printf("  %-12s", activityLabelName((ActivityLabel)a));
+    for (int b = ACTIVITY_IDLE; b < CLASSES; b++) printf(" %5u", (unsigned)confusion[a][b]);
+    uint32_t recall = row ? confusion[a][a] * 100 / row : 0;
+    printf("   recall %u%%\n", (unsigned)recall);
+    CHECK(row > 0);
+    CHECK(recall >= 85);
+    right += confusion[a][a];
+    total += row;
+  }
+  printf("  raw accuracy %u%% over %u windows, debounced %u%%\n",
+         (unsigned)(right * 100 / total), (unsigned)total,
+         (unsigned)(held_right * 100 / held));
+  CHECK(right * 100 / total >= 90);
+  CHECK(held_right * 100 / held >= 90);
+
+  // Active minutes: a minute of walking is active, a minute of rest is not
+  activityClassifierInit(c, FS, LSB);
+  Segment walk = {ACTIVITY_WALK, 1.8, 0.3, 0.04};
+  Segment rest = {ACTIVITY_IDLE, 0, 0, 0.005};
+  int done = 0;
+  for (int i = 0; i < FS * 60; i++, t += 1.0 / FS) {
+    int16_t ax, az;
+    sample(walk, t, ax, az);
+    int r = activityClassifierUpdate(c, ax, 0, az);
+    if (r) done = r;
+  }
+  CHECK_EQ(done, 1);
+  CHECK_EQ(c.active_minutes, 1);
+  done = 0;
+  for (int i = 0; i < FS * 60; i++, t += 1.0 / FS) {
+    int16_t ax, az;
+    sample(rest, t, ax, az);
+    int r = activityClassifierUpdate(c, ax, 0, az);
+    if (r) done = r;
+  }
+  CHECK_EQ(done, -1);
+  CHECK_EQ(c.active_minutes, 1);
+
+  printf("activity_classifier: OK\n");
+  return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * test_activity_history.cpp - History rings: totals and chunked NVS saves
+ *
+ * Three days of steps go in; the window totals must match a plain count,
+ * survive a save/load, and the save must fit in an NVS with room for one
+ * chunk's copy-on-write rewrite but not a second copy of the whole
+ * history. A save that only gets some chunks out leaves every ring
+ * loadable.
+ */
+
+#include "activity_history.h"
+#include "host_check.h"
+#include <Preferences.h>
+#include <vector>
+
+static const uint32_t START = 10 * 1440 + 7 * 60;   // Day 10, 07:00
+static const uint32_t MINUTES = 3 * 1440;
+
+static std::vector<uint32_t> truth;                 // Steps per absolute minute
+
+static uint32_t stepsAt(uint32_t m) {
+  uint32_t hour = (m / 60) % 24;
+  if (hour < 7 || hour > 21) return 0;
+  return (m * 2654435761u >> 24) % 120;             // 0-119, some minutes active
+}
+
+static uint32_t truthSum(uint32_t from, uint32_t to) {
+  uint32_t sum = 0;
+  for (uint32_t m = from; m <= to; m++) sum += truth[m - START];
+  return sum;
+}
+
+static void checkTotals(uint32_t now) {
+  CHECK_EQ(historySteps(HISTORY_MINUTE, 60), truthSum(now - 59, now));
+  uint32_t hour_start = now / 60 * 60;
+  CHECK_EQ(historySteps(HISTORY_HOUR, 24), truthSum(hour_start - 23 * 60, now));
+  uint32_t day_start = now / 1440 * 1440;
+  CHECK_EQ(historySteps(HISTORY_DAY, 2), truthSum(day_start - 1440, now));
+}
+
+int main() {
+  initActivityHistory();
+  uint32_t now = START;
+  for (uint32_t m = START; m < START + MINUTES; m++) {
+    now = m;
+    historyTick(m);
+    uint32_t steps = stepsAt(m);   // Below the minute ring's 255 cap
+    truth.push_back(steps);
+    historyAddSteps(steps);
+  }
+  checkTotals(now);
+  uint32_t day_total = historySteps(HISTORY_DAY, 3);
+  uint32_t active = historyActiveMinutes(HISTORY_DAY, 3);
+  CHECK(active > 0);
+
+  // Room for the chunks plus one chunk's rewrite, not for 2x the history
+  host_nvs_capacity = 7800 + 3400;
+  CHECK(saveActivityHistory());
+  size_t stored = 0;
+  for (const auto& kv : host_nvs) stored += kv.second.size();
+  printf("  %zu bytes in %zu keys\n", stored, host_nvs.size());
+  CHECK(saveActivityHistory());             // Rewrite in place
+
+  CHECK(loadActivityHistory());
+  checkTotals(now);
+  CHECK_EQ(historySteps(HISTORY_DAY, 3), day_total);
+  CHECK_EQ(historyActiveMinutes(HISTORY_DAY, 3), active);
+
+  // Torn save: only the minute chunk is newer. Every ring still loads, and
+  // the older rings are caught up to the newest head.
+  std::map<std::string, std::string> before = host_nvs;
+  for (uint32_t m = now + 1; m <= now + 90; m++) historyTick(m);
+  historyAddSteps(50);
+  CHECK(saveActivityHistory());
+  host_nvs["history/hour"] = before["history/hour"];
+  host_nvs["history/day"] = before["history/day"];
+  CHECK(loadActivityHistory());
+  uint32_t all = truthSum(START, now);
+  CHECK_EQ(historySteps(HISTORY_MINUTE, 1), 50);
+  CHECK_EQ(historySteps(HISTORY_HOUR, HISTORY_HOURS), all);   // Old chunk, no 50
+  CHECK_EQ(historySteps(HISTORY_HOUR, 1), 0);                 // ...advanced to the new hour
+  CHECK_EQ(historySteps(HISTORY_DAY, HISTORY_DAYS), all);
+
+  // A damaged chunk restarts that ring empty; the others load
+  host_nvs["history/day"][40] ^= 1;
+  CHECK(loadActivityHistory());
+  CHECK_EQ(historySteps(HISTORY_DAY, 3), 0);
+  CHECK(historySteps(HISTORY_MINUTE, 60) > 0);
+
+  printf("activity_history: OK\n");
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * test_backup_store.cpp - Incremental snapshots, restore and retention
+ *
+ * Runs the chunk store against the shim's directory-backed file system:
+ * an unchanged snapshot reads and writes no chunks, a one-byte change in
+ * a 40 KB save writes one chunk, an append-only file larger than the old
+ * 256 KB limit is stored and is skipped by length and modification time
+ * while unchanged, a damaged chunk never replaces a live save, and
+ * retention with the chunk sweep leaves every kept snapshot restorable.
+ */
+
+#include "backup_store.h"
+#include "sd_manager.h"
+#include "atomic_file.h"
+#include "time_service.h"
+#include "energy_monitor.h"
+#include "host_check.h"
+#include <mbedtls/sha256.h>
+#include <vector>
+
+// Firmware the store calls into
+bool sdCardInitialized = true;
+static uint32_t host_epoch = 1700000000;
+uint32_t timeServiceEpoch() { return host_epoch; }
+void timeFromEpoch(uint32_t epoch, WatchTime& out) {
+  memset(&out, 0, sizeof(out));
+  out.day = epoch / 86400;
+}
+void energyNoteWrite(EnergyStore store, uint32_t count) { (void)store; (void)count; }
+
+static const char* PLAYER = "/WATCH/data/player.dat";
+static const char* CARDS = "/WATCH/gacha/cards.dat";
+static const char* NIGHTS = "/WATCH/sleep/nights.dat";
+
+static const BackupFile files[] = {
+  {"player.dat", PLAYER},
+  {"cards.dat", CARDS},
+  {"nights.dat", NIGHTS},
+};
+#define FILE_COUNT  3
+
+static std::string pattern(size_t len, uint32_t seed) {
+  std::string s(len, '\0');
+  for (size_t i = 0; i < len; i++) {
+    seed = seed * 1103515245 + 12345;
+    s[i] = (char)(seed >> 16);
+  }
+  return s;
+}
+
+static void save(const char* path, const std::string& body) {
+  File f = atomicFileBegin(SD_MMC, path);
+  f.write((const uint8_t*)body.data(), body.size());
+  CHECK(atomicFileCommit(SD_MMC, path, f));
+}
+
+static void append(const char* path, const std::string& data) {
+  File f = SD_MMC.open(path, FILE_APPEND);
+  f.write((const uint8_t*)data.data(), data.size());
+  f.close();
+}
+
+// Body without the atomic-save footer
+static std::string body(const char* path) {
+  const std::string& s = host_files[path];
+  size_t footer = s.find("\n" ATOMIC_FOOTER_TAG);
+  return footer == std::string::npos ? s : s.substr(0, footer);
+}
+
+// Store path of the chunk holding `data`
+static std::string chunkOf(const std::string& data) {
+  uint8_t hash[32];
+  mbedtls_sha256((const uint8_t*)data.data(), data.size(), hash, 0);
+  char path[64];
+  int n = snprintf(path, sizeof(path), "%s/", SD_BACKUP_CHUNKS);
+  for (int i = 0; i < 8; i++) n += snprintf(path + n, sizeof(path) - n, "%02x", hash[i]);
+  return path;
+}
+
+static int chunkFiles() {
+  int n = 0;
+  for (const auto& f : host_files) {
+    if (f.first.compare(0, strlen(SD_BACKUP_CHUNKS) + 1, SD_BACKUP_CHUNKS "/") == 0) n++;
+  }
+  return n;
+}
+
+// Every file of snapshot `name` rebuilt under /restore, compared
+static bool restoresTo(const char* name, const std::string* want) {
+  static const BackupFile scratch[] = {
+    {"player.dat", "/restore/player.dat"},
+    {"cards.dat", "/restore/cards.dat"},
+    {"nights.dat", "/restore/nights.dat"},
+  };
+  for (const auto& f : scratch) SD_MMC.remove(f.path);
+  if (backupRestore(name, scratch, FILE_COUNT) != FILE_COUNT) return false;
+  for (int i = 0; i < FILE_COUNT; i++) {
+    if (body(scratch[i].path) != want[i]) return false;
+  }
+  return true;
+}
+
+int main() {
+  const BackupStats* st = getBackupStats();
+  std::string live[FILE_COUNT] = {
+    pattern(40 * 1024, 1),
+    "VERSION=1\nJOURNAL_SEQ=4\nCARD_3=0\n",
+    pattern(300 * 1024, 2),                    // Past the old 64-chunk limit
+  };
+  save(PLAYER, live[0]);
+  save(CARDS, live[1]);
+  append(NIGHTS, live[2]);
+
+  // First snapshot: everything hashed and stored, nights.dat included
+  CHECK(backupCreate("s1", files, FILE_COUNT));
+  CHECK_EQ(st->files_hashed, 3);
+  CHECK_EQ(st->chunks_written, 10 + 1 + 75);
+  std::string s1[FILE_COUNT] = {live[0], live[1], live[2]};
+
+  // Unchanged: only the manifest is written, no file is read
+  uint32_t written = st->chunks_written, read = st->bytes_read;
+  host_epoch += 3600;
+  CHECK(backupCreate("s2", files, FILE_COUNT));
+  CHECK_EQ(st->files_skipped, 3);
+  CHECK_EQ(st->chunks_written, written);
+  CHECK_EQ(st->bytes_read, read);
+
+  // One byte of the 40 KB save: one chunk
+  live[0][5000] ^= 0x55;
+  save(PLAYER, live[0]);
+  host_epoch += 3600;
+  CHECK(backupCreate("s3", files, FILE_COUNT));
+  CHECK_EQ(st->chunks_written, written + 1);
+  CHECK_EQ(st->bytes_read, read + 40 * 1024);
+
+  // A night appended: newer mtime and length, only its tail chunk is new
+  host_fs_time += 86400;
+  std::string night = pattern(200, 3);
+  append(NIGHTS, night);
+  live[2] += night;
+  written = st->chunks_written;
+  host_epoch += 86400;
+  CHECK(backupCreate("s4", files, FILE_COUNT));
+  CHECK_EQ(st->chunks_written, written + 1);
+
+  // Restore: every snapshot rebuilds its own bodies
+  CHECK(restoresTo("s1", s1));
+  CHECK(restoresTo("s4", live));
+  CHECK_EQ(st->restore_failures, 0);
+
+  // A damaged chunk fails that file's restore and keeps the live save
+  std::string chunk = chunkOf(live[0].substr(0, BACKUP_CHUNK_SIZE));
+  CHECK(host_files.count(chunk));
+  std::string good = host_files[chunk];
+  host_files[chunk][0] ^= 1;
+  save(PLAYER, "VERSION=1\nLEVEL=1\n");
+  save(CARDS, "VERSION=1\n");
+  std::string before = host_files[PLAYER];
+  CHECK_EQ(backupRestore("s4", files, 2), 1);
+  CHECK(host_files[PLAYER] == before);
+  CHECK(body(CARDS) == live[1]);
+  CHECK_EQ(st->restore_failures, 1);
+  host_files[chunk] = good;
+  CHECK_EQ(backupRestore("s4", files, 2), 2);
+  CHECK(body(PLAYER) == live[0]);
+
+  // Retention: a week of daily snapshots, then keep 2 recent + 3 daily
+  for (int day = 0; day < 7; day++) {
+    host_epoch += 86400;
+    live[0][day * 4096] ^= 0x33;
+    save(PLAYER, live[0]);
+    char name[16];
+    snprintf(name, sizeof(name), "d%d", day);
+    CHECK(backupCreate(name, files, FILE_COUNT));
+  }
+  int chunks_before = chunkFiles();
+  uint16_t removed = backupPrune(2, 3, 0);
+  CHECK(removed > 0);
+  CHECK(chunkFiles() < chunks_before);
+  CHECK_EQ(st->pruned_chunks, chunks_before - chunkFiles());
+  CHECK(restoresTo("d6", live));
+  CHECK(!backupExists("s1"));
+
+  // Every snapshot left restores with verified chunks
+  std::vector<std::string> names;
+  for (const auto& f : host_files) {
+    if (f.first.compare(0, strlen(SD_BACKUP_SNAPS) + 1, SD_BACKUP_SNAPS "/") != 0) continue;
+    std::string name = f.first.substr(strlen(SD_BACKUP_SNAPS) + 1);
+    names.push_back(name.substr(0, name.size() - strlen(BACKUP_SNAP_SUFFIX)));
+  }
+  static const BackupFile scratch[] = {
+    {"player.dat", "/restore/player.dat"},
+    {"cards.dat", "/restore/cards.dat"},
+    {"nights.dat", "/restore/nights.dat"},
+  };
+  uint32_t failures = st->restore_failures;
+  for (const std::string& name : names) {
+    CHECK_EQ(backupRestore(name.c_str(), scratch, FILE_COUNT), FILE_COUNT);
+  }
+  CHECK_EQ(st->restore_failures, failures);
+  int kept = (int)names.size();
+  CHECK_EQ(kept, 11 - removed);
+
+  printf("  %d chunks after retention kept %d of 11 snapshots\n", chunkFiles(), kept);
+  printf("backup_store: OK\n");
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * test_compass_engine.cpp - Compass math: calibration, tilt, smoothing
+ *
+ * The field and gravity vectors of a known heading are rotated through
+ * roll and pitch, and the tilt-compensated heading must not move. Free
+ * fall, a zeroed accelerometer and the watch on its edge must still give
+ * a finite heading. The calibration fit must recover a hard/soft-iron
+ * distortion applied to a sphere of samples.
+ */
+
+#include "compass_engine.h"
+#include "host_check.h"
+#include <math.h>
+#include <stdlib.h>
+
+static const float FIELD_H = 200;     // Horizontal field, counts
+static const float FIELD_V = 350;     // Downward component (northern dip)
+
+static float angleDiff(float a, float b) {
+  float d = fmodf(a - b + 540.0f, 360.0f) - 180.0f;
+  return fabsf(d);
+}
+
+// World frame: x north, y east, z down. Rotate the world vectors into a
+// body frame yawed by `heading`, then pitched about y, then rolled about x.
+static void bodyVectors(float heading, float pitch, float roll, float g,
+                        float m[3], float a[3]) {
+  float wm[3] = {FIELD_H, 0, FIELD_V};
+  float wa[3] = {0, 0, g};          // Flat watch reads +g on z
+  float ch = cosf(heading * (float)M_PI / 180), sh = sinf(heading * (float)M_PI / 180);
+  float cp = cosf(pitch * (float)M_PI / 180), sp = sinf(pitch * (float)M_PI / 180);
+  float cr = cosf(roll * (float)M_PI / 180), sr = sinf(roll * (float)M_PI / 180);
+  float* in[2] = {wm, wa};
+  float* out[2] = {m, a};
+  for (int k = 0; k < 2; k++) {
+    float* v = in[k];
+    // Yaw
+    float x1 = ch * v[0] + sh * v[1];
+    float y1 = -sh * v[0] + ch * v[1];
+    float z1 = v[2];
+    // Pitch about y
+    float x2 = cp * x1 - sp * z1;
+    float z2 = sp * x1 + cp * z1;
+    // Roll about x
+    float y3 = cr * y1 + sr * z2;
+    float z3 = -sr * y1 + cr * z2;
+    out[k][0] = x2;
+    out[k][1] = y3;
+    out[k][2] = z3;
+  }
+}
+
+static void testTilt() {
+  float worst = 0;
+  for (int h = 0; h < 360; h += 15) {
+    for (int p = -60; p <= 60; p += 20) {
+      for (int r = -60; r <= 60; r += 20) {
+        float m[3], a[3];
+        bodyVectors((float)h, (float)p, (float)r, 8192, m, a);
+        float got = compassTiltHeading(m[0], m[1], m[2], a[0], a[1], a[2]);
+        CHECK(got >= 0 && got < 360);
+        float err = angleDiff(got, (float)h);
+        if (err > worst) worst = err;
+      }
+    }
+  }
+  printf("  tilt: worst error %.3f deg over +-60 deg pitch/roll\n", worst);
+  CHECK(worst < 0.5f);
+}
+
+static void testDegenerateGravity() {
+  float m[3], a[3];
+  bodyVectors(90, 0, 0, 8192, m, a);
+
+  // Zeroed accelerometer: untilted heading, not 0/0
+  float h = compassTiltHeading(m[0], m[1], m[2], 0, 0, 0);
+  CHECK(isfinite(h));
+  CHECK(angleDiff(h, 90) < 0.5f);
+
+  // Free fall: a few counts of noise around zero
+  srand(7);
+  for (int i = 0; i < 10000; i++) {
+    float ax = (float)(rand() % 5 - 2), ay = (float)(rand() % 5 - 2), az = (float)(rand() % 5 - 2);
+    h = compassTiltHeading(m[0], m[1], m[2], ax, ay, az);
+    CHECK(isfinite(h) && h >= 0 && h < 360);
+  }
+  h = compassTiltHeading(m[0], m[1], m[2], 1e-30f, 0, 0);
+  CHECK(isfinite(h) && h >= 0 && h < 360);
+
+  // On its edge: gravity entirely on x, (ay, az) = 0
+  h = compassTiltHeading(m[0], m[1], m[2], 8192, 0, 0);
+  CHECK(isfinite(h) && h >= 0 && h < 360);
+  h = compassTiltHeading(m[0], m[1], m[2], -8192, 0, 0);
+  CHECK(isfinite(h) && h >= 0 && h < 360);
+
+  // Non-finite inputs never reach the smoother as NaN
+  h = compassTiltHeading(m[0], m[1], m[2], NAN, 0, 8192);
+  CHECK(isfinite(h));
+  h = compassTiltHeading(NAN, m[1], m[2], 0, 0, 8192);
+  CHECK(isfinite(h));
+  h = compassTiltHeading(m[0], m[1], m[2], INFINITY, 0, 0);
+  CHECK(isfinite(h));
+}
+
+static void testCalibration() {
+  const float off[3] = {420, -310, 95};
+  const float gain[3] = {1.25f, 0.8f, 1.05f};
+  static CompassCalFit fit;
+  compassCalReset(fit);
+  CompassCal cal;
+  compassCalIdentity(cal);
+  CHECK(!compassCalSolve(fit, cal));
+
+  srand(11);
+  for (int i = 0; i < 2000; i++) {
+    // Uniform direction on the sphere
+    float z = (rand() % 20001) / 10000.0f - 1;
+    float t = (rand() % 36000) / 100.0f * (float)M_PI / 180;
+    float s = sqrtf(1 - z * z);
+    float v[3] = {s * cosf(t), s * sinf(t), z};
+    float m[3];
+    for (int k = 0; k < 3; k++) m[k] = v[k] * 400 * gain[k] + off[k];
+    compassCalAddSample(fit, m[0], m[1], m[2]);
+  }
+  CHECK_EQ(compassCalProgress(fit), 100);
+  CHECK(compassCalSolve(fit, cal));
+  CHECK(cal.valid);
+  for (int k = 0; k < 3; k++) {
+    CHECK(fabsf(cal.offset[k] - off[k]) < 2.0f);
+    // Corrected radius is the same on every axis
+    CHECK(fabsf(400 * gain[k] * cal.scale[k] - cal.field) < 0.01f * cal.field);
+  }
+}
+
+static void testSmoothing() {
+  static CompassSmoother sm;
+  compassSmoothReset(sm);
+  float mean = 0;
+  for (int i = 0; i < COMPASS_SMOOTH_LEN; i++) mean = compassSmoothAdd(sm, i % 2 ? 359.0f : 1.0f);
+  CHECK(angleDiff(mean, 0) < 0.01f);
+  CHECK(compassSmoothStability(sm) > 0.99f);
+
+  // Opposite headings cancel: low stability
+  compassSmoothReset(sm);
+  for (int i = 0; i < COMPASS_SMOOTH_LEN; i++) compassSmoothAdd(sm, i % 2 ? 90.0f : 270.0f);
+  CHECK(compassSmoothStability(sm) < 0.01f);
+}
+
+int main() {
+  testTilt();
+  testDegenerateGravity();
+  testCalibration();
+  testSmoothing();
+  printf("compass_engine: OK\n");
+  return 0;
+}
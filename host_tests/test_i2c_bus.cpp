@@ -0,0 +1,109 @@
+/*
+ * test_i2c_bus.cpp - I2C bus manager: retry, bus clear, stats, locking
+ */
+
+#include "i2c_bus.h"
+#include "config.h"
+#include <Wire.h>
+#include "host_check.h"
+
+static const uint8_t DEV = QMI8658_ADDR;
+
+static void reset() {
+  host_wire.fail.clear();
+  host_wire.short_reads = 0;
+  host_gpio.stuck_clocks = 0;
+  host_gpio.scl_pulses = 0;
+  // Out of the bus-clear cooldown
+  hostAdvanceMs(I2C_BUS_CLEAR_COOLDOWN_MS + 1);
+  resetI2CBusStats();
+}
+
+int main() {
+  host_gpio.sda_pin = IIC_SDA;
+  host_gpio.scl_pin = IIC_SCL;
+  host_wire.present[DEV] = true;
+  CHECK(initI2CBus());
+  CHECK_EQ(getI2CBusStats()->device_count, 6);
+
+  // Clean write + read back, bytes counted
+  reset();
+  uint8_t v = 0;
+  CHECK(i2cWriteReg(DEV, 0x02, 0x5A));
+  CHECK(i2cReadReg(DEV, 0x02, &v));
+  CHECK_EQ(v, 0x5A);
+  const I2CDeviceStats* d = getI2CDeviceStats(DEV);
+  CHECK_EQ(d->transactions, 2);
+  CHECK_EQ(d->bytes_written, 2);
+  CHECK_EQ(d->bytes_read, 1);
+  CHECK_EQ(d->retries, 0);
+
+  // One NACK: the immediate retry succeeds, no bus clear
+  reset();
+  host_wire.fail = {I2C_ERR_NACK_DATA};
+  CHECK(i2cWriteReg(DEV, 0x03, 1));
+  CHECK_EQ(d->retries, 1);
+  CHECK_EQ(d->nacks, 1);
+  CHECK_EQ(d->errors, 0);
+  CHECK_EQ(getI2CBusStats()->bus_clears, 0);
+
+  // Two timeouts: the last retry follows a bus clear that clocks a stuck
+  // slave free (SDA low for 3 pulses)
+  reset();
+  host_wire.fail = {I2C_ERR_TIMEOUT, I2C_ERR_TIMEOUT};
+  host_gpio.stuck_clocks = 3;
+  int begins = host_wire.begins;
+  CHECK(i2cWriteReg(DEV, 0x04, 2));
+  CHECK_EQ(d->retries, 2);
+  CHECK_EQ(d->timeouts, 2);
+  CHECK_EQ(getI2CBusStats()->bus_clears, 1);
+  CHECK_EQ(host_gpio.scl_pulses, 3);
+  CHECK_EQ(host_wire.begins, begins + 1);      // Wire restarted
+
+  // Every attempt fails: error recorded, the cooldown suppresses a second
+  // clear right after the first
+  reset();
+  host_wire.fail = {I2C_ERR_TIMEOUT, I2C_ERR_TIMEOUT, I2C_ERR_TIMEOUT,
+                    I2C_ERR_TIMEOUT, I2C_ERR_TIMEOUT, I2C_ERR_TIMEOUT};
+  CHECK(!i2cWriteReg(DEV, 0x05, 3));
+  CHECK(!i2cWriteReg(DEV, 0x05, 3));
+  CHECK_EQ(d->errors, 2);
+  CHECK_EQ(d->last_error, I2C_ERR_TIMEOUT);
+  CHECK_EQ(getI2CBusStats()->bus_clears, 1);
+
+  // Short read counts as a timeout and is retried
+  reset();
+  host_wire.short_reads = 1;
+  CHECK(i2cReadReg(DEV, 0x02, &v));
+  CHECK_EQ(d->timeouts, 1);
+  CHECK_EQ(d->retries, 1);
+
+  // Burst read is chunked to the Wire buffer
+  reset();
+  uint8_t buf[200];
+  int reads = host_wire.reads;
+  CHECK(i2cReadRegs(DEV, 0x00, buf, sizeof(buf)));
+  CHECK_EQ(host_wire.reads - reads, 2);
+  CHECK_EQ(d->bytes_read, sizeof(buf));
+
+  // Absent device: NACK on every attempt, probe stays quiet
+  reset();
+  CHECK(!i2cProbe(0x42));
+  CHECK(!i2cReadReg(0x42, 0, &v));
+  CHECK_EQ(getI2CDeviceStats(0x42)->nacks, 3);
+
+  // Lock held by another task: nothing in the device table changes
+  reset();
+  SemaphoreHandle_t m = xSemaphoreCreateRecursiveMutex();
+  uint8_t devices = getI2CBusStats()->device_count;
+  m->held_elsewhere = true;
+  CHECK(!i2cWriteReg(0x55, 0, 0));
+  m->held_elsewhere = false;
+  CHECK_EQ(getI2CBusStats()->lock_timeouts, 1);
+  CHECK_EQ(getI2CBusStats()->device_count, devices);
+  CHECK(getI2CDeviceStats(0x55) == NULL);
+  CHECK_EQ(m->depth, 0);
+
+  printf("i2c_bus: OK\n");
+  return 0;
+}
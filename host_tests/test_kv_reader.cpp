@@ -0,0 +1,231 @@
+/*
+ * test_kv_reader.cpp - KEY=VALUE reader against the String loaders
+ *
+ * Fuzz: random save files (CRLF, '#' footers, garbage bytes, overflowing
+ * values, out-of-range and >255 indexes, no final newline) are fed to
+ * kvFeed() in random slices and must leave the same state as the old
+ * readStringUntil/trim/indexOf/substring/toInt loop. The one intended
+ * difference: an indexed key needs digits after the prefix (the old loop
+ * turned DECK_S1 into slot 0).
+ *
+ * Bench: a progress.dat-sized file through both, counting heap
+ * allocations with a replaced operator new.
+ */
+
+#include "kv_reader.h"
+#include "host_check.h"
+#include <chrono>
+#include <new>
+#include <random>
+
+static long allocs = 0;
+void* operator new(size_t n) {
+  allocs++;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+#define CARDS 300             // Indexes past uint8_t
+
+struct State {
+  int level, xp, theme, deck_size, deck[5];
+  uint8_t brightness;
+  bool boss[35];
+  int card[CARDS];
+};
+static State S;
+
+static void setTheme(int32_t value, uint16_t index) {
+  (void)index;
+  S.theme = value;
+}
+
+static void setDeckSize(int32_t value, uint16_t index) {
+  (void)index;
+  S.deck_size = constrain(value, 0, 5);
+}
+
+static void setCard(int32_t value, uint16_t index) {
+  S.card[index] = value;
+}
+
+static const KvField fields[] = {
+  {"LEVEL",      KV_INT,  &S.level,      0,     NULL},
+  {"XP",         KV_INT,  &S.xp,         0,     NULL},
+  {"BRIGHTNESS", KV_U8,   &S.brightness, 0,     NULL},
+  {"THEME",      KV_FN,   NULL,          0,     setTheme},
+  {"DECK_SIZE",  KV_FN,   NULL,          0,     setDeckSize},
+  {"DECK_",      KV_INT,  S.deck,        5,     NULL},
+  {"BOSS_",      KV_BOOL, S.boss,        35,    NULL},
+  {"CARD_",      KV_FN,   NULL,          CARDS, setCard},
+};
+static KvSchema schema = {"fuzz", fields, KV_COUNT(fields)};
+
+// =============================================================================
+// REFERENCE - the String loader, step for step
+// =============================================================================
+
+static bool isIndex(const std::string& d) {
+  return !d.empty() && d.size() <= 5 && d.find_first_not_of("0123456789") == std::string::npos;
+}
+
+static void refLoad(const std::string& in, State& r) {
+  size_t pos = 0;
+  while (pos < in.size()) {
+    size_t nl = in.find('\n', pos);               // readStringUntil('\n')
+    if (nl == std::string::npos) nl = in.size();
+    std::string line = in.substr(pos, nl - pos);
+    pos = nl + 1;
+
+    size_t a = 0, b = line.size();                // trim()
+    while (a < b && isspace((unsigned char)line[a])) a++;
+    while (b > a && isspace((unsigned char)line[b - 1])) b--;
+    line = line.substr(a, b - a);
+    if (line.empty() || line[0] == '#') continue;
+
+    size_t eq = line.find('=');                   // indexOf('=')
+    if (eq == std::string::npos || eq == 0) continue;
+    std::string key = line.substr(0, eq);
+    long long v = atoll(line.c_str() + eq + 1);   // toInt()
+    int value = (int)constrain(v, (long long)INT32_MIN, (long long)INT32_MAX);
+    if (key.find('\0') != std::string::npos) continue;
+
+    if (key == "LEVEL") r.level = value;
+    else if (key == "XP") r.xp = value;
+    else if (key == "BRIGHTNESS") r.brightness = (uint8_t)value;
+    else if (key == "THEME") r.theme = value;
+    else if (key == "DECK_SIZE") r.deck_size = constrain(value, 0, 5);
+    else if (key.rfind("DECK_", 0) == 0 && isIndex(key.substr(5))) {
+      int i = atoi(key.c_str() + 5);
+      if (i < 5) r.deck[i] = value;
+    } else if (key.rfind("BOSS_", 0) == 0 && isIndex(key.substr(5))) {
+      int i = atoi(key.c_str() + 5);
+      if (i < 35) r.boss[i] = value != 0;
+    } else if (key.rfind("CARD_", 0) == 0 && isIndex(key.substr(5))) {
+      int i = atoi(key.c_str() + 5);
+      if (i < CARDS) r.card[i] = value;
+    }
+  }
+}
+
+// kvFeed() in random slices, carrying the unused tail as kvLoadFile() does
+static void kvLoad(const std::string& in, std::mt19937& rng) {
+  KvParser p;
+  kvBegin(&p, &schema);
+  std::string buf;
+  size_t off = 0;
+  while (true) {
+    size_t take = std::min(in.size() - off, (size_t)(rng() % 40));
+    buf.append(in, off, take);
+    off += take;
+    bool eof = off >= in.size();
+    buf.erase(0, kvFeed(&p, buf.data(), buf.size(), eof));
+    if (eof) break;
+  }
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+static void fuzz() {
+  static const char* keys[] = {
+    "LEVEL", "XP", "BRIGHTNESS", "THEME", "DECK_SIZE", "DECK_0", "DECK_4", "DECK_5",
+    "DECK_", "BOSS_34", "BOSS_35", "BOSS_007", "BOSS_1000", "CARD_255", "CARD_256",
+    "CARD_299", "CARD_300", "CARD_00299", "CARD_123456", "#FSAV gen", "VERSION",
+    "LEVELX", "DECK_S1",
+  };
+  static const char* values[] = {
+    "5", "-3", "  42abc", "", "+7", "99999999999", "-99999999999", "x", "0", "1",
+    " 255", "256",
+  };
+  const int nkeys = sizeof(keys) / sizeof(keys[0]);
+  const int nvalues = sizeof(values) / sizeof(values[0]);
+
+  std::mt19937 rng(1234);
+  const int CASES = 200000;
+  for (int it = 0; it < CASES; it++) {
+    std::string in;
+    for (int l = rng() % 12; l > 0; l--) {
+      int kind = rng() % 10;
+      if (kind < 7) {
+        if (rng() % 4 == 0) in += " ";
+        in += keys[rng() % nkeys];
+        in += "=";
+        in += values[rng() % nvalues];
+      } else if (kind == 7) {
+        for (int k = rng() % 20; k > 0; k--) in += (char)(rng() % 256);
+      } else if (kind == 8) {
+        in += "noequals";
+      } else {
+        in += "  \t";
+      }
+      in += rng() % 5 == 0 ? "\r\n" : "\n";
+    }
+    if (rng() % 3 == 0 && !in.empty()) in.pop_back();
+
+    State r;
+    memset(&r, 0, sizeof(r));
+    memset(&S, 0, sizeof(S));
+    refLoad(in, r);
+    kvLoad(in, rng);
+    if (memcmp(&r, &S, sizeof(r)) != 0) {
+      fprintf(stderr, "case %d differs:\n", it);
+      fwrite(in.data(), 1, in.size(), stderr);
+    }
+    CHECK(memcmp(&r, &S, sizeof(r)) == 0);
+  }
+  printf("  fuzz: %d cases match the String loader\n", CASES);
+}
+
+static void files() {
+  static fs::FS SDX;
+
+  // A line longer than a block is dropped whole, its neighbours kept
+  host_files["/long.dat"] = "LEVEL=9\n" + std::string(700, 'A') + "=1\nXP=77\nCARD_299=4";
+  memset(&S, 0, sizeof(S));
+  CHECK(kvLoadFile(SDX, "/long.dat", &schema));
+  CHECK_EQ(S.level, 9);
+  CHECK_EQ(S.xp, 77);
+  CHECK_EQ(S.card[299], 4);
+
+  CHECK(!kvLoadFile(SDX, "/missing.dat", &schema));
+}
+
+static void bench() {
+  std::string file = "VERSION=1\nBOSSES_DEFEATED=12\n";
+  for (int i = 0; i < 35; i++) file += "BOSS_" + std::to_string(i) + "=" + std::to_string(i % 2) + "\n";
+  file += "\n#FSAV gen=00000003 len=00000200 crc=deadbeef\n";
+
+  const int N = 20000;
+  State r;
+  long a0 = allocs;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) refLoad(file, r);
+  auto t1 = std::chrono::steady_clock::now();
+  long a1 = allocs;
+  for (int i = 0; i < N; i++) {
+    KvParser p;
+    kvBegin(&p, &schema);
+    kvFeed(&p, file.data(), file.size(), true);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  long a2 = allocs;
+
+  CHECK_EQ(a2 - a1, 0);
+  printf("  bench (%zu bytes): String %.2f us %ld allocs/load, kv %.2f us %ld allocs/load\n",
+         file.size(),
+         std::chrono::duration<double, std::micro>(t1 - t0).count() / N, (a1 - a0) / N,
+         std::chrono::duration<double, std::micro>(t2 - t1).count() / N, (a2 - a1) / N);
+}
+
+int main() {
+  fuzz();
+  files();
+  bench();
+  printf("kv_reader: OK\n");
+  return 0;
+}
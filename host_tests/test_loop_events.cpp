@@ -0,0 +1,90 @@
+/*
+ * test_loop_events.cpp - Screen-off wake rate of the event-driven loop
+ *
+ * Replays the screen-off deadline set through loopWakeWithin() /
+ * loopWaitEvents() with a light-sleep function that runs the host clock,
+ * and reads the wake rate back from the loop's own accounting (the
+ * numbers WIDGET_LOOP prints). Periods are the firmware's constants; each
+ * job's phase is staggered so no two minute-rate deadlines share a wake.
+ *
+ * This measures the loop's scheduling, not the board: wake latency, ISR
+ * wakes and per-wake current still need WIDGET_LOOP on hardware.
+ */
+
+#include "loop_events.h"
+#include "host_check.h"
+#include "imu_fifo.h"
+#include "wrist_wake.h"
+#include "sleep_tracker.h"
+#include "fuel_gauge.h"
+#include "save_scheduler.h"
+#include "time_service.h"
+
+struct Job {
+  LoopDeadline owner;
+  uint32_t period_ms;
+  uint32_t last_ms;
+};
+
+static void lightSleep(uint32_t max_ms) {
+  hostAdvanceMs(max_ms);
+}
+
+// Screen-off loop passes for `seconds`, returns the measured wakes/s
+static float run(Job* jobs, int n, uint32_t seconds) {
+  uint32_t t0 = millis();
+  for (int i = 0; i < n; i++) jobs[i].last_ms = t0 - (uint32_t)(i * 7919 % jobs[i].period_ms);
+  loopWaitEvents(lightSleep);       // Starts the wake-to-wake clock
+  resetLoopEventStats();
+
+  while (millis() - t0 < seconds * 1000UL) {
+    uint32_t now = millis();
+    for (int i = 0; i < n; i++) {
+      uint32_t since = now - jobs[i].last_ms;
+      loopWakeWithin(since >= jobs[i].period_ms ? 0 : jobs[i].period_ms - since, jobs[i].owner);
+    }
+    CHECK_EQ(loopWaitEvents(lightSleep), 0);
+    now = millis();
+    for (int i = 0; i < n; i++) {
+      if (now - jobs[i].last_ms >= jobs[i].period_ms) jobs[i].last_ms = now;
+    }
+  }
+
+  const LoopEventStats* s = getLoopEventStats();
+  CHECK_EQ(s->idle_wakes, 0);
+  CHECK_EQ(s->event_wakes, 0);
+  CHECK(s->sleep_span_ms > 0);
+  return s->sleep_passes * 1000.0f / s->sleep_span_ms;
+}
+
+int main() {
+  initLoopEvents();
+  hostAdvanceMs(1000);
+
+  const uint32_t fifo_cap = IMU_FIFO_HW_DEPTH * 1000UL / IMU_FIFO_ODR_HZ * IMU_FIFO_MAX_POLL_PCT / 100;
+  const uint32_t still_poll = min((uint32_t)WRIST_STILL_POLL_MS, fifo_cap);
+
+  // The minute-rate deadlines every configuration shares
+  #define MINUTE_JOBS                                       \
+    {LOOP_DL_TIME, TIME_RESYNC_MS, 0},                      \
+    {LOOP_DL_SLEEP_EPOCH, SLEEP_EPOCH_MS, 0},               \
+    {LOOP_DL_FUEL, FUEL_SAMPLE_MS, 0},                      \
+    {LOOP_DL_SAVE, SAVE_PMU_POLL_OFF_MS, 0}
+
+  // Before the merged poll: wrist STATUS1 every 100 ms, FIFO every 250 ms
+  Job before[] = {{LOOP_DL_WRIST, 100, 0}, {LOOP_DL_IMU, IMU_FIFO_POLL_MS, 0}, MINUTE_JOBS};
+  Job moving[] = {{LOOP_DL_IMU, WRIST_POLL_MS, 0}, MINUTE_JOBS};
+  Job still[] = {{LOOP_DL_IMU, still_poll, 0}, MINUTE_JOBS};
+
+  float r_before = run(before, 6, 3600);
+  float r_moving = run(moving, 5, 3600);
+  float r_still = run(still, 5, 3600);
+  printf("  screen off: %.2f wakes/s before, %.2f moving, %.2f still (%lu ms poll)\n",
+         r_before, r_moving, r_still, (unsigned long)still_poll);
+
+  CHECK(r_before > 13.0f);
+  CHECK(r_moving < 2.2f);
+  CHECK(r_still < 0.75f);
+  printf("loop_events: OK\n");
+  return 0;
+}
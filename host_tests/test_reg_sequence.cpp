@@ -0,0 +1,56 @@
+/*
+ * test_reg_sequence.cpp - Register tables: burst merging and handshakes
+ *
+ * The two CONFIGURE_MOTION passes of the wrist-wake table put the CTRL9
+ * ACK (0x0A) right before CAL1_L (0x0B). Each command and ACK must go out
+ * as a transaction of its own, in table order; plain contiguous writes
+ * still merge.
+ */
+
+#include "reg_sequence.h"
+#include "qmi8658_reg.h"
+#include "i2c_bus.h"
+#include "config.h"
+#include <Wire.h>
+#include "host_check.h"
+
+static const uint8_t DEV = QMI8658_ADDR;
+
+static const RegSeqEntry two_pass[] = {
+  REG_WRITE(QMI8658_CAL1_L, 0x11),
+  REG_WRITE(QMI8658_CAL1_H, 0x12),
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_MOTION),
+  REG_WRITE(QMI8658_CAL1_L, 0x21),
+  REG_WRITE(QMI8658_CAL1_H, 0x22),
+  QMI8658_SEQ_CMD(QMI8658_CMD_CONFIGURE_MOTION),
+};
+
+int main() {
+  host_gpio.sda_pin = IIC_SDA;
+  host_gpio.scl_pin = IIC_SCL;
+  host_wire.present[DEV] = true;
+  host_wire.regs[DEV][QMI8658_STATUS_INT] = QMI8658_STATUS_INT_CMD_DONE;
+  CHECK(initI2CBus());
+
+  const RegSequence seq = REG_SEQ("two-pass", DEV, two_pass, true);
+  host_wire.writes.clear();
+  RegSeqResult res;
+  CHECK(runRegSequence(seq, &res));
+
+  // CAL pair, CMD, ACK, CAL pair, CMD, ACK
+  const std::vector<std::vector<uint8_t>> expect = {
+    {QMI8658_CAL1_L, 0x11, 0x12},
+    {QMI8658_CTRL9, QMI8658_CMD_CONFIGURE_MOTION},
+    {QMI8658_CTRL9, QMI8658_CMD_ACK},
+    {QMI8658_CAL1_L, 0x21, 0x22},
+    {QMI8658_CTRL9, QMI8658_CMD_CONFIGURE_MOTION},
+    {QMI8658_CTRL9, QMI8658_CMD_ACK},
+  };
+  CHECK_EQ(host_wire.writes.size(), expect.size());
+  for (size_t i = 0; i < expect.size(); i++) CHECK(host_wire.writes[i] == expect[i]);
+  CHECK_EQ(res.i2c_writes, 6);
+  CHECK_EQ(res.registers, 8);
+
+  printf("reg_sequence: OK\n");
+  return 0;
+}
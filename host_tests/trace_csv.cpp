@@ -0,0 +1,151 @@
+/*
+ * trace_csv.cpp - Recorded traces for the replay tests
+ */
+
+#include "trace_csv.h"
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+std::vector<std::string> listTraces(const std::string& dir) {
+  std::vector<std::string> out;
+  DIR* d = opendir(dir.c_str());
+  if (!d) return out;
+  while (struct dirent* e = readdir(d)) {
+    std::string name = e->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0) {
+      out.push_back(dir + "/" + name);
+    }
+  }
+  closedir(d);
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+TraceLabel parseTraceLabel(const std::string& s) {
+  static const struct { const char* name; TraceLabel label; } names[] = {
+    {"idle", TRACE_IDLE}, {"walk", TRACE_WALK}, {"walking", TRACE_WALK},
+    {"run", TRACE_RUN}, {"running", TRACE_RUN}, {"other", TRACE_OTHER},
+    {"moving", TRACE_OTHER}, {"sleep", TRACE_SLEEP}, {"wake", TRACE_WAKE},
+  };
+  for (const auto& n : names) {
+    if (strcasecmp(s.c_str(), n.name) == 0) return n.label;
+  }
+  return TRACE_NONE;
+}
+
+// "key=value" anywhere in a '#' line
+static bool headerValue(const std::string& line, const char* key, long& value) {
+  std::string k = std::string(key) + "=";
+  size_t at = line.find(k);
+  if (at == std::string::npos) return false;
+  value = strtol(line.c_str() + at + k.size(), NULL, 10);
+  return true;
+}
+
+static std::vector<std::string> splitCsv(const std::string& line) {
+  std::vector<std::string> cols;
+  std::stringstream ss(line);
+  std::string col;
+  while (std::getline(ss, col, ',')) {
+    while (!col.empty() && (col.back() == '\r' || col.back() == ' ')) col.pop_back();
+    cols.push_back(col);
+  }
+  return cols;
+}
+
+static std::string baseName(const std::string& path) {
+  size_t slash = path.rfind('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Calls row() for every data row (after the column header) with its columns
+template <typename Row>
+static bool readCsv(const std::string& path, size_t columns, Row row,
+                    std::vector<std::string>* comments = NULL) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", path.c_str());
+    return false;
+  }
+  std::string line;
+  bool header = false;
+  int lineno = 0;
+  while (std::getline(in, line)) {
+    lineno++;
+    if (line.empty() || line == "\r") continue;
+    if (line[0] == '#') {
+      if (comments) comments->push_back(line);
+      continue;
+    }
+    if (!header) {          // Column names
+      header = true;
+      continue;
+    }
+    std::vector<std::string> cols = splitCsv(line);
+    if (cols.size() < columns) {
+      fprintf(stderr, "%s:%d: expected %zu columns\n", path.c_str(), lineno, columns);
+      return false;
+    }
+    row(cols);
+  }
+  return header;
+}
+
+bool loadImuTrace(const std::string& path, ImuTrace& out) {
+  out = ImuTrace();
+  out.name = baseName(path);
+  std::vector<std::string> comments;
+  bool ok = readCsv(path, 4, [&](const std::vector<std::string>& c) {
+    out.ax.push_back((int16_t)atoi(c[0].c_str()));
+    out.ay.push_back((int16_t)atoi(c[1].c_str()));
+    out.az.push_back((int16_t)atoi(c[2].c_str()));
+    out.label.push_back(parseTraceLabel(c[3]));
+  }, &comments);
+  for (const std::string& line : comments) {
+    long v;
+    if (headerValue(line, "odr_hz", v)) out.odr_hz = (uint16_t)v;
+    if (headerValue(line, "lsb_per_g", v)) out.lsb_per_g = v;
+    if (headerValue(line, "steps", v)) out.steps = v;
+  }
+  if (ok && (out.odr_hz == 0 || out.lsb_per_g == 0)) {
+    fprintf(stderr, "%s: no odr_hz / lsb_per_g header\n", path.c_str());
+    return false;
+  }
+  return ok;
+}
+
+bool loadSleepTrace(const std::string& path, SleepTrace& out) {
+  out = SleepTrace();
+  out.name = baseName(path);
+  return readCsv(path, 2, [&](const std::vector<std::string>& c) {
+    out.counts.push_back((uint16_t)atoi(c[0].c_str()));
+    out.label.push_back(parseTraceLabel(c[1]));
+  });
+}
+
+bool loadFuelTrace(const std::string& path, FuelTrace& out) {
+  out = FuelTrace();
+  out.name = baseName(path);
+  std::vector<std::string> comments;
+  bool ok = readCsv(path, 5, [&](const std::vector<std::string>& c) {
+    if (c[0] == "t_s") return;              // Header of a later dump
+    FuelTraceRow r;
+    r.t_s = (uint32_t)strtoul(c[0].c_str(), NULL, 10);
+    if (!out.rows.empty() && r.t_s <= out.rows.back().t_s) return;   // Overlap
+    r.mv = (uint16_t)atoi(c[1].c_str());
+    r.load_ma = (float)atof(c[2].c_str());
+    r.pmu_pct = (int8_t)atoi(c[3].c_str());
+    r.flags = (uint8_t)atoi(c[4].c_str());
+    out.rows.push_back(r);
+  }, &comments);
+  for (const std::string& line : comments) {
+    long v;
+    if (headerValue(line, "capacity_mah", v)) out.capacity_mah = (uint16_t)v;
+  }
+  return ok;
+}
@@ -0,0 +1,75 @@
+/*
+ * trace_csv.h - Recorded traces for the replay tests
+ *
+ * traces/imu/<name>.csv
+ *     WIDGET_IMU_TRACE output: '#' header lines (odr_hz=, lsb_per_g=,
+ *     optional steps= marks), then ax,ay,az,label rows of raw FIFO samples
+ * traces/sleep/<name>.csv
+ *     WIDGET_SLEEP_COUNTS output: count,label per minute
+ * traces/fuel/<name>.csv
+ *     WIDGET_FUEL_LOG output: '# fuel_log capacity_mah=' header, then
+ *     t_s,mv,load_ma,pmu_pct,flags per minute. The ring holds 4 h, so a
+ *     full discharge is several dumps from one boot pasted together;
+ *     repeated column headers and rows already seen (t_s) are skipped.
+ *
+ * Labels: idle, walk, run, other (or the classifier's Idle/Walking/Running/
+ * Moving), sleep, wake; '-' for unlabelled.
+ */
+
+#ifndef TRACE_CSV_H
+#define TRACE_CSV_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum TraceLabel : int8_t {
+  TRACE_NONE = -1,
+  TRACE_IDLE = 1,             // Same values as ActivityLabel
+  TRACE_WALK,
+  TRACE_RUN,
+  TRACE_OTHER,
+  TRACE_SLEEP,
+  TRACE_WAKE
+};
+
+struct ImuTrace {
+  std::string name;
+  uint16_t odr_hz = 0;
+  int32_t lsb_per_g = 0;
+  int32_t steps = -1;         // Counted by hand (# steps=), -1 if not given
+  std::vector<int16_t> ax, ay, az;
+  std::vector<int8_t> label;
+};
+
+struct SleepTrace {
+  std::string name;
+  std::vector<uint16_t> counts;
+  std::vector<int8_t> label;
+};
+
+struct FuelTraceRow {
+  uint32_t t_s;
+  uint16_t mv;
+  float load_ma;
+  int8_t pmu_pct;
+  uint8_t flags;
+};
+
+struct FuelTrace {
+  std::string name;
+  uint16_t capacity_mah = 0;  // 0 if the header was not pasted
+  std::vector<FuelTraceRow> rows;
+};
+
+// *.csv files in dir, sorted; empty if the directory is missing
+std::vector<std::string> listTraces(const std::string& dir);
+
+TraceLabel parseTraceLabel(const std::string& s);
+
+// False (with a message on stderr) on a malformed file
+bool loadImuTrace(const std::string& path, ImuTrace& out);
+bool loadSleepTrace(const std::string& path, SleepTrace& out);
+bool loadFuelTrace(const std::string& path, FuelTrace& out);
+
+#endif // TRACE_CSV_H